@@ -6,11 +6,20 @@
 #define CMARK_NO_SHORT_NAMES
 #include <cmark-gfm.h>
 #include "node.h"
+#include "simd.h"
+#include "houdini.h"
+#include "utf8.h"
 #include <cmark-gfm-core-extensions.h>
 
 #include "harness.h"
 #include "cplusplus.h"
 
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
 #define UTF8_REPL "\xEF\xBF\xBD"
 
 static const cmark_node_type node_types[] = {
@@ -244,6 +253,79 @@ static void accessors(test_batch_runner *runner) {
   cmark_node_free(doc);
 }
 
+static int user_data_freed;
+
+static void free_user_data(cmark_mem *mem, void *user_data) {
+  (void) mem;
+  user_data_freed += *(int *)user_data;
+}
+
+static void user_data(test_batch_runner *runner) {
+  static int one = 1, two = 2;
+  cmark_node *doc = cmark_parse_document("Text *emph*\n", 12, CMARK_OPT_DEFAULT);
+  cmark_node *para = cmark_node_first_child(doc);
+  cmark_node *text = cmark_node_first_child(para);
+  cmark_node *emph = cmark_node_next(text);
+
+  OK(runner, cmark_node_get_user_data(text) == NULL, "no user data by default");
+  STR_EQ(runner, cmark_node_get_string_content(text), "",
+         "inline node has empty string content");
+
+  cmark_node_set_user_data(text, &one);
+  cmark_node_set_user_data_free_func(text, free_user_data);
+  cmark_node_set_user_data(emph, &two);
+  cmark_node_set_user_data_free_func(emph, free_user_data);
+  OK(runner, cmark_node_get_user_data(text) == &one, "get user data");
+  OK(runner, cmark_node_parent_footnote_def(text) == NULL,
+     "no footnote definition");
+
+  cmark_node_set_string_content(emph, "content");
+  STR_EQ(runner, cmark_node_get_string_content(emph), "content",
+         "set string content on an inline node");
+
+  user_data_freed = 0;
+  cmark_node_free(doc);
+  INT_EQ(runner, user_data_freed, 3, "user data freed with the nodes");
+}
+
+static void node_lifetime(test_batch_runner *runner) {
+  static const char markdown[] = "para *one*\n\npara **two**\n";
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_DEFAULT);
+  cmark_node *docs[2], *kept;
+  char *html;
+  int i;
+
+  // Nodes from one parser share slabs across documents; each must stay
+  // valid until it is freed itself, whatever happens to the others.
+  for (i = 0; i < 2; ++i) {
+    cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+    docs[i] = cmark_parser_finish(parser);
+  }
+  cmark_parser_free(parser);
+
+  kept = cmark_node_last_child(docs[0]);
+  cmark_node_unlink(kept);
+  cmark_node_free(docs[0]);
+  cmark_node_append_child(docs[1], kept);
+
+  html = cmark_render_html(docs[1], CMARK_OPT_DEFAULT, NULL);
+  STR_EQ(runner, html,
+         "<p>para <em>one</em></p>\n"
+         "<p>para <strong>two</strong></p>\n"
+         "<p>para <strong>two</strong></p>\n",
+         "nodes outlive their parser and document");
+  free(html);
+
+  cmark_node_free(cmark_node_first_child(docs[1]));
+  html = cmark_render_html(docs[1], CMARK_OPT_DEFAULT, NULL);
+  STR_EQ(runner, html,
+         "<p>para <strong>two</strong></p>\n"
+         "<p>para <strong>two</strong></p>\n",
+         "nodes can be freed one by one");
+  free(html);
+  cmark_node_free(docs[1]);
+}
+
 static void node_check(test_batch_runner *runner) {
   // Construct an incomplete tree.
   cmark_node *doc = cmark_node_new(CMARK_NODE_DOCUMENT);
@@ -741,6 +823,74 @@ static void render_plaintext(test_batch_runner *runner) {
   cmark_node_free(doc);
 }
 
+typedef struct {
+  cmark_strbuf buf;
+  int writes;
+} sink_state;
+
+static void sink_write(const char *data, size_t len, void *userdata) {
+  sink_state *sink = (sink_state *)userdata;
+
+  sink->writes++;
+  cmark_strbuf_write(data, len, &sink->buf);
+}
+
+static void render_to_sink(test_batch_runner *runner) {
+  static const char unit[] = "A *wrapped* paragraph with a [link](/url)\n"
+                             "and 12. a digit after the break.\n"
+                             "\n"
+                             "> - quoted item\n"
+                             ">\n"
+                             ">       code\n"
+                             "\n";
+  cmark_strbuf markdown = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+  sink_state sink = {CMARK_BUF_INIT(cmark_get_default_mem_allocator()), 0};
+  cmark_node *doc;
+  char *expected[6];
+  bufsize_t start;
+  int i;
+
+  for (i = 0; i < 2000; ++i)
+    cmark_strbuf_puts(&markdown, unit);
+  doc = cmark_parse_document((const char *)markdown.ptr, markdown.size,
+                             CMARK_OPT_DEFAULT);
+
+  // Sinks append to what the buffer already holds.
+  cmark_strbuf_puts(&sink.buf, "<!-- previous document -->\n");
+  start = sink.buf.size;
+
+  expected[0] = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+  cmark_render_html_to_sink(doc, CMARK_OPT_DEFAULT, NULL, sink_write, &sink);
+  OK(runner, sink.writes > 1, "large HTML output is written in pieces");
+  expected[1] = cmark_render_xml(doc, CMARK_OPT_DEFAULT);
+  cmark_render_xml_to_sink(doc, CMARK_OPT_DEFAULT, sink_write, &sink);
+  expected[2] = cmark_render_man(doc, CMARK_OPT_DEFAULT, 20);
+  cmark_render_man_to_sink(doc, CMARK_OPT_DEFAULT, 20, sink_write, &sink);
+  expected[3] = cmark_render_commonmark(doc, CMARK_OPT_DEFAULT, 20);
+  cmark_render_commonmark_to_sink(doc, CMARK_OPT_DEFAULT, 20, sink_write,
+                                  &sink);
+  expected[4] = cmark_render_plaintext(doc, CMARK_OPT_DEFAULT, 20);
+  cmark_render_plaintext_to_sink(doc, CMARK_OPT_DEFAULT, 20, sink_write,
+                                 &sink);
+  expected[5] = cmark_render_latex(doc, CMARK_OPT_DEFAULT, 20);
+  cmark_render_latex_to_sink(doc, CMARK_OPT_DEFAULT, 20, sink_write, &sink);
+
+  for (i = 0; i < 6; ++i) {
+    size_t len = strlen(expected[i]);
+    OK(runner,
+       (size_t)(sink.buf.size - start) >= len &&
+           memcmp(sink.buf.ptr + start, expected[i], len) == 0,
+       "sink output %d matches the rendered string", i);
+    start += (bufsize_t)len;
+    free(expected[i]);
+  }
+  INT_EQ(runner, sink.buf.size, start, "sinks write nothing else");
+
+  cmark_node_free(doc);
+  cmark_strbuf_free(&sink.buf);
+  cmark_strbuf_free(&markdown);
+}
+
 static void utf8(test_batch_runner *runner) {
   // Ranges
   test_char(runner, 1, "\x01", "valid utf8 01");
@@ -939,6 +1089,313 @@ static void test_feed_across_line_ending(test_batch_runner *runner) {
   cmark_node_free(document);
 }
 
+static char *parse_and_render(const char *markdown, size_t len,
+                              bool in_place, size_t split, bool tables,
+                              bool *unchanged) {
+  // Each part gets a buffer of its own, so that reading past the end of
+  // either one is caught by the address sanitizer.
+  char *first = (char *)malloc(split ? split : 1);
+  char *second = (char *)malloc(len - split ? len - split : 1);
+  char *html;
+
+  memcpy(first, markdown, split);
+  memcpy(second, markdown + split, len - split);
+
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_SOURCEPOS);
+  if (tables)
+    cmark_parser_attach_syntax_extension(parser,
+                                         cmark_find_syntax_extension("table"));
+  if (in_place) {
+    cmark_parser_feed_in_place(parser, first, split);
+    cmark_parser_feed_in_place(parser, second, len - split);
+  } else {
+    cmark_parser_feed(parser, first, split);
+    cmark_parser_feed(parser, second, len - split);
+  }
+  cmark_node *doc = cmark_parser_finish(parser);
+  html = cmark_render_html(doc, CMARK_OPT_SOURCEPOS,
+                           cmark_parser_get_syntax_extensions(parser));
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+
+  *unchanged = memcmp(first, markdown, split) == 0 &&
+               memcmp(second, markdown + split, len - split) == 0;
+  free(first);
+  free(second);
+
+  return html;
+}
+
+static void test_feed_in_place(test_batch_runner *runner) {
+  static const char markdown[] =
+      "# Heading\n"
+      "#\n"
+      "\n"
+      "- item *one*\r\n"
+      "- item `two`\n"
+      "\n"
+      "```c\n"
+      "int x;\n"
+      "```\n"
+      "<div>\n"
+      "html\n"
+      "</div>\n"
+      "\n"
+      "<!-- comment\n"
+      "-->\n"
+      "a\0b\n"
+      "| a | b |\n"
+      "| - | - |\n"
+      "| c | d |\n"
+      "\n"
+      "[ref]\n"
+      "\n"
+      "[ref]: /url\n"
+      "last line";
+  size_t len = sizeof(markdown) - 1;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  for (int tables = 0; tables < 2; ++tables) {
+    bool unchanged;
+    char *expected =
+        parse_and_render(markdown, len, false, 0, tables, &unchanged);
+
+    // Split at every byte, so each line is parsed in place at the very end
+    // of a buffer, where the scanners must not read past it.
+    for (size_t split = 0; split <= len; ++split) {
+      char *html =
+          parse_and_render(markdown, len, true, split, tables, &unchanged);
+      STR_EQ(runner, html, expected, "feed in place split at %d, tables %d",
+             (int)split, tables);
+      OK(runner, unchanged, "feed in place leaves buffer unchanged");
+      free(html);
+    }
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+    {
+      // The parser must not write to the buffer, so it can be read-only.
+      int fd = open("/dev/zero", O_RDWR);
+      char *buffer = (char *)mmap(NULL, len, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE, fd, 0);
+      close(fd);
+      memcpy(buffer, markdown, len);
+      mprotect(buffer, len, PROT_READ);
+
+      cmark_parser *parser = cmark_parser_new(CMARK_OPT_SOURCEPOS);
+      if (tables)
+        cmark_parser_attach_syntax_extension(
+            parser, cmark_find_syntax_extension("table"));
+      cmark_parser_feed_in_place(parser, buffer, len);
+      cmark_node *doc = cmark_parser_finish(parser);
+      char *html = cmark_render_html(
+          doc, CMARK_OPT_SOURCEPOS, cmark_parser_get_syntax_extensions(parser));
+      STR_EQ(runner, html, expected, "feed in place from read-only memory, "
+                                     "tables %d", tables);
+      free(html);
+      cmark_node_free(doc);
+      cmark_parser_free(parser);
+      munmap(buffer, len);
+    }
+#endif
+
+    free(expected);
+  }
+}
+
+static void simd_kernels(test_batch_runner *runner) {
+  unsigned char buf[300];
+  cmark_simd_level max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+
+  for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+    int failures = 0;
+
+    cmark_simd_set_level((cmark_simd_level)level);
+    for (size_t pos = 0; pos < sizeof(buf); ++pos) {
+      static const unsigned char terminators[] = {'\n', '\r', '\0'};
+      for (size_t t = 0; t < sizeof(terminators); ++t) {
+        memset(buf, 'a', sizeof(buf));
+        buf[pos] = terminators[t];
+        for (size_t start = 0; start <= pos; start += 13) {
+          const unsigned char *end = buf + sizeof(buf);
+          if (cmark_simd_find_eol(buf + start, end) != buf + pos)
+            failures++;
+          if (cmark_simd_find_eol(buf + start, buf + pos) != buf + pos)
+            failures++;
+        }
+      }
+    }
+    INT_EQ(runner, failures, 0, "find_eol at simd level %d", level);
+
+    static const char *sets[] = {"*_[]", "\n\r!&*<[\\]^_`\"'.-~:w",
+                                 "abcdefghijklmnopqrstuvwxyz0123456789",
+                                 "<\xc3\xff"};
+    for (size_t i = 0; i < sizeof(sets) / sizeof(*sets); ++i) {
+      cmark_simd_charset set;
+      const unsigned char *members = (const unsigned char *)sets[i];
+
+      cmark_simd_charset_init(&set);
+      for (size_t j = 0; members[j]; ++j)
+        cmark_simd_charset_add(&set, members[j]);
+
+      failures = 0;
+      for (int c = 0; c < 256; ++c) {
+        for (size_t pos = 0; pos < 100; pos += 3) {
+          const unsigned char *expected;
+
+          memset(buf, ' ', sizeof(buf));
+          buf[pos] = (unsigned char)c;
+          buf[pos + 40] = members[0];
+          expected = cmark_simd_charset_contains(&set, (unsigned char)c)
+                         ? buf + pos
+                         : buf + pos + 40;
+          if (cmark_simd_find_charset(&set, buf, buf + sizeof(buf)) !=
+              expected)
+            failures++;
+          if (cmark_simd_find_charset(&set, buf, buf + pos) != buf + pos)
+            failures++;
+
+          memset(buf, members[0], sizeof(buf));
+          buf[pos] = (unsigned char)c;
+          buf[pos + 40] = ' ';
+          expected = cmark_simd_charset_contains(&set, (unsigned char)c)
+                         ? buf + pos + 40
+                         : buf + pos;
+          if (cmark_simd_find_not_charset(&set, buf, buf + sizeof(buf)) !=
+              expected)
+            failures++;
+          if (cmark_simd_find_not_charset(&set, buf, buf + pos) != buf + pos)
+            failures++;
+        }
+      }
+      INT_EQ(runner, failures, 0, "find_charset set %d at simd level %d",
+             (int)i, level);
+    }
+
+    for (int secure = 0; secure < 2; ++secure) {
+      cmark_strbuf escaped = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+      const char *expected =
+          secure ? "x&quot;&amp;&#39;&#47;&lt;&gt;xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+                   "xxxxxxxxxxxxxxxxxxxxxx&amp;"
+                 : "x&quot;&amp;'/&lt;&gt;xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+                   "xxxxxxxxxxxxxx&amp;";
+      static const char input[] =
+          "x\"&'/<>xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx&";
+
+      houdini_escape_html0(&escaped, (const uint8_t *)input,
+                           sizeof(input) - 1, secure);
+      STR_EQ(runner, cmark_strbuf_cstr(&escaped), expected,
+             "escape_html secure %d at simd level %d", secure, level);
+      cmark_strbuf_free(&escaped);
+    }
+
+    {
+      cmark_strbuf escaped = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+      static const char input[] =
+          "https://example.com/a b?q=\"x\"&r='y'#\xc3\xa9"
+          "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz<>";
+
+      houdini_escape_href(&escaped, (const uint8_t *)input,
+                          sizeof(input) - 1);
+      STR_EQ(runner, cmark_strbuf_cstr(&escaped),
+             "https://example.com/a%20b?q=%22x%22&amp;r=&#x27;y&#x27;#%C3%A9"
+             "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz%3C%3E",
+             "escape_href at simd level %d", level);
+      cmark_strbuf_free(&escaped);
+    }
+
+    failures = 0;
+    for (int c = 0; c < 256; ++c) {
+      cmark_strbuf escaped = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+      char expected[128];
+      size_t pos = (size_t)c % 50, n;
+      bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') ||
+                  (c != 0 && strchr("-_.+!*(),%#@?=;:/$~", c) != NULL);
+
+      memset(buf, 'a', 100);
+      buf[pos] = (unsigned char)c;
+      houdini_escape_href(&escaped, buf, 100);
+
+      memset(expected, 'a', pos);
+      if (c == '&')
+        strcpy(expected + pos, "&amp;");
+      else if (c == '\'')
+        strcpy(expected + pos, "&#x27;");
+      else if (safe)
+        sprintf(expected + pos, "%c", c);
+      else
+        sprintf(expected + pos, "%%%02X", c);
+      n = strlen(expected);
+      memset(expected + n, 'a', 99 - pos);
+      expected[n + 99 - pos] = 0;
+
+      if (strcmp(cmark_strbuf_cstr(&escaped), expected) != 0)
+        failures++;
+      cmark_strbuf_free(&escaped);
+    }
+    INT_EQ(runner, failures, 0, "escape_href bytes at simd level %d", level);
+  }
+
+  cmark_simd_set_level(max);
+}
+
+static void simd_utf8(test_batch_runner *runner) {
+  static const char *fragments[] = {
+      "a",        "plain ascii text ", "\n",           "\0",
+      "\xC3\xA9",   "\xE2\x82\xAC",      "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF",
+      "\x80",     "\xBF",               "\xC0\x80",     "\xC1\xBF",
+      "\xC2",     "\xE0\xA0",           "\xE0\x80\x80", "\xED\xA0\x80",
+      "\xF0\x90", "\xF0\x8F\xBF\xBF",   "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80",
+      "\xFF",     "\xEF\xBB\xBF"};
+  size_t num_fragments = sizeof(fragments) / sizeof(*fragments);
+  cmark_simd_level max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+  unsigned int seed = 1;
+  int failures = 0;
+
+  for (int round = 0; round < 3000; ++round) {
+    cmark_mem *mem = cmark_get_default_mem_allocator();
+    cmark_strbuf input = CMARK_BUF_INIT(mem);
+    cmark_strbuf expected = CMARK_BUF_INIT(mem);
+    // Mostly valid text with the occasional bad sequence, so that errors
+    // land at every offset within a vector.
+    int count = (int)(seed % 60);
+
+    for (int i = 0; i < count; ++i) {
+      seed = seed * 1103515245 + 12345;
+      size_t f = (seed >> 16) % (num_fragments * 4);
+      cmark_strbuf_puts(&input, fragments[f < num_fragments * 3 ? f % 8 : f % num_fragments]);
+      if (f % num_fragments == 3)
+        cmark_strbuf_putc(&input, '\0');
+    }
+    seed = seed * 1103515245 + 12345;
+
+    cmark_simd_set_level(CMARK_SIMD_NONE);
+    cmark_utf8proc_check(&expected, input.ptr, input.size);
+
+    for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+      cmark_strbuf actual = CMARK_BUF_INIT(mem);
+      bool unchanged = expected.size == input.size &&
+                       memcmp(expected.ptr, input.ptr, input.size) == 0;
+
+      cmark_simd_set_level((cmark_simd_level)level);
+      cmark_utf8proc_check(&actual, input.ptr, input.size);
+      if (actual.size != expected.size ||
+          memcmp(actual.ptr, expected.ptr, expected.size) != 0)
+        failures++;
+      if (cmark_utf8proc_is_valid(input.ptr, input.size) != unchanged)
+        failures++;
+      cmark_strbuf_free(&actual);
+    }
+
+    cmark_strbuf_free(&input);
+    cmark_strbuf_free(&expected);
+  }
+
+  INT_EQ(runner, failures, 0, "utf8 validation agrees across simd levels");
+  cmark_simd_set_level(max);
+}
+
 #if !defined(_WIN32) || defined(__CYGWIN__)
 #  include <sys/time.h>
 static struct timeval _before, _after;
@@ -1572,7 +2029,1348 @@ static void table_spans(test_batch_runner *runner) {
   }
 }
 
-int main() {
+static void arena_objects(test_batch_runner *runner) {
+  static const char markdown[] =
+    "# Title\n"
+    "\n"
+    "| a | b |\n"
+    "| - | - |\n"
+    "| c | d |\n"
+    "not a row\n";
+  static const char expected[] =
+    "<h1>Title</h1>\n"
+    "<table>\n"
+    "<thead>\n"
+    "<tr>\n"
+    "<th>a</th>\n"
+    "<th>b</th>\n"
+    "</tr>\n"
+    "</thead>\n"
+    "<tbody>\n"
+    "<tr>\n"
+    "<td>c</td>\n"
+    "<td>d</td>\n"
+    "</tr>\n"
+    "<tr>\n"
+    "<td>not a row</td>\n"
+    "<td></td>\n"
+    "</tr>\n"
+    "</tbody>\n"
+    "</table>\n";
+  cmark_arena *arenas[2];
+  int i, round;
+
+  arenas[0] = cmark_arena_new();
+  arenas[1] = cmark_arena_new();
+  OK(runner, arenas[0] && arenas[1], "cmark_arena_new");
+  OK(runner, cmark_arena_get_mem(arenas[0]) != cmark_arena_get_mem(arenas[1]),
+     "arenas have distinct allocators");
+
+  // Interleave two parsers on two arenas, then reuse both after clearing.
+  for (round = 0; round < 2; ++round) {
+    cmark_parser *parsers[2];
+    cmark_node *docs[2];
+
+    for (i = 0; i < 2; ++i) {
+      parsers[i] = cmark_parser_new_with_mem(CMARK_OPT_DEFAULT,
+                                             cmark_arena_get_mem(arenas[i]));
+      cmark_parser_attach_syntax_extension(parsers[i],
+                                           cmark_find_syntax_extension("table"));
+    }
+    for (i = 0; i < 2; ++i)
+      cmark_parser_feed(parsers[i], markdown, sizeof(markdown) - 1);
+    for (i = 0; i < 2; ++i) {
+      docs[i] = cmark_parser_finish(parsers[i]);
+      char *html = cmark_render_html(docs[i], CMARK_OPT_DEFAULT,
+                                     cmark_parser_get_syntax_extensions(parsers[i]));
+      STR_EQ(runner, html, expected, "arena %d round %d renders", i, round);
+    }
+    for (i = 0; i < 2; ++i)
+      cmark_arena_clear(arenas[i]);
+  }
+
+  cmark_arena_free(arenas[0]);
+  cmark_arena_free(arenas[1]);
+  cmark_arena_free(NULL);
+
+  {
+    // There is no limit on how many arenas may be live at once.
+    cmark_arena *all[200];
+    cmark_node *docs[200];
+    int distinct = 1, rendered = 1;
+
+    for (i = 0; i < 200; ++i) {
+      cmark_parser *parser;
+
+      all[i] = cmark_arena_new();
+      parser = cmark_parser_new_with_arena(CMARK_OPT_DEFAULT, all[i]);
+      cmark_parser_feed(parser, "*text*", 6);
+      docs[i] = cmark_parser_finish(parser);
+      cmark_parser_free(parser);
+      if (cmark_arena_from_mem(cmark_node_mem(docs[i])) != all[i])
+        distinct = 0;
+    }
+    for (i = 0; i < 200; ++i) {
+      char *html = cmark_render_html(docs[i], CMARK_OPT_DEFAULT, NULL);
+      // The output lives in the arena too.
+      if (strcmp(html, "<p><em>text</em></p>\n") != 0)
+        rendered = 0;
+    }
+    OK(runner, distinct, "each of 200 arenas builds its own documents");
+    OK(runner, rendered, "documents in 200 live arenas render");
+
+    cmark_node *doc = cmark_parse_document("text", 4, CMARK_OPT_DEFAULT);
+    size_t len;
+    unsigned char *data = cmark_node_serialize(
+        doc, cmark_get_default_mem_allocator(), &len);
+    cmark_node *copy = cmark_node_deserialize(
+        data, len, CMARK_OPT_DOCUMENT_ARENA, cmark_get_default_mem_allocator());
+    OK(runner, copy != NULL, "deserialize into an arena with 200 live");
+    cmark_node_free(copy);
+    free(data);
+    cmark_node_free(doc);
+
+    for (i = 0; i < 200; ++i)
+      cmark_arena_free(all[i]);
+  }
+}
+
+static void arena_realloc_growth(test_batch_runner *runner) {
+  cmark_arena *arena = cmark_arena_new();
+  cmark_mem *mem = cmark_arena_get_mem(arena);
+  unsigned char *buf = NULL, *other;
+  size_t size = 0, new_size, i;
+  bool intact = true;
+
+  // A buffer that stays the most recent allocation grows in place, both
+  // inside the head chunk and once it needs a chunk of its own; it is only
+  // copied when it moves between chunks, so the waste stays bounded by the
+  // small chunk sizes rather than by the final size.
+  for (new_size = 16; new_size <= 4 * 1048576; new_size = new_size * 3 / 2) {
+    buf = (unsigned char *)cmark_mem_realloc(mem, buf, new_size);
+    for (i = size; i < new_size; ++i)
+      buf[i] = (unsigned char)i;
+    size = new_size;
+  }
+  for (i = 0; i < size; ++i)
+    intact = intact && buf[i] == (unsigned char)i;
+  OK(runner, intact, "growing buffer keeps its contents");
+  OK(runner, cmark_arena_wasted(arena) < 256 * 1024,
+     "growing the last allocation wastes little");
+
+  buf = (unsigned char *)cmark_mem_calloc(mem, 1, 100);
+  memset(buf, 'x', 100);
+  other = (unsigned char *)cmark_mem_calloc(mem, 1, 100);
+  buf = (unsigned char *)cmark_mem_realloc(mem, buf, 200);
+  OK(runner, buf[0] == 'x' && buf[99] == 'x' && buf != other,
+     "moved buffer keeps its contents");
+  OK(runner, cmark_arena_wasted(arena) >= 100,
+     "moving a buffer counts it as wasted");
+  OK(runner, cmark_mem_realloc(mem, buf, 50) == buf,
+     "shrinking stays in place");
+
+  cmark_arena_clear(arena);
+  INT_EQ(runner, (int)cmark_arena_size(arena), 0, "clear releases chunks");
+  INT_EQ(runner, (int)cmark_arena_wasted(arena), 0, "clear resets waste");
+  cmark_arena_free(arena);
+}
+
+static void arena_retain(test_batch_runner *runner) {
+  static const int modes[] = {CMARK_ARENA_RETAIN,
+                              CMARK_ARENA_RETAIN | CMARK_ARENA_MMAP};
+  static const char markdown[] = "Some *emphasis* and `code`.\n";
+  size_t len;
+  char *big = NULL, *expected;
+  int m, i, j;
+
+  // Long enough for the mapped arena to rewind its chunks with madvise.
+  len = 40000 * 8;
+  big = (char *)malloc(len);
+  for (i = 0; i < (int)len; i += 8)
+    memcpy(big + i, "- item\n\n", 8);
+
+  {
+    cmark_parser *parser = cmark_parser_new(CMARK_OPT_DEFAULT);
+    cmark_parser_feed(parser, big, len);
+    cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+    cmark_node *doc = cmark_parser_finish(parser);
+    expected = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+    cmark_node_free(doc);
+    cmark_parser_free(parser);
+  }
+
+  for (m = 0; m < 2; ++m) {
+    cmark_arena *arena = cmark_arena_new_with_options(modes[m], 8 * 1048576);
+    cmark_mem *mem = cmark_arena_get_mem(arena);
+    size_t kept = 0;
+
+    for (i = 0; i < 3; ++i) {
+      cmark_parser *parser = cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, mem);
+      cmark_parser_feed(parser, big, len);
+      cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+      cmark_node *doc = cmark_parser_finish(parser);
+      char *html = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+      STR_EQ(runner, html, expected, "mode %d document %d renders", m, i);
+      cmark_arena_clear(arena);
+
+      if (i == 0)
+        kept = cmark_arena_size(arena);
+      else
+        INT_EQ(runner, (int)cmark_arena_size(arena), (int)kept,
+               "mode %d document %d reuses the kept chunks", m, i);
+    }
+    OK(runner, kept > 0 && kept <= 8 * 1048576, "mode %d keeps chunks", m);
+    cmark_arena_free(arena);
+
+    // Memory handed out after a rewind reads back as zero, including pages
+    // of a mapped chunk that were handed back with madvise.
+    arena = cmark_arena_new_with_options(modes[m], 8 * 1048576);
+    mem = cmark_arena_get_mem(arena);
+    {
+      bool zero = true;
+      for (i = 0; i < 512; ++i) {
+        unsigned char *p = (unsigned char *)cmark_mem_calloc(mem, 1, 16384);
+        for (j = 0; j < 16384; ++j)
+          zero = zero && p[j] == 0;
+        memset(p, 0xff, 16384);
+      }
+      cmark_arena_clear(arena);
+      for (i = 0; i < 512; ++i) {
+        unsigned char *p = (unsigned char *)cmark_mem_calloc(mem, 1, 16384);
+        for (j = 0; j < 16384; ++j)
+          zero = zero && p[j] == 0;
+      }
+      OK(runner, zero, "mode %d rewound memory is zeroed", m);
+    }
+
+    cmark_arena_free(arena);
+  }
+
+  // Chunks beyond the high-water mark are freed.
+  {
+    cmark_arena *arena = cmark_arena_new_with_options(CMARK_ARENA_RETAIN, 100000);
+    cmark_mem *mem = cmark_arena_get_mem(arena);
+    cmark_parser *parser = cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, mem);
+    cmark_parser_feed(parser, big, len);
+    cmark_parser_finish(parser);
+    OK(runner, cmark_arena_size(arena) > 100000, "big document outgrows mark");
+    cmark_arena_clear(arena);
+    OK(runner, cmark_arena_size(arena) <= 100000, "clear trims to high-water mark");
+    cmark_arena_free(arena);
+  }
+
+  free(expected);
+  free(big);
+}
+
+static char *render_with_table(cmark_node *doc, cmark_parser *parser) {
+  return cmark_render_html(doc, CMARK_OPT_FOOTNOTES,
+                           cmark_parser_get_syntax_extensions(parser));
+}
+
+static void document_arena(test_batch_runner *runner) {
+  static const char markdown[] =
+      "A *paragraph* with a note[^n].\n"
+      "\n"
+      "| a | b |\n"
+      "|:--|--:|\n"
+      "| 1 | 2 |\n"
+      "\n"
+      "[^n]: The note.\n";
+  const int options = CMARK_OPT_FOOTNOTES | CMARK_OPT_DOCUMENT_ARENA;
+  cmark_parser *parser;
+  cmark_node *docs[2], *kept, *copy;
+  char *expected, *html;
+  int i;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  parser = cmark_parser_new(CMARK_OPT_FOOTNOTES);
+  cmark_parser_attach_syntax_extension(parser, cmark_find_syntax_extension("table"));
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  docs[0] = cmark_parser_finish(parser);
+  expected = render_with_table(docs[0], parser);
+  cmark_node_free(docs[0]);
+  cmark_parser_free(parser);
+
+  // Every document of a parser gets an arena of its own.
+  parser = cmark_parser_new(options);
+  cmark_parser_attach_syntax_extension(parser, cmark_find_syntax_extension("table"));
+  for (i = 0; i < 2; ++i) {
+    cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+    docs[i] = cmark_parser_finish(parser);
+    OK(runner, cmark_arena_from_mem(cmark_node_mem(docs[i])) != NULL,
+       "document %d lives in an arena", i);
+  }
+  OK(runner, cmark_node_mem(docs[0]) != cmark_node_mem(docs[1]),
+     "documents have separate arenas");
+
+  // The output comes from the parser's allocator and outlives the arena.
+  html = render_with_table(docs[1], parser);
+  STR_EQ(runner, html, expected, "document arena renders the same");
+  free(html);
+  html = cmark_render_xml(cmark_node_first_child(docs[1]), CMARK_OPT_DEFAULT);
+  OK(runner, strncmp(html, "<?xml", 5) == 0 && strstr(html, "<paragraph"),
+     "output for a node in the arena is the caller's");
+  free(html);
+
+  // A node copied out of a document survives freeing it.
+  kept = cmark_node_first_child(docs[0]);
+  cmark_node_unlink(kept);
+  copy = cmark_node_new(CMARK_NODE_DOCUMENT);
+  cmark_node_append_child(copy, cmark_node_copy(kept, cmark_get_default_mem_allocator()));
+  cmark_node_free(docs[0]);
+  html = cmark_render_html(copy, CMARK_OPT_DEFAULT, NULL);
+  STR_EQ(runner, html,
+         "<p>A <em>paragraph</em> with a note<sup class=\"footnote-ref\">"
+         "<a href=\"#fn-1\" id=\"fnref-1\" data-footnote-ref>1</a></sup>.</p>\n",
+         "copied node outlives its document");
+  free(html);
+  cmark_node_free(copy);
+
+  // Copying the whole document keeps tables and footnote links intact.
+  copy = cmark_node_copy(docs[1], cmark_get_default_mem_allocator());
+  cmark_node_free(docs[1]);
+  html = render_with_table(copy, parser);
+  STR_EQ(runner, html, expected, "copied document renders the same");
+  free(html);
+  cmark_node_free(copy);
+
+  // A document that is never finished goes with the parser.
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  cmark_parser_free(parser);
+
+  docs[0] = cmark_parse_document(markdown, sizeof(markdown) - 1, options);
+  OK(runner, cmark_arena_from_mem(cmark_node_mem(docs[0])) != NULL,
+     "cmark_parse_document honours the option");
+  cmark_node_free(docs[0]);
+
+  // Any number of documents may hold an arena at once.
+  {
+    cmark_node *many[100];
+    int in_arenas = 1;
+
+    for (i = 0; i < 100; ++i) {
+      many[i] = cmark_parse_document(markdown, sizeof(markdown) - 1, options);
+      if (!many[i] || !cmark_arena_from_mem(cmark_node_mem(many[i])))
+        in_arenas = 0;
+    }
+    OK(runner, in_arenas, "100 live documents each have an arena");
+    for (i = 0; i < 100; ++i)
+      cmark_node_free(many[i]);
+  }
+
+  // Nodes from another allocator are refused, and stay the caller's to
+  // free; nodes made with the document's allocator go with it.
+  {
+    cmark_node *para = cmark_node_new(CMARK_NODE_PARAGRAPH);
+    cmark_node *text = cmark_node_new(CMARK_NODE_TEXT);
+    cmark_node *first;
+
+    docs[0] = cmark_parse_document(markdown, sizeof(markdown) - 1, options);
+    first = cmark_node_first_child(docs[0]);
+    cmark_node_set_literal(text, "added text");
+    cmark_node_append_child(para, text);
+    OK(runner,
+       !cmark_node_append_child(docs[0], para) &&
+           !cmark_node_prepend_child(docs[0], para) &&
+           !cmark_node_insert_before(first, para) &&
+           !cmark_node_insert_after(first, para) &&
+           !cmark_node_replace(first, para) && cmark_node_parent(para) == NULL,
+       "an arena document refuses nodes from another allocator");
+    cmark_node_free(para);
+
+    para = cmark_node_new_with_mem(CMARK_NODE_PARAGRAPH,
+                                   cmark_node_mem(docs[0]));
+    text = cmark_node_new_with_mem(CMARK_NODE_TEXT, cmark_node_mem(docs[0]));
+    cmark_node_set_literal(text, "added text");
+    cmark_node_append_child(para, text);
+    OK(runner, cmark_node_append_child(docs[0], para),
+       "an arena document takes nodes made with its allocator");
+    cmark_node_free(docs[0]);
+  }
+
+  free(expected);
+  expected = cmark_markdown_to_html(markdown, sizeof(markdown) - 1,
+                                    CMARK_OPT_FOOTNOTES);
+  html = cmark_markdown_to_html(markdown, sizeof(markdown) - 1, options);
+  STR_EQ(runner, html, expected,
+         "cmark_markdown_to_html returns output that outlives the arena");
+  free(html);
+
+  free(expected);
+}
+
+static void opaque_alloc(cmark_syntax_extension *ext, cmark_mem *mem,
+                         cmark_node *node) {
+  node->as.opaque = cmark_mem_calloc(mem, 1, 16);
+}
+
+static void opaque_free(cmark_syntax_extension *ext, cmark_mem *mem,
+                        cmark_node *node) {
+  cmark_mem_free(mem, node->as.opaque);
+}
+
+static void node_copy(test_batch_runner *runner) {
+  cmark_syntax_extension *ext = cmark_syntax_extension_new("opaque");
+  cmark_node *doc = cmark_parse_document("a *b* `c`\n", 10, CMARK_OPT_DEFAULT);
+  cmark_node *custom, *copy;
+  char *html;
+
+  copy = cmark_node_copy(doc, cmark_get_default_mem_allocator());
+  OK(runner, copy != doc && cmark_node_first_child(copy) !=
+                                cmark_node_first_child(doc),
+     "copy has nodes of its own");
+  html = cmark_render_html(copy, CMARK_OPT_DEFAULT, NULL);
+  STR_EQ(runner, html, "<p>a <em>b</em> <code>c</code></p>\n", "copy renders");
+  free(html);
+  cmark_node_free(copy);
+
+  // Opaque data that the extension cannot copy makes the copy fail.
+  cmark_syntax_extension_set_opaque_alloc_func(ext, opaque_alloc);
+  cmark_syntax_extension_set_opaque_free_func(ext, opaque_free);
+  custom = cmark_node_new_with_ext(CMARK_NODE_CUSTOM_INLINE, ext);
+  cmark_node_append_child(cmark_node_first_child(doc), custom);
+  OK(runner, cmark_node_copy(doc, cmark_get_default_mem_allocator()) == NULL,
+     "copy fails on opaque data it cannot copy");
+
+  cmark_node_free(doc);
+  cmark_syntax_extension_free(cmark_get_default_mem_allocator(), ext);
+}
+
+typedef struct {
+  cmark_strbuf html;
+  int blocks;
+  int detached;
+  cmark_node *kept;
+} stream_state;
+
+static void stream_block(cmark_node *block, void *data) {
+  stream_state *state = (stream_state *)data;
+  char *html = cmark_render_html(block, CMARK_OPT_DEFAULT, NULL);
+
+  if (cmark_node_parent(block) == NULL)
+    ++state->detached;
+  cmark_strbuf_puts(&state->html, html);
+  free(html);
+  if (++state->blocks == 2)
+    state->kept = cmark_node_copy(block, cmark_get_default_mem_allocator());
+}
+
+static void stream_blocks(test_batch_runner *runner) {
+  static const char markdown[] =
+      "[ref]: /url\n"
+      "\n"
+      "# A [link][ref]\n"
+      "\n"
+      "- one\n"
+      "- two\n"
+      "\n"
+      "> quoted *text*\n"
+      "and [later]\n"
+      "\n"
+      "[later]: /later\n";
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_DEFAULT);
+  stream_state state = {CMARK_BUF_INIT(cmark_get_default_mem_allocator()), 0, 0,
+                         NULL};
+  cmark_node *doc;
+  char *html;
+  size_t i;
+
+  cmark_parser_set_stream_block_func(parser, stream_block, &state);
+  for (i = 0; i < sizeof(markdown) - 1; i += 5)
+    cmark_parser_feed(parser, markdown + i,
+                      sizeof(markdown) - 1 - i < 5 ? sizeof(markdown) - 1 - i : 5);
+  doc = cmark_parser_finish(parser);
+
+  STR_EQ(runner, (char *)state.html.ptr,
+         "<h1>A <a href=\"/url\">link</a></h1>\n"
+         "<ul>\n<li>one</li>\n<li>two</li>\n</ul>\n"
+         "<blockquote>\n<p>quoted <em>text</em>\nand [later]</p>\n</blockquote>\n",
+         "blocks are streamed with references defined before them");
+  INT_EQ(runner, state.blocks, 3, "each top-level block is streamed once");
+  INT_EQ(runner, state.detached, 0, "streamed blocks are still linked");
+  OK(runner, cmark_node_first_child(doc) == NULL, "finish returns an empty document");
+  cmark_node_free(doc);
+
+  html = cmark_render_commonmark(state.kept, CMARK_OPT_DEFAULT, 0);
+  STR_EQ(runner, html, "  - one\n  - two\n", "streamed block can be copied");
+  free(html);
+  cmark_node_free(state.kept);
+
+  // Without a stream function the parser builds whole documents again.
+  cmark_parser_set_stream_block_func(parser, NULL, NULL);
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  doc = cmark_parser_finish(parser);
+  html = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+  OK(runner, strstr(html, "<a href=\"/later\">later</a>") != NULL,
+     "whole documents resolve later definitions");
+  free(html);
+  cmark_node_free(doc);
+
+  cmark_strbuf_free(&state.html);
+  cmark_parser_free(parser);
+}
+
+static void append_output(const char *data, size_t len, void *userdata) {
+  cmark_strbuf_put((cmark_strbuf *)userdata, (const unsigned char *)data,
+                   (bufsize_t)len);
+}
+
+static void html_stream(test_batch_runner *runner) {
+  static const char markdown[] =
+      "[ref]: /url\n"
+      "\n"
+      "A [link][ref] and a note[^1].\n"
+      "\n"
+      "- item[^2]\n"
+      "\n"
+      "[^1]: The note.\n"
+      "\n"
+      "[^2]: Another note.\n"
+      "\n"
+      "> quoted\n";
+  static const char undefined[] =
+      "One[^none] and two[^2].\n"
+      "\n"
+      "- after\n"
+      "\n"
+      "[^2]: Defined.\n";
+  int options = CMARK_OPT_FOOTNOTES;
+  cmark_parser *parser = cmark_parser_new(options);
+  cmark_strbuf out = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+  cmark_html_stream *stream =
+      cmark_html_stream_new(parser, options, NULL, append_output, &out);
+  cmark_node *doc;
+  char *html;
+
+  cmark_parser_feed(parser, markdown, 44);
+  STR_EQ(runner, cmark_strbuf_cstr(&out), "",
+         "a block that refers to a footnote not defined yet is held back");
+
+  // Up to the line that closes the first definition.
+  cmark_parser_feed(parser, markdown + 44, 93 - 44);
+  STR_EQ(runner, cmark_strbuf_cstr(&out),
+         "<p>A <a href=\"/url\">link</a> and a note<sup class=\"footnote-ref\">"
+         "<a href=\"#fn-1\" id=\"fnref-1\" data-footnote-ref>1</a></sup>.</p>",
+         "held blocks are written once their footnotes are defined");
+
+  cmark_parser_feed(parser, markdown + 93, sizeof(markdown) - 1 - 93);
+  cmark_html_stream_finish(stream);
+
+  doc = cmark_parse_document(markdown, sizeof(markdown) - 1, options);
+  html = cmark_render_html(doc, options, NULL);
+  STR_EQ(runner, cmark_strbuf_cstr(&out), html,
+         "streamed HTML matches rendering the whole document");
+  cmark_node_free(doc);
+
+  // The stream carries on with the next document fed to the parser.
+  cmark_strbuf_clear(&out);
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  cmark_html_stream_finish(stream);
+  STR_EQ(runner, cmark_strbuf_cstr(&out), html,
+         "a stream renders one document after another");
+  free(html);
+
+  // A footnote that is never defined is left as text, and does not take
+  // a number from the ones that are.
+  cmark_strbuf_clear(&out);
+  cmark_parser_feed(parser, undefined, sizeof(undefined) - 1);
+  cmark_html_stream_finish(stream);
+  doc = cmark_parse_document(undefined, sizeof(undefined) - 1, options);
+  html = cmark_render_html(doc, options, NULL);
+  STR_EQ(runner, cmark_strbuf_cstr(&out), html,
+         "streamed HTML leaves undefined footnotes as text");
+  OK(runner, strstr(html, "[^none]") != NULL, "undefined footnote is text");
+  free(html);
+  cmark_node_free(doc);
+
+  cmark_html_stream_free(stream);
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  doc = cmark_parser_finish(parser);
+  INT_EQ(runner, cmark_node_get_type(cmark_node_last_child(doc)),
+         CMARK_NODE_FOOTNOTE_DEFINITION,
+         "freeing the stream stops the parser streaming");
+  cmark_node_free(doc);
+
+  cmark_strbuf_free(&out);
+  cmark_parser_free(parser);
+}
+
+static char *parse_with_threads(const char *markdown, size_t len,
+                                int threads) {
+  int options = CMARK_OPT_FOOTNOTES | CMARK_OPT_SOURCEPOS;
+  cmark_parser *parser = cmark_parser_new(options);
+  cmark_node *doc;
+  char *html;
+
+  cmark_parser_attach_syntax_extension(
+      parser, cmark_find_syntax_extension("strikethrough"));
+  cmark_parser_attach_syntax_extension(parser,
+                                       cmark_find_syntax_extension("autolink"));
+  cmark_parser_set_threads(parser, threads);
+  cmark_parser_feed(parser, markdown, len);
+  doc = cmark_parser_finish(parser);
+  html = cmark_render_html(doc, options,
+                           cmark_parser_get_syntax_extensions(parser));
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+  return html;
+}
+
+static bool refuse_large_realloc;
+
+static void *picky_realloc(void *ptr, size_t size) {
+  if (refuse_large_realloc && size > 1048576)
+    return NULL;
+  return realloc(ptr, size);
+}
+
+static cmark_mem picky_mem = {calloc, picky_realloc, free,
+                              NULL,   NULL,          NULL, NULL};
+
+static void parse_threads(test_batch_runner *runner) {
+  static const char unit[] =
+      "A *paragraph* with [a link][ref], ~~struck~~ text, www.example.com\n"
+      "and a footnote[^note].\n"
+      "\n"
+      "> - an item with **strong** [text][missing]\n"
+      "\n";
+  static const char defs[] = "[^note]: The note.\n\n[ref]: /url\n";
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_strbuf markdown = CMARK_BUF_INIT(mem);
+  char *sequential, *threaded;
+  size_t i;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  for (i = 0; i < 1000; ++i)
+    cmark_strbuf_puts(&markdown, unit);
+  cmark_strbuf_puts(&markdown, defs);
+
+  sequential = parse_with_threads((char *)markdown.ptr, markdown.size, 1);
+  threaded = parse_with_threads((char *)markdown.ptr, markdown.size, 4);
+  STR_EQ(runner, threaded, sequential,
+         "parsing inlines on several threads gives the same document");
+  free(threaded);
+  free(sequential);
+
+  // Every use of the reference expands to over 1KB, so the limit on
+  // reference expansion is reached partway through the document.
+  cmark_strbuf_clear(&markdown);
+  cmark_strbuf_puts(&markdown, "[ref]: /");
+  for (i = 0; i < 1000; ++i)
+    cmark_strbuf_putc(&markdown, 'x');
+  cmark_strbuf_puts(&markdown, "\n\n");
+  for (i = 0; i < 1000; ++i)
+    cmark_strbuf_puts(&markdown, "[ref] and [ref]\n\n");
+
+  sequential = parse_with_threads((char *)markdown.ptr, markdown.size, 1);
+  threaded = parse_with_threads((char *)markdown.ptr, markdown.size, 4);
+  OK(runner, strstr(sequential, "\">[ref] and [ref]</p>") != NULL,
+     "the reference expansion limit is reached");
+  STR_EQ(runner, threaded, sequential,
+         "the reference expansion limit applies in document order");
+  free(threaded);
+  free(sequential);
+
+  // Large enough to be cut into pieces whose blocks are parsed on several
+  // threads.  Blank lines inside fenced code and HTML blocks, followed by
+  // lines that would otherwise start a new block, must not be cut at.
+  static const char blocks[] =
+      "# Section with a [late] reference\n"
+      "\n"
+      "```\n"
+      "code\n"
+      "\n"
+      "not a paragraph\n"
+      "```\n"
+      "\n"
+      "<pre>\n"
+      "\n"
+      "still html\n"
+      "</pre>\n"
+      "\n"
+      "- a list\n"
+      "\n"
+      "- that is loose\n"
+      "\n"
+      "    indented code\n"
+      "\n"
+      "***\n"
+      "\n"
+      "Text[^note] under a break\n"
+      "\n";
+  cmark_strbuf_clear(&markdown);
+  while (markdown.size < 3 * 1048576)
+    cmark_strbuf_puts(&markdown, blocks);
+  cmark_strbuf_puts(&markdown, "[late]: /late\n\n[^note]: The note.\n");
+
+  sequential = parse_with_threads((char *)markdown.ptr, markdown.size, 1);
+  threaded = parse_with_threads((char *)markdown.ptr, markdown.size, 4);
+  OK(runner, strcmp(threaded, sequential) == 0,
+     "parsing blocks on several threads gives the same document");
+  free(threaded);
+  free(sequential);
+
+  // Every cut falls after a fenced code block in a list item, which the
+  // line after the blank line closes, so each piece's last code block ends
+  // on the first line of the next piece.
+  cmark_strbuf_clear(&markdown);
+  while (markdown.size < 3 * 1048576)
+    cmark_strbuf_puts(&markdown, "- ```\n"
+                                 "  fenced code in an item\n"
+                                 "\n"
+                                 "After the list\n"
+                                 "\n");
+
+  sequential = parse_with_threads((char *)markdown.ptr, markdown.size, 1);
+  threaded = parse_with_threads((char *)markdown.ptr, markdown.size, 4);
+  OK(runner, strcmp(threaded, sequential) == 0,
+     "fenced code in a list item ends where it does on one thread");
+  free(threaded);
+
+  // When the held input cannot grow, what was fed is parsed as it comes.
+  {
+    int options = CMARK_OPT_FOOTNOTES | CMARK_OPT_SOURCEPOS;
+    cmark_parser *parser = cmark_parser_new_with_mem(options, &picky_mem);
+    cmark_node *doc;
+    bufsize_t off;
+
+    cmark_parser_attach_syntax_extension(
+        parser, cmark_find_syntax_extension("strikethrough"));
+    cmark_parser_attach_syntax_extension(
+        parser, cmark_find_syntax_extension("autolink"));
+    cmark_parser_set_threads(parser, 4);
+    refuse_large_realloc = true;
+    for (off = 0; off < markdown.size; off += 65536)
+      cmark_parser_feed(parser, (char *)markdown.ptr + off,
+                        markdown.size - off < 65536 ? markdown.size - off
+                                                    : 65536);
+    refuse_large_realloc = false;
+    doc = cmark_parser_finish(parser);
+    threaded = cmark_render_html(doc, options,
+                                 cmark_parser_get_syntax_extensions(parser));
+    OK(runner, strcmp(threaded, sequential) == 0,
+       "input that cannot be held is parsed on one thread");
+    free(threaded);
+    cmark_node_free(doc);
+    cmark_parser_free(parser);
+  }
+  free(sequential);
+
+  cmark_strbuf_free(&markdown);
+}
+
+static cmark_parser *split_parser_new(void) {
+  static const char *extensions[] = {"table", "strikethrough", "autolink",
+                                     "tagfilter", "tasklist"};
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_UNSAFE);
+  size_t i;
+
+  for (i = 0; i < sizeof(extensions) / sizeof(*extensions); ++i)
+    cmark_parser_attach_syntax_extension(
+        parser, cmark_find_syntax_extension(extensions[i]));
+  return parser;
+}
+
+static char *split_render(cmark_parser *parser) {
+  cmark_node *doc = cmark_parser_finish(parser);
+  char *html = cmark_render_html(doc, CMARK_OPT_UNSAFE,
+                                 cmark_parser_get_syntax_extensions(parser));
+  cmark_node_free(doc);
+  return html;
+}
+
+// Renders 'markdown' whole, and cut into pieces of at least 'piece_size'
+// bytes that are rendered one at a time.  Returns the number of pieces.
+static size_t split_and_render(const char *markdown, size_t len,
+                               size_t piece_size, char **whole,
+                               char **pieces) {
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_strbuf html = CMARK_BUF_INIT(mem);
+  cmark_parser *parser = split_parser_new();
+  cmark_split *split = cmark_parser_split(parser, markdown, len, piece_size);
+  size_t count = cmark_split_count(split), i;
+
+  cmark_parser_feed(parser, markdown, len);
+  *whole = split_render(parser);
+  cmark_parser_free(parser);
+
+  for (i = 0; i < count; ++i) {
+    size_t start = cmark_split_offset(split, i);
+    char *refs = cmark_split_references(split, i), *piece;
+
+    parser = split_parser_new();
+    cmark_parser_feed(parser, refs, strlen(refs));
+    cmark_parser_feed(parser, markdown + start,
+                      cmark_split_offset(split, i + 1) - start);
+    piece = split_render(parser);
+    cmark_strbuf_puts(&html, piece);
+    free(piece);
+    free(refs);
+    cmark_parser_free(parser);
+  }
+
+  cmark_split_free(split);
+  *pieces = (char *)cmark_strbuf_detach(&html);
+  return count;
+}
+
+static void split_document(test_batch_runner *runner) {
+  static const char markdown[] =
+      "[dup]: /first \"Fir&amp;st\"\n"
+      "\n"
+      "A [dup] link, a [late] one and an ^[attr](ignored) span.\n"
+      "\n"
+      "```\n"
+      "fenced\n"
+      "\n"
+      "[fake]: /fake\n"
+      "```\n"
+      "\n"
+      "- an item\n"
+      "\n"
+      "- and [fake] text\n"
+      "\n"
+      "[dup]: /second\n"
+      "\n"
+      "^[attr]: {.class}\n"
+      "\n"
+      "[late]: <a b&#10;c\\>> '(t)'\n"
+      "\n"
+      "More [dup] text\n";
+  char *whole, *pieces, *refs;
+  cmark_parser *parser;
+  cmark_split *split;
+  size_t count, i;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  count = split_and_render(markdown, sizeof(markdown) - 1, 0, &whole, &pieces);
+  OK(runner, count > 4, "the document is cut into several pieces");
+  STR_EQ(runner, pieces, whole, "the pieces render like the whole document");
+  free(whole);
+  free(pieces);
+
+  parser = split_parser_new();
+  split = cmark_parser_split(parser, markdown, sizeof(markdown) - 1, 0);
+  INT_EQ(runner, (int)cmark_split_offset(split, 0), 0, "first offset");
+  OK(runner, strncmp(markdown + cmark_split_offset(split, 1), "A [dup]", 7) == 0,
+     "the second piece starts after the blank line");
+  for (i = 1; i < cmark_split_count(split); ++i)
+    OK(runner, strncmp(markdown + cmark_split_offset(split, i), "[fake]", 6),
+       "no cut inside fenced code");
+  INT_EQ(runner, (int)cmark_split_offset(split, cmark_split_count(split)),
+         (int)sizeof(markdown) - 1, "last offset is the end of the input");
+
+  refs = cmark_split_references(split, 0);
+  STR_EQ(runner, refs,
+         "^[attr]: {.class}\n"
+         "[late]: <a b&#10;c\\>> \"(t)\"\n"
+         "\n",
+         "references for the first piece");
+  free(refs);
+  refs = cmark_split_references(split, 1);
+  OK(runner, strncmp(refs, "[dup]: </first> \"Fir&amp;st\"\n", 29) == 0,
+     "references lead with the first definition of a label");
+  OK(runner, strstr(refs, "/second") == NULL,
+     "references leave out definitions that are never used");
+  free(refs);
+  cmark_split_free(split);
+
+  // The parser is reset and can be used again.
+  cmark_parser_feed(parser, "*a*", 3);
+  whole = split_render(parser);
+  STR_EQ(runner, whole, "<p><em>a</em></p>\n", "parser is usable after split");
+  free(whole);
+
+  split = cmark_parser_split(parser, "", 0, 1024);
+  INT_EQ(runner, (int)cmark_split_count(split), 1, "empty input is one piece");
+  refs = cmark_split_references(split, 0);
+  STR_EQ(runner, refs, "", "empty input needs no references");
+  free(refs);
+  cmark_split_free(split);
+  cmark_parser_free(parser);
+}
+
+// Checks that the files named on the command line render the same whole and
+// cut into pieces of several sizes.
+static void split_files(test_batch_runner *runner, int argc, char *argv[]) {
+  static const size_t piece_sizes[] = {0, 256, 4096};
+  char *markdown, *whole, *pieces;
+  size_t len, count, i;
+  FILE *fp;
+  int arg;
+
+  for (arg = 1; arg < argc; ++arg) {
+    fp = fopen(argv[arg], "rb");
+    if (!fp) {
+      OK(runner, false, "can open %s", argv[arg]);
+      continue;
+    }
+    fseek(fp, 0, SEEK_END);
+    len = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    markdown = (char *)malloc(len + 1);
+    len = fread(markdown, 1, len, fp);
+    fclose(fp);
+
+    for (i = 0; i < sizeof(piece_sizes) / sizeof(*piece_sizes); ++i) {
+      count = split_and_render(markdown, len, piece_sizes[i], &whole, &pieces);
+      OK(runner, strcmp(pieces, whole) == 0,
+         "%s cut into %d pieces renders the same", argv[arg], (int)count);
+      free(whole);
+      free(pieces);
+    }
+    free(markdown);
+  }
+}
+
+// Applies an edit to '*text' and to 'doc', and checks that the document
+// matches one parsed from the new text with 'options'.  Returns the number
+// of blocks parsed again.
+static int reparse_edit(test_batch_runner *runner, cmark_parser *parser,
+                        int options, cmark_node *doc, char **text,
+                        size_t offset, size_t removed, const char *inserted) {
+  size_t len = strlen(*text), inserted_len = strlen(inserted);
+  char *new_text = (char *)malloc(len - removed + inserted_len + 1);
+  cmark_node *replaced, *first, *last, *node, *full;
+  char *got, *expected;
+  int count = 0;
+
+  memcpy(new_text, *text, offset);
+  memcpy(new_text + offset, inserted, inserted_len);
+  strcpy(new_text + offset + inserted_len, *text + offset + removed);
+
+  replaced = cmark_parser_reparse(parser, doc, *text, len, offset, removed,
+                                  inserted, inserted_len, &first, &last);
+  for (node = first; node; node = node == last ? NULL : node->next)
+    ++count;
+  cmark_node_free(replaced);
+
+  full = cmark_parse_document(new_text, strlen(new_text), options);
+  got = cmark_render_xml(doc, CMARK_OPT_SOURCEPOS);
+  expected = cmark_render_xml(full, CMARK_OPT_SOURCEPOS);
+  STR_EQ(runner, got, expected, "reparse at %d matches a full parse",
+         (int)offset);
+  free(got);
+  free(expected);
+  cmark_node_free(full);
+
+  free(*text);
+  *text = new_text;
+  return count;
+}
+
+static void reparse(test_batch_runner *runner) {
+  static const char markdown[] = "# Title\n"
+                                 "\n"
+                                 "A [link] in a paragraph.\n"
+                                 "\n"
+                                 "```\n"
+                                 "code\n"
+                                 "```\n"
+                                 "\n"
+                                 "- a list\n"
+                                 "- of items\n"
+                                 "\n"
+                                 "Last paragraph.\n"
+                                 "\n"
+                                 "[link]: /url\n";
+  int options = CMARK_OPT_INCREMENTAL;
+  cmark_parser *parser = cmark_parser_new(options);
+  char *text = (char *)malloc(sizeof(markdown));
+  cmark_node *doc, *code, *last;
+
+  memcpy(text, markdown, sizeof(markdown));
+  cmark_parser_feed(parser, text, strlen(text));
+  doc = cmark_parser_finish(parser);
+  code = cmark_node_next(cmark_node_next(cmark_node_first_child(doc)));
+  last = cmark_node_last_child(doc);
+
+  // Only the edited block is parsed again, and links still resolve
+  // against the definition at the end.
+  INT_EQ(runner,
+         reparse_edit(runner, parser, options, doc, &text, 4, 0, "d"), 1,
+         "an edit in a heading replaces it");
+  INT_EQ(runner,
+         reparse_edit(runner, parser, options, doc, &text, 19, 0, "short "),
+         1, "an edit in a paragraph replaces it");
+  OK(runner,
+     cmark_node_next(cmark_node_next(cmark_node_first_child(doc))) == code,
+     "later blocks are kept");
+
+  // New lines move the blocks after the edit down.  A list cannot be cut
+  // at, so parsing starts again from the code block before it.
+  INT_EQ(runner,
+         reparse_edit(runner, parser, options, doc, &text, 75, 0, "\n\n- new"),
+         2, "a new item joins the list");
+  OK(runner, cmark_node_last_child(doc) == last,
+     "the paragraph after the list is kept");
+  INT_EQ(runner, cmark_node_get_start_line(last), 14,
+         "the paragraph after the list moves down");
+
+  // An open fence takes in everything after it, and closing it again
+  // brings the blocks back.
+  reparse_edit(runner, parser, options, doc, &text, 0, 0, "```\n\n");
+  INT_EQ(runner, reparse_edit(runner, parser, options, doc, &text, 0, 5, ""),
+         5, "removing the fence parses the rest again");
+
+  // A fenced code block in a list item ends on the line that closes the
+  // list, so that line is parsed again along with it.
+  reparse_edit(runner, parser, options, doc, &text, 0, 0,
+               "- ```\n\nAfter the list\n\n");
+  reparse_edit(runner, parser, options, doc, &text,
+               strstr(text, "the list") - text, 0, "all of ");
+
+  // Definitions change links anywhere in the document.
+  reparse_edit(runner, parser, options, doc, &text,
+               strstr(text, "/url") - text, 4, "/other");
+  OK(runner, strstr(text, "/other") != NULL, "the definition was edited");
+
+  OK(runner, cmark_parser_reparse(parser, doc, text, strlen(text),
+                                  strlen(text), 1, "", 0, NULL, NULL) == NULL,
+     "an edit past the end is refused");
+
+  free(text);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+}
+
+static void html_cache(test_batch_runner *runner) {
+  static const char markdown[] = "# Title\n"
+                                 "\n"
+                                 "A [link] and a note[^1].\n"
+                                 "\n"
+                                 "Another paragraph.\n"
+                                 "\n"
+                                 "[link]: /url\n"
+                                 "[^1]: The note.\n";
+  static const char first[] = "[a]\n\n[a]: /x\n";
+  static const char second[] = "[a]\n\n[a]: /y\n";
+  int options = CMARK_OPT_INCREMENTAL | CMARK_OPT_FOOTNOTES;
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_html_cache *cache = cmark_html_cache_new(1 << 20);
+  cmark_parser *parser = cmark_parser_new(options);
+  char *text = (char *)malloc(sizeof(markdown));
+  cmark_node *doc, *other;
+  char *html, *expected;
+
+  memcpy(text, markdown, sizeof(markdown));
+  cmark_parser_feed(parser, text, strlen(text));
+  doc = cmark_parser_finish(parser);
+
+  // The footnote definition is rendered every time.
+  expected = cmark_render_html(doc, options, NULL);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text), options,
+                                  NULL, mem);
+  STR_EQ(runner, html, expected, "a first cached render matches");
+  free(html);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text), options,
+                                  NULL, mem);
+  STR_EQ(runner, html, expected, "a second cached render matches");
+  free(html);
+  free(expected);
+  INT_EQ(runner, (int)cmark_html_cache_misses(cache), 3,
+         "the first render misses every block");
+  INT_EQ(runner, (int)cmark_html_cache_hits(cache), 3,
+         "the second render hits every block");
+
+  // Only the edited block is rendered again.
+  reparse_edit(runner, parser, options, doc, &text,
+               strstr(text, "Another") - text, 0, "Yet ");
+  expected = cmark_render_html(doc, options, NULL);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text), options,
+                                  NULL, mem);
+  STR_EQ(runner, html, expected, "a render after an edit matches");
+  free(html);
+  free(expected);
+  INT_EQ(runner, (int)cmark_html_cache_misses(cache), 4,
+         "the edited block misses");
+  INT_EQ(runner, (int)cmark_html_cache_hits(cache), 5,
+         "the other blocks hit");
+
+  // A link's block depends on the definition it resolved to.
+  reparse_edit(runner, parser, options, doc, &text,
+               strstr(text, "/url") - text, 4, "/other");
+  expected = cmark_render_html(doc, options, NULL);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text), options,
+                                  NULL, mem);
+  STR_EQ(runner, html, expected, "a render after a new definition matches");
+  OK(runner, strstr(html, "/other") != NULL, "the link has its new url");
+  free(html);
+  free(expected);
+
+  // Source positions move with the lines before them.
+  reparse_edit(runner, parser, options, doc, &text, 0, 0, "\n");
+  expected = cmark_render_html(doc, options | CMARK_OPT_SOURCEPOS, NULL);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text),
+                                  options | CMARK_OPT_SOURCEPOS, NULL, mem);
+  STR_EQ(runner, html, expected, "a render with source positions matches");
+  free(html);
+  free(expected);
+
+  // Without the definitions, a block is told apart by its links.
+  other = cmark_parse_document(first, sizeof(first) - 1, 0);
+  free(cmark_render_html_cached(cache, other, first, sizeof(first) - 1, 0,
+                                NULL, mem));
+  cmark_node_free(other);
+  other = cmark_parse_document(second, sizeof(second) - 1, 0);
+  html = cmark_render_html_cached(cache, other, second, sizeof(second) - 1, 0,
+                                  NULL, mem);
+  STR_EQ(runner, html, "<p><a href=\"/y\">a</a></p>\n",
+         "a link to another definition is rendered again");
+  free(html);
+  cmark_node_free(other);
+  cmark_html_cache_free(cache);
+
+  // A cache too small for more than one block keeps the last one.
+  cache = cmark_html_cache_new(200);
+  html = cmark_render_html_cached(cache, doc, text, strlen(text), options,
+                                  NULL, mem);
+  free(html);
+  OK(runner, cmark_html_cache_size(cache) > 0 &&
+                 cmark_html_cache_size(cache) <= 200,
+     "a small cache stays within its size");
+  cmark_html_cache_free(cache);
+
+  free(text);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+}
+
+static void record_diff(cmark_node *old_node, cmark_node *new_node,
+                        void *userdata) {
+  char *changes = (char *)userdata;
+  size_t len = strlen(changes);
+
+  snprintf(changes + len, 256 - len, "%s>%s ",
+           old_node ? cmark_node_get_type_string(old_node) : "-",
+           new_node ? cmark_node_get_type_string(new_node) : "-");
+}
+
+static void node_hash(test_batch_runner *runner) {
+  static const char markdown[] = "# Title\n"
+                                 "\n"
+                                 "One *two*.\n"
+                                 "\n"
+                                 "- a\n"
+                                 "- b\n";
+  static const char moved[] = "\n\n# Title\n"
+                              "\n"
+                              "One *two*.\n"
+                              "\n"
+                              "- a\n"
+                              "- b\n";
+  static const char edited[] = "# Title\n"
+                               "\n"
+                               "One *three*.\n"
+                               "\n"
+                               "Inserted.\n"
+                               "\n"
+                               "- a\n"
+                               "- b\n";
+  static const char left[] = "| x |\n|:--|\n| 1 |\n";
+  static const char right[] = "| x |\n|--:|\n| 1 |\n";
+  static const char upper[] = "x[^A]\n\n[^A]: note\n";
+  static const char lower[] = "x[^A]\n\n[^a]: note\n";
+  cmark_node *doc, *other, *text, *node;
+  uint64_t hash;
+  char changes[256];
+
+  doc = cmark_parse_document(markdown, sizeof(markdown) - 1, 0);
+  hash = cmark_node_hash(doc);
+  INT_EQ(runner, cmark_node_hash(doc) == hash, 1, "hashes are stable");
+  other = cmark_node_copy(doc, cmark_get_default_mem_allocator());
+  INT_EQ(runner, cmark_node_hash(other) == hash, 1, "copies hash equal");
+  cmark_node_free(other);
+  other = cmark_parse_document(moved, sizeof(moved) - 1, 0);
+  INT_EQ(runner, cmark_node_hash(other) == hash, 1,
+         "hashes do not depend on positions");
+  INT_EQ(runner, cmark_node_diff(doc, other, NULL, NULL), 0,
+         "equal documents have no changes");
+  cmark_node_free(other);
+
+  // Changing a node changes the hashes of its ancestors.
+  text = cmark_node_first_child(cmark_node_first_child(doc));
+  cmark_node_set_literal(text, "Other");
+  INT_EQ(runner, cmark_node_hash(doc) != hash, 1,
+         "a new literal changes the hash");
+  cmark_node_set_literal(text, "Title");
+  INT_EQ(runner, cmark_node_hash(doc) == hash, 1,
+         "the old literal brings the hash back");
+  node = cmark_node_new(CMARK_NODE_THEMATIC_BREAK);
+  cmark_node_append_child(doc, node);
+  INT_EQ(runner, cmark_node_hash(doc) != hash, 1,
+         "a new child changes the hash");
+  cmark_node_free(node);
+  INT_EQ(runner, cmark_node_hash(doc) == hash, 1,
+         "removing it brings the hash back");
+  node = cmark_node_last_child(doc);
+  cmark_node_set_list_type(node, CMARK_ORDERED_LIST);
+  INT_EQ(runner, cmark_node_hash(doc) != hash, 1,
+         "a new list type changes the hash");
+  cmark_node_set_list_type(node, CMARK_BULLET_LIST);
+
+  // Only the smallest subtrees that differ are reported.
+  other = cmark_parse_document(edited, sizeof(edited) - 1, 0);
+  changes[0] = '\0';
+  INT_EQ(runner, cmark_node_diff(doc, other, record_diff, changes), 2,
+         "two changes are found");
+  STR_EQ(runner, changes, "text>text ->paragraph ",
+         "the changed text and the inserted paragraph are reported");
+  changes[0] = '\0';
+  cmark_node_diff(other, doc, record_diff, changes);
+  STR_EQ(runner, changes, "text>text paragraph>- ",
+         "the removed paragraph is reported");
+  cmark_node_free(other);
+  cmark_node_free(doc);
+
+  // Extensions contribute the data they keep for their nodes.
+  cmark_gfm_core_extensions_ensure_registered();
+  cmark_parser *parser = cmark_parser_new(0);
+  cmark_parser_attach_syntax_extension(parser,
+                                       cmark_find_syntax_extension("table"));
+  cmark_parser_feed(parser, left, sizeof(left) - 1);
+  doc = cmark_parser_finish(parser);
+  cmark_parser_free(parser);
+  parser = cmark_parser_new(0);
+  cmark_parser_attach_syntax_extension(parser,
+                                       cmark_find_syntax_extension("table"));
+  cmark_parser_feed(parser, right, sizeof(right) - 1);
+  other = cmark_parser_finish(parser);
+  cmark_parser_free(parser);
+  changes[0] = '\0';
+  cmark_node_diff(doc, other, record_diff, changes);
+  STR_EQ(runner, changes, "table>table ",
+         "a table with other alignments is reported");
+  cmark_node_free(other);
+  cmark_node_free(doc);
+
+  // A footnote reference links to the label of its definition, which may
+  // differ from its own in case.
+  doc = cmark_parse_document(upper, sizeof(upper) - 1, CMARK_OPT_FOOTNOTES);
+  other = cmark_parse_document(lower, sizeof(lower) - 1, CMARK_OPT_FOOTNOTES);
+  INT_EQ(runner, cmark_node_diff(doc, other, NULL, NULL), 2,
+         "a reference to a relabeled definition is reported");
+  cmark_node_free(other);
+  cmark_node_free(doc);
+}
+
+static void serialize(test_batch_runner *runner) {
+  static const char markdown[] = "# Title\n"
+                                 "\n"
+                                 "A [link](/url \"t\") with `code`, "
+                                 "![an image](/i.png \"i\") and a "
+                                 "note[^1].\n"
+                                 "\n"
+                                 "3. one\n"
+                                 "4. two\n"
+                                 "\n"
+                                 "| a | b |\n"
+                                 "|:--|--:|\n"
+                                 "| 1 |\n"
+                                 "\n"
+                                 "```c\n"
+                                 "int x;\n"
+                                 "```\n"
+                                 "\n"
+                                 "[^1]: The note.\n";
+  int options = CMARK_OPT_FOOTNOTES;
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_parser *parser;
+  cmark_node *doc, *loaded;
+  cmark_llist *extensions;
+  unsigned char *data, *copy;
+  char *expected, *xml, *html;
+  size_t len, i, failures;
+
+  cmark_gfm_core_extensions_ensure_registered();
+  parser = cmark_parser_new(options);
+  cmark_parser_attach_syntax_extension(parser,
+                                       cmark_find_syntax_extension("table"));
+  cmark_parser_feed(parser, markdown, sizeof(markdown) - 1);
+  doc = cmark_parser_finish(parser);
+  extensions = cmark_parser_get_syntax_extensions(parser);
+  expected = cmark_render_xml(doc, CMARK_OPT_SOURCEPOS);
+  data = cmark_node_serialize(doc, mem, &len);
+  OK(runner, data != NULL, "a tree with tables is serialized");
+
+  // The loaded tree does not depend on the buffer it was read from.
+  copy = (unsigned char *)malloc(len);
+  memcpy(copy, data, len);
+  loaded = cmark_node_deserialize(copy, len, 0, mem);
+  memset(copy, 0, len);
+  xml = cmark_render_xml(loaded, CMARK_OPT_SOURCEPOS);
+  STR_EQ(runner, xml, expected, "a loaded tree matches the original");
+  free(xml);
+  html = cmark_render_html(loaded, options, extensions);
+  xml = cmark_render_html(doc, options, extensions);
+  STR_EQ(runner, html, xml, "a loaded tree renders as the original");
+  free(html);
+  free(xml);
+  INT_EQ(runner, cmark_node_hash(loaded) == cmark_node_hash(doc), 1,
+         "a loaded tree hashes as the original");
+  cmark_node_free(loaded);
+  free(copy);
+
+  copy = (unsigned char *)malloc(len);
+  memcpy(copy, data, len);
+  loaded = cmark_node_deserialize_in_place(copy, len, 0, mem);
+  xml = cmark_render_xml(loaded, CMARK_OPT_SOURCEPOS);
+  STR_EQ(runner, xml, expected, "a tree loaded in place matches");
+  free(xml);
+
+  // Once it owns its strings, it no longer needs the buffer.
+  cmark_node_own(loaded);
+  memset(copy, 0, len);
+  free(copy);
+  xml = cmark_render_xml(loaded, CMARK_OPT_SOURCEPOS);
+  STR_EQ(runner, xml, expected, "an owned tree outlives its buffer");
+  free(xml);
+  html = cmark_render_html(loaded, options, extensions);
+  xml = cmark_render_html(doc, options, extensions);
+  STR_EQ(runner, html, xml, "an owned tree renders as the original");
+  free(html);
+  free(xml);
+  cmark_node_free(loaded);
+
+  loaded = cmark_node_deserialize_in_place(data, len,
+                                           CMARK_OPT_DOCUMENT_ARENA, mem);
+  xml = cmark_render_xml_with_mem(loaded, CMARK_OPT_SOURCEPOS, mem);
+  STR_EQ(runner, xml, expected, "a tree loaded into an arena matches");
+  free(xml);
+  cmark_node_free(loaded);
+
+  // Truncated and corrupted data is refused.
+  failures = 0;
+  for (i = 0; i < len; ++i) {
+    loaded = cmark_node_deserialize(data, i, 0, mem);
+    if (loaded) {
+      ++failures;
+      cmark_node_free(loaded);
+    }
+  }
+  INT_EQ(runner, (int)failures, 0, "every truncation is refused");
+  data[0] = 'X';
+  OK(runner, cmark_node_deserialize(data, len, 0, mem) == NULL,
+     "a bad magic number is refused");
+  data[0] = 'C';
+  for (i = 0; i + 5 <= len; ++i)
+    if (memcmp(data + i, "table", 5) == 0)
+      break;
+  data[i] = 'T';
+  OK(runner, cmark_node_deserialize(data, len, 0, mem) == NULL,
+     "an unknown extension is refused");
+
+  cmark_mem_free(mem, data);
+  free(expected);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+}
+
+int main(int argc, char *argv[]) {
   int retval;
   test_batch_runner *runner = test_batch_runner_new();
 
@@ -1580,6 +3378,8 @@ int main() {
   version(runner);
   constructor(runner);
   accessors(runner);
+  user_data(runner);
+  node_lifetime(runner);
   node_check(runner);
   iterator(runner);
   iterator_delete(runner);
@@ -1593,12 +3393,16 @@ int main() {
   render_latex(runner);
   render_commonmark(runner);
   render_plaintext(runner);
+  render_to_sink(runner);
   utf8(runner);
   line_endings(runner);
   numeric_entities(runner);
   test_cplusplus(runner);
   test_safe(runner);
   test_feed_across_line_ending(runner);
+  test_feed_in_place(runner);
+  simd_kernels(runner);
+  simd_utf8(runner);
   test_pathological_regressions(runner);
   source_pos(runner);
   source_pos_inlines(runner);
@@ -1609,6 +3413,20 @@ int main() {
   verify_custom_attributes_node_with_footnote(runner);
   parser_interrupt(runner);
   table_spans(runner);
+  arena_objects(runner);
+  arena_realloc_growth(runner);
+  arena_retain(runner);
+  document_arena(runner);
+  node_copy(runner);
+  stream_blocks(runner);
+  html_stream(runner);
+  parse_threads(runner);
+  split_document(runner);
+  split_files(runner, argc, argv);
+  reparse(runner);
+  html_cache(runner);
+  node_hash(runner);
+  serialize(runner);
 
   test_print_summary(runner);
   retval = test_ok(runner) ? 0 : 1;
@@ -0,0 +1,140 @@
+// Measures how much memory an arena holds after parsing documents made of
+// one ever-growing block, and how much of it was abandoned by reallocations
+// that could not grow in place.  Then measures a request-per-document loop
+// over small documents with and without retained chunks.
+//
+// Usage: bench_arena [ITERATIONS]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+
+static char *make_input(const char *head, const char *unit, size_t repeat,
+                        const char *tail, size_t *len) {
+  size_t head_len = strlen(head), unit_len = strlen(unit),
+         tail_len = strlen(tail);
+  char *buf = (char *)malloc(head_len + unit_len * repeat + tail_len);
+  char *p = buf;
+
+  memcpy(p, head, head_len);
+  p += head_len;
+  for (size_t i = 0; i < repeat; ++i, p += unit_len)
+    memcpy(p, unit, unit_len);
+  memcpy(p, tail, tail_len);
+
+  *len = head_len + unit_len * repeat + tail_len;
+  return buf;
+}
+
+static cmark_arena *new_arena(int options) {
+  return cmark_arena_new_with_options(options, 16 * 1048576);
+}
+
+static void run(const char *name, const char *buf, size_t len,
+                int iterations) {
+  cmark_arena *arena = new_arena(0);
+  size_t size = 0, wasted = 0;
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser =
+        cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, cmark_arena_get_mem(arena));
+    cmark_parser_feed(parser, buf, len);
+    cmark_parser_finish(parser);
+    size = cmark_arena_size(arena);
+    wasted = cmark_arena_wasted(arena);
+    cmark_arena_clear(arena);
+  }
+
+  double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("%-16s input %7.1f MB   arena %7.1f MB (%4.1fx)   wasted %7.1f MB   "
+         "%7.1f MB/s\n",
+         name, len / 1e6, size / 1e6, (double)size / len, wasted / 1e6,
+         (double)len * iterations / t / 1e6);
+  cmark_arena_free(arena);
+}
+
+// Parses and renders 'buf' again and again, clearing an arena object after
+// each document, or resetting the global arena if 'global' is set.
+static void run_documents(const char *name, bool global, int options,
+                          const char *buf, size_t len, int documents) {
+  cmark_arena *arena = NULL;
+  cmark_mem *mem;
+
+  if (global) {
+    cmark_arena_set_global_options(options, 16 * 1048576);
+    mem = cmark_get_arena_mem_allocator();
+  } else {
+    arena = new_arena(options);
+    mem = cmark_arena_get_mem(arena);
+  }
+
+  clock_t start = clock();
+
+  for (int i = 0; i < documents; ++i) {
+    cmark_parser *parser = cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, mem);
+    cmark_parser_feed(parser, buf, len);
+    cmark_render_html(cmark_parser_finish(parser), CMARK_OPT_DEFAULT, NULL);
+    if (global)
+      cmark_arena_reset();
+    else
+      cmark_arena_clear(arena);
+  }
+
+  double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("%-6s %-12s %6zu KB documents   %8.0f docs/s\n",
+         global ? "global" : "object", name, len / 1000, documents / t);
+
+  if (global)
+    cmark_arena_set_global_options(0, 0);
+  else
+    cmark_arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 5;
+  static const size_t sizes[] = {1, 8, 32};
+  char name[32];
+  size_t len;
+  char *buf;
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+    size_t lines = sizes[i] * 1000000 / 64;
+
+    buf = make_input("```c\n",
+                     "    for (i = 0; i < n; ++i) sum += values[i] * w[i];\n",
+                     lines, "```\n", &len);
+    snprintf(name, sizeof(name), "code %zu MB", sizes[i]);
+    run(name, buf, len, iterations);
+    free(buf);
+
+    buf = make_input("", "lorem ipsum dolor sit amet consectetur adipiscing\n",
+                     lines, "\n", &len);
+    snprintf(name, sizeof(name), "paragraph %zu MB", sizes[i]);
+    run(name, buf, len, iterations);
+    free(buf);
+  }
+
+  static const size_t doc_sizes[] = {4, 64, 512};
+  for (size_t i = 0; i < sizeof(doc_sizes) / sizeof(*doc_sizes); ++i) {
+    size_t units = doc_sizes[i] * 1000 / 64;
+    int documents = (int)(iterations * 20000 / doc_sizes[i]);
+
+    buf = make_input("# Title\n\n",
+                     "Some *emphasis*, a [link](/url) and `code` in a line.\n",
+                     units, "\n", &len);
+    for (int global = 0; global < 2; ++global) {
+      run_documents("fresh", global, 0, buf, len, documents);
+      run_documents("retain", global, CMARK_ARENA_RETAIN, buf, len, documents);
+      run_documents("retain+mmap", global,
+                    CMARK_ARENA_RETAIN | CMARK_ARENA_MMAP, buf, len, documents);
+    }
+    free(buf);
+  }
+
+  return 0;
+}
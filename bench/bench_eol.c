@@ -0,0 +1,96 @@
+// Measures the end-of-line scan in the feed loop on inputs with long lines,
+// for each instruction set the CPU supports.
+//
+// Usage: bench_eol [ITERATIONS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "simd.h"
+
+static const char *level_names[] = {"scalar", "sse2", "ssse3", "avx2"};
+
+static char *make_input(const char *unit, size_t units_per_line, size_t lines,
+                        size_t *len) {
+  size_t unit_len = strlen(unit);
+  size_t line_len = unit_len * units_per_line + 1;
+  char *buf = (char *)malloc(line_len * lines);
+  char *p = buf;
+
+  for (size_t i = 0; i < lines; ++i) {
+    for (size_t j = 0; j < units_per_line; ++j) {
+      memcpy(p, unit, unit_len);
+      p += unit_len;
+    }
+    *p++ = '\n';
+  }
+
+  *len = (size_t)(p - buf);
+  return buf;
+}
+
+static double scan(const char *buf, size_t len, int iterations) {
+  const unsigned char *end = (const unsigned char *)buf + len;
+  size_t lines = 0;
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    const unsigned char *p = (const unsigned char *)buf;
+    while (p < end) {
+      p = cmark_simd_find_eol(p, end) + 1;
+      lines++;
+    }
+  }
+
+  if (lines == 0)
+    fprintf(stderr, "no lines\n");
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double parse(const char *buf, size_t len, int iterations) {
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_node *doc = cmark_parse_document(buf, len, CMARK_OPT_DEFAULT);
+    cmark_node_free(doc);
+  }
+
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void run(const char *name, const char *buf, size_t len,
+                int iterations) {
+  cmark_simd_level max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+
+  for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+    cmark_simd_set_level((cmark_simd_level)level);
+    double s = scan(buf, len, iterations * 20);
+    double p = parse(buf, len, iterations);
+    printf("%-18s %-7s scan %8.1f MB/s   parse %8.1f MB/s\n", name,
+           level_names[level], (double)len * iterations * 20 / s / 1e6,
+           (double)len * iterations / p / 1e6);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+  size_t len;
+  char *buf;
+
+  buf = make_input("| cell |", 500, 2000, &len);
+  run("minified table", buf, len, iterations);
+  free(buf);
+
+  buf = make_input("lorem ipsum dolor sit amet, ", 80, 2000, &len);
+  run("long paragraphs", buf, len, iterations);
+  free(buf);
+
+  buf = make_input("short line", 1, 200000, &len);
+  run("short lines", buf, len, iterations);
+  free(buf);
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+// Measures how long finding the blocks that an edit changed takes, by
+// hashing the XML of every block as cmark_render_xml gives it, and with
+// cmark_node_diff, which only hashes the nodes the edit replaced and skips
+// the subtrees that hash equal.  The document is brought up to date with
+// cmark_parser_reparse after each edit, like a character typed into it,
+// and compared with a copy taken before the edit.  Also measures hashing a
+// whole document that has no hashes yet.
+//
+// Usage: bench_hash [EDITS] [FILE]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "cmark-gfm-extension_api.h"
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "## Section %zu with *emphasis*\n"
+      "\n"
+      "A paragraph with **strong** text, `code`, a [link][ref] and a soft\n"
+      "break, followed by ![an image](/img.png \"title\") and more words.\n"
+      "\n"
+      "- item %zu with _underscores_ and [an inline link](/url)\n"
+      "- another with <span>raw html</span>\n"
+      "\n"
+      "```\n"
+      "code block %zu\n"
+      "```\n"
+      "\n";
+  static const char refs[] = "[ref]: /url \"Title\"\n\n";
+  size_t repeat = 5000, size = sizeof(refs) + repeat * (sizeof(unit) + 64);
+  char *buf = (char *)malloc(size);
+
+  *len = (size_t)sprintf(buf, "%s", refs);
+  for (size_t i = 0; i < repeat; ++i)
+    *len += (size_t)sprintf(buf + *len, unit, i, i, i);
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size + 1);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Returns an offset inside a line that starts with a letter.
+static size_t pick_offset(const char *buf, size_t len) {
+  for (;;) {
+    size_t offset = (size_t)rand() % len;
+    while (offset > 0 && buf[offset - 1] != '\n')
+      --offset;
+    if (offset + 2 < len && buf[offset + 1] != '\n' &&
+        ((buf[offset] >= 'A' && buf[offset] <= 'Z') ||
+         (buf[offset] >= 'a' && buf[offset] <= 'z')))
+      return offset + 2;
+  }
+}
+
+// Hashes the XML of each top-level block, the way changes were found
+// before there were structural hashes, and counts those that differ from
+// 'hashes'.
+static size_t hash_xml(cmark_node *doc, unsigned long long *hashes,
+                       size_t n) {
+  size_t i = 0, changed = 0;
+
+  for (cmark_node *block = cmark_node_first_child(doc); block;
+       block = cmark_node_next(block), ++i) {
+    char *xml = cmark_render_xml(block, CMARK_OPT_DEFAULT);
+    unsigned long long hash =
+        cmark_hash_bytes(14695981039346656037u, xml, strlen(xml));
+    if (i >= n || hashes[i] != hash)
+      ++changed;
+    if (i < n)
+      hashes[i] = hash;
+    free(xml);
+  }
+  return changed;
+}
+
+int main(int argc, char *argv[]) {
+  int edits = argc > 1 ? atoi(argv[1]) : 100;
+  size_t len, n = 0, changed_xml = 0, changed = 0;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_INCREMENTAL);
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *doc, *before;
+  unsigned long long *hashes;
+  double xml = 0, diff = 0;
+
+  srand(1);
+  cmark_parser_feed(parser, buf, len);
+  doc = cmark_parser_finish(parser);
+
+  for (cmark_node *block = cmark_node_first_child(doc); block;
+       block = cmark_node_next(block))
+    ++n;
+  hashes = (unsigned long long *)calloc(n, sizeof(*hashes));
+  hash_xml(doc, hashes, n);
+
+  double start = now();
+  cmark_node_hash(doc);
+  double whole = now() - start;
+
+  for (int i = 0; i < edits; ++i) {
+    size_t offset = pick_offset(buf, len);
+    char *edited = (char *)malloc(len + 2);
+
+    before = cmark_node_copy(doc, mem);
+    memcpy(edited, buf, offset);
+    edited[offset] = 'x';
+    memcpy(edited + offset + 1, buf + offset, len - offset);
+    cmark_node_free(cmark_parser_reparse(parser, doc, buf, len, offset, 0,
+                                         "x", 1, NULL, NULL));
+    free(buf);
+    buf = edited;
+    ++len;
+
+    start = now();
+    changed_xml += hash_xml(doc, hashes, n);
+    xml += now() - start;
+
+    start = now();
+    changed += (size_t)cmark_node_diff(before, doc, NULL, NULL);
+    diff += now() - start;
+
+    cmark_node_free(before);
+  }
+
+  printf("%.1f MB document   hash all %8.3f ms   xml %8.3f ms   "
+         "diff %8.3f ms   %zu/%zu changes\n",
+         len / 1e6, whole * 1e3, xml * 1e3 / edits, diff * 1e3 / edits,
+         changed, changed_xml);
+
+  free(hashes);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Measures how long rendering a document as HTML takes after typing a
+// character into it, with cmark_render_html and with
+// cmark_render_html_cached, which only renders the blocks the edit
+// changed.  The document is brought up to date with cmark_parser_reparse
+// after each edit.
+//
+// Usage: bench_html_cache [EDITS] [FILE]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "## Section %zu with *emphasis*\n"
+      "\n"
+      "A paragraph with **strong** text, `code`, a [link][ref] and a soft\n"
+      "break, followed by ![an image](/img.png \"title\") and more words.\n"
+      "\n"
+      "- item %zu with _underscores_ and [an inline link](/url)\n"
+      "- another with <span>raw html</span>\n"
+      "\n"
+      "```\n"
+      "code block %zu\n"
+      "```\n"
+      "\n";
+  static const char refs[] = "[ref]: /url \"Title\"\n\n";
+  size_t repeat = 5000, size = sizeof(refs) + repeat * (sizeof(unit) + 64);
+  char *buf = (char *)malloc(size);
+
+  *len = (size_t)sprintf(buf, "%s", refs);
+  for (size_t i = 0; i < repeat; ++i)
+    *len += (size_t)sprintf(buf + *len, unit, i, i, i);
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size + 1);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Returns an offset inside a line that starts with a letter.
+static size_t pick_offset(const char *buf, size_t len) {
+  for (;;) {
+    size_t offset = (size_t)rand() % len;
+    while (offset > 0 && buf[offset - 1] != '\n')
+      --offset;
+    if (offset + 2 < len && buf[offset + 1] != '\n' &&
+        ((buf[offset] >= 'A' && buf[offset] <= 'Z') ||
+         (buf[offset] >= 'a' && buf[offset] <= 'z')))
+      return offset + 2;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int edits = argc > 1 ? atoi(argv[1]) : 100;
+  size_t len;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_INCREMENTAL);
+  cmark_html_cache *cache = cmark_html_cache_new(64 * 1048576);
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *doc;
+  double full = 0, cached = 0;
+  char *html;
+
+  srand(1);
+  cmark_parser_feed(parser, buf, len);
+  doc = cmark_parser_finish(parser);
+  free(cmark_render_html_cached(cache, doc, buf, len, CMARK_OPT_DEFAULT, NULL,
+                                mem));
+
+  for (int i = 0; i < edits; ++i) {
+    size_t offset = pick_offset(buf, len);
+    char *edited = (char *)malloc(len + 2);
+
+    memcpy(edited, buf, offset);
+    edited[offset] = 'x';
+    memcpy(edited + offset + 1, buf + offset, len - offset);
+    cmark_node_free(cmark_parser_reparse(parser, doc, buf, len, offset, 0,
+                                         "x", 1, NULL, NULL));
+    free(buf);
+    buf = edited;
+    ++len;
+
+    double start = now();
+    html = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+    full += now() - start;
+    free(html);
+
+    start = now();
+    html = cmark_render_html_cached(cache, doc, buf, len, CMARK_OPT_DEFAULT,
+                                    NULL, mem);
+    cached += now() - start;
+    free(html);
+  }
+
+  printf("%.1f MB document   render %8.3f ms   cached %8.3f ms   "
+         "%zu hits %zu misses   %.1f MB cached\n",
+         len / 1e6, full * 1e3 / edits, cached * 1e3 / edits,
+         cmark_html_cache_hits(cache), cmark_html_cache_misses(cache),
+         cmark_html_cache_size(cache) / 1e6);
+
+  cmark_html_cache_free(cache);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+  free(buf);
+  return 0;
+}
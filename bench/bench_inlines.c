@@ -0,0 +1,73 @@
+// Measures inline parsing of prose-heavy text, for each instruction set the
+// CPU supports.
+//
+// Usage: bench_inlines [ITERATIONS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "cmark-gfm-core-extensions.h"
+#include "simd.h"
+
+static const char *level_names[] = {"scalar", "sse2", "ssse3", "avx2"};
+
+static const char prose[] =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+    "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+    "commodo consequat. Duis aute irure dolor in *reprehenderit* in voluptate\n"
+    "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+    "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+    "mollit anim id est laborum, with a `code span` in the middle of it.\n"
+    "\n";
+
+static double parse(const char *buf, size_t len, int options,
+                    const char **extensions, int iterations) {
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser = cmark_parser_new(options);
+    for (const char **ext = extensions; *ext; ++ext)
+      cmark_parser_attach_syntax_extension(parser,
+                                           cmark_find_syntax_extension(*ext));
+    cmark_parser_feed(parser, buf, len);
+    cmark_node *doc = cmark_parser_finish(parser);
+    cmark_node_free(doc);
+    cmark_parser_free(parser);
+  }
+
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+  size_t unit = sizeof(prose) - 1, copies = 2000, len = unit * copies;
+  char *buf = (char *)malloc(len);
+  const char *none[] = {NULL};
+  const char *gfm[] = {"strikethrough", "autolink", NULL};
+  cmark_simd_level max;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  for (size_t i = 0; i < copies; ++i)
+    memcpy(buf + i * unit, prose, unit);
+
+  max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+  for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+    cmark_simd_set_level((cmark_simd_level)level);
+    printf("%-7s default %7.1f MB/s   smart %7.1f MB/s   gfm %7.1f MB/s\n",
+           level_names[level],
+           len * iterations /
+               parse(buf, len, CMARK_OPT_DEFAULT, none, iterations) / 1e6,
+           len * iterations /
+               parse(buf, len, CMARK_OPT_SMART, none, iterations) / 1e6,
+           len * iterations /
+               parse(buf, len, CMARK_OPT_DEFAULT, gfm, iterations) / 1e6);
+  }
+
+  free(buf);
+  return 0;
+}
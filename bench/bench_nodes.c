@@ -0,0 +1,155 @@
+// Measures how much memory the parser allocates per node, how fast a full
+// cmark_iter_next walk over the resulting tree is, and how long parsing and
+// freeing the document take with and without CMARK_OPT_DOCUMENT_ARENA.
+//
+// Usage: bench_nodes [ITERATIONS] [FILE]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+
+// An allocator that counts the bytes requested through it.  Blocks carry
+// their size in front so that realloc and free can account for them.
+static size_t live_bytes;
+
+static void *counting_calloc(size_t nmem, size_t size) {
+  size_t *p = (size_t *)calloc(1, nmem * size + sizeof(size_t));
+  if (!p)
+    abort();
+  *p = nmem * size;
+  live_bytes += *p;
+  return p + 1;
+}
+
+static void *counting_realloc(void *ptr, size_t size) {
+  size_t *p = ptr ? (size_t *)ptr - 1 : NULL;
+  if (p)
+    live_bytes -= *p;
+  p = (size_t *)realloc(p, size + sizeof(size_t));
+  if (!p)
+    abort();
+  *p = size;
+  live_bytes += size;
+  return p + 1;
+}
+
+static void counting_free(void *ptr) {
+  if (ptr) {
+    size_t *p = (size_t *)ptr - 1;
+    live_bytes -= *p;
+    free(p);
+  }
+}
+
+static cmark_mem counting_mem = {counting_calloc, counting_realloc,
+                                 counting_free, NULL, NULL, NULL, NULL};
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "# Heading with *emphasis*\n"
+      "\n"
+      "A paragraph with `code`, a [link](/url \"title\"), **strong** text\n"
+      "and a soft break, followed by ![an image](/img.png).\n"
+      "\n"
+      "- item one\n"
+      "- item *two*\n"
+      "  - nested item\n"
+      "\n"
+      "> a quoted line\n"
+      "> and another\n"
+      "\n"
+      "```\n"
+      "code block\n"
+      "```\n"
+      "\n";
+  size_t repeat = 20000, unit_len = sizeof(unit) - 1;
+  char *buf = (char *)malloc(unit_len * repeat);
+
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + i * unit_len, unit, unit_len);
+
+  *len = unit_len * repeat;
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static void time_parse_and_free(const char *name, const char *buf, size_t len,
+                                int options, int iterations) {
+  double parse = 0, release = 0;
+
+  for (int i = 0; i < iterations; ++i) {
+    clock_t start = clock();
+    cmark_node *doc = cmark_parse_document(buf, len, options);
+    clock_t parsed = clock();
+    cmark_node_free(doc);
+    parse += (double)(parsed - start) / CLOCKS_PER_SEC;
+    release += (double)(clock() - parsed) / CLOCKS_PER_SEC;
+  }
+
+  printf("%-16s parse %8.2f ms   free %8.2f ms\n", name,
+         parse * 1e3 / iterations, release * 1e3 / iterations);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+  size_t len, nodes = 0, bytes;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  cmark_parser *parser = cmark_parser_new_with_mem(CMARK_OPT_DEFAULT,
+                                                   &counting_mem);
+  cmark_node *doc;
+  cmark_iter *iter;
+  cmark_event_type ev;
+
+  cmark_parser_feed(parser, buf, len);
+  doc = cmark_parser_finish(parser);
+  cmark_parser_free(parser);
+  bytes = live_bytes;
+
+  iter = cmark_iter_new(doc);
+  while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE)
+    if (ev == CMARK_EVENT_ENTER)
+      ++nodes;
+
+  clock_t start = clock();
+  for (int i = 0; i < iterations; ++i) {
+    size_t types = 0;
+    cmark_iter_reset(iter, doc, CMARK_EVENT_ENTER);
+    while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE)
+      types += cmark_node_get_type(cmark_iter_get_node(iter));
+    if (types == 0)
+      puts("");
+  }
+  double t = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%zu nodes   %.1f bytes/node   walk %.2f ns/node\n", nodes,
+         (double)bytes / nodes, t * 1e9 / ((double)nodes * iterations));
+
+  cmark_iter_free(iter);
+  cmark_node_free(doc);
+
+  time_parse_and_free("default", buf, len, CMARK_OPT_DEFAULT, iterations);
+  time_parse_and_free("document arena", buf, len, CMARK_OPT_DOCUMENT_ARENA,
+                      iterations);
+  free(buf);
+  return 0;
+}
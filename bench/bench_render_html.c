@@ -0,0 +1,110 @@
+// Measures cmark_render_html on the given documents, for each instruction
+// set the CPU supports, and then appending the HTML to a reused buffer by
+// way of a returned string and of cmark_render_html_to_sink. Each document
+// is repeated to make it large enough to time.
+//
+// Usage: bench_render_html [-n ITERATIONS] FILE...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "buffer.h"
+#include "cmark-gfm.h"
+#include "simd.h"
+
+static const char *level_names[] = {"scalar", "sse2", "ssse3", "avx2"};
+
+static char *read_file(const char *path, size_t copies, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp)
+    return NULL;
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc((size_t)size * copies);
+  if (fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+    fclose(fp);
+    free(buf);
+    return NULL;
+  }
+  fclose(fp);
+
+  for (size_t i = 1; i < copies; ++i)
+    memcpy(buf + i * (size_t)size, buf, (size_t)size);
+  *len = (size_t)size * copies;
+  return buf;
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = 20;
+  int i = 1;
+  cmark_simd_level max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = atoi(argv[2]);
+    i = 3;
+  }
+
+  for (; i < argc; ++i) {
+    size_t len;
+    char *buf = read_file(argv[i], 200, &len);
+
+    if (!buf) {
+      fprintf(stderr, "cannot read %s\n", argv[i]);
+      return 1;
+    }
+
+    cmark_node *doc = cmark_parse_document(buf, len, CMARK_OPT_DEFAULT);
+    for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+      size_t out = 0;
+      clock_t start;
+      double elapsed;
+
+      cmark_simd_set_level((cmark_simd_level)level);
+      start = clock();
+      for (int n = 0; n < iterations; ++n) {
+        char *html = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+        out += strlen(html);
+        free(html);
+      }
+      elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+      printf("%-32s %-7s %8.1f MB/s of HTML\n", argv[i], level_names[level],
+             out / elapsed / 1e6);
+    }
+
+    cmark_strbuf buffer = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+    for (int sink = 0; sink < 2; ++sink) {
+      size_t out = 0;
+      clock_t start;
+      double elapsed;
+
+      start = clock();
+      for (int n = 0; n < iterations; ++n) {
+        cmark_strbuf_clear(&buffer);
+        if (sink) {
+          cmark_render_html_to_sink(doc, CMARK_OPT_DEFAULT, NULL,
+                                    cmark_strbuf_write, &buffer);
+        } else {
+          char *html = cmark_render_html(doc, CMARK_OPT_DEFAULT, NULL);
+          cmark_strbuf_puts(&buffer, html);
+          free(html);
+        }
+        out += buffer.size;
+      }
+      elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+      printf("%-32s %-7s %8.1f MB/s of HTML\n", argv[i],
+             sink ? "sink" : "string", out / elapsed / 1e6);
+    }
+    cmark_strbuf_free(&buffer);
+
+    cmark_node_free(doc);
+    free(buf);
+  }
+
+  return 0;
+}
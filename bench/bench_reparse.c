@@ -0,0 +1,130 @@
+// Measures how long cmark_parser_reparse takes to bring a document up to
+// date after typing a character, against parsing the edited text again
+// with cmark_parser_feed and cmark_parser_finish.  The edits type words of
+// five characters, one at a time, into random paragraphs of the document.
+//
+// Usage: bench_reparse [EDITS] [FILE]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "## A section with *emphasis*\n"
+      "\n"
+      "A paragraph with **strong** text, `code`, a [link][ref] and a soft\n"
+      "break, followed by ![an image](/img.png \"title\") and more words.\n"
+      "\n"
+      "- an item with _underscores_ and [an inline link](/url)\n"
+      "- another with <span>raw html</span>\n"
+      "\n"
+      "```\n"
+      "code block\n"
+      "```\n"
+      "\n";
+  static const char refs[] = "[ref]: /url \"Title\"\n\n";
+  size_t repeat = 5000, unit_len = sizeof(unit) - 1,
+         refs_len = sizeof(refs) - 1;
+  char *buf = (char *)malloc(refs_len + unit_len * repeat + 1);
+
+  memcpy(buf, refs, refs_len);
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + refs_len + i * unit_len, unit, unit_len);
+
+  *len = refs_len + unit_len * repeat;
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size + 1);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Returns an offset inside a line that starts with a letter, where typing
+// does not start or end a block.
+static size_t pick_offset(const char *buf, size_t len) {
+  for (;;) {
+    size_t offset = (size_t)rand() % len;
+    while (offset > 0 && buf[offset - 1] != '\n')
+      --offset;
+    if (offset + 2 < len && buf[offset + 1] != '\n' &&
+        ((buf[offset] >= 'A' && buf[offset] <= 'Z') ||
+         (buf[offset] >= 'a' && buf[offset] <= 'z')))
+      return offset + 2;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int edits = argc > 1 ? atoi(argv[1]) : 200;
+  size_t len, blocks = 0;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_INCREMENTAL);
+  cmark_node *doc, *replaced, *first, *last, *node;
+  double full = 0, incremental = 0;
+  size_t offset = 0;
+
+  srand(1);
+  cmark_parser_feed(parser, buf, len);
+  doc = cmark_parser_finish(parser);
+
+  for (int i = 0; i < edits; ++i) {
+    offset = i % 5 ? offset + 1 : pick_offset(buf, len);
+    char *edited = (char *)malloc(len + 2);
+
+    memcpy(edited, buf, offset);
+    edited[offset] = 'x';
+    memcpy(edited + offset + 1, buf + offset, len - offset);
+
+    double start = now();
+    replaced = cmark_parser_reparse(parser, doc, buf, len, offset, 0, "x", 1,
+                                    &first, &last);
+    incremental += now() - start;
+    for (node = first; node; node = node == last ? NULL : cmark_node_next(node))
+      ++blocks;
+    cmark_node_free(replaced);
+
+    free(buf);
+    buf = edited;
+    ++len;
+
+    start = now();
+    cmark_parser_feed(parser, buf, len);
+    cmark_node_free(cmark_parser_finish(parser));
+    full += now() - start;
+  }
+
+  printf("%.1f MB document   full parse %8.3f ms   reparse %8.3f ms   "
+         "%.1f blocks parsed per edit\n",
+         len / 1e6, full * 1e3 / edits, incremental * 1e3 / edits,
+         (double)blocks / edits);
+
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,162 @@
+// Measures how long parsing a document with cmark_parser_finish takes
+// against loading the same tree from the output of cmark_node_serialize,
+// both by copying it into a fresh tree and by loading it in place from a
+// read-only mapping of a file, and how large the serialized form is.
+//
+// Usage: bench_serialize [ITERATIONS] [FILE]
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "cmark-gfm-core-extensions.h"
+
+static const char *extensions[] = {"table", "strikethrough", "autolink",
+                                   "tagfilter", "tasklist"};
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "# Heading with *emphasis*\n"
+      "\n"
+      "A paragraph with `code`, a [link](/url \"title\"), **strong** text,\n"
+      "~~struck~~ words and www.example.com, then a soft break and a note[^1].\n"
+      "\n"
+      "- [ ] a task\n"
+      "- item *two*\n"
+      "  - nested item\n"
+      "\n"
+      "| column | other |\n"
+      "|:-------|------:|\n"
+      "| `a`    | *b*   |\n"
+      "\n"
+      "```\n"
+      "code block\n"
+      "```\n"
+      "\n";
+  static const char notes[] = "[^1]: The note.\n";
+  size_t repeat = 20000, unit_len = sizeof(unit) - 1,
+         notes_len = sizeof(notes) - 1;
+  char *buf = (char *)malloc(unit_len * repeat + notes_len);
+
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + i * unit_len, unit, unit_len);
+  memcpy(buf + unit_len * repeat, notes, notes_len);
+
+  *len = unit_len * repeat + notes_len;
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static cmark_node *parse(const char *buf, size_t len) {
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_FOOTNOTES);
+  cmark_node *doc;
+
+  for (size_t e = 0; e < sizeof(extensions) / sizeof(*extensions); ++e)
+    cmark_parser_attach_syntax_extension(
+        parser, cmark_find_syntax_extension(extensions[e]));
+  cmark_parser_feed(parser, buf, len);
+  doc = cmark_parser_finish(parser);
+  cmark_parser_free(parser);
+  return doc;
+}
+
+static void report(const char *name, double t, double base, int iterations) {
+  printf("%-24s %8.2f ms   %5.1fx\n", name, t * 1e3 / iterations, base / t);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 10;
+  size_t len, size;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  double parsing = 0, copying = 0, mapping = 0, arena = 0, start;
+  unsigned char *data;
+  cmark_node *doc;
+  FILE *fp;
+  void *map;
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  doc = parse(buf, len);
+  data = cmark_node_serialize(doc, mem, &size);
+  cmark_node_free(doc);
+  if (!data) {
+    fputs("the document cannot be serialized\n", stderr);
+    return 1;
+  }
+
+  fp = tmpfile();
+  if (!fp || fwrite(data, 1, size, fp) != size || fflush(fp)) {
+    perror("tmpfile");
+    return 1;
+  }
+  map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+  if (map == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  for (int i = 0; i < iterations; ++i) {
+    start = now();
+    doc = parse(buf, len);
+    parsing += now() - start;
+    cmark_node_free(doc);
+
+    start = now();
+    doc = cmark_node_deserialize(data, size, 0, mem);
+    copying += now() - start;
+    cmark_node_free(doc);
+
+    start = now();
+    doc = cmark_node_deserialize_in_place((const unsigned char *)map, size, 0,
+                                          mem);
+    mapping += now() - start;
+    cmark_node_free(doc);
+
+    start = now();
+    doc = cmark_node_deserialize_in_place((const unsigned char *)map, size,
+                                          CMARK_OPT_DOCUMENT_ARENA, mem);
+    arena += now() - start;
+    cmark_node_free(doc);
+  }
+
+  printf("%zu bytes of input, %zu bytes serialized\n", len, size);
+  report("cmark_parser_finish", parsing, parsing, iterations);
+  report("deserialize", copying, parsing, iterations);
+  report("in place from mmap", mapping, parsing, iterations);
+  report("in place into an arena", arena, parsing, iterations);
+
+  munmap(map, size);
+  fclose(fp);
+  cmark_mem_free(mem, data);
+  free(buf);
+  return 0;
+}
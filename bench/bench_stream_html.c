@@ -0,0 +1,172 @@
+// Measures the time to the first byte of HTML, the total time including
+// freeing the document, and the peak memory allocated when a document is
+// parsed and rendered as a whole, and when it is streamed with
+// cmark_html_stream.
+//
+// Usage: bench_stream_html [ITERATIONS] [FILE]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+
+// An allocator that tracks the most bytes live through it at once.  Blocks
+// carry their size in front so that realloc and free can account for them.
+static size_t live_bytes, peak_bytes;
+
+static void count(size_t add, size_t sub) {
+  live_bytes = live_bytes + add - sub;
+  if (live_bytes > peak_bytes)
+    peak_bytes = live_bytes;
+}
+
+static void *counting_calloc(size_t nmem, size_t size) {
+  size_t *p = (size_t *)calloc(1, nmem * size + sizeof(size_t));
+  if (!p)
+    abort();
+  *p = nmem * size;
+  count(*p, 0);
+  return p + 1;
+}
+
+static void *counting_realloc(void *ptr, size_t size) {
+  size_t *p = ptr ? (size_t *)ptr - 1 : NULL;
+  size_t old = p ? *p : 0;
+  p = (size_t *)realloc(p, size + sizeof(size_t));
+  if (!p)
+    abort();
+  *p = size;
+  count(size, old);
+  return p + 1;
+}
+
+static void counting_free(void *ptr) {
+  if (ptr) {
+    size_t *p = (size_t *)ptr - 1;
+    count(0, *p);
+    free(p);
+  }
+}
+
+static cmark_mem counting_mem = {counting_calloc, counting_realloc,
+                                 counting_free, NULL, NULL, NULL, NULL};
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "# Heading with *emphasis*\n"
+      "\n"
+      "A paragraph with `code`, a [link](/url \"title\"), **strong** text\n"
+      "and a soft break, followed by ![an image](/img.png).\n"
+      "\n"
+      "- item one\n"
+      "- item *two*\n"
+      "  - nested item\n"
+      "\n"
+      "> a quoted line\n"
+      "> and another\n"
+      "\n";
+  size_t repeat = 100000, unit_len = sizeof(unit) - 1;
+  char *buf = (char *)malloc(unit_len * repeat);
+
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + i * unit_len, unit, unit_len);
+
+  *len = unit_len * repeat;
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static clock_t start, first_byte;
+static size_t written;
+
+static void write_output(const char *data, size_t len, void *userdata) {
+  (void)data;
+  (void)userdata;
+  if (written == 0)
+    first_byte = clock();
+  written += len;
+}
+
+static void report(const char *name, double first, double total,
+                   int iterations) {
+  printf("%-8s first byte %8.2f ms   total %8.2f ms   peak %9.0f KB   "
+         "output %8.1f MB\n",
+         name, first * 1e3 / iterations, total * 1e3 / iterations,
+         peak_bytes / 1e3, written / 1e6);
+}
+
+// Feeds 'buf' to the parser in 64 KB pieces, as a reader of a file or a
+// socket would.
+static void feed(cmark_parser *parser, const char *buf, size_t len) {
+  for (size_t off = 0; off < len; off += 65536)
+    cmark_parser_feed(parser, buf + off, len - off < 65536 ? len - off : 65536);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 5;
+  size_t len;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+  double first = 0, total = 0;
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser =
+        cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, &counting_mem);
+    cmark_node *doc;
+    char *html;
+
+    written = 0;
+    start = clock();
+    feed(parser, buf, len);
+    doc = cmark_parser_finish(parser);
+    html = cmark_render_html_with_mem(doc, CMARK_OPT_DEFAULT, NULL,
+                                      &counting_mem);
+    write_output(html, strlen(html), NULL);
+    counting_free(html);
+    cmark_node_free(doc);
+    first += (double)(first_byte - start) / CLOCKS_PER_SEC;
+    total += (double)(clock() - start) / CLOCKS_PER_SEC;
+    cmark_parser_free(parser);
+  }
+  report("tree", first, total, iterations);
+
+  first = total = 0;
+  peak_bytes = live_bytes;
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser =
+        cmark_parser_new_with_mem(CMARK_OPT_DEFAULT, &counting_mem);
+    cmark_html_stream *stream = cmark_html_stream_new(
+        parser, CMARK_OPT_DEFAULT, NULL, write_output, NULL);
+
+    written = 0;
+    start = clock();
+    feed(parser, buf, len);
+    cmark_html_stream_finish(stream);
+    first += (double)(first_byte - start) / CLOCKS_PER_SEC;
+    total += (double)(clock() - start) / CLOCKS_PER_SEC;
+    cmark_html_stream_free(stream);
+    cmark_parser_free(parser);
+  }
+  report("stream", first, total, iterations);
+
+  free(buf);
+  return 0;
+}
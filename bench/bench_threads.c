@@ -0,0 +1,107 @@
+// Measures the wall-clock time of feeding a document to the parser and of
+// cmark_parser_finish for several thread counts given to
+// cmark_parser_set_threads.  With one thread, feeding parses the blocks and
+// finishing parses the inlines; with more, feeding only holds the input and
+// finishing does all the work.  Threads only make a difference when the
+// library is built with CMARK_THREADING.
+//
+// Usage: bench_threads [ITERATIONS] [FILE]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "cmark-gfm-core-extensions.h"
+
+static char *make_sample(size_t *len) {
+  static const char unit[] =
+      "A paragraph with *emphasis*, **strong** text, `code`, a [link][ref]\n"
+      "and an autolink to www.example.com, followed by ~~struck~~ words and\n"
+      "a ![an image](/img.png \"title\") at the end of a soft-broken line.\n"
+      "\n"
+      "- an item with _underscores_ and [an inline link](/url)\n"
+      "- another with <span>raw html</span> and \"smart\" quotes...\n"
+      "\n";
+  static const char refs[] = "[ref]: /url \"Title\"\n\n";
+  size_t repeat = 20000, unit_len = sizeof(unit) - 1,
+         refs_len = sizeof(refs) - 1;
+  char *buf = (char *)malloc(refs_len + unit_len * repeat);
+
+  memcpy(buf, refs, refs_len);
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + refs_len + i * unit_len, unit, unit_len);
+
+  *len = refs_len + unit_len * repeat;
+  return buf;
+}
+
+static char *read_file(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  char *buf;
+  long size;
+
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  buf = (char *)malloc(size);
+  *len = fread(buf, 1, size, fp);
+  fclose(fp);
+  return buf;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run(const char *buf, size_t len, int threads, int iterations) {
+  static const char *extensions[] = {"table", "strikethrough", "autolink",
+                                     "tagfilter", "tasklist"};
+  double feed = 0, finish = 0;
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser = cmark_parser_new(CMARK_OPT_SMART);
+    for (size_t e = 0; e < sizeof(extensions) / sizeof(*extensions); ++e)
+      cmark_parser_attach_syntax_extension(
+          parser, cmark_find_syntax_extension(extensions[e]));
+    cmark_parser_set_threads(parser, threads);
+
+    double start = now();
+    cmark_parser_feed(parser, buf, len);
+    double fed = now();
+    cmark_node *doc = cmark_parser_finish(parser);
+    finish += now() - fed;
+    feed += fed - start;
+
+    cmark_node_free(doc);
+    cmark_parser_free(parser);
+  }
+
+  printf("%2d thread%s  feed %8.2f ms   finish %8.2f ms   %7.1f MB/s\n",
+         threads, threads == 1 ? " " : "s", feed * 1e3 / iterations,
+         finish * 1e3 / iterations,
+         (double)len * iterations / (feed + finish) / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 10;
+  size_t len;
+  char *buf = argc > 2 ? read_file(argv[2], &len) : make_sample(&len);
+
+  cmark_gfm_core_extensions_ensure_registered();
+
+  for (int threads = 1; threads <= 8; threads *= 2)
+    run(buf, len, threads, iterations);
+
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Measures UTF-8 validation on its own and as part of parsing with
+// CMARK_OPT_VALIDATE_UTF8, for each instruction set the CPU supports.
+//
+// Usage: bench_utf8 [ITERATIONS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmark-gfm.h"
+#include "simd.h"
+#include "utf8.h"
+
+static const char *level_names[] = {"scalar", "sse2", "ssse3", "avx2"};
+
+static char *make_input(const char *unit, size_t repeat, size_t *len) {
+  size_t unit_len = strlen(unit);
+  char *buf = (char *)malloc(unit_len * repeat);
+
+  for (size_t i = 0; i < repeat; ++i)
+    memcpy(buf + i * unit_len, unit, unit_len);
+
+  *len = unit_len * repeat;
+  return buf;
+}
+
+static double check(const char *buf, size_t len, int iterations) {
+  cmark_strbuf out = CMARK_BUF_INIT(cmark_get_default_mem_allocator());
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_strbuf_clear(&out);
+    cmark_utf8proc_check(&out, (const uint8_t *)buf, (bufsize_t)len);
+  }
+
+  cmark_strbuf_free(&out);
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double parse(char *buf, size_t len, int options, int iterations) {
+  clock_t start = clock();
+
+  for (int i = 0; i < iterations; ++i) {
+    cmark_parser *parser = cmark_parser_new(options);
+    cmark_parser_feed_in_place(parser, buf, len);
+    cmark_node_free(cmark_parser_finish(parser));
+    cmark_parser_free(parser);
+  }
+
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void run(const char *name, char *buf, size_t len, int iterations) {
+  cmark_simd_level max = cmark_simd_set_level(CMARK_SIMD_AVX2);
+
+  for (int level = CMARK_SIMD_NONE; level <= (int)max; ++level) {
+    cmark_simd_set_level((cmark_simd_level)level);
+    double c = check(buf, len, iterations * 10);
+    double p = parse(buf, len, CMARK_OPT_DEFAULT, iterations);
+    double v = parse(buf, len, CMARK_OPT_VALIDATE_UTF8, iterations);
+    printf("%-10s %-7s check %8.1f MB/s   parse %7.1f MB/s   "
+           "parse+validate %7.1f MB/s\n",
+           name, level_names[level], (double)len * iterations * 10 / c / 1e6,
+           (double)len * iterations / p / 1e6,
+           (double)len * iterations / v / 1e6);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+  size_t len;
+  char *buf;
+
+  buf = make_input("Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+                   "sed do *eiusmod* tempor incididunt ut labore.\n",
+                   20000, &len);
+  run("ascii", buf, len, iterations);
+  free(buf);
+
+  buf = make_input("Größenwahn café naïve — “quoted” text, then some plain "
+                   "ASCII words to follow it.\n",
+                   20000, &len);
+  run("latin", buf, len, iterations);
+  free(buf);
+
+  buf = make_input("日本語のテキストと中文文本，以及一些 emoji 😀 混在。\n",
+                   20000, &len);
+  run("cjk", buf, len, iterations);
+  free(buf);
+
+  return 0;
+}
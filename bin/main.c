@@ -73,37 +73,39 @@ void print_usage() {
   printf("  --version        Print version\n");
 }
 
+static void write_stdout(const char *data, size_t len, void *userdata) {
+  (void)userdata;
+  fwrite(data, 1, len, stdout);
+}
+
 static bool print_document(cmark_node *document, writer_format writer,
                            int options, int width, cmark_parser *parser) {
-  char *result;
-
-  cmark_mem *mem = cmark_get_default_mem_allocator();
-
   switch (writer) {
   case FORMAT_HTML:
-    result = cmark_render_html_with_mem(document, options, parser->syntax_extensions, mem);
+    cmark_render_html_to_sink(document, options, parser->syntax_extensions,
+                              write_stdout, NULL);
     break;
   case FORMAT_XML:
-    result = cmark_render_xml_with_mem(document, options, mem);
+    cmark_render_xml_to_sink(document, options, write_stdout, NULL);
     break;
   case FORMAT_MAN:
-    result = cmark_render_man_with_mem(document, options, width, mem);
+    cmark_render_man_to_sink(document, options, width, write_stdout, NULL);
     break;
   case FORMAT_COMMONMARK:
-    result = cmark_render_commonmark_with_mem(document, options, width, mem);
+    cmark_render_commonmark_to_sink(document, options, width, write_stdout,
+                                    NULL);
     break;
   case FORMAT_PLAINTEXT:
-    result = cmark_render_plaintext_with_mem(document, options, width, mem);
+    cmark_render_plaintext_to_sink(document, options, width, write_stdout,
+                                   NULL);
     break;
   case FORMAT_LATEX:
-    result = cmark_render_latex_with_mem(document, options, width, mem);
+    cmark_render_latex_to_sink(document, options, width, write_stdout, NULL);
     break;
   default:
     fprintf(stderr, "Unknown format %d\n", writer);
     return false;
   }
-  printf("%s", result);
-  mem->free(result);
 
   return true;
 }
@@ -131,6 +133,9 @@ int main(int argc, char *argv[]) {
   cmark_parser *parser = NULL;
   size_t bytes;
   cmark_node *document = NULL;
+#if !DEBUG
+  cmark_arena *arena = NULL;
+#endif
   int width = 0;
   char *unparsed;
   writer_format writer = FORMAT_HTML;
@@ -252,7 +257,8 @@ int main(int argc, char *argv[]) {
 #if DEBUG
   parser = cmark_parser_new(options);
 #else
-  parser = cmark_parser_new_with_mem(options, cmark_get_arena_mem_allocator());
+  arena = cmark_arena_new();
+  parser = cmark_parser_new_with_arena(options, arena);
 #endif
 
   for (i = 1; i < argc; i++) {
@@ -284,7 +290,7 @@ int main(int argc, char *argv[]) {
     }
 
     while ((bytes = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
-      cmark_parser_feed(parser, buffer, bytes);
+      cmark_parser_feed_in_place(parser, buffer, bytes);
       if (bytes < sizeof(buffer)) {
         break;
       }
@@ -295,7 +301,7 @@ int main(int argc, char *argv[]) {
 
   if (numfps == 0) {
     while ((bytes = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
-      cmark_parser_feed(parser, buffer, bytes);
+      cmark_parser_feed_in_place(parser, buffer, bytes);
       if (bytes < sizeof(buffer)) {
         break;
       }
@@ -326,7 +332,7 @@ failure:
   if (document)
     cmark_node_free(document);
 #else
-  cmark_arena_reset();
+  cmark_arena_free(arena);
 #endif
 
   cmark_release_plugins();
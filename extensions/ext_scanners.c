@@ -1,26 +1,22 @@
 /* Generated by re2c 1.3 */
+/* The input accesses were converted by hand to the YYPEEK/YYSKIP API that
+   the .re file declares; regenerate with `make extensions/ext_scanners.c` (re2c >= 1.2). */
 
 #include "ext_scanners.h"
 #include <stdlib.h>
 
-bufsize_t _ext_scan_at(bufsize_t (*scanner)(const unsigned char *),
-                       unsigned char *ptr, int len, bufsize_t offset) {
-  bufsize_t res;
-
+bufsize_t _ext_scan_at(bufsize_t (*scanner)(const unsigned char *,
+                                            const unsigned char *),
+                       const unsigned char *ptr, int len, bufsize_t offset) {
   if (ptr == NULL || offset >= len) {
     return 0;
-  } else {
-    unsigned char lim = ptr[len];
-
-    ptr[len] = '\0';
-    res = scanner(ptr + offset);
-    ptr[len] = lim;
   }
 
-  return res;
+  // As in _scan_at, the scanners stop at the end of the input.
+  return scanner(ptr + offset, ptr + len);
 }
 
-bufsize_t _scan_table_start(const unsigned char *p) {
+bufsize_t _scan_table_start(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -40,7 +36,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
         0, 0,   0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0,   0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= ' ') {
       if (yych <= '\n') {
         if (yych == '\t')
@@ -65,7 +61,9 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     ++p;
   yy3 : { return 0; }
   yy4:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy7;
     }
@@ -75,7 +73,9 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       goto yy12;
     goto yy3;
   yy5:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy10;
     }
@@ -99,13 +99,16 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       }
     }
   yy6:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy10;
     }
     goto yy3;
   yy7:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy7;
     }
@@ -117,7 +120,8 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     p = marker;
     goto yy3;
   yy10:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy10;
     }
@@ -149,13 +153,15 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       }
     }
   yy12:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy10;
     }
     goto yy9;
   yy13:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy14:
     if (yych <= '\r') {
       if (yych <= '\t') {
@@ -184,12 +190,14 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy17:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '\n')
       goto yy15;
     goto yy9;
   yy18:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy10;
     }
@@ -219,7 +227,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_table_cell(const unsigned char *p) {
+bufsize_t _scan_table_cell(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -227,7 +235,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     unsigned char yych;
     unsigned int yyaccept = 0;
     static const unsigned char yybm[] = {
-        64, 64, 64,  64, 64, 64, 64, 64, 64, 64, 0,  64, 64, 0,  64, 64, 64, 64,
+        0,  64, 64,  64, 64, 64, 64, 64, 64, 64, 0,  64, 64, 0,  64, 64, 64, 64,
         64, 64, 64,  64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
         64, 64, 64,  64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
         64, 64, 64,  64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
@@ -243,7 +251,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
         0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy22;
     }
@@ -278,7 +286,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     }
   yy22:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy22;
     }
@@ -315,12 +325,16 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
   yy26 : { return 0; }
   yy27:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy27;
     }
     if (yych <= 0xDF) {
       if (yych <= '\f') {
+        if (yych <= 0x00)
+          goto yy24;
         if (yych == '\n')
           goto yy24;
         goto yy22;
@@ -351,7 +365,8 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
       }
     }
   yy29:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy26;
     if (yych <= 0xBF)
@@ -359,7 +374,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy30:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy26;
     if (yych <= 0xBF)
@@ -367,7 +384,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy31:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy26;
     if (yych <= 0xBF)
@@ -375,7 +394,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy32:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy26;
     if (yych <= 0x9F)
@@ -383,7 +404,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy33:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy26;
     if (yych <= 0xBF)
@@ -391,7 +414,9 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy34:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy26;
     if (yych <= 0xBF)
@@ -399,14 +424,17 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy26;
   yy35:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy26;
     if (yych <= 0x8F)
       goto yy39;
     goto yy26;
   yy36:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy37;
     if (yych <= 0xBF)
@@ -419,42 +447,48 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
       goto yy26;
     }
   yy38:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy37;
     if (yych <= 0xBF)
       goto yy36;
     goto yy37;
   yy39:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy37;
     if (yych <= 0xBF)
       goto yy36;
     goto yy37;
   yy40:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy37;
     if (yych <= 0x9F)
       goto yy36;
     goto yy37;
   yy41:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy37;
     if (yych <= 0xBF)
       goto yy39;
     goto yy37;
   yy42:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy37;
     if (yych <= 0xBF)
       goto yy39;
     goto yy37;
   yy43:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy37;
     if (yych <= 0x8F)
@@ -463,7 +497,8 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_table_cell_end(const unsigned char *p) {
+bufsize_t _scan_table_cell_end(const unsigned char *p,
+                               const unsigned char *end) {
   const unsigned char *start = p;
 
   {
@@ -483,13 +518,14 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '|')
       goto yy48;
     ++p;
     { return 0; }
   yy48:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy48;
     }
@@ -497,7 +533,8 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_table_row_end(const unsigned char *p) {
+bufsize_t _scan_table_row_end(const unsigned char *p,
+                              const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -518,7 +555,7 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\f') {
       if (yych <= 0x08)
         goto yy53;
@@ -535,7 +572,9 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
     ++p;
   yy54 : { return 0; }
   yy55:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x08)
       goto yy54;
     if (yych <= '\r')
@@ -547,12 +586,14 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy58:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '\n')
       goto yy56;
     goto yy54;
   yy59:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy60:
     if (yybm[0 + yych] & 128) {
       goto yy59;
@@ -567,14 +608,15 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
     p = marker;
     goto yy54;
   yy62:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '\n')
       goto yy56;
     goto yy61;
   }
 }
 
-bufsize_t _scan_tasklist(const unsigned char *p) {
+bufsize_t _scan_tasklist(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -598,7 +640,7 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 0,  0,  0, 0, 0,
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 0,  0,  0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= ' ') {
       if (yych <= '\n') {
         if (yych == '\t')
@@ -628,7 +670,9 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
     ++p;
   yy66 : { return 0; }
   yy67:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy70;
     }
@@ -648,7 +692,9 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       goto yy66;
     }
   yy68:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych == '\t')
         goto yy75;
@@ -661,7 +707,9 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       goto yy66;
     }
   yy69:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x1F) {
       if (yych <= '\t') {
         if (yych <= 0x08)
@@ -688,7 +736,8 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       }
     }
   yy70:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy70;
     }
@@ -709,12 +758,14 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
     p = marker;
     goto yy66;
   yy73:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '[')
       goto yy72;
     goto yy76;
   yy74:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych == '\t')
         goto yy73;
@@ -727,7 +778,8 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       goto yy78;
     }
   yy75:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy76:
     if (yych <= '\f') {
       if (yych == '\t')
@@ -747,7 +799,8 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       }
     }
   yy77:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy78:
     if (yybm[0 + yych] & 128) {
       goto yy77;
@@ -790,56 +843,64 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
       }
     }
   yy79:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy72;
     if (yych <= 0xBF)
       goto yy73;
     goto yy72;
   yy80:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy72;
     if (yych <= 0xBF)
       goto yy79;
     goto yy72;
   yy81:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy72;
     if (yych <= 0xBF)
       goto yy79;
     goto yy72;
   yy82:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy72;
     if (yych <= 0x9F)
       goto yy79;
     goto yy72;
   yy83:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy72;
     if (yych <= 0xBF)
       goto yy81;
     goto yy72;
   yy84:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy72;
     if (yych <= 0xBF)
       goto yy81;
     goto yy72;
   yy85:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy72;
     if (yych <= 0x8F)
       goto yy81;
     goto yy72;
   yy86:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'W') {
       if (yych != ' ')
         goto yy72;
@@ -850,10 +911,12 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
         goto yy72;
     }
   yy87:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != ']')
       goto yy72;
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych != '\t')
         goto yy72;
@@ -864,7 +927,8 @@ bufsize_t _scan_tasklist(const unsigned char *p) {
         goto yy72;
     }
   yy89:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych == '\t')
         goto yy89;
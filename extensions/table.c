@@ -52,16 +52,16 @@ typedef struct {
 
 static void free_table_cell(cmark_mem *mem, node_cell *cell) {
   cmark_strbuf_free((cmark_strbuf *)cell->buf);
-  mem->free(cell->buf);
+  cmark_mem_free(mem, cell->buf);
   if (cell->cell_data)
-    mem->free(cell->cell_data);
+    cmark_mem_free(mem, cell->cell_data);
 }
 
 static void free_row_cells(cmark_mem *mem, table_row *row) {
   while (row->n_columns > 0) {
     free_table_cell(mem, &row->cells[--row->n_columns]);
   }
-  mem->free(row->cells);
+  cmark_mem_free(mem, row->cells);
   row->cells = NULL;
 }
 
@@ -70,21 +70,21 @@ static void free_table_row(cmark_mem *mem, table_row *row) {
     return;
 
   free_row_cells(mem, row);
-  mem->free(row);
+  cmark_mem_free(mem, row);
 }
 
 static void free_node_table(cmark_mem *mem, void *ptr) {
   node_table *t = (node_table *)ptr;
-  mem->free(t->alignments);
-  mem->free(t);
+  cmark_mem_free(mem, t->alignments);
+  cmark_mem_free(mem, t);
 }
 
 static void free_node_table_row(cmark_mem *mem, void *ptr) {
-  mem->free(ptr);
+  cmark_mem_free(mem, ptr);
 }
 
 static void free_node_table_cell_data(cmark_mem *mem, void *data) {
-  mem->free(data);
+  cmark_mem_free(mem, data);
 }
 
 static int get_n_table_columns(cmark_node *node) {
@@ -99,6 +99,7 @@ static int set_n_table_columns(cmark_node *node, uint16_t n_columns) {
     return 0;
 
   ((node_table *)node->as.opaque)->n_columns = n_columns;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -141,6 +142,7 @@ static int set_table_alignments(cmark_node *node, uint8_t *alignments) {
     return 0;
 
   ((node_table *)node->as.opaque)->alignments = alignments;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -164,6 +166,7 @@ static int set_cell_index(cmark_node *node, int i) {
   if (!data)
     return 0;
   data->cell_index = i;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -195,6 +198,7 @@ static int set_cell_colspan(cmark_node *node, unsigned colspan) {
   if (!data)
     return 0;
   data->colspan = colspan;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -206,6 +210,7 @@ static int set_cell_rowspan(cmark_node *node, unsigned rowspan) {
   if (!data)
     return 0;
   data->rowspan = rowspan;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -222,7 +227,8 @@ static int increment_cell_rowspan(cmark_node *node) {
 
 static cmark_strbuf *unescape_pipes(cmark_mem *mem, unsigned char *string, bufsize_t len)
 {
-  cmark_strbuf *res = (cmark_strbuf *)mem->calloc(1, sizeof(cmark_strbuf));
+  cmark_strbuf *res =
+      (cmark_strbuf *)cmark_mem_calloc(mem, 1, sizeof(cmark_strbuf));
   bufsize_t r, w;
 
   cmark_strbuf_init(mem, res, len + 1);
@@ -253,7 +259,7 @@ static node_cell* append_row_cell(cmark_mem *mem, table_row *row) {
       return NULL;
     }
     // Use realloc to double the size of the buffer.
-    row->cells = (node_cell *)mem->realloc(row->cells, (2 * n_columns - 1) * sizeof(node_cell));
+    row->cells = (node_cell *)cmark_mem_realloc(mem, row->cells, (2 * n_columns - 1) * sizeof(node_cell));
   }
   row->n_columns = (uint16_t)n_columns;
   return &row->cells[n_columns-1];
@@ -279,7 +285,7 @@ static table_row *row_from_string(cmark_syntax_extension *self,
   int row_end_offset = 0;
   int int_overflow_abort = 0;
 
-  row = (table_row *)parser->mem->calloc(1, sizeof(table_row));
+  row = (table_row *)cmark_mem_calloc(parser->mem, 1, sizeof(table_row));
   row->n_columns = 0;
   row->cells = NULL;
 
@@ -304,7 +310,7 @@ static table_row *row_from_string(cmark_syntax_extension *self,
       if (!cell) {
         int_overflow_abort = 1;
         cmark_strbuf_free(cell_buf);
-        parser->mem->free(cell_buf);
+        cmark_mem_free(parser->mem, cell_buf);
         break;
       }
       cell->buf = cell_buf;
@@ -319,7 +325,7 @@ static table_row *row_from_string(cmark_syntax_extension *self,
         --cell->start_offset;
         ++cell->internal_offset;
       }
-      cell->cell_data = (node_cell_data *)parser->mem->calloc(1, sizeof(node_cell_data));
+      cell->cell_data = (node_cell_data *)cmark_mem_calloc(parser->mem, 1, sizeof(node_cell_data));
 
       if (parser->options & CMARK_OPT_TABLE_SPANS) {
         // Check for a column-spanning cell
@@ -411,10 +417,10 @@ static void try_inserting_table_header_paragraph(cmark_parser *parser,
   cmark_strbuf_trim(paragraph_content);
   cmark_node_set_string_content(paragraph, (char *) paragraph_content->ptr);
   cmark_strbuf_free(paragraph_content);
-  parser->mem->free(paragraph_content);
+  cmark_mem_free(parser->mem, paragraph_content);
 
   if (!cmark_node_insert_before(parent_container, paragraph)) {
-    parser->mem->free(paragraph);
+    cmark_mem_free(parser->mem, paragraph);
   }
 }
 
@@ -448,7 +454,7 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
 
   assert(delimiter_row);
 
-  cmark_arena_push();
+  cmark_arena_push_mem(parser->mem);
 
   // Check for a matching header row. We call `row_from_string` with the entire
   // (potentially long) parent container as input, but this should be safe since
@@ -459,12 +465,12 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
   if (!header_row || header_row->n_columns != delimiter_row->n_columns) {
     free_table_row(parser->mem, delimiter_row);
     free_table_row(parser->mem, header_row);
-    cmark_arena_pop();
+    cmark_arena_pop_mem(parser->mem);
     parent_container->flags |= CMARK_NODE__TABLE_VISITED;
     return parent_container;
   }
 
-  if (cmark_arena_pop()) {
+  if (cmark_arena_pop_mem(parser->mem)) {
     delimiter_row = row_from_string(
         self, parser, input + cmark_parser_get_first_nonspace(parser),
         len - cmark_parser_get_first_nonspace(parser));
@@ -490,13 +496,14 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
   }
 
   cmark_node_set_syntax_extension(parent_container, self);
-  parent_container->as.opaque = parser->mem->calloc(1, sizeof(node_table));
+  parent_container->as.opaque =
+      cmark_mem_calloc(parser->mem, 1, sizeof(node_table));
   set_n_table_columns(parent_container, header_row->n_columns);
 
   // allocate alignments based on delimiter_row->n_columns
   // since we populate the alignments array based on delimiter_row->cells
-  uint8_t *alignments =
-      (uint8_t *)parser->mem->calloc(delimiter_row->n_columns, sizeof(uint8_t));
+  uint8_t *alignments = (uint8_t *)cmark_mem_calloc(
+      parser->mem, delimiter_row->n_columns, sizeof(uint8_t));
   for (i = 0; i < delimiter_row->n_columns; ++i) {
     node_cell *node = &delimiter_row->cells[i];
     bool left = node->buf->ptr[0] == ':', right = node->buf->ptr[node->buf->size - 1] == ':';
@@ -517,7 +524,7 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
   table_header->end_column = parent_container->start_column + (int)strlen(parent_string) - 2;
   table_header->start_line = table_header->end_line = parent_container->start_line;
 
-  table_header->as.opaque = ntr = (node_table_row *)parser->mem->calloc(1, sizeof(node_table_row));
+  table_header->as.opaque = ntr = (node_table_row *)cmark_mem_calloc(parser->mem, 1, sizeof(node_table_row));
   ntr->is_header = true;
 
   for (i = 0; i < header_row->n_columns; ++i) {
@@ -525,7 +532,7 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
     cmark_node *header_cell = cmark_parser_add_child(parser, table_header,
         CMARK_NODE_TABLE_CELL, parent_container->start_column + cell->start_offset);
     header_cell->start_line = header_cell->end_line = parent_container->start_line;
-    header_cell->internal_offset = cell->internal_offset;
+    cmark_node_cold_fields(header_cell)->internal_offset = cell->internal_offset;
     header_cell->end_column = parent_container->start_column + cell->end_offset;
     header_cell->as.opaque = cell->cell_data;
     cell->cell_data = NULL;
@@ -564,7 +571,8 @@ static cmark_node *try_opening_table_row(cmark_syntax_extension *self,
                              parent_container->start_column);
   cmark_node_set_syntax_extension(table_row_block, self);
   table_row_block->end_column = parent_container->end_column;
-  table_row_block->as.opaque = parser->mem->calloc(1, sizeof(node_table_row));
+  table_row_block->as.opaque =
+      cmark_mem_calloc(parser->mem, 1, sizeof(node_table_row));
 
   row = row_from_string(self, parser, input + cmark_parser_get_first_nonspace(parser),
       len - cmark_parser_get_first_nonspace(parser));
@@ -612,7 +620,7 @@ static cmark_node *try_opening_table_row(cmark_syntax_extension *self,
       node_cell *cell = &row->cells[i];
       cmark_node *node = cmark_parser_add_child(parser, table_row_block,
           CMARK_NODE_TABLE_CELL, parent_container->start_column + cell->start_offset);
-      node->internal_offset = cell->internal_offset;
+      cmark_node_cold_fields(node)->internal_offset = cell->internal_offset;
       node->end_column = parent_container->start_column + cell->end_offset;
       node->as.opaque = cell->cell_data;
       cell->cell_data = NULL;
@@ -660,14 +668,14 @@ static int matches(cmark_syntax_extension *self, cmark_parser *parser,
   int res = 0;
 
   if (cmark_node_get_type(parent_container) == CMARK_NODE_TABLE) {
-    cmark_arena_push();
+    cmark_arena_push_mem(parser->mem);
     table_row *new_row = row_from_string(
         self, parser, input + cmark_parser_get_first_nonspace(parser),
         len - cmark_parser_get_first_nonspace(parser));
     if (new_row && new_row->n_columns)
       res = 1;
     free_table_row(parser->mem, new_row);
-    cmark_arena_pop();
+    cmark_arena_pop_mem(parser->mem);
   }
 
   return res;
@@ -1032,11 +1040,11 @@ static void html_render(cmark_syntax_extension *extension,
 
 static void opaque_alloc(cmark_syntax_extension *self, cmark_mem *mem, cmark_node *node) {
   if (node->type == CMARK_NODE_TABLE) {
-    node->as.opaque = mem->calloc(1, sizeof(node_table));
+    node->as.opaque = cmark_mem_calloc(mem, 1, sizeof(node_table));
   } else if (node->type == CMARK_NODE_TABLE_ROW) {
-    node->as.opaque = mem->calloc(1, sizeof(node_table_row));
+    node->as.opaque = cmark_mem_calloc(mem, 1, sizeof(node_table_row));
   } else if (node->type == CMARK_NODE_TABLE_CELL) {
-    node->as.opaque = mem->calloc(1, sizeof(node_cell_data));
+    node->as.opaque = cmark_mem_calloc(mem, 1, sizeof(node_cell_data));
   }
 }
 
@@ -1050,6 +1058,137 @@ static void opaque_free(cmark_syntax_extension *self, cmark_mem *mem, cmark_node
   }
 }
 
+static void opaque_copy(cmark_syntax_extension *self, cmark_mem *mem,
+                        cmark_node *dst, cmark_node *src) {
+  if (src->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)cmark_mem_calloc(mem, 1, sizeof(node_table));
+    *t = *(node_table *)src->as.opaque;
+    if (t->alignments) {
+      t->alignments =
+          (uint8_t *)cmark_mem_calloc(mem, t->n_columns, sizeof(uint8_t));
+      memcpy(t->alignments, ((node_table *)src->as.opaque)->alignments,
+             t->n_columns);
+    }
+    dst->as.opaque = t;
+  } else if (src->type == CMARK_NODE_TABLE_ROW) {
+    dst->as.opaque = cmark_mem_calloc(mem, 1, sizeof(node_table_row));
+    memcpy(dst->as.opaque, src->as.opaque, sizeof(node_table_row));
+  } else if (src->type == CMARK_NODE_TABLE_CELL) {
+    dst->as.opaque = cmark_mem_calloc(mem, 1, sizeof(node_cell_data));
+    memcpy(dst->as.opaque, src->as.opaque, sizeof(node_cell_data));
+  }
+}
+
+static uint64_t hash(cmark_syntax_extension *self, cmark_node *node,
+                     uint64_t h) {
+  if (node->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)node->as.opaque;
+    h = cmark_hash_bytes(h, &t->n_columns, sizeof(t->n_columns));
+    if (t->alignments)
+      h = cmark_hash_bytes(h, t->alignments, t->n_columns);
+  } else if (node->type == CMARK_NODE_TABLE_ROW) {
+    bool is_header = ((node_table_row *)node->as.opaque)->is_header;
+    h = cmark_hash_bytes(h, &is_header, sizeof(is_header));
+  } else if (node->type == CMARK_NODE_TABLE_CELL && node->as.opaque) {
+    node_cell_data *data = (node_cell_data *)node->as.opaque;
+    // The index picks the alignment of the cell from its table.
+    int cell[3] = {(int)data->colspan, (int)data->rowspan, data->cell_index};
+    h = cmark_hash_bytes(h, cell, sizeof(cell));
+  }
+  return h;
+}
+
+static void put_u32(unsigned char *p, unsigned value) {
+  p[0] = (unsigned char)value;
+  p[1] = (unsigned char)(value >> 8);
+  p[2] = (unsigned char)(value >> 16);
+  p[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned get_u32(const unsigned char *p) {
+  return p[0] | (unsigned)p[1] << 8 | (unsigned)p[2] << 16 |
+         (unsigned)p[3] << 24;
+}
+
+// A table is its column count and alignments, a row whether it is the
+// header, and a cell its spans and index, or nothing for a filler cell.
+static size_t serialize(cmark_syntax_extension *self, cmark_node *node,
+                        unsigned char *buf, size_t size) {
+  if (node->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)node->as.opaque;
+    size_t len = 2 + (t->alignments ? t->n_columns : 0);
+    if (len <= size) {
+      buf[0] = (unsigned char)t->n_columns;
+      buf[1] = (unsigned char)(t->n_columns >> 8);
+      if (t->alignments)
+        memcpy(buf + 2, t->alignments, t->n_columns);
+    }
+    return len;
+  } else if (node->type == CMARK_NODE_TABLE_ROW) {
+    if (size >= 1)
+      buf[0] = ((node_table_row *)node->as.opaque)->is_header;
+    return 1;
+  } else if (node->type == CMARK_NODE_TABLE_CELL && node->as.opaque) {
+    node_cell_data *data = (node_cell_data *)node->as.opaque;
+    if (size >= 12) {
+      put_u32(buf, data->colspan);
+      put_u32(buf + 4, data->rowspan);
+      put_u32(buf + 8, (unsigned)data->cell_index);
+    }
+    return 12;
+  }
+  return 0;
+}
+
+static int deserialize(cmark_syntax_extension *self, cmark_mem *mem,
+                       cmark_node *node, const unsigned char *data,
+                       size_t len) {
+  cmark_node *row = node->parent;
+  cmark_node *table = row ? row->parent : NULL;
+
+  if (node->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)node->as.opaque;
+    uint16_t n_columns;
+
+    if (len < 2)
+      return 0;
+    n_columns = (uint16_t)(data[0] | data[1] << 8);
+    if (len != 2u + n_columns)
+      return 0;
+    for (size_t i = 2; i < len; ++i)
+      if (data[i] != 0 && data[i] != 'l' && data[i] != 'c' && data[i] != 'r')
+        return 0;
+    t->n_columns = n_columns;
+    t->alignments =
+        (uint8_t *)cmark_mem_calloc(mem, n_columns ? n_columns : 1, 1);
+    memcpy(t->alignments, data + 2, n_columns);
+    return 1;
+  } else if (node->type == CMARK_NODE_TABLE_ROW) {
+    if (len != 1 || !row || row->type != CMARK_NODE_TABLE)
+      return 0;
+    ((node_table_row *)node->as.opaque)->is_header = data[0] != 0;
+    return 1;
+  } else if (node->type == CMARK_NODE_TABLE_CELL) {
+    if (!row || row->type != CMARK_NODE_TABLE_ROW || !table ||
+        table->type != CMARK_NODE_TABLE)
+      return 0;
+    if (len == 0) {
+      free_node_table_cell_data(mem, node->as.opaque);
+      node->as.opaque = NULL;
+      return 1;
+    }
+    node_cell_data *cell = (node_cell_data *)node->as.opaque;
+    if (len != 12 ||
+        get_u32(data + 8) >= ((node_table *)table->as.opaque)->n_columns)
+      return 0;
+    cell->colspan = get_u32(data);
+    cell->rowspan = get_u32(data + 4);
+    cell->cell_index = (int)get_u32(data + 8);
+    return 1;
+  }
+  return 0;
+}
+
 static int escape(cmark_syntax_extension *self, cmark_node *node, int c) {
   return
     node->type != CMARK_NODE_TABLE &&
@@ -1075,6 +1214,10 @@ cmark_syntax_extension *create_table_extension(void) {
   cmark_syntax_extension_set_html_render_func(self, html_render);
   cmark_syntax_extension_set_opaque_alloc_func(self, opaque_alloc);
   cmark_syntax_extension_set_opaque_free_func(self, opaque_free);
+  cmark_syntax_extension_set_opaque_copy_func(self, opaque_copy);
+  cmark_syntax_extension_set_hash_func(self, hash);
+  cmark_syntax_extension_set_serialize_func(self, serialize);
+  cmark_syntax_extension_set_deserialize_func(self, deserialize);
   cmark_syntax_extension_set_commonmark_escape_func(self, escape);
   CMARK_NODE_TABLE = cmark_syntax_extension_add_node(0);
   CMARK_NODE_TABLE_ROW = cmark_syntax_extension_add_node(0);
@@ -1106,7 +1249,7 @@ int cmark_gfm_extensions_set_table_columns(cmark_node *node, uint16_t n_columns)
 
 CMARK_GFM_EXPORT
 int cmark_gfm_extensions_set_table_alignments(cmark_node *node, uint16_t ncols, uint8_t *alignments) {
-  uint8_t *a = (uint8_t *)cmark_node_mem(node)->calloc(1, ncols);
+  uint8_t *a = (uint8_t *)cmark_mem_calloc(cmark_node_mem(node), 1, ncols);
   memcpy(a, alignments, ncols);
   return set_table_alignments(node, a);
 }
@@ -1127,6 +1270,7 @@ int cmark_gfm_extensions_set_table_row_is_header(cmark_node *node, int is_header
     return 0;
 
   ((node_table_row *)node->as.opaque)->is_header = (is_header != 0);
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -27,6 +27,7 @@ int cmark_gfm_extensions_set_tasklist_item_checked(cmark_node *node, bool is_che
     return 0;
 
   node->as.list.checked = is_checked;
+  cmark_node_invalidate_hash(node);
   return 1;
 }
 
@@ -1,3 +1,8 @@
+#if defined(__linux__)
+// MAP_ANONYMOUS and madvise are not part of C99.
+#define _DEFAULT_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -5,109 +10,279 @@
 #include "cmark-gfm-extension_api.h"
 #include "mutex.h"
 
+// Only Linux promises that private anonymous pages read back as zero after
+// MADV_DONTNEED, which is what lets a retained chunk be rewound without
+// touching it.
+#if defined(__linux__)
+#define ARENA_USE_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Rewinding a mapped chunk zeroes at most this many bytes at its start, which
+// the next document is about to reuse, and hands the pages after them back
+// with madvise.  A multiple of the page size.
+#define ARENA_MADVISE_MIN (1024 * 1024)
+
 CMARK_DEFINE_LOCK(arena)
 
-static struct arena_chunk {
+struct arena_chunk {
   size_t sz, used;
   uint8_t push_point;
+  uint8_t mapped;
   void *ptr;
   struct arena_chunk *prev;
-} *A = NULL;
+};
+
+struct cmark_arena {
+  // The allocator handed out for the arena, with the arena as its context.
+  cmark_mem mem;
+  struct arena_chunk *head;
+  struct arena_chunk *spare; // rewound chunks kept by CMARK_ARENA_RETAIN
+  size_t first_chunk_size;
+  size_t size;   // bytes currently held in chunks, spare ones included
+  size_t wasted; // bytes left behind by reallocations that had to move
+  size_t spare_size;
+  size_t high_water;
+  int options;
+  // Where renderers allocate their results for the nodes of a document
+  // built in this arena, or NULL if the arena is not a document's.
+  cmark_mem *output_mem;
+};
+
+static void *chunk_memory_alloc(cmark_arena *arena, size_t *sz,
+                                uint8_t *mapped) {
+  void *ptr;
+
+#ifdef ARENA_USE_MMAP
+  if (arena->options & CMARK_ARENA_MMAP) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    *sz = (*sz + page - 1) & ~(page - 1);
+    ptr = mmap(NULL, *sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+               -1, 0);
+    if (ptr == MAP_FAILED)
+      abort();
+    *mapped = 1;
+    return ptr;
+  }
+#else
+  (void) arena;
+#endif
+
+  ptr = calloc(1, *sz);
+  if (!ptr)
+    abort();
+  *mapped = 0;
+  return ptr;
+}
+
+static void chunk_memory_free(struct arena_chunk *c) {
+#ifdef ARENA_USE_MMAP
+  if (c->mapped) {
+    munmap(c->ptr, c->sz);
+    return;
+  }
+#endif
+  free(c->ptr);
+}
+
+// Zeroes the used part of a chunk so that it can be handed out again.
+static void chunk_memory_rewind(struct arena_chunk *c) {
+#ifdef ARENA_USE_MMAP
+  if (c->mapped && c->used > ARENA_MADVISE_MIN) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    memset(c->ptr, 0, ARENA_MADVISE_MIN);
+    madvise((uint8_t *) c->ptr + ARENA_MADVISE_MIN,
+            ((c->used + page - 1) & ~(page - 1)) - ARENA_MADVISE_MIN,
+            MADV_DONTNEED);
+    return;
+  }
+#endif
+  memset(c->ptr, 0, c->used);
+}
+
+static struct arena_chunk *alloc_arena_chunk(cmark_arena *arena, size_t sz,
+                                             struct arena_chunk *prev) {
+  struct arena_chunk *c, **link;
+
+  // A spare chunk that is large enough is reused as is.
+  for (link = &arena->spare; *link; link = &(*link)->prev) {
+    if ((*link)->sz >= sz) {
+      c = *link;
+      *link = c->prev;
+      arena->spare_size -= c->sz;
+      c->prev = prev;
+      return c;
+    }
+  }
 
-static struct arena_chunk *alloc_arena_chunk(size_t sz, struct arena_chunk *prev) {
-  struct arena_chunk *c = (struct arena_chunk *)calloc(1, sizeof(*c));
+  c = (struct arena_chunk *)calloc(1, sizeof(*c));
   if (!c)
     abort();
+  c->ptr = chunk_memory_alloc(arena, &sz, &c->mapped);
   c->sz = sz;
-  c->ptr = calloc(1, sz);
-  if (!c->ptr)
-    abort();
   c->prev = prev;
+  arena->size += sz;
   return c;
 }
 
-void cmark_arena_push(void) {
-  CMARK_INITIALIZE_AND_LOCK(arena);
-  if (A) {
-    A->push_point = 1;
-    A = alloc_arena_chunk(10240, A);
-  }
-  CMARK_UNLOCK(arena);
+static void free_arena_chunk(cmark_arena *arena, struct arena_chunk *c) {
+  arena->size -= c->sz;
+  chunk_memory_free(c);
+  free(c);
 }
 
-int cmark_arena_pop(void) {
-  int ret = 1;
-  CMARK_INITIALIZE_AND_LOCK(arena);
-  if (!A)
-    ret = 0;
-  else {
-    while (A && !A->push_point) {
-      free(A->ptr);
-      struct arena_chunk *n = A->prev;
-      free(A);
-      A = n;
-    }
-    if (A)
-      A->push_point = 0;
+// Keeps 'c' for reuse if the arena retains chunks and has room under its
+// high-water mark, and frees it otherwise.
+static void release_arena_chunk(cmark_arena *arena, struct arena_chunk *c) {
+  if ((arena->options & CMARK_ARENA_RETAIN) &&
+      arena->spare_size + c->sz <= arena->high_water) {
+    chunk_memory_rewind(c);
+    c->used = 0;
+    c->push_point = 0;
+    c->prev = arena->spare;
+    arena->spare = c;
+    arena->spare_size += c->sz;
+  } else {
+    free_arena_chunk(arena, c);
   }
-  CMARK_UNLOCK(arena);
-  return ret;
 }
 
-static void init_arena(void) {
-  CMARK_INITIALIZE_AND_LOCK(arena);
-  A = alloc_arena_chunk(4 * 1048576, NULL);
-  CMARK_UNLOCK(arena);
+static void free_spare_chunks(cmark_arena *arena) {
+  while (arena->spare) {
+    struct arena_chunk *n = arena->spare->prev;
+    free_arena_chunk(arena, arena->spare);
+    arena->spare = n;
+  }
+  arena->spare_size = 0;
 }
 
-void cmark_arena_reset(void) {
-  CMARK_INITIALIZE_AND_LOCK(arena);
-  while (A) {
-    free(A->ptr);
-    struct arena_chunk *n = A->prev;
-    free(A);
-    A = n;
+// The operations below work on a single arena and do no locking of their
+// own; the process-global arena wraps them in the 'arena' lock.
+
+static void arena_push(cmark_arena *arena) {
+  if (arena->head) {
+    arena->head->push_point = 1;
+    arena->head = alloc_arena_chunk(arena, 10240, arena->head);
   }
-  CMARK_UNLOCK(arena);
 }
 
-static void *arena_calloc(size_t nmem, size_t size) {
-  if (!A)
-    init_arena();
+static int arena_pop(cmark_arena *arena) {
+  if (!arena->head)
+    return 0;
+
+  while (arena->head && !arena->head->push_point) {
+    struct arena_chunk *n = arena->head->prev;
+    release_arena_chunk(arena, arena->head);
+    arena->head = n;
+  }
+  if (arena->head)
+    arena->head->push_point = 0;
+  return 1;
+}
 
-  size_t sz = nmem * size + sizeof(size_t);
+static void arena_clear(cmark_arena *arena) {
+  while (arena->head) {
+    struct arena_chunk *n = arena->head->prev;
+    release_arena_chunk(arena, arena->head);
+    arena->head = n;
+  }
+  arena->wasted = 0;
+}
 
-  // Round allocation sizes to largest integer size to
-  // ensure returned memory is correctly aligned
+// Round allocation sizes to largest integer size to
+// ensure returned memory is correctly aligned
+static size_t block_size(size_t size) {
   const size_t align = sizeof(size_t) - 1;
-  sz = (sz + align) & ~align;
-
-  CMARK_INITIALIZE_AND_LOCK(arena);
+  return (size + sizeof(size_t) + align) & ~align;
+}
 
+static void *arena_alloc(cmark_arena *arena, size_t nmem, size_t size) {
   struct arena_chunk *chunk;
-  if (sz > A->sz) {
-    A->prev = chunk = alloc_arena_chunk(sz, A->prev);
-  } else if (sz > A->sz - A->used) {
-    A = chunk = alloc_arena_chunk(A->sz + A->sz / 2, A);
+  size_t sz = block_size(nmem * size);
+
+  if (!arena->head)
+    arena->head = alloc_arena_chunk(arena, arena->first_chunk_size, NULL);
+
+  if (sz > arena->head->sz) {
+    // Oversized blocks get a chunk of their own, kept just behind the head
+    // so that arena_realloc can find it again.
+    arena->head->prev = chunk =
+        alloc_arena_chunk(arena, sz, arena->head->prev);
+  } else if (sz > arena->head->sz - arena->head->used) {
+    arena->head = chunk = alloc_arena_chunk(
+        arena, arena->head->sz + arena->head->sz / 2, arena->head);
   } else {
-    chunk = A;
+    chunk = arena->head;
   }
   void *ptr = (uint8_t *) chunk->ptr + chunk->used;
   chunk->used += sz;
   *((size_t *) ptr) = sz - sizeof(size_t);
-  
-  CMARK_UNLOCK(arena);
 
   return (uint8_t *) ptr + sizeof(size_t);
 }
 
-static void *arena_realloc(void *ptr, size_t size) {
-  if (!A)
-    init_arena();
+static void *arena_realloc(cmark_arena *arena, void *ptr, size_t size) {
+  struct arena_chunk *chunk;
+  size_t old_size, sz;
+  uint8_t *block;
+  void *new_ptr;
+
+  if (!ptr)
+    return arena_alloc(arena, 1, size);
+
+  old_size = ((size_t *) ptr)[-1];
+  if (size <= old_size)
+    return ptr;
+
+  sz = block_size(size);
+  block = (uint8_t *) ptr - sizeof(size_t);
+  chunk = arena->head;
+
+  // The most recent allocation in the head chunk sits at the bump pointer
+  // and can simply grow into the free space after it.
+  if (block + sizeof(size_t) + old_size == (uint8_t *) chunk->ptr + chunk->used &&
+      sz - sizeof(size_t) - old_size <= chunk->sz - chunk->used) {
+    chunk->used += sz - sizeof(size_t) - old_size;
+    ((size_t *) ptr)[-1] = sz - sizeof(size_t);
+    return ptr;
+  }
+
+  // A block with a chunk to itself can grow to the end of the chunk, and
+  // beyond that be resized along with it.
+  chunk = arena->head->prev;
+  if (chunk && block == chunk->ptr &&
+      block + sizeof(size_t) + old_size == (uint8_t *) chunk->ptr + chunk->used) {
+    if (sz > chunk->sz) {
+      struct arena_chunk grown;
+      grown.sz = sz;
+      grown.mapped = chunk->mapped;
+#ifdef ARENA_USE_MMAP
+      if (chunk->mapped) {
+        grown.ptr = chunk_memory_alloc(arena, &grown.sz, &grown.mapped);
+        memcpy(grown.ptr, chunk->ptr, chunk->used);
+        chunk_memory_free(chunk);
+      } else
+#endif
+      {
+        grown.ptr = realloc(chunk->ptr, sz);
+        if (!grown.ptr)
+          abort();
+      }
+      arena->size += grown.sz - chunk->sz;
+      chunk->ptr = grown.ptr;
+      chunk->sz = grown.sz;
+      chunk->mapped = grown.mapped;
+    }
+    block = (uint8_t *) chunk->ptr;
+    chunk->used = sz;
+    *((size_t *) block) = sz - sizeof(size_t);
+    return block + sizeof(size_t);
+  }
 
-  void *new_ptr = arena_calloc(1, size);
-  if (ptr)
-    memcpy(new_ptr, ptr, ((size_t *) ptr)[-1]);
+  new_ptr = arena_alloc(arena, 1, size);
+  memcpy(new_ptr, ptr, old_size);
+  arena->wasted += old_size;
   return new_ptr;
 }
 
@@ -116,8 +291,154 @@ static void arena_free(void *ptr) {
   /* no-op */
 }
 
-cmark_mem CMARK_ARENA_MEM_ALLOCATOR = {arena_calloc, arena_realloc, arena_free};
+// The process-global arena, shared by every user of
+// cmark_get_arena_mem_allocator().
+
+static cmark_arena A = {{NULL, NULL, NULL, NULL, NULL, NULL, NULL},
+                        NULL, NULL, 4 * 1048576, 0, 0, 0, 0, 0, NULL};
+
+void cmark_arena_push(void) {
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  arena_push(&A);
+  CMARK_UNLOCK(arena);
+}
+
+int cmark_arena_pop(void) {
+  int ret;
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  ret = arena_pop(&A);
+  CMARK_UNLOCK(arena);
+  return ret;
+}
+
+void cmark_arena_reset(void) {
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  arena_clear(&A);
+  CMARK_UNLOCK(arena);
+}
+
+void cmark_arena_set_global_options(int options, size_t high_water) {
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  free_spare_chunks(&A);
+  A.options = options;
+  A.high_water = high_water;
+  CMARK_UNLOCK(arena);
+}
+
+static void *global_arena_calloc(size_t nmem, size_t size) {
+  void *ptr;
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  ptr = arena_alloc(&A, nmem, size);
+  CMARK_UNLOCK(arena);
+  return ptr;
+}
+
+static void *global_arena_realloc(void *ptr, size_t size) {
+  void *new_ptr;
+  CMARK_INITIALIZE_AND_LOCK(arena);
+  new_ptr = arena_realloc(&A, ptr, size);
+  CMARK_UNLOCK(arena);
+  return new_ptr;
+}
+
+cmark_mem CMARK_ARENA_MEM_ALLOCATOR = {global_arena_calloc, global_arena_realloc,
+                                       arena_free, NULL, NULL, NULL, NULL};
 
 cmark_mem *cmark_get_arena_mem_allocator(void) {
   return &CMARK_ARENA_MEM_ALLOCATOR;
 }
+
+// Arena objects.  Each one carries its own allocator, whose context
+// functions find the arena through 'ctx'.
+
+static void *arena_ctx_calloc(void *ctx, size_t nmem, size_t size) {
+  return arena_alloc((cmark_arena *)ctx, nmem, size);
+}
+
+static void *arena_ctx_realloc(void *ctx, void *ptr, size_t size) {
+  return arena_realloc((cmark_arena *)ctx, ptr, size);
+}
+
+static void arena_ctx_free(void *ctx, void *ptr) {
+  (void) ctx;
+  (void) ptr;
+  /* no-op */
+}
+
+cmark_arena *cmark_arena_new(void) {
+  return cmark_arena_new_with_options(0, 0);
+}
+
+cmark_arena *cmark_arena_new_with_options(int options, size_t high_water) {
+  cmark_arena *arena = (cmark_arena *)calloc(1, sizeof(*arena));
+  if (!arena)
+    abort();
+  // Code that still frees through 'free' directly does no harm.
+  arena->mem.free = arena_free;
+  arena->mem.ctx_calloc = arena_ctx_calloc;
+  arena->mem.ctx_realloc = arena_ctx_realloc;
+  arena->mem.ctx_free = arena_ctx_free;
+  arena->mem.ctx = arena;
+  arena->first_chunk_size = 65536;
+  arena->options = options;
+  arena->high_water = high_water;
+  return arena;
+}
+
+cmark_mem *cmark_arena_get_mem(cmark_arena *arena) {
+  return &arena->mem;
+}
+
+void cmark_arena_clear(cmark_arena *arena) {
+  arena_clear(arena);
+}
+
+size_t cmark_arena_size(cmark_arena *arena) {
+  return arena->size;
+}
+
+size_t cmark_arena_wasted(cmark_arena *arena) {
+  return arena->wasted;
+}
+
+void cmark_arena_free(cmark_arena *arena) {
+  if (arena == NULL)
+    return;
+
+  arena_clear(arena);
+  free_spare_chunks(arena);
+  free(arena);
+}
+
+void cmark_arena_set_output_mem(cmark_arena *arena, cmark_mem *mem) {
+  arena->output_mem = mem;
+}
+
+cmark_mem *cmark_arena_output_mem(cmark_arena *arena) {
+  return arena->output_mem;
+}
+
+cmark_arena *cmark_arena_from_mem(cmark_mem *mem) {
+  if (mem->ctx_calloc == arena_ctx_calloc)
+    return (cmark_arena *)mem->ctx;
+  return NULL;
+}
+
+void cmark_arena_push_mem(cmark_mem *mem) {
+  cmark_arena *arena = cmark_arena_from_mem(mem);
+
+  if (arena)
+    arena_push(arena);
+  else if (mem == &CMARK_ARENA_MEM_ALLOCATOR)
+    cmark_arena_push();
+}
+
+int cmark_arena_pop_mem(cmark_mem *mem) {
+  cmark_arena *arena = cmark_arena_from_mem(mem);
+
+  if (arena)
+    return arena_pop(arena);
+  if (mem == &CMARK_ARENA_MEM_ALLOCATOR)
+    return cmark_arena_pop();
+  return 0;
+}
@@ -23,6 +23,8 @@
 #include "houdini.h"
 #include "buffer.h"
 #include "footnotes.h"
+#include "simd.h"
+#include "mutex.h"
 
 #define CODE_INDENT 4
 #define TAB_STOP 4
@@ -39,7 +41,11 @@
 #define MIN(x, y) ((x < y) ? x : y)
 #endif
 
-#define peek_at(i, n) (i)->data[n]
+// Lines parsed in place are not NUL-terminated, so reading at or past the
+// end of the line gives 0, as the scanners do.
+static inline unsigned char peek_at(const cmark_chunk *input, bufsize_t n) {
+  return n < input->len ? input->data[n] : 0;
+}
 
 static bool S_last_line_blank(const cmark_node *node) {
   return (node->flags & CMARK_NODE__LAST_LINE_BLANK) != 0;
@@ -73,19 +79,22 @@ static inline bool S_is_space_or_tab(char c) {
 }
 
 static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
-                          size_t len, bool eof);
+                          size_t len, bool eof, bool in_place);
 
 static void S_process_line(cmark_parser *parser, const unsigned char *buffer,
                            bufsize_t bytes, bool ensureEndsInNewline);
 
-static cmark_node *make_block(cmark_mem *mem, cmark_node_type tag,
+static void S_process_line_in_place(cmark_parser *parser,
+                                    const unsigned char *buffer,
+                                    bufsize_t bytes);
+
+static cmark_node *make_block(cmark_parser *parser, cmark_node_type tag,
                               int start_line, int start_column) {
   cmark_node *e;
 
-  e = (cmark_node *)mem->calloc(1, sizeof(*e));
-  cmark_strbuf_init(mem, &e->content, 32);
+  e = cmark_node_slab_alloc(&parser->node_slab, parser->mem);
   e->type = (uint16_t)tag;
-  e->flags = CMARK_NODE__OPEN;
+  e->flags |= CMARK_NODE__OPEN;
   e->start_line = start_line;
   e->start_column = start_column;
   e->end_line = start_line;
@@ -94,57 +103,117 @@ static cmark_node *make_block(cmark_mem *mem, cmark_node_type tag,
 }
 
 // Create a root document node.
-static cmark_node *make_document(cmark_mem *mem) {
-  cmark_node *e = make_block(mem, CMARK_NODE_DOCUMENT, 1, 1);
+static cmark_node *make_document(cmark_parser *parser) {
+  cmark_node *e = make_block(parser, CMARK_NODE_DOCUMENT, 1, 1);
   return e;
 }
 
 int cmark_parser_attach_syntax_extension(cmark_parser *parser,
                                          cmark_syntax_extension *extension) {
-  parser->syntax_extensions = cmark_llist_append(parser->mem, parser->syntax_extensions, extension);
+  parser->syntax_extensions = cmark_llist_append(parser->base_mem, parser->syntax_extensions, extension);
   if (extension->match_inline || extension->insert_inline_from_delim) {
     if (!parser->inline_syntax_extensions) {
       // if we're loading an inline extension into this parser for the first time,
       // allocate new buffers for the inline parser character arrays
-      parser->skip_chars = (int8_t *)parser->mem->calloc(sizeof(int8_t), 256);
+      parser->skip_chars = (int8_t *)cmark_mem_calloc(parser->base_mem, sizeof(int8_t), 256);
       cmark_set_default_skip_chars(&parser->skip_chars, true);
 
-      parser->special_chars = (int8_t *)parser->mem->calloc(sizeof(int8_t), 256);
+      parser->special_chars = (int8_t *)cmark_mem_calloc(parser->base_mem, sizeof(int8_t), 256);
       cmark_set_default_special_chars(&parser->special_chars, true);
+      parser->special_charset_valid = false;
     }
 
     parser->inline_syntax_extensions = cmark_llist_append(
-      parser->mem, parser->inline_syntax_extensions, extension);
+      parser->base_mem, parser->inline_syntax_extensions, extension);
   }
 
   return 1;
 }
 
+static void stream_free_held(cmark_parser *parser);
+
 static void cmark_parser_dispose(cmark_parser *parser) {
+  if (parser->doc_arena) {
+    // The reference map, node slab, inline pools and line buffers all live
+    // in the document's arena.  Forget them, and free the arena along with
+    // the document unless cmark_parser_finish has handed that out.
+    cmark_node *root = parser->root;
+
+    parser->doc_arena = NULL;
+    parser->root = NULL;
+    parser->refmap = NULL;
+    parser->stream_footnotes = NULL;
+    parser->node_slab = NULL;
+    memset(&parser->delimiter_pool, 0, sizeof(cmark_pool));
+    memset(&parser->bracket_pool, 0, sizeof(cmark_pool));
+    cmark_strbuf_init(parser->base_mem, &parser->curline, 0);
+    cmark_strbuf_init(parser->base_mem, &parser->linebuf, 0);
+    if (root)
+      cmark_node_free(root);
+    return;
+  }
+
+  // The footnote definitions kept while streaming may still be in blocks
+  // held back.
+  if (parser->stream_footnotes)
+    cmark_unlink_footnotes_map(parser->stream_footnotes);
+
+  if (parser->stream_held)
+    stream_free_held(parser);
+
   if (parser->root)
     cmark_node_free(parser->root);
 
   if (parser->refmap)
     cmark_map_free(parser->refmap);
+
+  if (parser->stream_footnotes)
+    cmark_map_free(parser->stream_footnotes);
 }
 
 static void cmark_parser_reset(cmark_parser *parser) {
   cmark_llist *saved_exts = parser->syntax_extensions;
   cmark_llist *saved_inline_exts = parser->inline_syntax_extensions;
   int saved_options = parser->options;
-  cmark_mem *saved_mem = parser->mem;
+  cmark_mem *saved_mem = parser->base_mem;
   int8_t *saved_specials = parser->special_chars;
   int8_t *saved_skips = parser->skip_chars;
+  cmark_stream_block_func saved_stream_func = parser->stream_block_func;
+  void *saved_stream_data = parser->stream_block_data;
+  int saved_threads = parser->threads;
+  bool had_doc_arena = parser->doc_arena != NULL;
 
   cmark_parser_dispose(parser);
 
+  // The nodes of a finished document may be freed on another thread, so
+  // its slabs are left to them rather than shared with the next document.
+  cmark_node_slab_release(&parser->node_slab);
+
+  cmark_pool saved_delimiter_pool = parser->delimiter_pool;
+  cmark_pool saved_bracket_pool = parser->bracket_pool;
+
+  cmark_mem_free(saved_mem, parser->held_input);
   memset(parser, 0, sizeof(cmark_parser));
-  parser->mem = saved_mem;
+  parser->mem = parser->base_mem = saved_mem;
+  if (saved_options & CMARK_OPT_DOCUMENT_ARENA) {
+    parser->doc_arena = cmark_arena_new();
+    parser->mem = cmark_arena_get_mem(parser->doc_arena);
+    cmark_arena_set_output_mem(parser->doc_arena, saved_mem);
+  }
+  if (parser->doc_arena || had_doc_arena) {
+    // The pools come from 'mem'; start over when it changes.
+    cmark_inlines_init_pools(parser);
+  } else {
+    parser->delimiter_pool = saved_delimiter_pool;
+    parser->bracket_pool = saved_bracket_pool;
+  }
 
   cmark_strbuf_init(parser->mem, &parser->curline, 256);
   cmark_strbuf_init(parser->mem, &parser->linebuf, 0);
 
-  cmark_node *document = make_document(parser->mem);
+  cmark_node *document = make_document(parser);
+  if (parser->doc_arena)
+    document->flags |= CMARK_NODE__ARENA_ROOT;
 
   parser->refmap = cmark_reference_map_new(parser->mem);
   parser->root = document;
@@ -156,38 +225,51 @@ static void cmark_parser_reset(cmark_parser *parser) {
 
   parser->special_chars = saved_specials;
   parser->skip_chars = saved_skips;
+  parser->stream_block_func = saved_stream_func;
+  parser->stream_block_data = saved_stream_data;
+  parser->threads = saved_threads;
 }
 
 cmark_parser *cmark_parser_new_with_mem(int options, cmark_mem *mem) {
-  cmark_parser *parser = (cmark_parser *)mem->calloc(1, sizeof(cmark_parser));
-  parser->mem = mem;
+  cmark_parser *parser =
+      (cmark_parser *)cmark_mem_calloc(mem, 1, sizeof(cmark_parser));
+  parser->mem = parser->base_mem = mem;
   parser->options = options;
   cmark_set_default_skip_chars(&parser->skip_chars, false);
   cmark_set_default_special_chars(&parser->special_chars, false);
+  cmark_inlines_init_pools(parser);
   cmark_parser_reset(parser);
   return parser;
 }
 
+cmark_parser *cmark_parser_new_with_arena(int options, cmark_arena *arena) {
+  return cmark_parser_new_with_mem(options, cmark_arena_get_mem(arena));
+}
+
 cmark_parser *cmark_parser_new(int options) {
   extern cmark_mem CMARK_DEFAULT_MEM_ALLOCATOR;
   return cmark_parser_new_with_mem(options, &CMARK_DEFAULT_MEM_ALLOCATOR);
 }
 
 void cmark_parser_free(cmark_parser *parser) {
-  cmark_mem *mem = parser->mem;
+  cmark_mem *mem = parser->base_mem;
 
   // If any inline syntax extensions were added, free the memory allocated for the special-chars arrays
   if (parser->inline_syntax_extensions) {
-    mem->free(parser->special_chars);
-    mem->free(parser->skip_chars);
+    cmark_mem_free(mem, parser->special_chars);
+    cmark_mem_free(mem, parser->skip_chars);
   }
 
   cmark_parser_dispose(parser);
+  cmark_node_slab_release(&parser->node_slab);
+  cmark_pool_release(&parser->delimiter_pool);
+  cmark_pool_release(&parser->bracket_pool);
   cmark_strbuf_free(&parser->curline);
   cmark_strbuf_free(&parser->linebuf);
-  cmark_llist_free(parser->mem, parser->syntax_extensions);
-  cmark_llist_free(parser->mem, parser->inline_syntax_extensions);
-  mem->free(parser);
+  cmark_mem_free(mem, parser->held_input);
+  cmark_llist_free(mem, parser->syntax_extensions);
+  cmark_llist_free(mem, parser->inline_syntax_extensions);
+  cmark_mem_free(mem, parser);
 }
 
 static cmark_node *finalize(cmark_parser *parser, cmark_node *b);
@@ -237,10 +319,10 @@ static void add_line(cmark_node *node, cmark_chunk *ch, cmark_parser *parser) {
     // add space characters:
     chars_to_tab = TAB_STOP - (parser->column % TAB_STOP);
     for (i = 0; i < chars_to_tab; i++) {
-      cmark_strbuf_putc(&node->content, ' ');
+      cmark_strbuf_putc(cmark_node_content(node), ' ');
     }
   }
-  cmark_strbuf_put(&node->content, ch->data + parser->offset,
+  cmark_strbuf_put(cmark_node_content(node), ch->data + parser->offset,
                    ch->len - parser->offset);
 }
 
@@ -291,7 +373,7 @@ static bool resolve_reference_link_definitions(
 		cmark_parser *parser,
                 cmark_node *b) {
   bufsize_t pos;
-  cmark_strbuf *node_content = &b->content;
+  cmark_strbuf *node_content = cmark_node_content(b);
   cmark_chunk chunk = {node_content->ptr, node_content->size, 0};
   while ((chunk.len && chunk.data[0] == '[' &&
             (pos = cmark_parse_reference_inline(parser->mem, &chunk, parser->refmap))) ||
@@ -302,7 +384,7 @@ static bool resolve_reference_link_definitions(
     chunk.len -= pos;
   }
   cmark_strbuf_drop(node_content, (node_content->size - chunk.len));
-  return !is_blank(&b->content, 0);
+  return !is_blank(node_content, 0);
 }
 
 static cmark_node *finalize(cmark_parser *parser, cmark_node *b) {
@@ -317,7 +399,7 @@ static cmark_node *finalize(cmark_parser *parser, cmark_node *b) {
          CMARK_NODE__OPEN); // shouldn't call finalize on closed blocks
   b->flags &= ~CMARK_NODE__OPEN;
 
-  if (parser->curline.size == 0) {
+  if (parser->line.len == 0) {
     // end of input - line number has not been incremented
     b->end_line = parser->line_number;
     b->end_column = parser->last_line_length;
@@ -326,17 +408,17 @@ static cmark_node *finalize(cmark_parser *parser, cmark_node *b) {
              (S_type(b) == CMARK_NODE_HEADING && b->as.heading.setext) ||
              (parser->line_number - 1 < b->end_line)) {
     b->end_line = parser->line_number;
-    b->end_column = parser->curline.size;
-    if (b->end_column && parser->curline.ptr[b->end_column - 1] == '\n')
+    b->end_column = parser->line.len;
+    if (b->end_column && parser->line.data[b->end_column - 1] == '\n')
       b->end_column -= 1;
-    if (b->end_column && parser->curline.ptr[b->end_column - 1] == '\r')
+    if (b->end_column && parser->line.data[b->end_column - 1] == '\r')
       b->end_column -= 1;
   } else {
     b->end_line = parser->line_number - 1;
     b->end_column = parser->last_line_length;
   }
 
-  cmark_strbuf *node_content = &b->content;
+  cmark_strbuf *node_content = cmark_node_content(b);
 
   switch (S_type(b)) {
   case CMARK_NODE_PARAGRAPH:
@@ -428,7 +510,7 @@ static cmark_node *add_child(cmark_parser *parser, cmark_node *parent,
   }
 
   cmark_node *child =
-      make_block(parser->mem, block_type, parser->line_number, start_column);
+      make_block(parser, block_type, parser->line_number, start_column);
   child->parent = parent;
 
   if (parent->last_child) {
@@ -460,9 +542,9 @@ void cmark_manage_extensions_special_characters(cmark_parser *parser, int add) {
 
 // Walk through node and all children, recursively, parsing
 // string content into inline content where appropriate.
-static void process_inlines(cmark_parser *parser,
+static void process_inlines(cmark_parser *parser, cmark_node *root,
                             cmark_map *refmap, int options) {
-  cmark_iter *iter = cmark_iter_new(parser->root);
+  cmark_iter *iter = cmark_iter_new(root);
   cmark_node *cur;
   cmark_event_type ev_type;
 
@@ -473,6 +555,9 @@ static void process_inlines(cmark_parser *parser,
     if (ev_type == CMARK_EVENT_ENTER) {
       if (contains_inlines(cur)) {
         cmark_parse_inlines(parser, cur, refmap, options);
+        // Merge adjacent text nodes while their slab is still the one new
+        // nodes come from, so that the freed slots get reused.
+        cmark_consolidate_text_nodes(cur);
       }
     }
   }
@@ -482,12 +567,248 @@ static void process_inlines(cmark_parser *parser,
   cmark_iter_free(iter);
 }
 
+#ifdef CMARK_HAVE_THREADS
+
+// Threads take the inline containers INLINE_BATCH at a time; documents with
+// fewer than PARALLEL_INLINES_MIN of them are not worth starting threads for.
+#define INLINE_BATCH 64
+#define PARALLEL_INLINES_MIN (4 * INLINE_BATCH)
+
+// Recorded for a block whose inline parse had a link refused for going over
+// the reference expansion limit.
+#define REF_SIZE_EXCEEDED ((size_t)-1)
+
+typedef struct {
+  cmark_parser *parser;
+  cmark_map *refmap;
+  int options;
+  cmark_node **blocks;
+  size_t num_blocks;
+  // How much each block added to refmap->ref_size.
+  size_t *ref_sizes;
+  size_t next_block;
+  cmark_mutex lock;
+} inline_work;
+
+// Parses the inlines of batches of blocks until none are left.  Each thread
+// works on copies of the parser and reference map with their own node slab,
+// stack pools, normalization buffer and expansion count, so the only
+// things shared are read-only tables and the allocator.
+static void parse_inline_batches(inline_work *work) {
+  cmark_parser parser = *work->parser;
+  cmark_map refmap = *work->refmap;
+  size_t i, end, before;
+
+  parser.node_slab = NULL;
+  cmark_inlines_init_pools(&parser);
+  cmark_strbuf_init(refmap.mem, &refmap.scratch, 0);
+
+  for (;;) {
+    CMARK_MUTEX_LOCK(work->lock);
+    i = work->next_block;
+    if (i < work->num_blocks)
+      work->next_block += INLINE_BATCH;
+    CMARK_MUTEX_UNLOCK(work->lock);
+    if (i >= work->num_blocks)
+      break;
+
+    end = i + INLINE_BATCH < work->num_blocks ? i + INLINE_BATCH
+                                              : work->num_blocks;
+    for (; i < end; ++i) {
+      before = refmap.ref_size;
+      refmap.ref_size_exceeded = false;
+      cmark_parse_inlines(&parser, work->blocks[i], &refmap, work->options);
+      cmark_consolidate_text_nodes(work->blocks[i]);
+      work->ref_sizes[i] = refmap.ref_size_exceeded
+                               ? REF_SIZE_EXCEEDED
+                               : refmap.ref_size - before;
+    }
+  }
+
+  cmark_node_slab_release(&parser.node_slab);
+  cmark_pool_release(&parser.delimiter_pool);
+  cmark_pool_release(&parser.bracket_pool);
+  cmark_strbuf_free(&refmap.scratch);
+}
+
+CMARK_THREAD_FUNC(inline_worker, arg) {
+  parse_inline_batches((inline_work *)arg);
+  CMARK_THREAD_RETURN;
+}
+
+// As process_inlines on the whole document, but on up to parser->threads
+// threads.  The result is the same as parsing in document order: each
+// thread counts reference expansion against the limit on its own, and if
+// the blocks' counts added up in order go over it, or a thread refused a
+// link, the blocks from the first one affected onwards are parsed again
+// in order against the real count.
+static void process_inlines_parallel(cmark_parser *parser, cmark_map *refmap,
+                                     int options) {
+  cmark_mem *mem = parser->mem;
+  cmark_iter *iter = cmark_iter_new(parser->root);
+  cmark_thread *threads = NULL;
+  bool *started = NULL;
+  inline_work work;
+  size_t capacity = 0, num_threads, i, ref_size;
+  cmark_event_type ev_type;
+  cmark_node *cur;
+
+  memset(&work, 0, sizeof(work));
+  work.parser = parser;
+  work.refmap = refmap;
+  work.options = options;
+
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    if (ev_type == CMARK_EVENT_ENTER && contains_inlines(cur)) {
+      if (work.num_blocks == capacity) {
+        capacity = capacity ? capacity * 2 : 256;
+        work.blocks = (cmark_node **)cmark_mem_realloc(
+            mem, work.blocks, capacity * sizeof(cmark_node *));
+      }
+      work.blocks[work.num_blocks++] = cur;
+    }
+  }
+  cmark_iter_free(iter);
+
+  cmark_manage_extensions_special_characters(parser, true);
+
+  if (work.num_blocks < PARALLEL_INLINES_MIN) {
+    for (i = 0; i < work.num_blocks; ++i) {
+      cmark_parse_inlines(parser, work.blocks[i], refmap, options);
+      cmark_consolidate_text_nodes(work.blocks[i]);
+    }
+    cmark_manage_extensions_special_characters(parser, false);
+    cmark_mem_free(mem, work.blocks);
+    return;
+  }
+
+  cmark_inlines_prepare(parser, options);
+  work.ref_sizes =
+      (size_t *)cmark_mem_calloc(mem, work.num_blocks, sizeof(size_t));
+  CMARK_MUTEX_INIT(work.lock);
+
+  num_threads = (work.num_blocks + INLINE_BATCH - 1) / INLINE_BATCH;
+  if (num_threads > (size_t)parser->threads)
+    num_threads = (size_t)parser->threads;
+  // This thread is one of them.
+  threads =
+      (cmark_thread *)cmark_mem_calloc(mem, num_threads, sizeof(cmark_thread));
+  started = (bool *)cmark_mem_calloc(mem, num_threads, sizeof(bool));
+  for (i = 1; i < num_threads; ++i)
+    started[i] = CMARK_THREAD_START(threads[i], inline_worker, &work);
+  parse_inline_batches(&work);
+  for (i = 1; i < num_threads; ++i)
+    if (started[i])
+      CMARK_THREAD_JOIN(threads[i]);
+
+  ref_size = refmap->ref_size;
+  for (i = 0; i < work.num_blocks; ++i) {
+    if (work.ref_sizes[i] == REF_SIZE_EXCEEDED ||
+        work.ref_sizes[i] > refmap->max_ref_size - ref_size)
+      break;
+    ref_size += work.ref_sizes[i];
+  }
+  refmap->ref_size = ref_size;
+  for (; i < work.num_blocks; ++i) {
+    cur = work.blocks[i];
+    while (cur->first_child)
+      cmark_node_free(cur->first_child);
+    cmark_parse_inlines(parser, cur, refmap, options);
+    cmark_consolidate_text_nodes(cur);
+  }
+
+  cmark_manage_extensions_special_characters(parser, false);
+
+  CMARK_MUTEX_DESTROY(work.lock);
+  cmark_mem_free(mem, started);
+  cmark_mem_free(mem, threads);
+  cmark_mem_free(mem, work.ref_sizes);
+  cmark_mem_free(mem, work.blocks);
+}
+
+#endif
+
 static int sort_footnote_by_ix(const void *_a, const void *_b) {
   cmark_footnote *a = *(cmark_footnote **)_a;
   cmark_footnote *b = *(cmark_footnote **)_b;
   return (int)a->ix - (int)b->ix;
 }
 
+// Points the footnote reference 'cur' at its definition and replaces its
+// label with the definition's number, numbering the definition from '*ix'
+// when it is referenced for the first time.
+static void number_footnote_reference(cmark_parser *parser, cmark_node *cur,
+                                      cmark_footnote *footnote,
+                                      unsigned int *ix) {
+  if (!footnote->ix)
+    footnote->ix = ++*ix;
+
+  // store a reference to this footnote reference's footnote definition
+  // this is used by renderers when generating label ids
+  cmark_node_cold_fields(cur)->parent_footnote_def = footnote->node;
+
+  // keep track of a) count of how many times this footnote def has been
+  // referenced, and b) which reference index this footnote ref is at.
+  // this is used by renderers when generating links and backreferences.
+  cur->cold->footnote.ref_ix =
+      ++cmark_node_cold_fields(footnote->node)->footnote.def_count;
+
+  char n[32];
+  snprintf(n, sizeof(n), "%d", footnote->ix);
+  cmark_chunk_free(parser->mem, &cur->as.literal);
+  cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
+  cmark_strbuf_puts(&buf, n);
+
+  cur->as.literal = cmark_chunk_buf_detach(&buf);
+}
+
+// Replaces a reference to a footnote that is not defined with its text.
+static void footnote_reference_to_text(cmark_parser *parser, cmark_node *cur) {
+  cmark_node *text = cmark_node_slab_alloc(&parser->node_slab, parser->mem);
+  text->type = (uint16_t) CMARK_NODE_TEXT;
+
+  cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
+  cmark_strbuf_puts(&buf, "[^");
+  cmark_strbuf_put(&buf, cur->as.literal.data, cur->as.literal.len);
+  cmark_strbuf_putc(&buf, ']');
+
+  text->as.literal = cmark_chunk_buf_detach(&buf);
+  cmark_node_insert_after(cur, text);
+  cmark_node_free(cur);
+}
+
+// Writes out the referenced footnotes at the bottom of the document in
+// index order, and frees 'map' along with the others.
+static void append_footnotes(cmark_parser *parser, cmark_map *map) {
+  if (map->num_labels) {
+    cmark_map_entry **defs = (cmark_map_entry **)cmark_mem_calloc(
+        parser->mem, map->num_labels, sizeof(cmark_map_entry *));
+    size_t num_defs = 0;
+
+    for (size_t i = 0; i < map->table_size; ++i) {
+      if (map->table[i])
+        defs[num_defs++] = map->table[i];
+    }
+
+    qsort(defs, num_defs, sizeof(cmark_map_entry *), sort_footnote_by_ix);
+    for (size_t i = 0; i < num_defs; ++i) {
+      cmark_footnote *footnote = (cmark_footnote *)defs[i];
+      if (!footnote->ix) {
+        cmark_node_unlink(footnote->node);
+        continue;
+      }
+      cmark_node_append_child(parser->root, footnote->node);
+      footnote->node = NULL;
+    }
+
+    cmark_mem_free(parser->mem, defs);
+  }
+
+  cmark_unlink_footnotes_map(map);
+  cmark_map_free(map);
+}
+
 static void process_footnotes(cmark_parser *parser) {
   // * Collect definitions in a map.
   // * Iterate the references in the document in order, assigning indices to
@@ -516,59 +837,100 @@ static void process_footnotes(cmark_parser *parser) {
     if (ev_type == CMARK_EVENT_EXIT && cur->type == CMARK_NODE_FOOTNOTE_REFERENCE) {
       cmark_footnote *footnote = (cmark_footnote *)cmark_map_lookup(map, &cur->as.literal);
       if (footnote) {
-        if (!footnote->ix)
-          footnote->ix = ++ix;
+        number_footnote_reference(parser, cur, footnote, &ix);
+      } else {
+        footnote_reference_to_text(parser, cur);
+      }
+    }
+  }
 
-        // store a reference to this footnote reference's footnote definition
-        // this is used by renderers when generating label ids
-        cur->parent_footnote_def = footnote->node;
+  cmark_iter_free(iter);
+  append_footnotes(parser, map);
+}
 
-        // keep track of a) count of how many times this footnote def has been
-        // referenced, and b) which reference index this footnote ref is at.
-        // this is used by renderers when generating links and backreferences.
-        cur->footnote.ref_ix = ++footnote->node->footnote.def_count;
+// Collects the footnote definitions in a streamed block, keeping the first
+// of each label, so that the blocks after it can refer to them.
+static void stream_footnote_defs(cmark_parser *parser, cmark_node *block) {
+  cmark_map *map = parser->stream_footnotes;
+  cmark_iter *iter;
+  cmark_node *cur;
+  cmark_event_type ev_type;
 
-        char n[32];
-        snprintf(n, sizeof(n), "%d", footnote->ix);
-        cmark_chunk_free(parser->mem, &cur->as.literal);
-        cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
-        cmark_strbuf_puts(&buf, n);
+  if (map == NULL)
+    map = parser->stream_footnotes = cmark_footnote_map_new(parser->mem);
 
-        cur->as.literal = cmark_chunk_buf_detach(&buf);
-      } else {
-        cmark_node *text = (cmark_node *)parser->mem->calloc(1, sizeof(*text));
-        cmark_strbuf_init(parser->mem, &text->content, 0);
-        text->type = (uint16_t) CMARK_NODE_TEXT;
-
-        cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
-        cmark_strbuf_puts(&buf, "[^");
-        cmark_strbuf_put(&buf, cur->as.literal.data, cur->as.literal.len);
-        cmark_strbuf_putc(&buf, ']');
-
-        text->as.literal = cmark_chunk_buf_detach(&buf);
-        cmark_node_insert_after(cur, text);
-        cmark_node_free(cur);
-      }
-    }
+  iter = cmark_iter_new(block);
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    if (ev_type == CMARK_EVENT_EXIT && cur->type == CMARK_NODE_FOOTNOTE_DEFINITION &&
+        !cmark_map_lookup(map, &cur->as.literal))
+      cmark_footnote_create(map, cur);
   }
+  cmark_iter_free(iter);
+}
+
+// Returns whether every footnote a streamed block refers to is defined.
+static bool stream_footnotes_defined(cmark_parser *parser, cmark_node *block) {
+  cmark_iter *iter = cmark_iter_new(block);
+  cmark_node *cur;
+  cmark_event_type ev_type;
+  bool defined = true;
 
+  while (defined && (ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    if (ev_type == CMARK_EVENT_EXIT && cur->type == CMARK_NODE_FOOTNOTE_REFERENCE)
+      defined = cmark_map_lookup(parser->stream_footnotes, &cur->as.literal) != NULL;
+  }
   cmark_iter_free(iter);
+  return defined;
+}
 
-  if (map->sorted) {
-    qsort(map->sorted, map->size, sizeof(cmark_map_entry *), sort_footnote_by_ix);
-    for (unsigned int i = 0; i < map->size; ++i) {
-      cmark_footnote *footnote = (cmark_footnote *)map->sorted[i];
-      if (!footnote->ix) {
-        cmark_node_unlink(footnote->node);
-        continue;
+// Does for one streamed block what process_footnotes does for a document,
+// keeping the numbering from one block to the next, and moves the
+// definitions out of it.  Returns whether 'block' was one.
+static bool stream_footnotes(cmark_parser *parser, cmark_node *block) {
+  cmark_map *map = parser->stream_footnotes;
+  cmark_llist *defs = NULL, *it;
+  cmark_footnote *footnote;
+  cmark_iter *iter;
+  cmark_node *cur;
+  cmark_event_type ev_type;
+  bool taken = false;
+
+  iter = cmark_iter_new(block);
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    if (ev_type != CMARK_EVENT_EXIT)
+      continue;
+    if (cur->type == CMARK_NODE_FOOTNOTE_DEFINITION) {
+      defs = cmark_llist_append(parser->mem, defs, cur);
+    } else if (cur->type == CMARK_NODE_FOOTNOTE_REFERENCE) {
+      footnote = (cmark_footnote *)cmark_map_lookup(map, &cur->as.literal);
+      if (footnote) {
+        number_footnote_reference(parser, cur, footnote,
+                                  &parser->stream_footnote_ix);
+      } else {
+        footnote_reference_to_text(parser, cur);
       }
-      cmark_node_append_child(parser->root, footnote->node);
-      footnote->node = NULL;
     }
   }
+  cmark_iter_free(iter);
+
+  for (it = defs; it; it = it->next) {
+    cur = (cmark_node *)it->data;
+    footnote = (cmark_footnote *)cmark_map_lookup(map, &cur->as.literal);
+    if (footnote == NULL)
+      continue;
+
+    if (cur == block)
+      taken = true;
+    cmark_node_unlink(cur);
+    if (footnote->node != cur)
+      cmark_node_free(cur);
+  }
+  cmark_llist_free(parser->mem, defs);
 
-  cmark_unlink_footnotes_map(map);
-  cmark_map_free(map);
+  return taken;
 }
 
 // Attempts to parse a list item marker (bullet or enumerated).
@@ -602,7 +964,7 @@ static bufsize_t parse_list_marker(cmark_mem *mem, cmark_chunk *input,
       }
     }
 
-    data = (cmark_list *)mem->calloc(1, sizeof(*data));
+    data = (cmark_list *)cmark_mem_calloc(mem, 1, sizeof(*data));
     data->marker_offset = 0; // will be adjusted later
     data->list_type = CMARK_BULLET_LIST;
     data->bullet_char = c;
@@ -642,7 +1004,7 @@ static bufsize_t parse_list_marker(cmark_mem *mem, cmark_chunk *input,
         }
       }
 
-      data = (cmark_list *)mem->calloc(1, sizeof(*data));
+      data = (cmark_list *)cmark_mem_calloc(mem, 1, sizeof(*data));
       data->marker_offset = 0; // will be adjusted later
       data->list_type = CMARK_ORDERED_LIST;
       data->bullet_char = 0;
@@ -668,6 +1030,120 @@ static int lists_match(cmark_list *list_data, cmark_list *item_data) {
           list_data->bullet_char == item_data->bullet_char);
 }
 
+static void limit_ref_size(cmark_parser *parser) {
+  // Limit total size of extra content created from reference links to
+  // document size to avoid superlinear growth. Always allow 100KB.
+  if (parser->total_size > 100000)
+    parser->refmap->max_ref_size = parser->total_size;
+  else
+    parser->refmap->max_ref_size = 100000;
+}
+
+// Hands 'processed', what the extensions made of the first child of the
+// document, to the stream function, unless it is a footnote definition to
+// keep for cmark_parser_finish, and frees it.
+static void stream_block(cmark_parser *parser, cmark_node *processed) {
+  cmark_node *block = parser->root->first_child;
+
+  if ((parser->options & CMARK_OPT_FOOTNOTES) &&
+      stream_footnotes(parser, processed)) {
+    // A definition, kept for cmark_parser_finish.
+    if (processed == block)
+      return;
+  } else {
+    parser->stream_block_func(processed, parser->stream_block_data);
+    if (processed != block)
+      cmark_node_free(processed);
+  }
+  cmark_node_free(block);
+}
+
+// Hands over the blocks held back for footnotes that were not defined yet,
+// up to the first that still refers to one, or all of them when the
+// document is finished.
+static void stream_held_blocks(cmark_parser *parser, bool finished) {
+  cmark_llist *held;
+
+  while ((held = parser->stream_held) != NULL &&
+         (finished || stream_footnotes_defined(parser, held->data))) {
+    parser->stream_held = held->next;
+    stream_block(parser, (cmark_node *)held->data);
+    cmark_mem_free(parser->mem, held);
+  }
+  if (parser->stream_held == NULL) {
+    parser->stream_held_last = NULL;
+    parser->stream_held_block = NULL;
+  }
+}
+
+// Frees the blocks held back when the document is dropped unfinished.
+// The footnote definitions in them must have been unlinked first.
+static void stream_free_held(cmark_parser *parser) {
+  cmark_llist *held, *next;
+  cmark_footnote *footnote;
+  cmark_node *node;
+
+  for (held = parser->stream_held; held; held = next) {
+    next = held->next;
+    node = (cmark_node *)held->data;
+    // Blocks the extensions kept go with the document, and footnote
+    // definitions with the footnote map.
+    footnote = node->type == CMARK_NODE_FOOTNOTE_DEFINITION
+                   ? (cmark_footnote *)cmark_map_lookup(
+                         parser->stream_footnotes, &node->as.literal)
+                   : NULL;
+    if (node->parent != parser->root && !(footnote && footnote->node == node))
+      cmark_node_free(node);
+    cmark_mem_free(parser->mem, held);
+  }
+  parser->stream_held = parser->stream_held_last = NULL;
+  parser->stream_held_block = NULL;
+}
+
+// Hands every closed block at the start of the document to the stream
+// function, parsing its inlines first, and frees it.  With footnotes, a
+// block that refers to one not defined yet is held back, along with the
+// blocks after it, until the definition comes or the document ends.
+static void stream_closed_blocks(cmark_parser *parser) {
+  cmark_node *block, *processed;
+  cmark_llist *extensions, *held;
+
+  while ((block = parser->stream_held_block ? parser->stream_held_block->next
+                                             : parser->root->first_child) != NULL &&
+         !(block->flags & CMARK_NODE__OPEN)) {
+    limit_ref_size(parser);
+    process_inlines(parser, block, parser->refmap, parser->options);
+
+    processed = block;
+    for (extensions = parser->syntax_extensions; extensions;
+         extensions = extensions->next) {
+      cmark_syntax_extension *ext = (cmark_syntax_extension *)extensions->data;
+      if (ext->postprocess_func) {
+        cmark_node *result = ext->postprocess_func(ext, parser, processed);
+        if (result)
+          processed = result;
+      }
+    }
+
+    if (parser->options & CMARK_OPT_FOOTNOTES) {
+      stream_footnote_defs(parser, processed);
+      if (parser->stream_held || !stream_footnotes_defined(parser, processed)) {
+        held = cmark_llist_append(parser->mem, NULL, processed);
+        if (parser->stream_held_last)
+          parser->stream_held_last->next = held;
+        else
+          parser->stream_held = held;
+        parser->stream_held_last = held;
+        parser->stream_held_block = block;
+        stream_held_blocks(parser, false);
+        continue;
+      }
+    }
+
+    stream_block(parser, processed);
+  }
+}
+
 static cmark_node *finalize_document(cmark_parser *parser) {
   while (parser->current != parser->root) {
     parser->current = finalize(parser, parser->current);
@@ -675,14 +1151,24 @@ static cmark_node *finalize_document(cmark_parser *parser) {
 
   finalize(parser, parser->root);
 
-  // Limit total size of extra content created from reference links to
-  // document size to avoid superlinear growth. Always allow 100KB.
-  if (parser->total_size > 100000)
-    parser->refmap->max_ref_size = parser->total_size;
-  else
-    parser->refmap->max_ref_size = 100000;
+  if (parser->stream_block_func) {
+    stream_closed_blocks(parser);
+    stream_held_blocks(parser, true);
+    if (parser->stream_footnotes) {
+      append_footnotes(parser, parser->stream_footnotes);
+      parser->stream_footnotes = NULL;
+    }
+    return parser->root;
+  }
 
-  process_inlines(parser, parser->refmap, parser->options);
+  limit_ref_size(parser);
+#ifdef CMARK_HAVE_THREADS
+  // The arena behind CMARK_OPT_DOCUMENT_ARENA is not safe to share.
+  if (parser->threads > 1 && !parser->doc_arena)
+    process_inlines_parallel(parser, parser->refmap, parser->options);
+  else
+#endif
+    process_inlines(parser, parser->root, parser->refmap, parser->options);
   if (parser->options & CMARK_OPT_FOOTNOTES)
     process_footnotes(parser);
 
@@ -697,7 +1183,7 @@ cmark_node *cmark_parse_file(FILE *f, int options) {
 
   while ((bytes = fread(buffer, 1, sizeof(buffer), f)) > 0) {
     bool eof = bytes < sizeof(buffer);
-    S_parser_feed(parser, buffer, bytes, eof);
+    S_parser_feed(parser, buffer, bytes, eof, false);
     if (eof) {
       break;
     }
@@ -712,15 +1198,73 @@ cmark_node *cmark_parse_document(const char *buffer, size_t len, int options) {
   cmark_parser *parser = cmark_parser_new(options);
   cmark_node *document;
 
-  S_parser_feed(parser, (const unsigned char *)buffer, len, true);
+  S_parser_feed(parser, (const unsigned char *)buffer, len, true, false);
 
   document = cmark_parser_finish(parser);
   cmark_parser_free(parser);
   return document;
 }
 
+// Whether input is held back for cmark_parser_finish, to parse the
+// document's blocks on several threads.
+static bool S_hold_input(cmark_parser *parser) {
+#ifdef CMARK_HAVE_THREADS
+  return parser->threads > 1 && !parser->stream_block_func &&
+         !parser->doc_arena &&
+         (parser->held_size ||
+          (parser->line_number == 0 && !parser->linebuf.size));
+#else
+  (void)parser;
+  return false;
+#endif
+}
+
+// Adds 'len' bytes to the held input.  If the buffer cannot grow to take
+// them, because it would get too large or the allocator returns NULL, what
+// is held is parsed on this thread after all, and so is the rest.
+static void S_hold(cmark_parser *parser, const unsigned char *buffer,
+                   size_t len, bool in_place) {
+  size_t size = parser->held_size + len;
+
+  if (size > parser->held_alloc) {
+    size_t alloc = parser->held_alloc ? parser->held_alloc : 65536;
+    unsigned char *ptr = NULL;
+
+    while (alloc < size && alloc <= SIZE_MAX / 2)
+      alloc *= 2;
+    if (size >= len && alloc >= size)
+      ptr = (unsigned char *)cmark_mem_realloc(parser->base_mem,
+                                               parser->held_input, alloc);
+    if (ptr == NULL) {
+      if (parser->held_size)
+        S_parser_feed(parser, parser->held_input, parser->held_size, false,
+                      true);
+      cmark_mem_free(parser->base_mem, parser->held_input);
+      parser->held_input = NULL;
+      parser->held_size = parser->held_alloc = 0;
+      S_parser_feed(parser, buffer, len, false, in_place);
+      return;
+    }
+    parser->held_input = ptr;
+    parser->held_alloc = alloc;
+  }
+  memcpy(parser->held_input + parser->held_size, buffer, len);
+  parser->held_size = size;
+}
+
 void cmark_parser_feed(cmark_parser *parser, const char *buffer, size_t len) {
-  S_parser_feed(parser, (const unsigned char *)buffer, len, false);
+  if (S_hold_input(parser))
+    S_hold(parser, (const unsigned char *)buffer, len, false);
+  else
+    S_parser_feed(parser, (const unsigned char *)buffer, len, false, false);
+}
+
+void cmark_parser_feed_in_place(cmark_parser *parser, const char *buffer,
+                                size_t len) {
+  if (S_hold_input(parser))
+    S_hold(parser, (const unsigned char *)buffer, len, true);
+  else
+    S_parser_feed(parser, (const unsigned char *)buffer, len, false, true);
 }
 
 void cmark_parser_feed_reentrant(cmark_parser *parser, const char *buffer, size_t len) {
@@ -730,14 +1274,14 @@ void cmark_parser_feed_reentrant(cmark_parser *parser, const char *buffer, size_
   cmark_strbuf_puts(&saved_linebuf, cmark_strbuf_cstr(&parser->linebuf));
   cmark_strbuf_clear(&parser->linebuf);
 
-  S_parser_feed(parser, (const unsigned char *)buffer, len, true);
+  S_parser_feed(parser, (const unsigned char *)buffer, len, true, false);
 
   cmark_strbuf_sets(&parser->linebuf, cmark_strbuf_cstr(&saved_linebuf));
   cmark_strbuf_free(&saved_linebuf);
 }
 
 static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
-                          size_t len, bool eof) {
+                          size_t len, bool eof, bool in_place) {
   const unsigned char *end = buffer + len;
   static const uint8_t repl[] = {239, 191, 189};
   bool preserveWhitespace = parser->options & CMARK_OPT_PRESERVE_WHITESPACE;
@@ -756,14 +1300,9 @@ static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
     const unsigned char *eol;
     bufsize_t chunk_len;
     bool process = false;
-    for (eol = buffer; eol < end; ++eol) {
-      if (S_is_line_end_char(*eol)) {
-        process = true;
-        break;
-      }
-      if (*eol == '\0' && eol < end) {
-        break;
-      }
+    eol = cmark_simd_find_eol(buffer, end);
+    if (eol < end && S_is_line_end_char(*eol)) {
+      process = true;
     }
     if (eol >= end && eof) {
       process = true;
@@ -775,6 +1314,13 @@ static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
         cmark_strbuf_put(&parser->linebuf, buffer, chunk_len);
         S_process_line(parser, parser->linebuf.ptr, parser->linebuf.size, !preserveWhitespace || !eof || eol < end);
         cmark_strbuf_clear(&parser->linebuf);
+      } else if (in_place && eol < end && *eol == '\n' &&
+                 ((parser->options & CMARK_OPT_VALIDATE_UTF8) == 0 ||
+                  cmark_utf8proc_is_valid(buffer, chunk_len))) {
+        // The line, including its newline, can be parsed where it is.  Lines
+        // that fail UTF-8 validation are copied, so the invalid bytes can be
+        // replaced.
+        S_process_line_in_place(parser, buffer, chunk_len + 1);
       } else {
         S_process_line(parser, buffer, chunk_len, !preserveWhitespace || !eof || eol < end);
       }
@@ -1053,12 +1599,26 @@ static bool parse_html_block_prefix(cmark_parser *parser,
   return res;
 }
 
+// Syntax extensions receive the line as a NUL-terminated string, so a line
+// that is being parsed in place has to be copied into parser->curline before
+// it is handed to them.
+static void S_own_line(cmark_parser *parser, cmark_chunk *input) {
+  if (parser->line.data == parser->curline.ptr)
+    return;
+
+  cmark_strbuf_set(&parser->curline, parser->line.data, parser->line.len);
+  parser->line.data = parser->curline.ptr;
+  input->data = parser->curline.ptr;
+}
+
 static bool parse_extension_block(cmark_parser *parser,
                                   cmark_node *container,
                                   cmark_chunk *input)
 {
   bool res = false;
 
+  S_own_line(parser, input);
+
   if (container->extension->last_block_matches) {
     if (container->extension->last_block_matches(
         container->extension, parser, input->data, input->len, container))
@@ -1157,12 +1717,16 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
   int save_offset;
   int save_column;
   size_t depth = 0;
+  unsigned char first;
 
   while (cont_type != CMARK_NODE_CODE_BLOCK &&
          cont_type != CMARK_NODE_HTML_BLOCK) {
     depth++;
     S_find_first_nonspace(parser, input);
     indented = parser->indent >= CODE_INDENT;
+    // Every block start pattern begins with a fixed set of characters, so
+    // most lines can skip the scanners altogether.
+    first = peek_at(input, parser->first_nonspace);
 
     if (!indented && peek_at(input, parser->first_nonspace) == '>') {
 
@@ -1177,7 +1741,8 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       *container = add_child(parser, *container, CMARK_NODE_BLOCK_QUOTE,
                              blockquote_startpos + 1);
 
-    } else if (!indented && (matched = scan_atx_heading_start(
+    } else if (!indented && first == '#' &&
+               (matched = scan_atx_heading_start(
                                  input, parser->first_nonspace))) {
       bufsize_t hashpos;
       int level = 0;
@@ -1198,9 +1763,10 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
 
       (*container)->as.heading.level = level;
       (*container)->as.heading.setext = false;
-      (*container)->internal_offset = matched;
+      cmark_node_cold_fields(*container)->internal_offset = matched;
 
-    } else if (!indented && (matched = scan_open_code_fence(
+    } else if (!indented && (first == '`' || first == '~') &&
+               (matched = scan_open_code_fence(
                                  input, parser->first_nonspace))) {
       *container = add_child(parser, *container, CMARK_NODE_CODE_BLOCK,
                              parser->first_nonspace + 1);
@@ -1214,7 +1780,8 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
                        parser->first_nonspace + matched - parser->offset,
                        false);
 
-    } else if (!indented && ((matched = scan_html_block_start(
+    } else if (!indented && first == '<' &&
+               ((matched = scan_html_block_start(
                                   input, parser->first_nonspace)) ||
                              (cont_type != CMARK_NODE_PARAGRAPH &&
                               (matched = scan_html_block_start_7(
@@ -1225,6 +1792,7 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       // note, we don't adjust parser->offset because the tag is part of the
       // text
     } else if (!indented && cont_type == CMARK_NODE_PARAGRAPH &&
+               (first == '=' || first == '-') &&
                (lev =
                     scan_setext_heading_line(input, parser->first_nonspace))) {
       // finalize paragraph, resolving reference links
@@ -1247,7 +1815,7 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       S_advance_offset(parser, input, input->len - 1 - parser->offset, false);
     } else if (!indented &&
                (parser->options & CMARK_OPT_FOOTNOTES) &&
-               depth < MAX_LIST_DEPTH &&
+               depth < MAX_LIST_DEPTH && first == '[' &&
                (matched = scan_footnote_definition(input, parser->first_nonspace))) {
       cmark_chunk c = cmark_chunk_dup(input, parser->first_nonspace + 2, matched - 2);
 
@@ -1261,7 +1829,7 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       *container = add_child(parser, *container, CMARK_NODE_FOOTNOTE_DEFINITION, parser->first_nonspace + matched + 1);
       (*container)->as.literal = c;
 
-      (*container)->internal_offset = matched;
+      cmark_node_cold_fields(*container)->internal_offset = matched;
     } else if ((!indented || cont_type == CMARK_NODE_LIST) &&
 	       parser->indent < 4 &&
                depth < MAX_LIST_DEPTH &&
@@ -1320,7 +1888,7 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
                              parser->first_nonspace + 1);
       /* TODO: static */
       memcpy(&((*container)->as.list), data, sizeof(*data));
-      parser->mem->free(data);
+      cmark_mem_free(parser->mem, data);
     } else if (indented && !maybe_lazy && !parser->blank) {
       S_advance_offset(parser, input, CODE_INDENT, true);
       *container = add_child(parser, *container, CMARK_NODE_CODE_BLOCK,
@@ -1334,6 +1902,9 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       cmark_llist *tmp;
       cmark_node *new_container = NULL;
 
+      if (parser->syntax_extensions)
+        S_own_line(parser, input);
+
       for (tmp = parser->syntax_extensions; tmp; tmp=tmp->next) {
         cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp->data;
 
@@ -1483,27 +2054,13 @@ static void add_text_to_container(cmark_parser *parser, cmark_node *container,
 }
 
 /* See http://spec.commonmark.org/0.24/#phase-1-block-structure */
-static void S_process_line(cmark_parser *parser, const unsigned char *buffer,
-                           bufsize_t bytes, bool ensureEndsInNewline) {
+static void S_process_current_line(cmark_parser *parser) {
   cmark_node *last_matched_container;
   bool all_matched = true;
   cmark_node *container;
   cmark_chunk input;
   cmark_node *current;
 
-  cmark_strbuf_clear(&parser->curline);
-
-  if (parser->options & CMARK_OPT_VALIDATE_UTF8)
-    cmark_utf8proc_check(&parser->curline, buffer, bytes);
-  else
-    cmark_strbuf_put(&parser->curline, buffer, bytes);
-
-  bytes = parser->curline.size;
-
-  // ensure line ends with a newline:
-  if (ensureEndsInNewline && (bytes == 0 || !S_is_line_end_char(parser->curline.ptr[bytes - 1])))
-    cmark_strbuf_putc(&parser->curline, '\n');
-
   parser->offset = 0;
   parser->column = 0;
   parser->first_nonspace = 0;
@@ -1513,9 +2070,7 @@ static void S_process_line(cmark_parser *parser, const unsigned char *buffer,
   parser->blank = false;
   parser->partially_consumed_tab = false;
 
-  input.data = parser->curline.ptr;
-  input.len = parser->curline.size;
-  input.alloc = 0;
+  input = parser->line;
 
   // Skip UTF-8 BOM.
   if (parser->line_number == 0 &&
@@ -1552,6 +2107,865 @@ finished:
     parser->last_line_length -= 1;
 
   cmark_strbuf_clear(&parser->curline);
+  parser->line = cmark_chunk_literal(NULL);
+
+  if (parser->stream_block_func)
+    stream_closed_blocks(parser);
+}
+
+static void S_process_line(cmark_parser *parser, const unsigned char *buffer,
+                           bufsize_t bytes, bool ensureEndsInNewline) {
+  cmark_strbuf_clear(&parser->curline);
+
+  if (parser->options & CMARK_OPT_VALIDATE_UTF8)
+    cmark_utf8proc_check(&parser->curline, buffer, bytes);
+  else
+    cmark_strbuf_put(&parser->curline, buffer, bytes);
+
+  bytes = parser->curline.size;
+
+  // ensure line ends with a newline:
+  if (ensureEndsInNewline && (bytes == 0 || !S_is_line_end_char(parser->curline.ptr[bytes - 1])))
+    cmark_strbuf_putc(&parser->curline, '\n');
+
+  parser->line.data = parser->curline.ptr;
+  parser->line.len = parser->curline.size;
+  parser->line.alloc = 0;
+
+  S_process_current_line(parser);
+}
+
+// Process a line that ends in a newline directly from the caller's buffer,
+// without copying it into parser->curline first.  The line is only ever
+// read, so casting away const is safe.
+static void S_process_line_in_place(cmark_parser *parser,
+                                    const unsigned char *buffer,
+                                    bufsize_t bytes) {
+  parser->line.data = (unsigned char *)buffer;
+  parser->line.len = bytes;
+  parser->line.alloc = 0;
+
+  S_process_current_line(parser);
+}
+
+void cmark_parser_set_stream_block_func(cmark_parser *parser,
+                                        cmark_stream_block_func func,
+                                        void *data) {
+  parser->stream_block_func = func;
+  parser->stream_block_data = data;
+}
+
+// Processes what is left of the last line if it did not end in a newline.
+static void S_process_last_line(cmark_parser *parser) {
+  if (parser->linebuf.size) {
+    S_process_line(parser, parser->linebuf.ptr, parser->linebuf.size, (parser->options & CMARK_OPT_PRESERVE_WHITESPACE) == 0);
+    cmark_strbuf_clear(&parser->linebuf);
+  }
+}
+
+// Returns the end of the line at 'p', not counting NUL bytes, and sets
+// '*blank' to whether the line holds nothing but spaces and tabs.
+static const unsigned char *S_find_line_end(const unsigned char *p,
+                                            const unsigned char *end,
+                                            bool *blank) {
+  const unsigned char *eol = cmark_simd_find_eol(p, end), *q;
+
+  while (eol < end && *eol == '\0')
+    eol = cmark_simd_find_eol(eol + 1, end);
+  for (q = p; q < eol && S_is_space_or_tab(*q); ++q)
+    ;
+  *blank = q == eol;
+  return eol;
+}
+
+// Returns the start of the line after the line ending at 'eol'.
+static const unsigned char *S_skip_line_end(const unsigned char *eol,
+                                            const unsigned char *end) {
+  if (eol < end && *eol == '\r')
+    ++eol;
+  if (eol < end && *eol == '\n')
+    ++eol;
+  return eol;
+}
+
+// Whether a line starting with 'c' that follows a blank line can do nothing
+// but start a new top-level block: it is not indented, and cannot be an
+// item that continues a list.
+static bool S_starts_top_level_block(unsigned char c) {
+  return c != '\0' && !S_is_space_or_tab(c) && !S_is_line_end_char(c) &&
+         c != '-' && c != '+' && c != '*' && !cmark_isdigit(c);
+}
+
+// Whether 'parser', having just parsed a blank line, would parse a line
+// for which S_starts_top_level_block holds exactly as a new parser would:
+// the line closes every block still open, and none of them can take it as
+// lazy continuation text.
+static bool S_ends_at_blank_line(cmark_parser *parser) {
+  cmark_node *block = parser->root->last_child;
+
+  if (S_type(parser->current) == CMARK_NODE_PARAGRAPH)
+    return false;
+  // A fenced code block, even one in a list item that the next line
+  // closes, ends on the line closing it: its source position would be
+  // wrong if that line were parsed on its own.
+  if (S_type(parser->current) == CMARK_NODE_CODE_BLOCK &&
+      parser->current->as.code.fenced)
+    return false;
+  if (!block || !(block->flags & CMARK_NODE__OPEN))
+    return true;
+  if (block->extension)
+    return false;
+
+  switch (S_type(block)) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+  case CMARK_NODE_THEMATIC_BREAK:
+    return true;
+  case CMARK_NODE_CODE_BLOCK:
+    return !block->as.code.fenced;
+  default:
+    // Fenced code and some HTML blocks carry on past blank lines.
+    return false;
+  }
+}
+
+// Closes the blocks still open below the document.
+static void S_close_blocks(cmark_parser *parser) {
+  while (parser->current != parser->root)
+    parser->current = finalize(parser, parser->current);
+}
+
+#ifdef CMARK_HAVE_THREADS
+
+// Documents are only split into pieces of at least this many bytes.
+#define BLOCK_SEGMENT_MIN (1 << 19)
+
+typedef struct {
+  cmark_parser *parser;
+  const unsigned char *data;
+  size_t len;
+  // How many lines come before the segment.
+  int lines;
+} block_segment;
+
+// Returns the length of the run of backticks or tildes, indented by at most
+// three spaces, that starts the line at 'p' if it is long enough to be a
+// code fence, and sets '*c' to its character; otherwise returns 0.
+static size_t S_fence_length(const unsigned char *p, const unsigned char *eol,
+                             unsigned char *c) {
+  const unsigned char *start;
+  int indent = 0;
+
+  while (p < eol && *p == ' ' && indent < 3) {
+    ++p;
+    ++indent;
+  }
+  if (p == eol || (*p != '`' && *p != '~'))
+    return 0;
+  *c = *p;
+  for (start = p; p < eol && *p == *c; ++p)
+    ;
+  return p - start >= 3 ? (size_t)(p - start) : 0;
+}
+
+// Cuts the input into at most 'count' segments of about the same size, at
+// the start of lines that follow blank lines and can only start a new
+// top-level block.  Lines inside what look like top-level code fences are
+// passed over, as a blank line there is most likely part of the code.  This
+// is only a guess: each cut is checked once the text before it is parsed.
+// Returns the number of segments.
+static size_t S_split_blocks(const unsigned char *data, size_t len,
+                             size_t count, block_segment *segments) {
+  const unsigned char *p = data, *end = data + len, *eol;
+  size_t n = 1, fence = 0, run;
+  unsigned char fence_char = 0, c;
+  bool blank = false;
+  int lines = 0;
+
+  segments[0].data = data;
+  segments[0].lines = 0;
+
+  while (p < end && n < count) {
+    if (blank && !fence && (size_t)(p - data) >= n * (len / count) &&
+        S_starts_top_level_block(*p)) {
+      segments[n].data = p;
+      segments[n].lines = lines;
+      ++n;
+    }
+
+    eol = S_find_line_end(p, end, &blank);
+    run = S_fence_length(p, eol, &c);
+    if (!fence) {
+      fence = run;
+      fence_char = c;
+    } else if (run >= fence && c == fence_char) {
+      fence = 0;
+    }
+
+    ++lines;
+    p = S_skip_line_end(eol, end);
+  }
+
+  for (size_t i = 0; i < n; ++i)
+    segments[i].len =
+        (size_t)((i + 1 < n ? segments[i + 1].data : end) - segments[i].data);
+  return n;
+}
+
+// Moves the top-level blocks of 'from' to the end of 'parser's document,
+// and the reference definitions along with them.
+static void S_append_blocks(cmark_parser *parser, cmark_parser *from) {
+  cmark_node *root = parser->root, *first = from->root->first_child, *block;
+
+  cmark_map_append(parser->refmap, from->refmap);
+  if (!first)
+    return;
+
+  for (block = first; block; block = block->next)
+    block->parent = root;
+  first->prev = root->last_child;
+  if (root->last_child)
+    root->last_child->next = first;
+  else
+    root->first_child = first;
+  root->last_child = from->root->last_child;
+  from->root->first_child = from->root->last_child = NULL;
+}
+
+CMARK_THREAD_FUNC(block_worker, arg) {
+  block_segment *segment = (block_segment *)arg;
+  S_parser_feed(segment->parser, segment->data, segment->len, false, true);
+  CMARK_THREAD_RETURN;
+}
+
+// Parses the blocks of the held input on up to parser->threads threads.
+// The input is cut into segments, each parsed by a parser of its own as if
+// it were a document, and the blocks are then joined up in order.  A
+// segment is only kept if the text before it, as parsed, ends in a way
+// that makes the cut harmless; otherwise its blocks are thrown away and it
+// is parsed again as part of the text before it.
+static void parse_blocks_parallel(cmark_parser *parser) {
+  cmark_mem *mem = parser->base_mem;
+  const unsigned char *data = parser->held_input;
+  size_t len = parser->held_size, count, i;
+  block_segment *segments;
+  cmark_thread *threads;
+  bool *started;
+  cmark_parser *cur;
+  cmark_llist *extensions;
+
+  count = len / BLOCK_SEGMENT_MIN;
+  if (count > (size_t)parser->threads)
+    count = (size_t)parser->threads;
+  if (count < 1)
+    count = 1;
+
+  segments =
+      (block_segment *)cmark_mem_calloc(mem, count, sizeof(block_segment));
+  threads = (cmark_thread *)cmark_mem_calloc(mem, count, sizeof(cmark_thread));
+  started = (bool *)cmark_mem_calloc(mem, count, sizeof(bool));
+  count = S_split_blocks(data, len, count, segments);
+
+  segments[0].parser = parser;
+  for (i = 1; i < count; ++i) {
+    cur = cmark_parser_new_with_mem(parser->options, mem);
+    for (extensions = parser->syntax_extensions; extensions;
+         extensions = extensions->next)
+      cmark_parser_attach_syntax_extension(
+          cur, (cmark_syntax_extension *)extensions->data);
+    cur->line_number = segments[i].lines;
+    segments[i].parser = cur;
+    started[i] = CMARK_THREAD_START(threads[i], block_worker, &segments[i]);
+  }
+  S_parser_feed(parser, segments[0].data, segments[0].len, false, true);
+  for (i = 1; i < count; ++i) {
+    if (started[i])
+      CMARK_THREAD_JOIN(threads[i]);
+    else
+      S_parser_feed(segments[i].parser, segments[i].data, segments[i].len,
+                    false, true);
+  }
+
+  cur = parser;
+  for (i = 1; i < count; ++i) {
+    if (S_ends_at_blank_line(cur)) {
+      S_close_blocks(cur);
+      if (cur != parser) {
+        S_append_blocks(parser, cur);
+        cmark_parser_free(cur);
+      }
+      cur = segments[i].parser;
+    } else {
+      cmark_parser_free(segments[i].parser);
+      S_parser_feed(cur, segments[i].data, segments[i].len, false, true);
+    }
+  }
+
+  if (cur != parser) {
+    S_process_last_line(cur);
+    S_close_blocks(cur);
+    S_append_blocks(parser, cur);
+    parser->line_number = cur->line_number;
+    parser->last_line_length = cur->last_line_length;
+    cmark_parser_free(cur);
+  }
+
+  parser->total_size = len > UINT_MAX ? UINT_MAX : len;
+  cmark_mem_free(mem, parser->held_input);
+  parser->held_input = NULL;
+  parser->held_size = parser->held_alloc = 0;
+  cmark_mem_free(mem, started);
+  cmark_mem_free(mem, threads);
+  cmark_mem_free(mem, segments);
+}
+
+#endif
+
+// Throws away what 'parser' has been fed, as if it had just been created.
+static void S_parser_discard(cmark_parser *parser) {
+  cmark_strbuf_free(&parser->curline);
+  cmark_strbuf_free(&parser->linebuf);
+  cmark_parser_reset(parser);
+}
+
+struct cmark_split {
+  cmark_mem *mem;
+  size_t count;
+  // Where each piece starts, followed by the end of the input.
+  size_t *offsets;
+  // The definitions lookups find, as Markdown in document order, and where
+  // those from each piece start in it, followed by its size.
+  cmark_strbuf references;
+  size_t *reference_offsets;
+};
+
+// Appends 'chunk' so that it reads back the same from a link destination
+// in angle brackets, a title in double quotes or an attribute list, where
+// entities and backslash escapes are resolved: ampersands and control
+// characters, which entities may have put there, become entities, and
+// backslashes, angle brackets and double quotes are escaped.
+static void S_put_escaped(cmark_strbuf *buf, cmark_chunk *chunk) {
+  bufsize_t i;
+
+  for (i = 0; i < chunk->len; ++i) {
+    if (chunk->data[i] == '&') {
+      cmark_strbuf_puts(buf, "&amp;");
+      continue;
+    }
+    if (chunk->data[i] < 0x20) {
+      cmark_strbuf_puts(buf, "&#");
+      if (chunk->data[i] >= 10)
+        cmark_strbuf_putc(buf, '0' + chunk->data[i] / 10);
+      cmark_strbuf_putc(buf, '0' + chunk->data[i] % 10);
+      cmark_strbuf_putc(buf, ';');
+      continue;
+    }
+    if (strchr("\\<>\"", chunk->data[i]))
+      cmark_strbuf_putc(buf, '\\');
+    cmark_strbuf_putc(buf, chunk->data[i]);
+  }
+}
+
+// Appends a definition that parses back into 'ref'.  The label is already
+// normalized, which normalizing again leaves as it is.
+static void S_put_reference(cmark_strbuf *buf, cmark_reference *ref) {
+  if (ref->is_attributes_reference) {
+    cmark_strbuf_puts(buf, "^[");
+    cmark_strbuf_puts(buf, (const char *)ref->entry.label);
+    cmark_strbuf_puts(buf, "]: ");
+    S_put_escaped(buf, &ref->attributes);
+  } else {
+    cmark_strbuf_putc(buf, '[');
+    cmark_strbuf_puts(buf, (const char *)ref->entry.label);
+    cmark_strbuf_puts(buf, "]: <");
+    S_put_escaped(buf, &ref->url);
+    cmark_strbuf_putc(buf, '>');
+    if (ref->title.len) {
+      cmark_strbuf_puts(buf, " \"");
+      S_put_escaped(buf, &ref->title);
+      cmark_strbuf_putc(buf, '"');
+    }
+  }
+  cmark_strbuf_putc(buf, '\n');
+}
+
+// Writes out the definitions lookups find in 'map', in document order,
+// noting where those from each piece start.  'ages' holds the number of
+// definitions seen before each piece.
+static void S_collect_references(cmark_split *split, cmark_map *map,
+                                 const size_t *ages) {
+  cmark_map_entry **entries = NULL, *entry;
+  size_t piece, age;
+
+  if (map->size) {
+    entries = (cmark_map_entry **)cmark_mem_calloc(split->mem, map->size,
+                                                     sizeof(*entries));
+    for (entry = map->refs; entry; entry = entry->next)
+      entries[entry->age] = entry;
+  }
+
+  for (piece = 0; piece < split->count; ++piece) {
+    split->reference_offsets[piece] = (size_t)split->references.size;
+    for (age = ages[piece]; age < ages[piece + 1]; ++age) {
+      if (cmark_map_entry_found(map, entries[age]))
+        S_put_reference(&split->references, (cmark_reference *)entries[age]);
+    }
+  }
+  split->reference_offsets[split->count] = (size_t)split->references.size;
+
+  cmark_mem_free(split->mem, entries);
+}
+
+cmark_split *cmark_parser_split(cmark_parser *parser, const char *buffer,
+                                size_t len, size_t piece_size) {
+  const unsigned char *data = (const unsigned char *)buffer, *end = data + len;
+  const unsigned char *p = data, *fed = data, *eol;
+  cmark_mem *mem = parser->mem;
+  cmark_split *split =
+      (cmark_split *)cmark_mem_calloc(mem, 1, sizeof(cmark_split));
+  size_t capacity = 16, *ages;
+  cmark_node *block;
+  bool blank = false;
+
+  split->mem = mem;
+  cmark_strbuf_init(mem, &split->references, 0);
+  split->offsets =
+      (size_t *)cmark_mem_calloc(mem, capacity + 1, sizeof(size_t));
+  ages = (size_t *)cmark_mem_calloc(mem, capacity + 1, sizeof(size_t));
+  split->count = 1;
+  // A byte order mark would not be skipped in front of the definitions a
+  // piece is given, so leave it out of the first piece.
+  if (len >= 3 && memcmp(data, "\xef\xbb\xbf", 3) == 0)
+    split->offsets[0] = 3;
+
+  // Only blocks are parsed.  At each line that could start a piece, the
+  // blocks closed so far are freed, and if the piece before is long enough
+  // and the blocks still open are ones the line would close anyway, they
+  // are closed and the piece starts there.
+  while (p < end) {
+    if (blank && S_starts_top_level_block(*p)) {
+      S_parser_feed(parser, fed, (size_t)(p - fed), false, true);
+      fed = p;
+      while ((block = parser->root->first_child) != NULL &&
+             !(block->flags & CMARK_NODE__OPEN))
+        cmark_node_free(block);
+
+      if ((size_t)(p - data) >= split->offsets[split->count - 1] + piece_size &&
+          S_ends_at_blank_line(parser)) {
+        S_close_blocks(parser);
+        if (split->count == capacity) {
+          capacity *= 2;
+          split->offsets = (size_t *)cmark_mem_realloc(
+              mem, split->offsets, (capacity + 1) * sizeof(size_t));
+          ages = (size_t *)cmark_mem_realloc(
+              mem, ages, (capacity + 1) * sizeof(size_t));
+        }
+        split->offsets[split->count] = (size_t)(p - data);
+        ages[split->count] = parser->refmap->size;
+        ++split->count;
+      }
+    }
+
+    eol = S_find_line_end(p, end, &blank);
+    p = S_skip_line_end(eol, end);
+  }
+
+  S_parser_feed(parser, fed, (size_t)(end - fed), false, true);
+  S_process_last_line(parser);
+  S_close_blocks(parser);
+  split->offsets[split->count] = len;
+  ages[split->count] = parser->refmap->size;
+
+  split->reference_offsets =
+      (size_t *)cmark_mem_calloc(mem, split->count + 1, sizeof(size_t));
+  S_collect_references(split, parser->refmap, ages);
+
+  cmark_mem_free(mem, ages);
+  S_parser_discard(parser);
+  return split;
+}
+
+size_t cmark_split_count(const cmark_split *split) { return split->count; }
+
+size_t cmark_split_offset(const cmark_split *split, size_t piece) {
+  return split->offsets[piece];
+}
+
+char *cmark_split_references(const cmark_split *split, size_t piece) {
+  const char *refs = (const char *)split->references.ptr;
+  size_t size = (size_t)split->references.size;
+  size_t start = split->reference_offsets[piece];
+  size_t stop = split->reference_offsets[piece + 1];
+  size_t len = size - (stop - start);
+  char *result = (char *)cmark_mem_calloc(split->mem, len + 2, 1);
+
+  memcpy(result, refs, start);
+  memcpy(result + start, refs + stop, size - stop);
+  // A blank line ends the paragraph the definitions make up.
+  if (len)
+    result[len] = '\n';
+  return result;
+}
+
+void cmark_split_free(cmark_split *split) {
+  cmark_mem *mem = split->mem;
+
+  cmark_strbuf_free(&split->references);
+  cmark_mem_free(mem, split->reference_offsets);
+  cmark_mem_free(mem, split->offsets);
+  cmark_mem_free(mem, split);
+}
+
+// Feeds the 'len' bytes at 'data' to 'parser', if there are any.
+static void S_feed_bytes(cmark_parser *parser, const unsigned char *data,
+                         size_t len) {
+  if (len)
+    S_parser_feed(parser, data, len, false, true);
+}
+
+// Whether 'data' holds "]:", as every reference definition does, or, with
+// 'footnotes', "[^".  'prev' is the byte before 'data'.
+static bool S_may_define(unsigned char prev, const unsigned char *data,
+                         size_t len, bool footnotes) {
+  size_t i;
+
+  for (i = 0; i < len; prev = data[i++]) {
+    if (prev == ']' && data[i] == ':')
+      return true;
+    if (footnotes && prev == '[' && data[i] == '^')
+      return true;
+  }
+  return false;
+}
+
+// Adds 'delta' to the line numbers of 'node' and everything inside it.
+// Blocks without a position, such as the paragraphs the table extension
+// splits off, give their inlines lines relative to themselves; those are
+// left alone.
+static void S_shift_lines(cmark_node *node, int delta) {
+  cmark_node *cur = node;
+
+  for (;;) {
+    if (cur->start_line) {
+      cur->start_line += delta;
+      cur->end_line += delta;
+      if (cur->first_child) {
+        cur = cur->first_child;
+        continue;
+      }
+    }
+    while (cur != node && !cur->next)
+      cur = cur->parent;
+    if (cur == node)
+      return;
+    cur = cur->next;
+  }
+}
+
+// Returns the first of the blocks that came from the lines 'block' starts
+// at: blocks without a position, such as the paragraph the table extension
+// splits off a table, come before the block they were split from.
+static cmark_node *S_first_of_line(cmark_node *block) {
+  while (block->prev && block->prev->start_line == 0)
+    block = block->prev;
+  return block;
+}
+
+// Whether 'block', or the last block nested in it, ends on 'line' or later.
+// A fenced code block in a list item that the line after a blank line
+// closes ends on that line, so the line cannot be parsed on its own.
+static bool S_reaches_line(cmark_node *block, int line) {
+  for (; block; block = block->last_child)
+    if (block->end_line >= line)
+      return true;
+  return false;
+}
+
+// Returns the start of the line before the one starting at 'p'.
+static const unsigned char *S_prev_line_start(const unsigned char *text,
+                                              const unsigned char *p) {
+  if (p > text && p[-1] == '\n')
+    --p;
+  if (p > text && p[-1] == '\r')
+    --p;
+  while (p > text && p[-1] != '\n' && p[-1] != '\r')
+    --p;
+  return p;
+}
+
+// Points 'state' at the start of the text and the first block of
+// 'document'.
+static void S_reset_restart(cmark_node *document, cmark_incremental *state) {
+  state->block = document->first_child;
+  state->offset = 0;
+  state->line = 1;
+}
+
+// Finds the last top-level block of 'document' whose first line starts
+// before 'offset' in 'text', follows a blank line and starts with a
+// character for which S_starts_top_level_block holds, and on which no
+// block before it ends.  That line was parsed as a new parser would parse
+// it, and a change after its first byte cannot reach the blocks before it.
+// The search starts where the last re-parse did, and goes forward or
+// backward from there, so that a run of nearby edits scans only the lines
+// between them.  Points 'state' at the line found, at the first block from
+// it on, or at the start of the text if there is no such block.
+static void S_find_restart(cmark_node *document, cmark_incremental *state,
+                           const unsigned char *text, size_t len,
+                           size_t offset) {
+  const unsigned char *p, *end = text + len, *eol;
+  cmark_node *block;
+  int n;
+  bool blank = false, advanced;
+
+  if (state->offset > len)
+    S_reset_restart(document, state);
+
+  p = text + state->offset;
+  n = state->line;
+  if (state->offset < offset || state->offset == 0) {
+    for (block = state->block; block; block = block->next) {
+      if (block->start_line == 0)
+        continue;
+      for (advanced = false; n < block->start_line && p < end;
+           advanced = true) {
+        eol = S_find_line_end(p, end, &blank);
+        p = S_skip_line_end(eol, end);
+        ++n;
+      }
+      if (n != block->start_line || (size_t)(p - text) >= offset)
+        break;
+      if (advanced && blank && block->start_column == 1 &&
+          S_starts_top_level_block(*p) &&
+          !S_reaches_line(S_first_of_line(block)->prev, n)) {
+        state->block = S_first_of_line(block);
+        state->offset = (size_t)(p - text);
+        state->line = n;
+      }
+    }
+    return;
+  }
+
+  block = state->block ? state->block->prev : document->last_child;
+  for (; block; block = block->prev) {
+    if (block->start_line == 0)
+      continue;
+    while (n > block->start_line && p > text) {
+      p = S_prev_line_start(text, p);
+      --n;
+    }
+    if (n != block->start_line)
+      break;
+    if ((size_t)(p - text) >= offset || block->start_column != 1 || n == 1 ||
+        !S_starts_top_level_block(*p) ||
+        (block->prev && block->prev->start_line == n) ||
+        S_reaches_line(S_first_of_line(block)->prev, n))
+      continue;
+    S_find_line_end(S_prev_line_start(text, p), end, &blank);
+    if (blank) {
+      state->block = S_first_of_line(block);
+      state->offset = (size_t)(p - text);
+      state->line = n;
+      return;
+    }
+  }
+  S_reset_restart(document, state);
+}
+
+// Gives 'a' the children of 'b', and 'b' those of 'a'.
+static void S_swap_children(cmark_node *a, cmark_node *b) {
+  cmark_node *first = a->first_child, *last = a->last_child, *child;
+
+  a->first_child = b->first_child;
+  a->last_child = b->last_child;
+  b->first_child = first;
+  b->last_child = last;
+  for (child = a->first_child; child; child = child->next)
+    child->parent = a;
+  for (child = b->first_child; child; child = child->next)
+    child->parent = b;
+  cmark_node_invalidate_hash(a);
+  cmark_node_invalidate_hash(b);
+}
+
+// Parses the edited text from the block S_find_restart finds up to the
+// first unchanged block after the edit that the parser reaches in the state
+// a new parser would be in, and puts the new blocks in place of the old
+// ones.  Returns a document holding the old blocks, or NULL if the text
+// parsed again may define references or footnotes, or reaches the limit on
+// reference expansion, in which case all of it must be parsed again.
+static cmark_node *S_reparse_blocks(cmark_parser *parser, cmark_node *document,
+                                    const unsigned char *old, size_t old_len,
+                                    size_t offset, size_t removed,
+                                    const unsigned char *inserted,
+                                    size_t inserted_len, cmark_node **first,
+                                    cmark_node **last) {
+  const unsigned char *end = old + old_len, *edit_end = old + offset + removed;
+  const unsigned char *p, *next, *eol, *fed;
+  cmark_incremental *state = document->as.incremental;
+  bool footnotes = (parser->options & CMARK_OPT_FOOTNOTES) != 0;
+  bool blank = false, line_blank, whole_line = false, found = false;
+  cmark_node *block, *stop, *region, *cur, *next_block;
+  unsigned char prev;
+  size_t start, new_len = old_len - removed + inserted_len;
+  int line, delta = 0;
+
+  S_find_restart(document, state, old, old_len, offset);
+  block = state->block;
+  start = state->offset;
+  line = state->line;
+  parser->line_number = line - 1;
+  S_feed_bytes(parser, old + start, offset - start);
+  S_feed_bytes(parser, inserted, inserted_len);
+
+  // Find the line the edit ends in.
+  for (p = old + start;; p = next, ++line) {
+    eol = S_find_line_end(p, end, &line_blank);
+    next = S_skip_line_end(eol, end);
+    if (next > edit_end || next == end)
+      break;
+  }
+
+  // Go on a line at a time, the first of which may have been edited, until
+  // an old block starts after a blank line where the parser would close
+  // every open block.  'line' is the line in the old text.
+  stop = block;
+  for (p = fed = edit_end; p < end; p = next, ++line) {
+    if (blank && S_starts_top_level_block(*p)) {
+      S_feed_bytes(parser, fed, (size_t)(p - fed));
+      fed = p;
+      while (stop && stop->start_line < line)
+        stop = stop->next;
+      if (stop && stop->start_line == line && stop->start_column == 1 &&
+          S_ends_at_blank_line(parser)) {
+        stop = S_first_of_line(stop);
+        // The lines after this one move by as many as the edit added.
+        delta = parser->line_number + 1 - line;
+        found = true;
+        break;
+      }
+    }
+    eol = S_find_line_end(p, end, &line_blank);
+    next = S_skip_line_end(eol, end);
+    blank = line_blank && whole_line;
+    whole_line = true;
+  }
+  if (!found) {
+    S_feed_bytes(parser, fed, (size_t)(end - fed));
+    p = end;
+    stop = NULL;
+  }
+
+  prev = offset > start ? old[offset - 1] : 0;
+  if (S_may_define(0, old + start, (size_t)(p - old) - start, footnotes) ||
+      S_may_define(prev, inserted, inserted_len, footnotes) ||
+      (edit_end < p &&
+       S_may_define(inserted_len ? inserted[inserted_len - 1] : prev,
+                    edit_end, 1, footnotes))) {
+    S_parser_discard(parser);
+    return NULL;
+  }
+
+  // Links resolve against all of the document's definitions, which the
+  // text parsed again does not change.
+  cmark_map_free(parser->refmap);
+  parser->refmap = state->refmap;
+  state->refmap = NULL;
+  parser->total_size = new_len > UINT_MAX ? UINT_MAX : new_len;
+  region = cmark_parser_finish(parser);
+  state->refmap = region->as.incremental->refmap;
+  region->as.incremental->refmap = NULL;
+  if (state->refmap->ref_size_exceeded) {
+    cmark_node_free(region);
+    return NULL;
+  }
+
+  *first = region->first_child;
+  *last = region->last_child;
+  for (cur = block; cur && cur != stop; cur = next_block) {
+    next_block = cur->next;
+    cmark_node_append_child(region, cur);
+  }
+  for (cur = *first; cur; cur = cur == *last ? NULL : next_block) {
+    next_block = cur->next;
+    if (stop)
+      cmark_node_insert_before(stop, cur);
+    else
+      cmark_node_append_child(document, cur);
+  }
+  // The line parsing started at is still where it was, and is where the
+  // next edit is looked for from.
+  state->block = *first ? *first : stop;
+
+  if (!found) {
+    document->end_line = region->end_line;
+    document->end_column = region->end_column;
+  } else if (delta) {
+    for (cur = stop; cur; cur = cur->next)
+      S_shift_lines(cur, delta);
+    document->end_line += delta;
+  }
+  return region;
+}
+
+cmark_node *cmark_parser_reparse(cmark_parser *parser, cmark_node *document,
+                                 const char *old_text, size_t old_len,
+                                 size_t offset, size_t removed,
+                                 const char *inserted, size_t inserted_len,
+                                 cmark_node **first, cmark_node **last) {
+  const unsigned char *old = (const unsigned char *)old_text;
+  const unsigned char *ins = (const unsigned char *)inserted;
+  int options = parser->options;
+  cmark_node *replaced = NULL, *new_first = NULL, *new_last = NULL;
+  cmark_incremental *state;
+
+  if (!document || S_type(document) != CMARK_NODE_DOCUMENT ||
+      (document->flags & CMARK_NODE__ARENA_ROOT) ||
+      (options & CMARK_OPT_DOCUMENT_ARENA) || parser->stream_block_func ||
+      parser->line_number || parser->linebuf.size ||
+      parser->held_size || offset > old_len ||
+      removed > old_len - offset)
+    return NULL;
+
+  // The new blocks, or the new document, keep the reference map.
+  parser->options |= CMARK_OPT_INCREMENTAL;
+
+  // Footnotes are numbered across the whole document, and their
+  // definitions moved to its end.
+  state = document->as.incremental;
+  if (state && !state->refmap->ref_size_exceeded &&
+      !((options & CMARK_OPT_FOOTNOTES) && document->last_child &&
+        S_type(document->last_child) == CMARK_NODE_FOOTNOTE_DEFINITION))
+    replaced = S_reparse_blocks(parser, document, old, old_len, offset,
+                                removed, ins, inserted_len, &new_first,
+                                &new_last);
+
+  if (!replaced) {
+    S_feed_bytes(parser, old, offset);
+    S_feed_bytes(parser, ins, inserted_len);
+    S_feed_bytes(parser, old + offset + removed, old_len - offset - removed);
+    replaced = cmark_parser_finish(parser);
+
+    S_swap_children(document, replaced);
+    state = document->as.incremental;
+    document->as.incremental = replaced->as.incremental;
+    replaced->as.incremental = state;
+    document->end_line = replaced->end_line;
+    document->end_column = replaced->end_column;
+    new_first = document->first_child;
+    new_last = document->last_child;
+  }
+
+  parser->options = options;
+  if (first)
+    *first = new_first;
+  if (last)
+    *last = new_last;
+  return replaced;
+}
+
+void cmark_parser_set_threads(cmark_parser *parser, int threads) {
+  parser->threads = threads;
 }
 
 cmark_node *cmark_parser_finish(cmark_parser *parser) {
@@ -1562,14 +2976,19 @@ cmark_node *cmark_parser_finish(cmark_parser *parser) {
   if (parser->root == NULL)
     return NULL;
 
-  if (parser->linebuf.size) {
-    S_process_line(parser, parser->linebuf.ptr, parser->linebuf.size, (parser->options & CMARK_OPT_PRESERVE_WHITESPACE) == 0);
-    cmark_strbuf_clear(&parser->linebuf);
-  }
+#ifdef CMARK_HAVE_THREADS
+  if (parser->held_size)
+    parse_blocks_parallel(parser);
+#endif
+
+  S_process_last_line(parser);
 
   finalize_document(parser);
 
-  cmark_consolidate_text_nodes(parser->root);
+  // process_inlines consolidated each block already; footnote processing
+  // may have put new text nodes next to existing ones.
+  if (parser->options & CMARK_OPT_FOOTNOTES)
+    cmark_consolidate_text_nodes(parser->root);
 
   cmark_strbuf_free(&parser->curline);
   cmark_strbuf_free(&parser->linebuf);
@@ -1592,6 +3011,16 @@ cmark_node *cmark_parser_finish(cmark_parser *parser) {
   res = parser->root;
   parser->root = NULL;
 
+  if ((parser->options & CMARK_OPT_INCREMENTAL) &&
+      S_type(res) == CMARK_NODE_DOCUMENT) {
+    cmark_incremental *state = (cmark_incremental *)cmark_mem_calloc(
+        parser->mem, 1, sizeof(cmark_incremental));
+    state->refmap = parser->refmap;
+    parser->refmap = NULL;
+    S_reset_restart(res, state);
+    res->as.incremental = state;
+  }
+
   cmark_parser_reset(parser);
 
   return res;
@@ -53,8 +53,8 @@ void cmark_strbuf_grow(cmark_strbuf *buf, bufsize_t target_size) {
   new_size += 1;
   new_size = (new_size + 7) & ~7;
 
-  buf->ptr = (unsigned char *)buf->mem->realloc(buf->asize ? buf->ptr : NULL,
-                                                new_size);
+  buf->ptr = (unsigned char *)cmark_mem_realloc(
+      buf->mem, buf->asize ? buf->ptr : NULL, new_size);
   buf->asize = new_size;
 }
 
@@ -65,7 +65,7 @@ void cmark_strbuf_free(cmark_strbuf *buf) {
     return;
 
   if (buf->ptr != cmark_strbuf__initbuf)
-    buf->mem->free(buf->ptr);
+    cmark_mem_free(buf->mem, buf->ptr);
 
   cmark_strbuf_init(buf->mem, buf, 0);
 }
@@ -118,6 +118,11 @@ void cmark_strbuf_puts(cmark_strbuf *buf, const char *string) {
   cmark_strbuf_put(buf, (const unsigned char *)string, (bufsize_t)strlen(string));
 }
 
+void cmark_strbuf_write(const char *data, size_t len, void *userdata) {
+  cmark_strbuf_put((cmark_strbuf *)userdata, (const unsigned char *)data,
+                   (bufsize_t)len);
+}
+
 void cmark_strbuf_copy_cstr(char *data, bufsize_t datasize,
                             const cmark_strbuf *buf) {
   bufsize_t copylen;
@@ -149,7 +154,7 @@ unsigned char *cmark_strbuf_detach(cmark_strbuf *buf) {
 
   if (buf->asize == 0) {
     /* return an empty string */
-    return (unsigned char *)buf->mem->calloc(1, 1);
+    return (unsigned char *)cmark_mem_calloc(buf->mem, 1, 1);
   }
 
   cmark_strbuf_init(buf->mem, buf, 0);
@@ -473,11 +473,13 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
     if (entering) {
       LIT("[^");
 
-      char *footnote_label = renderer->mem->calloc(node->parent_footnote_def->as.literal.len + 1, sizeof(char));
-      memmove(footnote_label, node->parent_footnote_def->as.literal.data, node->parent_footnote_def->as.literal.len);
+      cmark_node *def = cmark_node_parent_footnote_def(node);
+      cmark_chunk *label = def ? &def->as.literal : &node->as.literal;
+      char *footnote_label = cmark_mem_calloc(renderer->mem, label->len + 1, sizeof(char));
+      memmove(footnote_label, label->data, label->len);
 
       OUT(footnote_label, false, LITERAL);
-      renderer->mem->free(footnote_label);
+      cmark_mem_free(renderer->mem, footnote_label);
 
       LIT("]");
     }
@@ -488,11 +490,11 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
       renderer->footnote_ix += 1;
       LIT("[^");
 
-      char *footnote_label = renderer->mem->calloc(node->as.literal.len + 1, sizeof(char));
+      char *footnote_label = cmark_mem_calloc(renderer->mem, node->as.literal.len + 1, sizeof(char));
       memmove(footnote_label, node->as.literal.data, node->as.literal.len);
 
       OUT(footnote_label, false, LITERAL);
-      renderer->mem->free(footnote_label);
+      cmark_mem_free(renderer->mem, footnote_label);
 
       LIT("]:\n");
 
@@ -511,7 +513,7 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
 }
 
 char *cmark_render_commonmark(cmark_node *root, int options, int width) {
-  return cmark_render_commonmark_with_mem(root, options, width, cmark_node_mem(root));
+  return cmark_render_commonmark_with_mem(root, options, width, cmark_node_output_mem(root));
 }
 
 char *cmark_render_commonmark_with_mem(cmark_node *root, int options, int width, cmark_mem *mem) {
@@ -522,3 +524,14 @@ char *cmark_render_commonmark_with_mem(cmark_node *root, int options, int width,
   }
   return cmark_render(mem, root, options, width, outc, S_render_node);
 }
+
+void cmark_render_commonmark_to_sink(cmark_node *root, int options, int width,
+                                     cmark_write_func write, void *userdata) {
+  if (options & CMARK_OPT_HARDBREAKS) {
+    // disable breaking on width, since it has
+    // a different meaning with OPT_HARDBREAKS
+    width = 0;
+  }
+  cmark_render_to_sink(cmark_node_output_mem(root), root, options, width, outc,
+                       S_render_node, write, userdata);
+}
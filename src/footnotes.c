@@ -8,10 +8,10 @@ static void footnote_free(cmark_map *map, cmark_map_entry *_ref) {
   cmark_footnote *ref = (cmark_footnote *)_ref;
   cmark_mem *mem = map->mem;
   if (ref != NULL) {
-    mem->free(ref->entry.label);
+    cmark_mem_free(mem, ref->entry.label);
     if (ref->node)
       cmark_node_free(ref->node);
-    mem->free(ref);
+    cmark_mem_free(mem, ref);
   }
 }
 
@@ -23,16 +23,11 @@ void cmark_footnote_create(cmark_map *map, cmark_node *node) {
   if (reflabel == NULL)
     return;
 
-  assert(map->sorted == NULL);
-
-  ref = (cmark_footnote *)map->mem->calloc(1, sizeof(*ref));
+  ref = (cmark_footnote *)cmark_mem_calloc(map->mem, 1, sizeof(*ref));
   ref->entry.label = reflabel;
   ref->node = node;
-  ref->entry.age = map->size;
-  ref->entry.next = map->refs;
 
-  map->refs = (cmark_map_entry *)ref;
-  map->size++;
+  cmark_map_insert(map, (cmark_map_entry *)ref);
 }
 
 cmark_map *cmark_footnote_map_new(cmark_mem *mem) {
@@ -3,6 +3,8 @@
 #include <string.h>
 
 #include "houdini.h"
+#include "mutex.h"
+#include "simd.h"
 
 #if !defined(__has_builtin)
 # define __has_builtin(b) 0
@@ -53,6 +55,21 @@ static const char HREF_SAFE[] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
+/* HREF_SAFE as a set for the SIMD scanner. */
+static cmark_simd_charset HREF_SAFE_SET;
+
+CMARK_DEFINE_ONCE(href_safe_set)
+
+static void initialize_href_safe_set(void) {
+  int c;
+
+  cmark_simd_charset_init(&HREF_SAFE_SET);
+  for (c = 0; c < 256; ++c) {
+    if (HREF_SAFE[c])
+      cmark_simd_charset_add(&HREF_SAFE_SET, (unsigned char)c);
+  }
+}
+
 int houdini_escape_href(cmark_strbuf *ob, const uint8_t *src, bufsize_t size) {
   static const uint8_t hex_chars[] = "0123456789ABCDEF";
   bufsize_t i = 0, org;
@@ -60,10 +77,13 @@ int houdini_escape_href(cmark_strbuf *ob, const uint8_t *src, bufsize_t size) {
 
   hex_str[0] = '%';
 
+  CMARK_RUN_ONCE(href_safe_set, initialize_href_safe_set);
+
   while (i < size) {
     org = i;
-    while (i < size && HREF_SAFE[src[i]] != 0)
-      i++;
+    i = (bufsize_t)(cmark_simd_find_not_charset(&HREF_SAFE_SET, src + i,
+                                                src + size) -
+                    src);
 
     if (likely(i > org))
       cmark_strbuf_put(ob, src + org, i - org);
@@ -3,6 +3,8 @@
 #include <string.h>
 
 #include "houdini.h"
+#include "mutex.h"
+#include "simd.h"
 
 #if !defined(__has_builtin)
 # define __has_builtin(b) 0
@@ -42,14 +44,39 @@ static const char HTML_ESCAPE_TABLE[] = {
 static const char *HTML_ESCAPES[] = {"",      "&quot;", "&amp;", "&#39;",
                                      "&#47;", "&lt;",   "&gt;"};
 
+/* The characters of HTML_ESCAPE_TABLE that need escaping, as sets for the
+ * SIMD scanner. The forward slash and single quote are only escaped in
+ * secure mode. */
+static cmark_simd_charset HTML_ESCAPE_SET;
+static cmark_simd_charset HTML_ESCAPE_SET_SECURE;
+
+CMARK_DEFINE_ONCE(html_escape_sets)
+
+static void initialize_html_escape_sets(void) {
+  int c;
+
+  cmark_simd_charset_init(&HTML_ESCAPE_SET);
+  cmark_simd_charset_init(&HTML_ESCAPE_SET_SECURE);
+  for (c = 0; c < 256; ++c) {
+    if (!HTML_ESCAPE_TABLE[c])
+      continue;
+    cmark_simd_charset_add(&HTML_ESCAPE_SET_SECURE, (unsigned char)c);
+    if (c != '/' && c != '\'')
+      cmark_simd_charset_add(&HTML_ESCAPE_SET, (unsigned char)c);
+  }
+}
+
 int houdini_escape_html0(cmark_strbuf *ob, const uint8_t *src, bufsize_t size,
                          int secure) {
-  bufsize_t i = 0, org, esc = 0;
+  const cmark_simd_charset *set;
+  bufsize_t i = 0, org;
+
+  CMARK_RUN_ONCE(html_escape_sets, initialize_html_escape_sets);
+  set = secure ? &HTML_ESCAPE_SET_SECURE : &HTML_ESCAPE_SET;
 
   while (i < size) {
     org = i;
-    while (i < size && (esc = HTML_ESCAPE_TABLE[src[i]]) == 0)
-      i++;
+    i = (bufsize_t)(cmark_simd_find_charset(set, src + i, src + size) - src);
 
     if (i > org)
       cmark_strbuf_put(ob, src + org, i - org);
@@ -58,12 +85,7 @@ int houdini_escape_html0(cmark_strbuf *ob, const uint8_t *src, bufsize_t size,
     if (unlikely(i >= size))
       break;
 
-    /* The forward slash and single quote are only escaped in secure mode */
-    if ((src[i] == '/' || src[i] == '\'') && !secure) {
-      cmark_strbuf_putc(ob, src[i]);
-    } else {
-      cmark_strbuf_puts(ob, HTML_ESCAPES[esc]);
-    }
+    cmark_strbuf_puts(ob, HTML_ESCAPES[(int)HTML_ESCAPE_TABLE[src[i]]]);
 
     i++;
   }
@@ -10,7 +10,11 @@
 #include "scanners.h"
 #include "syntax_extension.h"
 #include "html.h"
+#include "node.h"
+#include "parser.h"
+#include "references.h"
 #include "render.h"
+#include "simd.h"
 
 // Functions to convert cmark_nodes to HTML strings.
 
@@ -61,6 +65,8 @@ static void filter_html_block(cmark_html_renderer *renderer, uint8_t *data, size
 }
 
 static bool S_put_footnote_backref(cmark_html_renderer *renderer, cmark_strbuf *html, cmark_node *node) {
+  int def_count = node->cold ? node->cold->footnote.def_count : 0;
+
   if (renderer->written_footnote_ix >= renderer->footnote_ix)
     return false;
   renderer->written_footnote_ix = renderer->footnote_ix;
@@ -75,9 +81,9 @@ static bool S_put_footnote_backref(cmark_html_renderer *renderer, cmark_strbuf *
   cmark_strbuf_puts(html, m);
   cmark_strbuf_puts(html, "\">↩</a>");
 
-  if (node->footnote.def_count > 1)
+  if (def_count > 1)
   {
-    for(int i = 2; i <= node->footnote.def_count; i++) {
+    for(int i = 2; i <= def_count; i++) {
       char n[32];
       snprintf(n, sizeof(n), "%d", i);
 
@@ -453,14 +459,18 @@ static int S_render_node(cmark_html_renderer *renderer, cmark_node *node,
 
   case CMARK_NODE_FOOTNOTE_REFERENCE:
     if (entering) {
+      cmark_node *def = cmark_node_parent_footnote_def(node);
+      // A copied reference may have lost its definition.
+      cmark_chunk *label = def ? &def->as.literal : &node->as.literal;
+
       cmark_strbuf_puts(html, "<sup class=\"footnote-ref\"><a href=\"#fn-");
-      houdini_escape_href(html, node->parent_footnote_def->as.literal.data, node->parent_footnote_def->as.literal.len);
+      houdini_escape_href(html, label->data, label->len);
       cmark_strbuf_puts(html, "\" id=\"fnref-");
-      houdini_escape_href(html, node->parent_footnote_def->as.literal.data, node->parent_footnote_def->as.literal.len);
+      houdini_escape_href(html, label->data, label->len);
 
-      if (node->footnote.ref_ix > 1) {
+      if (node->cold && node->cold->footnote.ref_ix > 1) {
         char n[32];
-        snprintf(n, sizeof(n), "%d", node->footnote.ref_ix);
+        snprintf(n, sizeof(n), "%d", node->cold->footnote.ref_ix);
         cmark_strbuf_puts(html, "-");
         cmark_strbuf_puts(html, n);
       }
@@ -479,28 +489,589 @@ static int S_render_node(cmark_html_renderer *renderer, cmark_node *node,
   return 1;
 }
 
+static cmark_llist *S_filter_extensions(cmark_mem *mem,
+                                        cmark_llist *extensions) {
+  cmark_llist *filter_extensions = NULL;
+
+  for (; extensions; extensions = extensions->next)
+    if (((cmark_syntax_extension *) extensions->data)->html_filter_func)
+      filter_extensions = cmark_llist_append(
+          mem,
+          filter_extensions,
+          (cmark_syntax_extension *) extensions->data);
+
+  return filter_extensions;
+}
+
+// Writes out what has been rendered so far.  Unless 'all' is set, the last
+// byte is kept back for cmark_html_render_cr to look at.
+static void S_flush(cmark_strbuf *html, cmark_write_func write,
+                    void *userdata, bool all) {
+  bufsize_t len = all || html->size == 0 ? html->size : html->size - 1;
+
+  if (len == 0)
+    return;
+  write((const char *)html->ptr, (size_t)len, userdata);
+  cmark_strbuf_drop(html, len);
+}
+
+static void S_render_tree(cmark_html_renderer *renderer, cmark_node *root,
+                          int options, cmark_write_func write,
+                          void *userdata) {
+  cmark_event_type ev_type;
+  cmark_node *cur;
+  cmark_iter *iter = cmark_iter_new(root);
+
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    S_render_node(renderer, cur, ev_type, options);
+    if (write && renderer->html->size >= CMARK_SINK_CHUNK_SIZE)
+      S_flush(renderer->html, write, userdata, false);
+  }
+
+  cmark_iter_free(iter);
+}
+
 char *cmark_render_html(cmark_node *root, int options, cmark_llist *extensions) {
-  return cmark_render_html_with_mem(root, options, extensions, cmark_node_mem(root));
+  return cmark_render_html_with_mem(root, options, extensions, cmark_node_output_mem(root));
 }
 
 char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *extensions, cmark_mem *mem) {
   char *result;
   cmark_strbuf html = CMARK_BUF_INIT(mem);
-  cmark_event_type ev_type;
-  cmark_node *cur;
   cmark_html_renderer renderer = {&html, NULL, NULL, 0, 0, NULL};
-  cmark_iter *iter = cmark_iter_new(root);
 
-  for (; extensions; extensions = extensions->next)
-    if (((cmark_syntax_extension *) extensions->data)->html_filter_func)
-      renderer.filter_extensions = cmark_llist_append(
-          mem,
-          renderer.filter_extensions,
-          (cmark_syntax_extension *) extensions->data);
+  renderer.filter_extensions = S_filter_extensions(mem, extensions);
 
-  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
-    cur = cmark_iter_get_node(iter);
-    S_render_node(&renderer, cur, ev_type, options);
+  S_render_tree(&renderer, root, options, NULL, NULL);
+
+  if (renderer.footnote_ix) {
+    cmark_strbuf_puts(&html, "</ol>\n</section>\n");
+  }
+
+  result = (char *)cmark_strbuf_detach(&html);
+
+  cmark_llist_free(mem, renderer.filter_extensions);
+
+  return result;
+}
+
+void cmark_render_html_to_sink(cmark_node *root, int options,
+                               cmark_llist *extensions,
+                               cmark_write_func write, void *userdata) {
+  cmark_mem *mem = cmark_node_output_mem(root);
+  cmark_strbuf html = CMARK_BUF_INIT(mem);
+  cmark_html_renderer renderer = {&html, NULL, NULL, 0, 0, NULL};
+
+  renderer.filter_extensions = S_filter_extensions(mem, extensions);
+
+  S_render_tree(&renderer, root, options, write, userdata);
+
+  if (renderer.footnote_ix) {
+    cmark_strbuf_puts(&html, "</ol>\n</section>\n");
+  }
+
+  S_flush(&html, write, userdata, true);
+  cmark_strbuf_free(&html);
+  cmark_llist_free(mem, renderer.filter_extensions);
+}
+
+struct cmark_html_stream {
+  cmark_mem *mem;
+  cmark_parser *parser;
+  int options;
+  cmark_strbuf html;
+  cmark_html_renderer renderer;
+  cmark_write_func write;
+  void *userdata;
+};
+
+static void S_stream_block(cmark_node *block, void *data) {
+  cmark_html_stream *stream = (cmark_html_stream *)data;
+
+  S_render_tree(&stream->renderer, block, stream->options, stream->write,
+                stream->userdata);
+  S_flush(&stream->html, stream->write, stream->userdata, false);
+}
+
+cmark_html_stream *cmark_html_stream_new(cmark_parser *parser, int options,
+                                         cmark_llist *extensions,
+                                         cmark_write_func write,
+                                         void *userdata) {
+  cmark_mem *mem = parser->base_mem;
+  cmark_html_stream *stream =
+      (cmark_html_stream *)cmark_mem_calloc(mem, 1, sizeof(cmark_html_stream));
+
+  stream->mem = mem;
+  stream->parser = parser;
+  stream->options = options;
+  cmark_strbuf_init(mem, &stream->html, 0);
+  stream->renderer.html = &stream->html;
+  stream->renderer.filter_extensions = S_filter_extensions(mem, extensions);
+  stream->write = write;
+  stream->userdata = userdata;
+
+  cmark_parser_set_stream_block_func(parser, S_stream_block, stream);
+  return stream;
+}
+
+void cmark_html_stream_finish(cmark_html_stream *stream) {
+  cmark_html_renderer *renderer = &stream->renderer;
+  cmark_node *doc = cmark_parser_finish(stream->parser);
+
+  // What is left of the document is its footnotes.
+  S_render_tree(renderer, doc, stream->options, stream->write,
+                stream->userdata);
+  cmark_node_free(doc);
+
+  if (renderer->footnote_ix) {
+    cmark_strbuf_puts(&stream->html, "</ol>\n</section>\n");
+  }
+
+  S_flush(&stream->html, stream->write, stream->userdata, true);
+  renderer->footnote_ix = 0;
+  renderer->written_footnote_ix = 0;
+}
+
+void cmark_html_stream_free(cmark_html_stream *stream) {
+  cmark_mem *mem = stream->mem;
+
+  cmark_parser_set_stream_block_func(stream->parser, NULL, NULL);
+  cmark_llist_free(mem, stream->renderer.filter_extensions);
+  cmark_strbuf_free(&stream->html);
+  cmark_mem_free(mem, stream);
+}
+
+// A rendered top-level block in a 'cmark_html_cache'.  The bytes of its
+// lines, then the rest of the key it was rendered for, then its HTML,
+// follow the struct.
+typedef struct cmark_html_cache_entry {
+  struct cmark_html_cache_entry *chain;
+  struct cmark_html_cache_entry *newer;
+  struct cmark_html_cache_entry *older;
+  uint64_t hash;
+  size_t source_len;
+  size_t key_len;
+  size_t html_len;
+} cmark_html_cache_entry;
+
+struct cmark_html_cache {
+  cmark_mem *mem;
+  // Chained hash table of the entries; 'table_size' is a power of two.
+  cmark_html_cache_entry **table;
+  size_t table_size;
+  size_t count;
+  // The ends of the list of entries, in order of use.
+  cmark_html_cache_entry *newest;
+  cmark_html_cache_entry *oldest;
+  size_t size;
+  size_t max_size;
+  size_t hits;
+  size_t misses;
+  // The number given to the last set of reference definitions added.
+  uint64_t serial;
+};
+
+static unsigned char *S_entry_data(cmark_html_cache_entry *entry) {
+  return (unsigned char *)(entry + 1);
+}
+
+cmark_html_cache *cmark_html_cache_new(size_t max_size) {
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_html_cache *cache =
+      (cmark_html_cache *)cmark_mem_calloc(mem, 1, sizeof(cmark_html_cache));
+
+  cache->mem = mem;
+  cache->max_size = max_size;
+  cache->table_size = 64;
+  cache->table = (cmark_html_cache_entry **)cmark_mem_calloc(
+      mem, cache->table_size, sizeof(cmark_html_cache_entry *));
+  return cache;
+}
+
+void cmark_html_cache_free(cmark_html_cache *cache) {
+  cmark_mem *mem = cache->mem;
+  cmark_html_cache_entry *entry, *older;
+
+  for (entry = cache->newest; entry; entry = older) {
+    older = entry->older;
+    cmark_mem_free(mem, entry);
+  }
+  cmark_mem_free(mem, cache->table);
+  cmark_mem_free(mem, cache);
+}
+
+size_t cmark_html_cache_hits(const cmark_html_cache *cache) {
+  return cache->hits;
+}
+
+size_t cmark_html_cache_misses(const cmark_html_cache *cache) {
+  return cache->misses;
+}
+
+size_t cmark_html_cache_size(const cmark_html_cache *cache) {
+  return cache->size;
+}
+
+static void S_cache_unlink(cmark_html_cache *cache,
+                           cmark_html_cache_entry *entry) {
+  if (entry->newer)
+    entry->newer->older = entry->older;
+  else
+    cache->newest = entry->older;
+  if (entry->older)
+    entry->older->newer = entry->newer;
+  else
+    cache->oldest = entry->newer;
+}
+
+static void S_cache_push(cmark_html_cache *cache,
+                         cmark_html_cache_entry *entry) {
+  entry->newer = NULL;
+  entry->older = cache->newest;
+  if (cache->newest)
+    cache->newest->newer = entry;
+  else
+    cache->oldest = entry;
+  cache->newest = entry;
+}
+
+static cmark_html_cache_entry **S_cache_slot(cmark_html_cache *cache,
+                                             uint64_t hash) {
+  return &cache->table[hash & (cache->table_size - 1)];
+}
+
+static cmark_html_cache_entry *
+S_cache_find(cmark_html_cache *cache, uint64_t hash,
+             const unsigned char *source, size_t source_len,
+             const cmark_strbuf *key) {
+  cmark_html_cache_entry *entry;
+
+  for (entry = *S_cache_slot(cache, hash); entry; entry = entry->chain)
+    if (entry->hash == hash && entry->source_len == source_len &&
+        entry->key_len == (size_t)key->size &&
+        memcmp(S_entry_data(entry), source, source_len) == 0 &&
+        memcmp(S_entry_data(entry) + source_len, key->ptr, key->size) == 0)
+      return entry;
+  return NULL;
+}
+
+static void S_cache_remove(cmark_html_cache *cache,
+                           cmark_html_cache_entry *entry) {
+  cmark_html_cache_entry **slot = S_cache_slot(cache, entry->hash);
+
+  while (*slot != entry)
+    slot = &(*slot)->chain;
+  *slot = entry->chain;
+  S_cache_unlink(cache, entry);
+  cache->size -= sizeof(*entry) + entry->source_len + entry->key_len +
+                 entry->html_len;
+  --cache->count;
+  cmark_mem_free(cache->mem, entry);
+}
+
+static void S_cache_grow(cmark_html_cache *cache) {
+  cmark_html_cache_entry **old = cache->table, *entry, *chain, **slot;
+  size_t old_size = cache->table_size, i;
+
+  cache->table_size *= 2;
+  cache->table = (cmark_html_cache_entry **)cmark_mem_calloc(
+      cache->mem, cache->table_size, sizeof(cmark_html_cache_entry *));
+  for (i = 0; i < old_size; ++i) {
+    for (entry = old[i]; entry; entry = chain) {
+      chain = entry->chain;
+      slot = S_cache_slot(cache, entry->hash);
+      entry->chain = *slot;
+      *slot = entry;
+    }
+  }
+  cmark_mem_free(cache->mem, old);
+}
+
+// Adds 'html' as the rendering of the block with 'source' and 'key', then
+// drops the entries used least recently until the cache fits its size
+// again.
+static void S_cache_insert(cmark_html_cache *cache, uint64_t hash,
+                           const unsigned char *source, size_t source_len,
+                           const cmark_strbuf *key, const unsigned char *html,
+                           size_t html_len) {
+  size_t size = sizeof(cmark_html_cache_entry) + source_len +
+                (size_t)key->size + html_len;
+  cmark_html_cache_entry *entry, **slot;
+  unsigned char *data;
+
+  if (size > cache->max_size)
+    return;
+
+  entry = (cmark_html_cache_entry *)cmark_mem_calloc(cache->mem, 1, size);
+  entry->hash = hash;
+  entry->source_len = source_len;
+  entry->key_len = (size_t)key->size;
+  entry->html_len = html_len;
+  data = S_entry_data(entry);
+  memcpy(data, source, source_len);
+  memcpy(data + source_len, key->ptr, key->size);
+  memcpy(data + source_len + key->size, html, html_len);
+
+  if (cache->count >= cache->table_size)
+    S_cache_grow(cache);
+  slot = S_cache_slot(cache, hash);
+  entry->chain = *slot;
+  *slot = entry;
+  S_cache_push(cache, entry);
+  cache->size += size;
+  ++cache->count;
+
+  while (cache->size > cache->max_size)
+    S_cache_remove(cache, cache->oldest);
+}
+
+// Appends 'len' and then the 'len' bytes at 'data' to 'key', so that
+// adjacent fields cannot run into each other.
+static void S_key_put(cmark_strbuf *key, const unsigned char *data,
+                      size_t len) {
+  cmark_strbuf_put(key, (const unsigned char *)&len, sizeof(len));
+  cmark_strbuf_put(key, data, (bufsize_t)len);
+}
+
+static void S_key_put_int(cmark_strbuf *key, int value) {
+  cmark_strbuf_put(key, (const unsigned char *)&value, sizeof(value));
+}
+
+// Appends to 'key' what the definitions elsewhere in the document made of
+// the brackets in 'block': the shape of its tree, which tells which of
+// them became links, where the links went, and the footnotes it refers
+// to.  The shape is the types of the nodes as they are entered, each
+// node's children ending with CMARK_NODE_NONE, gathered in 'shape' to
+// keep the appends few.
+static void S_key_put_targets(cmark_strbuf *key, cmark_node *block) {
+  uint16_t shape[128];
+  size_t n = 0;
+  cmark_node *cur = block, *def;
+
+#define PUT_SHAPE(type)                                                        \
+  do {                                                                         \
+    if (n == sizeof(shape) / sizeof(*shape)) {                                 \
+      cmark_strbuf_put(key, (const unsigned char *)shape, sizeof(shape));      \
+      n = 0;                                                                   \
+    }                                                                          \
+    shape[n++] = (type);                                                       \
+  } while (0)
+
+  for (;;) {
+    PUT_SHAPE(cur->type);
+    switch (cur->type) {
+    case CMARK_NODE_LINK:
+    case CMARK_NODE_IMAGE:
+    case CMARK_NODE_FOOTNOTE_REFERENCE:
+      cmark_strbuf_put(key, (const unsigned char *)shape, n * sizeof(*shape));
+      n = 0;
+      if (cur->type != CMARK_NODE_FOOTNOTE_REFERENCE) {
+        S_key_put(key, cur->as.link.url.data, cur->as.link.url.len);
+        S_key_put(key, cur->as.link.title.data, cur->as.link.title.len);
+        break;
+      }
+      def = cmark_node_parent_footnote_def(cur);
+      if (def)
+        S_key_put(key, def->as.literal.data, def->as.literal.len);
+      S_key_put(key, cur->as.literal.data, cur->as.literal.len);
+      S_key_put_int(key, cur->cold ? cur->cold->footnote.ref_ix : 0);
+      break;
+    default:
+      break;
+    }
+    if (cur->first_child) {
+      cur = cur->first_child;
+      continue;
+    }
+    PUT_SHAPE(CMARK_NODE_NONE);
+    while (cur != block && !cur->next) {
+      cur = cur->parent;
+      PUT_SHAPE(CMARK_NODE_NONE);
+    }
+    if (cur == block)
+      break;
+    cur = cur->next;
+  }
+  cmark_strbuf_put(key, (const unsigned char *)shape, n * sizeof(*shape));
+
+#undef PUT_SHAPE
+}
+
+// Returns the number 'cache' knows the reference definitions of 'document'
+// by, adding them as an entry of their own if they are new, so that the
+// blocks with links can be told apart by the definitions they were parsed
+// with rather than by their trees.  Returns 0 if the document did not keep
+// its definitions, or if some links went unresolved for going over the
+// limit on reference expansion.
+static uint64_t S_cache_definitions(cmark_html_cache *cache,
+                                    cmark_node *document) {
+  cmark_incremental *state = document->as.incremental;
+  cmark_strbuf key = CMARK_BUF_INIT(cache->mem);
+  cmark_html_cache_entry *entry;
+  cmark_map_entry *it;
+  uint64_t hash, serial;
+
+  if (!state || !state->refmap || state->refmap->ref_size_exceeded)
+    return 0;
+
+  for (it = state->refmap->refs; it; it = it->next) {
+    cmark_reference *ref = (cmark_reference *)it;
+    S_key_put(&key, it->label, strlen((const char *)it->label));
+    S_key_put_int(&key, ref->is_attributes_reference);
+    S_key_put(&key, ref->url.data, ref->url.len);
+    S_key_put(&key, ref->title.data, ref->title.len);
+    S_key_put(&key, ref->attributes.data, ref->attributes.len);
+  }
+  hash = cmark_hash_bytes(14695981039346656037u, key.ptr, (size_t)key.size);
+
+  // Blocks always have some bytes of their lines; definitions have none.
+  entry = S_cache_find(cache, hash, (const unsigned char *)"", 0, &key);
+  if (entry) {
+    memcpy(&serial, S_entry_data(entry) + entry->key_len, sizeof(serial));
+    S_cache_unlink(cache, entry);
+    S_cache_push(cache, entry);
+  } else {
+    serial = ++cache->serial;
+    S_cache_insert(cache, hash, (const unsigned char *)"", 0, &key,
+                   (const unsigned char *)&serial, sizeof(serial));
+  }
+  cmark_strbuf_free(&key);
+  return serial;
+}
+
+// Whether the 'len' bytes at 'data' hold "[^".
+static bool S_may_refer_to_footnote(const unsigned char *data, size_t len) {
+  const unsigned char *p = data, *end = data + len;
+
+  while ((p = (const unsigned char *)memchr(p, '[', (size_t)(end - p)))) {
+    if (++p < end && *p == '^')
+      return true;
+  }
+  return false;
+}
+
+// Returns the offsets of the starts of the lines of 'source', followed by
+// 'len', and sets '*count' to the number of lines.
+static size_t *S_line_starts(cmark_mem *mem, const unsigned char *source,
+                             size_t len, size_t *count) {
+  const unsigned char *p = source, *end = source + len;
+  size_t n = 0, alloc = 64;
+  size_t *starts = (size_t *)cmark_mem_calloc(mem, alloc, sizeof(size_t));
+
+  while (p < end) {
+    p = cmark_simd_find_eol(p, end);
+    while (p < end && *p == '\0')
+      p = cmark_simd_find_eol(p + 1, end);
+    if (p < end && *p == '\r')
+      ++p;
+    if (p < end && *p == '\n')
+      ++p;
+    if (++n == alloc) {
+      alloc *= 2;
+      starts = (size_t *)cmark_mem_realloc(mem, starts, alloc * sizeof(size_t));
+    }
+    starts[n] = (size_t)(p - source);
+  }
+  *count = n;
+  return starts;
+}
+
+char *cmark_render_html_cached(cmark_html_cache *cache, cmark_node *root,
+                               const char *source, size_t len, int options,
+                               cmark_llist *extensions, cmark_mem *mem) {
+  cmark_strbuf html = CMARK_BUF_INIT(mem);
+  cmark_strbuf key = CMARK_BUF_INIT(cache->mem);
+  cmark_html_renderer renderer = {&html, NULL, NULL, 0, 0, NULL};
+  const unsigned char *src = (const unsigned char *)source, *span;
+  cmark_html_cache_entry *entry;
+  cmark_node *block, *next;
+  cmark_llist *it;
+  size_t *lines, nlines, span_len;
+  bufsize_t prefix, start;
+  uint64_t seed, hash, definitions = (uint64_t)-1;
+  int end_line;
+  char *result;
+
+  if (root->type != CMARK_NODE_DOCUMENT)
+    return cmark_render_html_with_mem(root, options, extensions, mem);
+
+  renderer.filter_extensions = S_filter_extensions(mem, extensions);
+  lines = S_line_starts(cache->mem, src, len, &nlines);
+
+  S_key_put_int(&key, options);
+  for (it = extensions; it; it = it->next) {
+    const char *name = ((cmark_syntax_extension *)it->data)->name;
+    S_key_put(&key, (const unsigned char *)name, strlen(name));
+  }
+  prefix = key.size;
+  seed = cmark_hash_bytes(14695981039346656037u, key.ptr, (size_t)prefix);
+
+  for (block = root->first_child; block; block = block->next) {
+    // Some blocks end short of the last line that went into them, so the
+    // bytes a block is known by run up to the next block the parser met.
+    // The position a node in it ends at may come from the line that closed
+    // it, which is the first line of that block.
+    for (next = block->next; next; next = next->next)
+      if (next->type != CMARK_NODE_FOOTNOTE_DEFINITION && next->start_line > 0)
+        break;
+    if (!next)
+      end_line = (int)nlines;
+    else if (options & CMARK_OPT_SOURCEPOS)
+      end_line = next->start_line;
+    else
+      end_line = next->start_line - 1;
+    if (end_line < block->end_line)
+      end_line = block->end_line;
+
+    // A block's HTML starts as if after a newline, and footnote
+    // definitions are numbered in the order they are rendered.
+    if (block->type == CMARK_NODE_FOOTNOTE_DEFINITION ||
+        block->start_line <= 0 || (size_t)end_line > nlines ||
+        (html.size && html.ptr[html.size - 1] != '\n')) {
+      S_render_tree(&renderer, block, options, NULL, NULL);
+      continue;
+    }
+
+    span = src + lines[block->start_line - 1];
+    span_len = (size_t)(src + lines[end_line] - span);
+    cmark_strbuf_truncate(&key, prefix);
+    if (options & CMARK_OPT_SOURCEPOS)
+      S_key_put_int(&key, block->start_line);
+    // Only brackets make a block depend on the rest of the document.
+    if (memchr(span, '[', span_len)) {
+      if (definitions == (uint64_t)-1)
+        definitions = S_cache_definitions(cache, root);
+      if (definitions && !((options & CMARK_OPT_FOOTNOTES) &&
+                           S_may_refer_to_footnote(span, span_len))) {
+        S_key_put_int(&key, 1);
+        cmark_strbuf_put(&key, (const unsigned char *)&definitions,
+                         sizeof(definitions));
+      } else {
+        S_key_put_int(&key, 2);
+        S_key_put_targets(&key, block);
+      }
+    }
+    hash = cmark_hash_bytes(seed, span, span_len);
+    hash = cmark_hash_bytes(hash, key.ptr + prefix, (size_t)(key.size - prefix));
+
+    entry = S_cache_find(cache, hash, span, span_len, &key);
+    if (entry) {
+      ++cache->hits;
+      cmark_strbuf_put(&html,
+                       S_entry_data(entry) + entry->source_len +
+                           entry->key_len,
+                       (bufsize_t)entry->html_len);
+      S_cache_unlink(cache, entry);
+      S_cache_push(cache, entry);
+      continue;
+    }
+
+    ++cache->misses;
+    start = html.size;
+    S_render_tree(&renderer, block, options, NULL, NULL);
+    S_cache_insert(cache, hash, span, span_len, &key, html.ptr + start,
+                   (size_t)(html.size - start));
   }
 
   if (renderer.footnote_ix) {
@@ -509,8 +1080,9 @@ char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *ext
 
   result = (char *)cmark_strbuf_detach(&html);
 
+  cmark_mem_free(cache->mem, lines);
+  cmark_strbuf_free(&key);
   cmark_llist_free(mem, renderer.filter_extensions);
 
-  cmark_iter_free(iter);
   return result;
 }
@@ -81,6 +81,10 @@ void cmark_strbuf_put(cmark_strbuf *buf, const unsigned char *data,
 CMARK_GFM_EXPORT
 void cmark_strbuf_puts(cmark_strbuf *buf, const char *string);
 
+/* A cmark_write_func that appends 'data' to the cmark_strbuf 'userdata'. */
+CMARK_GFM_EXPORT
+void cmark_strbuf_write(const char *data, size_t len, void *userdata);
+
 CMARK_GFM_EXPORT
 void cmark_strbuf_clear(cmark_strbuf *buf);
 
@@ -19,7 +19,7 @@ typedef struct cmark_chunk {
 
 static inline void cmark_chunk_free(cmark_mem *mem, cmark_chunk *c) {
   if (c->alloc)
-    mem->free(c->data);
+    cmark_mem_free(mem, c->data);
 
   c->data = NULL;
   c->alloc = 0;
@@ -64,7 +64,7 @@ static inline const char *cmark_chunk_to_cstr(cmark_mem *mem, cmark_chunk *c) {
   if (c->alloc) {
     return (char *)c->data;
   }
-  str = (unsigned char *)mem->calloc(c->len + 1, 1);
+  str = (unsigned char *)cmark_mem_calloc(mem, c->len + 1, 1);
   if (c->len > 0) {
     memcpy(str, c->data, c->len);
   }
@@ -84,12 +84,12 @@ static inline void cmark_chunk_set_cstr(cmark_mem *mem, cmark_chunk *c,
     c->alloc = 0;
   } else {
     c->len = (bufsize_t)strlen(str);
-    c->data = (unsigned char *)mem->calloc(c->len + 1, 1);
+    c->data = (unsigned char *)cmark_mem_calloc(mem, c->len + 1, 1);
     c->alloc = 1;
     memcpy(c->data, str, c->len + 1);
   }
   if (old != NULL) {
-    mem->free(old);
+    cmark_mem_free(mem, old);
   }
 }
 
@@ -266,6 +266,26 @@ typedef void (*cmark_opaque_free_func) (cmark_syntax_extension *extension,
                                         cmark_mem *mem,
                                         cmark_node *node);
 
+typedef void (*cmark_opaque_copy_func) (cmark_syntax_extension *extension,
+                                        cmark_mem *mem,
+                                        cmark_node *dst,
+                                        cmark_node *src);
+
+typedef uint64_t (*cmark_hash_func) (cmark_syntax_extension *extension,
+                                     cmark_node *node,
+                                     uint64_t hash);
+
+typedef size_t (*cmark_serialize_func) (cmark_syntax_extension *extension,
+                                        cmark_node *node,
+                                        unsigned char *buf,
+                                        size_t size);
+
+typedef int (*cmark_deserialize_func) (cmark_syntax_extension *extension,
+                                       cmark_mem *mem,
+                                       cmark_node *node,
+                                       const unsigned char *data,
+                                       size_t len);
+
 /** Free a cmark_syntax_extension.
  */
 CMARK_GFM_EXPORT
@@ -408,6 +428,58 @@ CMARK_GFM_EXPORT
 void cmark_syntax_extension_set_opaque_free_func(cmark_syntax_extension *extension,
                                                  cmark_opaque_free_func func);
 
+/** Sets the function 'cmark_node_copy' calls to give 'dst' a copy of the
+ * opaque data of 'src', allocated from 'mem'.  Nodes of an extension that
+ * frees its opaque data but has no copy function cannot be copied.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_opaque_copy_func(cmark_syntax_extension *extension,
+                                                 cmark_opaque_copy_func func);
+
+/** Sets the function 'cmark_node_hash' calls to mix the data the extension
+ * keeps for 'node' into 'hash', typically with 'cmark_hash_bytes', and
+ * return the result.  Extensions that keep data in 'as.opaque' or that
+ * change it outside of the node accessors need one, and must call
+ * 'cmark_node_invalidate_hash' when they change it.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_hash_func(cmark_syntax_extension *extension,
+                                          cmark_hash_func func);
+
+/** Sets the function 'cmark_node_serialize' calls to write the data the
+ * extension keeps for 'node'.  It writes at most 'size' bytes to 'buf' and
+ * returns the number of bytes the data takes, and is called again with a
+ * buffer of that size if it did not fit.  Nodes of an extension that frees
+ * its opaque data but has no serialize function cannot be serialized.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_serialize_func(cmark_syntax_extension *extension,
+                                               cmark_serialize_func func);
+
+/** Sets the function 'cmark_node_deserialize' calls to restore the data
+ * the serialize function wrote for 'node', allocating from 'mem'.  'node'
+ * is already linked to its parent and has its type, its position and the
+ * opaque data the extension's opaque alloc function gives it, but not its
+ * children yet.  Returns 1 on success, or 0 if 'data' is not valid for
+ * 'node' where it is, in which case loading fails.  Since the data may
+ * come from anywhere, the function should check everything the renderers
+ * rely on.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_deserialize_func(cmark_syntax_extension *extension,
+                                                 cmark_deserialize_func func);
+
+/** Returns 'hash' with 'len' bytes at 'data' mixed in.
+ */
+CMARK_GFM_EXPORT
+uint64_t cmark_hash_bytes(uint64_t hash, const void *data, size_t len);
+
+/** Drops the cached structural hashes of 'node' and its ancestors, for
+ * extensions that change a node without going through the accessors.
+ */
+CMARK_GFM_EXPORT
+void cmark_node_invalidate_hash(cmark_node *node);
+
 /** See the documentation for 'cmark_syntax_extension'
  */
 CMARK_GFM_EXPORT
@@ -732,6 +804,37 @@ void cmark_arena_push(void);
 CMARK_GFM_EXPORT
 int cmark_arena_pop(void);
 
+/** Like 'cmark_arena_push', but on the arena behind 'mem'.  Does nothing
+ * if 'mem' is not an arena allocator.
+ */
+CMARK_GFM_EXPORT
+void cmark_arena_push_mem(cmark_mem *mem);
+
+/** Like 'cmark_arena_pop', but on the arena behind 'mem'.  Returns 0 if
+ * 'mem' is not an arena allocator.
+ */
+CMARK_GFM_EXPORT
+int cmark_arena_pop_mem(cmark_mem *mem);
+
+/** Returns the arena object behind 'mem', or NULL if 'mem' is not the
+ * allocator of an arena object.
+ */
+CMARK_GFM_EXPORT
+cmark_arena *cmark_arena_from_mem(cmark_mem *mem);
+
+/** Makes renderers allocate the results for nodes in 'arena' from 'mem'
+ * instead, so that they can be freed, and outlive the arena, as usual.
+ * Documents built with 'CMARK_OPT_DOCUMENT_ARENA' have this set to the
+ * allocator they were built with.
+ */
+CMARK_GFM_EXPORT
+void cmark_arena_set_output_mem(cmark_arena *arena, cmark_mem *mem);
+
+/** Returns what 'cmark_arena_set_output_mem' set for 'arena', or NULL.
+ */
+CMARK_GFM_EXPORT
+cmark_mem *cmark_arena_output_mem(cmark_arena *arena);
+
 #ifdef __cplusplus
 }
 #endif
@@ -100,14 +100,43 @@ typedef struct cmark_syntax_extension cmark_syntax_extension;
  */
 
 /** Defines the memory allocation functions to be used by CMark
- * when parsing and allocating a document tree
+ * when parsing and allocating a document tree.  An allocator that needs
+ * state of its own sets 'ctx_calloc', 'ctx_realloc' and 'ctx_free',
+ * which are passed 'ctx' and are then used instead of the first three.
  */
 typedef struct cmark_mem {
   void *(*calloc)(size_t, size_t);
   void *(*realloc)(void *, size_t);
   void (*free)(void *);
+  void *(*ctx_calloc)(void *, size_t, size_t);
+  void *(*ctx_realloc)(void *, void *, size_t);
+  void (*ctx_free)(void *, void *);
+  void *ctx;
 } cmark_mem;
 
+/** Allocates with 'mem', through its context functions if it has them.
+ * Code that allocates with a 'cmark_mem' it did not set up itself, such
+ * as a parser's or a node's, should use these rather than calling the
+ * functions in the struct.
+ */
+static inline void *cmark_mem_calloc(cmark_mem *mem, size_t nmem,
+                                     size_t size) {
+  return mem->ctx_calloc ? mem->ctx_calloc(mem->ctx, nmem, size)
+                         : mem->calloc(nmem, size);
+}
+
+static inline void *cmark_mem_realloc(cmark_mem *mem, void *ptr, size_t size) {
+  return mem->ctx_calloc ? mem->ctx_realloc(mem->ctx, ptr, size)
+                         : mem->realloc(ptr, size);
+}
+
+static inline void cmark_mem_free(cmark_mem *mem, void *ptr) {
+  if (mem->ctx_calloc)
+    mem->ctx_free(mem->ctx, ptr);
+  else
+    mem->free(ptr);
+}
+
 /** The default memory allocator; uses the system's calloc,
  * realloc and free.
  */
@@ -121,11 +150,83 @@ CMARK_GFM_EXPORT
 cmark_mem *cmark_get_arena_mem_allocator(void);
 
 /** Resets the arena allocator, quickly returning all used memory
- * to the operating system.
+ * to the operating system, or rewinding it for reuse if the global
+ * arena was set up with 'CMARK_ARENA_RETAIN'.
  */
 CMARK_GFM_EXPORT
 void cmark_arena_reset(void);
 
+/** Keep an arena's chunks when it is reset or cleared, up to its
+ * high-water mark, and rewind them for the next document instead of
+ * allocating fresh ones.  Only the bytes that were used are re-zeroed.
+ */
+#define CMARK_ARENA_RETAIN (1 << 0)
+
+/** Back an arena's chunks with anonymous 'mmap' pages.  Rewinding a
+ * retained chunk that saw heavy use then returns its pages to the
+ * operating system with 'madvise(MADV_DONTNEED)' rather than zeroing
+ * them.  Ignored on systems other than Linux.
+ */
+#define CMARK_ARENA_MMAP (1 << 1)
+
+/** Sets the options ('CMARK_ARENA_RETAIN', 'CMARK_ARENA_MMAP') of the
+ * global arena, and the number of bytes of chunks it may keep across
+ * 'cmark_arena_reset'.  Frees any chunks it currently keeps.
+ */
+CMARK_GFM_EXPORT
+void cmark_arena_set_global_options(int options, size_t high_water);
+
+/** An arena object.  Unlike the global arena returned by
+ * 'cmark_get_arena_mem_allocator', each arena object is meant to be
+ * used by a single parser at a time and allocates without locking.
+ */
+typedef struct cmark_arena cmark_arena;
+
+/** Creates a new, empty arena.
+ */
+CMARK_GFM_EXPORT
+cmark_arena *cmark_arena_new(void);
+
+/** Like 'cmark_arena_new', with the given options ('CMARK_ARENA_RETAIN',
+ * 'CMARK_ARENA_MMAP') and the number of bytes of chunks the arena may
+ * keep across 'cmark_arena_clear'.
+ */
+CMARK_GFM_EXPORT
+cmark_arena *cmark_arena_new_with_options(int options, size_t high_water);
+
+/** Returns an allocator that carves memory out of 'arena', through the
+ * context functions of 'cmark_mem'.  Pass it to
+ * 'cmark_parser_new_with_mem', or use 'cmark_parser_new_with_arena'; the
+ * parser and every node it creates then live in the arena.
+ */
+CMARK_GFM_EXPORT
+cmark_mem *cmark_arena_get_mem(cmark_arena *arena);
+
+/** Returns all memory used by 'arena' to the operating system, or keeps
+ * it for reuse if the arena was created with 'CMARK_ARENA_RETAIN'.  The
+ * arena stays usable; anything allocated from it before is invalid.
+ */
+CMARK_GFM_EXPORT
+void cmark_arena_clear(cmark_arena *arena);
+
+/** Returns the number of bytes 'arena' currently holds from the
+ * operating system.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_arena_size(cmark_arena *arena);
+
+/** Returns the number of bytes in 'arena' that were abandoned since it
+ * was last cleared because a reallocation could not grow a block in
+ * place and had to copy it elsewhere.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_arena_wasted(cmark_arena *arena);
+
+/** Frees 'arena' and all memory allocated from it.
+ */
+CMARK_GFM_EXPORT
+void cmark_arena_free(cmark_arena *arena);
+
 /** Callback for freeing user data with a 'cmark_mem' context.
  */
 typedef void (*cmark_free_func) (cmark_mem *mem, void *user_data);
@@ -196,10 +297,21 @@ CMARK_GFM_EXPORT cmark_node *cmark_node_new_with_mem_and_ext(cmark_node_type typ
                                                 cmark_mem *mem,
                                                 cmark_syntax_extension *extension);
 
-/** Frees the memory allocated for a node and any children.
+/** Frees the memory allocated for a node and any children.  A document
+ * parsed with 'CMARK_OPT_DOCUMENT_ARENA' is freed in one step together
+ * with its arena; see there.
  */
 CMARK_GFM_EXPORT void cmark_node_free(cmark_node *node);
 
+/** Returns a deep copy of 'node' and its children allocated from 'mem',
+ * or NULL if one of them belongs to an extension whose data cannot be
+ * copied.  The copy does not share memory with 'node', so it survives
+ * freeing the document 'node' came from.  User data is copied as a
+ * pointer, without its free function.  A footnote reference whose
+ * definition is not copied along with it loses the link to it.
+ */
+CMARK_GFM_EXPORT cmark_node *cmark_node_copy(cmark_node *node, cmark_mem *mem);
+
 /**
  * ## Tree Traversal
  */
@@ -568,6 +680,81 @@ CMARK_GFM_EXPORT void cmark_consolidate_text_nodes(cmark_node *root);
  */
 CMARK_GFM_EXPORT void cmark_node_own(cmark_node *root);
 
+/**
+ * ## Structural Hashes
+ */
+
+/** Returns a 64-bit hash of the structure of 'node': its type, what its
+ * accessors return apart from its position (literal, url, title, fence
+ * info and so on), what its syntax extension contributes, and the hashes
+ * of its children in order.  Equal subtrees hash equal wherever they are in
+ * their documents, so unchanged blocks keep their hashes when lines are
+ * inserted above them.
+ *
+ * Hashes are cached on the nodes.  The accessors and tree manipulation
+ * functions above drop the cached hash of the node they change and of its
+ * ancestors, so asking again only hashes those.  Copies made with
+ * 'cmark_node_copy' keep the hashes of their originals.
+ */
+CMARK_GFM_EXPORT uint64_t cmark_node_hash(cmark_node *node);
+
+/** Called by 'cmark_node_diff' for each change: with both nodes when
+ * 'new_node' replaces 'old_node', with NULL for 'old_node' when 'new_node'
+ * was inserted, and with NULL for 'new_node' when 'old_node' was removed.
+ */
+typedef void (*cmark_diff_func)(cmark_node *old_node, cmark_node *new_node,
+                                void *userdata);
+
+/** Compares the trees under 'old_root' and 'new_root' top-down by their
+ * structural hashes, skipping the subtrees that hash equal, and calls
+ * 'func' (if not NULL) in document order for the smallest subtrees that
+ * differ.  Nodes that differ only in their children are not reported
+ * themselves; the children in between the ones both sides share at either
+ * end are matched in order, taking a child that equals the next one on the
+ * other side as inserted or removed.  Returns the number of changes.
+ */
+CMARK_GFM_EXPORT int cmark_node_diff(cmark_node *old_root, cmark_node *new_root,
+                                     cmark_diff_func func, void *userdata);
+
+/**
+ * ## Serialization
+ */
+
+/** Writes the tree under 'root' in a compact binary form that
+ * 'cmark_node_deserialize' reads back without parsing: the types,
+ * positions and contents of the nodes, and what their syntax extensions
+ * write for them.  User data and the state 'cmark_parser_reparse' keeps
+ * are left out.  Returns a buffer allocated with 'mem' and sets '*len' to
+ * its length, or returns NULL if a node's extension keeps data it cannot
+ * write.
+ */
+CMARK_GFM_EXPORT unsigned char *cmark_node_serialize(cmark_node *root,
+                                                     cmark_mem *mem,
+                                                     size_t *len);
+
+/** Rebuilds a tree written by 'cmark_node_serialize' from the 'len' bytes
+ * at 'data', allocating it with 'mem', or in an arena of its own that is
+ * freed with it if 'options' has 'CMARK_OPT_DOCUMENT_ARENA'.  The syntax
+ * extensions the nodes use must be registered (see
+ * 'cmark_find_syntax_extension'), in the same order as when the tree was
+ * written if they add node types.  Returns NULL if 'data' is not such a
+ * tree, including one that was cut short or that would not be a valid
+ * tree here.
+ */
+CMARK_GFM_EXPORT cmark_node *cmark_node_deserialize(const unsigned char *data,
+                                                    size_t len, int options,
+                                                    cmark_mem *mem);
+
+/** As for 'cmark_node_deserialize', but the strings of the tree point into
+ * 'data' instead of being copied, so that loading only builds the nodes.
+ * 'data' is never written to, so it may be read-only memory such as a file
+ * mapped with PROT_READ, and must stay unchanged until the tree is freed
+ * (or until 'cmark_node_own' copies the strings).
+ */
+CMARK_GFM_EXPORT cmark_node *
+cmark_node_deserialize_in_place(const unsigned char *data, size_t len,
+                                int options, cmark_mem *mem);
+
 /**
  * ## Parsing
  *
@@ -600,6 +787,13 @@ cmark_parser *cmark_parser_new(int options);
 CMARK_GFM_EXPORT
 cmark_parser *cmark_parser_new_with_mem(int options, cmark_mem *mem);
 
+/** Creates a new parser object that allocates the parser and every node
+ * it creates in 'arena', as with 'cmark_arena_get_mem'.  The arena must
+ * outlive the parser and the documents it builds.
+ */
+CMARK_GFM_EXPORT
+cmark_parser *cmark_parser_new_with_arena(int options, cmark_arena *arena);
+
 /** Frees memory allocated for a parser object.
  */
 CMARK_GFM_EXPORT
@@ -610,11 +804,154 @@ void cmark_parser_free(cmark_parser *parser);
 CMARK_GFM_EXPORT
 void cmark_parser_feed(cmark_parser *parser, const char *buffer, size_t len);
 
+/** As for 'cmark_parser_feed', but complete lines are parsed directly
+ * out of 'buffer' instead of being copied into the parser first. Only
+ * lines that span calls, contain NUL bytes, end in a carriage return or
+ * fail UTF-8 validation are copied. 'buffer' is never written to, so it
+ * may be read-only memory such as a file mapped with PROT_READ.  A parser
+ * set to use several threads ('cmark_parser_set_threads') copies all of
+ * its input nonetheless, to hold it until 'cmark_parser_finish'.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_feed_in_place(cmark_parser *parser, const char *buffer,
+                                size_t len);
+
 /** Finish parsing and return a pointer to a tree of nodes.
  */
 CMARK_GFM_EXPORT
 cmark_node *cmark_parser_finish(cmark_parser *parser);
 
+/** Called with each block 'cmark_parser_set_stream_block_func' streams.
+ */
+typedef void (*cmark_stream_block_func)(cmark_node *block, void *data);
+
+/** Streams the document instead of building all of it: as soon as a
+ * direct child of the document is closed, it is parsed for inlines and
+ * passed to 'func' with 'data', and freed when 'func' returns (use
+ * 'cmark_node_copy' to keep it).  The block is still linked into the
+ * document during the call, so it renders as it would in place.
+ * 'cmark_parser_finish' streams the remaining blocks and returns the
+ * document without them.
+ *
+ * Links are resolved against the reference definitions seen so far: a
+ * link to a definition that comes after it is left as literal text, as
+ * if the definition did not exist.  With 'CMARK_OPT_FOOTNOTES', a block
+ * that refers to a footnote not defined yet is held back, along with the
+ * blocks after it, until the definition is seen; a reference to a
+ * footnote that is never defined is turned into text when the document
+ * is finished, as it is in a whole document.  The definitions are kept
+ * back too: the document 'cmark_parser_finish' returns holds the
+ * referenced ones, in order.  A document built
+ * in an arena of its own ('CMARK_OPT_DOCUMENT_ARENA') does not get memory
+ * back from the blocks freed.  Pass NULL to build the whole document
+ * again.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_stream_block_func(cmark_parser *parser,
+                                        cmark_stream_block_func func,
+                                        void *data);
+
+/** Lets the parser use up to 'threads' threads; 0 or 1, the default,
+ * parses on the calling thread only.  The input fed to the parser is then
+ * copied and held until 'cmark_parser_finish' (or, if the parser's
+ * allocator cannot grow the copy, parsed on the calling thread as it
+ * comes), and 'cmark_parser_finish' cuts a large document at blank
+ * lines between top-level blocks, parses the blocks of the pieces side by
+ * side and joins them up, and parses the inline content of the blocks on
+ * several threads too.  The tree is the same either way.  Small documents
+ * are still parsed on one thread, and so is a document streamed with
+ * 'cmark_parser_set_stream_block_func' or built with
+ * 'CMARK_OPT_DOCUMENT_ARENA'.  Call this before feeding the parser.  The
+ * parser's allocator and the syntax extensions attached to it must be safe
+ * to call from several threads at once; the default allocator and the core
+ * extensions are.  Has no effect unless the library was built with
+ * CMARK_THREADING.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_threads(cmark_parser *parser, int threads);
+
+/** The places where a document can be cut into pieces that are parsed on
+ * their own, as returned by 'cmark_parser_split'.
+ */
+typedef struct cmark_split cmark_split;
+
+/** Finds places in 'buffer', of length 'len', where the document can be
+ * cut so that each piece parses into the same blocks as it does as part of
+ * the whole, with pieces of at least 'piece_size' bytes where the document
+ * allows.  Pieces start at blank lines before top-level blocks, and only
+ * where every block still open would be closed there anyway.  Uses the
+ * options and syntax extensions of 'parser', which must not have been fed
+ * yet, and resets it afterwards.  Free the result with
+ * 'cmark_split_free'.
+ *
+ * To parse a piece, feed a parser the string returned by
+ * 'cmark_split_references' for the piece, then the bytes of the piece.
+ * The HTML rendered for the pieces, one after the other, is then the HTML
+ * of the whole document.  Source positions are relative to each piece,
+ * footnotes are numbered within each piece, and the limit on how much
+ * text references may expand to applies to each piece on its own.
+ */
+CMARK_GFM_EXPORT
+cmark_split *cmark_parser_split(cmark_parser *parser, const char *buffer,
+                                size_t len, size_t piece_size);
+
+/** Returns the number of pieces in 'split', which is at least one.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_split_count(const cmark_split *split);
+
+/** Returns the byte offset at which 'piece' starts.  Passing
+ * 'cmark_split_count' returns the end of the input.  The first piece
+ * starts after the byte order mark, if the input has one.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_split_offset(const cmark_split *split, size_t piece);
+
+/** Returns, as Markdown, the link reference definitions of the document
+ * that 'piece' needs and does not hold itself: the ones that links resolve
+ * to, whichever piece they are in, followed by a blank line, or an empty
+ * string if there are none.  The string is allocated with the allocator of
+ * the parser passed to 'cmark_parser_split', and must be freed with it.
+ */
+CMARK_GFM_EXPORT
+char *cmark_split_references(const cmark_split *split, size_t piece);
+
+/** Frees the memory allocated for 'split'.
+ */
+CMARK_GFM_EXPORT
+void cmark_split_free(cmark_split *split);
+
+/** Brings 'document', parsed from 'old_text' of length 'old_len', up to date
+ * with an edit that replaces the 'removed' bytes at 'offset' with the
+ * 'inserted_len' bytes at 'inserted'.  Only the top-level blocks the edit
+ * can reach are parsed again: from the last one before the edit that
+ * starts after a blank line, up to the first one after it that the new text
+ * leaves as it was.  The blocks after it keep their nodes, and their line
+ * numbers move with the lines the edit adds or removes.  The whole text is
+ * parsed again if the document was not parsed with
+ * 'CMARK_OPT_INCREMENTAL', or if the text parsed again holds, or held, a
+ * reference definition or, with 'CMARK_OPT_FOOTNOTES', there are
+ * footnotes.  The block to start from is looked for from where the
+ * previous edit was parsed, so a run of nearby edits only scans the lines
+ * between them; between edits, 'document' must not be changed other than
+ * through this function.
+ *
+ * 'parser' must have the options, syntax extensions and allocator
+ * 'document' was parsed with, and must not have been fed; it is reset
+ * afterwards.  The blocks taken out of 'document' are returned, in order,
+ * as the children of a new document node, to be freed with
+ * 'cmark_node_free'.  '*first' and '*last', when not NULL, are set to the
+ * first and last of the new blocks, or to NULL if there are none.  Returns
+ * NULL, changing nothing, if the edit is out of range, if 'document' was
+ * parsed with 'CMARK_OPT_DOCUMENT_ARENA', or if 'parser' streams blocks.
+ */
+CMARK_GFM_EXPORT
+cmark_node *cmark_parser_reparse(cmark_parser *parser, cmark_node *document,
+                                 const char *old_text, size_t old_len,
+                                 size_t offset, size_t removed,
+                                 const char *inserted, size_t inserted_len,
+                                 cmark_node **first, cmark_node **last);
+
 /** Parse a CommonMark document in 'buffer' of length 'len'.
  * Returns a pointer to a tree of nodes.  The memory allocated for
  * the node tree should be released using 'cmark_node_free'
@@ -634,6 +971,12 @@ cmark_node *cmark_parse_file(FILE *f, int options);
  * ## Rendering
  */
 
+/** Called by the '_to_sink' renderers and 'cmark_html_stream' with each
+ * piece of output they write.  'cmark_strbuf_write' appends the output to
+ * a 'cmark_strbuf'.
+ */
+typedef void (*cmark_write_func)(const char *data, size_t len, void *userdata);
+
 /** Render a 'node' tree as XML.  It is the caller's responsibility
  * to free the returned buffer.
  */
@@ -646,6 +989,13 @@ char *cmark_render_xml(cmark_node *root, int options);
 CMARK_GFM_EXPORT
 char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem);
 
+/** As for 'cmark_render_xml', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_xml_to_sink(cmark_node *root, int options,
+                              cmark_write_func write, void *userdata);
+
 /** Render a 'node' tree as an HTML fragment.  It is up to the user
  * to add an appropriate header and footer. It is the caller's
  * responsibility to free the returned buffer.
@@ -659,6 +1009,95 @@ char *cmark_render_html(cmark_node *root, int options, cmark_llist *extensions);
 CMARK_GFM_EXPORT
 char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *extensions, cmark_mem *mem);
 
+/** As for 'cmark_render_html', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_html_to_sink(cmark_node *root, int options,
+                               cmark_llist *extensions,
+                               cmark_write_func write, void *userdata);
+
+typedef struct cmark_html_stream cmark_html_stream;
+
+/** Renders the documents fed to 'parser' as HTML while they are parsed.
+ * Each top-level block is written to 'write' with 'userdata' as soon as
+ * it is closed, so the output held at any time is one block's worth.
+ * See 'cmark_parser_set_stream_block_func' for which links and footnotes
+ * resolve in this mode.  The stream takes over the parser's stream block
+ * function until it is freed.
+ */
+CMARK_GFM_EXPORT
+cmark_html_stream *cmark_html_stream_new(cmark_parser *parser, int options,
+                                         cmark_llist *extensions,
+                                         cmark_write_func write,
+                                         void *userdata);
+
+/** Finishes the document fed to the stream's parser and writes the rest
+ * of it, ending with the footnotes.  The parser is then ready for the
+ * next document.
+ */
+CMARK_GFM_EXPORT
+void cmark_html_stream_finish(cmark_html_stream *stream);
+
+/** Frees the stream, and stops its parser from streaming.
+ */
+CMARK_GFM_EXPORT
+void cmark_html_stream_free(cmark_html_stream *stream);
+
+/** A cache of the HTML of top-level blocks, for
+ * 'cmark_render_html_cached'.  A cache is not safe to use from several
+ * threads at once.
+ */
+typedef struct cmark_html_cache cmark_html_cache;
+
+/** Creates an empty cache that holds at most 'max_size' bytes, dropping
+ * the blocks used least recently to stay under it.
+ */
+CMARK_GFM_EXPORT
+cmark_html_cache *cmark_html_cache_new(size_t max_size);
+
+/** Frees 'cache' and everything it holds.
+ */
+CMARK_GFM_EXPORT
+void cmark_html_cache_free(cmark_html_cache *cache);
+
+/** As for 'cmark_render_html_with_mem', but takes the HTML of each
+ * top-level block of the document 'root' from 'cache' when it was rendered
+ * before, and adds the blocks it renders.  'source', of length 'len', is
+ * the text 'root' was parsed from.  A block is looked up by the bytes of
+ * its lines, 'options', the names of 'extensions' and, with
+ * 'CMARK_OPT_SOURCEPOS', the line it starts at.  A block with brackets in
+ * it also depends on the reference definitions it was parsed with: on all
+ * of the document's when it was parsed with 'CMARK_OPT_INCREMENTAL', or
+ * else, and for footnote references, on the links and footnotes it ended
+ * up with, which takes a walk over its nodes.  Footnote definitions and
+ * blocks without a source position are always rendered.  The document
+ * must not have been changed since it was parsed from 'source', other than
+ * by 'cmark_parser_reparse', and the HTML renderers of 'extensions' must
+ * not carry state from one top-level block to the next.
+ */
+CMARK_GFM_EXPORT
+char *cmark_render_html_cached(cmark_html_cache *cache, cmark_node *root,
+                               const char *source, size_t len, int options,
+                               cmark_llist *extensions, cmark_mem *mem);
+
+/** Returns the number of blocks 'cmark_render_html_cached' found in
+ * 'cache'.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_html_cache_hits(const cmark_html_cache *cache);
+
+/** Returns the number of blocks 'cmark_render_html_cached' looked up in
+ * 'cache' without finding them.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_html_cache_misses(const cmark_html_cache *cache);
+
+/** Returns the number of bytes 'cache' holds.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_html_cache_size(const cmark_html_cache *cache);
+
 /** Render a 'node' tree as a groff man page, without the header.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -671,6 +1110,13 @@ char *cmark_render_man(cmark_node *root, int options, int width);
 CMARK_GFM_EXPORT
 char *cmark_render_man_with_mem(cmark_node *root, int options, int width, cmark_mem *mem);
 
+/** As for 'cmark_render_man', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_man_to_sink(cmark_node *root, int options, int width,
+                              cmark_write_func write, void *userdata);
+
 /** Render a 'node' tree as a commonmark document.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -683,6 +1129,13 @@ char *cmark_render_commonmark(cmark_node *root, int options, int width);
 CMARK_GFM_EXPORT
 char *cmark_render_commonmark_with_mem(cmark_node *root, int options, int width, cmark_mem *mem);
 
+/** As for 'cmark_render_commonmark', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_commonmark_to_sink(cmark_node *root, int options, int width,
+                                     cmark_write_func write, void *userdata);
+
 /** Render a 'node' tree as a plain text document.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -695,6 +1148,13 @@ char *cmark_render_plaintext(cmark_node *root, int options, int width);
 CMARK_GFM_EXPORT
 char *cmark_render_plaintext_with_mem(cmark_node *root, int options, int width, cmark_mem *mem);
 
+/** As for 'cmark_render_plaintext', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_plaintext_to_sink(cmark_node *root, int options, int width,
+                                    cmark_write_func write, void *userdata);
+
 /** Render a 'node' tree as a LaTeX document.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -707,6 +1167,13 @@ char *cmark_render_latex(cmark_node *root, int options, int width);
 CMARK_GFM_EXPORT
 char *cmark_render_latex_with_mem(cmark_node *root, int options, int width, cmark_mem *mem);
 
+/** As for 'cmark_render_latex', but passing the output to 'write' with
+ * 'userdata', a piece at a time, instead of returning it.
+ */
+CMARK_GFM_EXPORT
+void cmark_render_latex_to_sink(cmark_node *root, int options, int width,
+                                cmark_write_func write, void *userdata);
+
 /**
  * ## Options
  */
@@ -811,6 +1278,26 @@ char *cmark_render_latex_with_mem(cmark_node *root, int options, int width, cmar
  */
 #define CMARK_OPT_TABLE_ROWSPAN_DITTO (1 << 21)
 
+/** Build every document in an arena object of its own, so that
+ * 'cmark_node_free' on the document releases all of its nodes and strings
+ * at once instead of visiting them.  Nodes unlinked from such a document
+ * stay valid only until it is freed (use 'cmark_node_copy' to keep one).
+ * Nodes from another allocator cannot be inserted into it: the functions
+ * that insert nodes refuse them and return 0, leaving them to the caller
+ * to free.  Create nodes for it with 'cmark_node_new_with_mem' and
+ * 'cmark_node_mem' of the document.
+ * Rendered output still comes from the parser's allocator, to be freed by
+ * the caller as usual.  The user data free functions of the document's own
+ * nodes are not called.  Every such document holds an arena object until
+ * it is freed; any number of them may be live at once.
+ */
+#define CMARK_OPT_DOCUMENT_ARENA (1 << 22)
+
+/** Keep the reference definitions of the document with it, so that it can
+ * be passed to 'cmark_parser_reparse' after an edit.
+ */
+#define CMARK_OPT_INCREMENTAL (1 << 23)
+
 /**
  * ## Version information
  */
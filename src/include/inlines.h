@@ -29,6 +29,16 @@ bufsize_t cmark_parse_reference_attributes_inline(cmark_mem *mem, cmark_chunk *i
 void cmark_inlines_add_special_character(cmark_parser *parser, unsigned char c, bool emphasis);
 void cmark_inlines_remove_special_character(cmark_parser *parser, unsigned char c, bool emphasis);
 
+/** Sets up the parser's pools of delimiter and bracket stack entries.
+ */
+void cmark_inlines_init_pools(cmark_parser *parser);
+
+/** Builds the tables 'cmark_parse_inlines' would otherwise build on first
+ * use, so that copies of 'parser' made afterwards can parse inlines on
+ * several threads without writing to anything they share.
+ */
+void cmark_inlines_prepare(cmark_parser *parser, int options);
+
 void cmark_set_default_skip_chars(int8_t **skip_chars, bool use_memcpy);
 void cmark_set_default_special_chars(int8_t **special_chars, bool use_memcpy);
 
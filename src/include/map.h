@@ -1,6 +1,9 @@
 #ifndef CMARK_MAP_H
 #define CMARK_MAP_H
 
+#include <stdbool.h>
+
+#include "buffer.h"
 #include "chunk.h"
 
 #ifdef __cplusplus
@@ -12,6 +15,7 @@ struct cmark_map_entry {
   unsigned char *label;
   size_t age;
   size_t size;
+  uint32_t hash;
 };
 
 typedef struct cmark_map_entry cmark_map_entry;
@@ -23,11 +27,19 @@ typedef void (*cmark_map_free_f)(struct cmark_map *, cmark_map_entry *);
 struct cmark_map {
   cmark_mem *mem;
   cmark_map_entry *refs;
-  cmark_map_entry **sorted;
+  // Open-addressing table of the first entry for each distinct label;
+  // 'table_size' is zero or a power of two.
+  cmark_map_entry **table;
+  size_t table_size;
+  size_t num_labels;
   size_t size;
   size_t ref_size;
   size_t max_ref_size;
+  // Set when a lookup is refused for going over 'max_ref_size'.
+  bool ref_size_exceeded;
   cmark_map_free_f free;
+  // Reused for normalizing labels during lookup.
+  cmark_strbuf scratch;
 };
 
 typedef struct cmark_map cmark_map;
@@ -35,7 +47,14 @@ typedef struct cmark_map cmark_map;
 unsigned char *normalize_map_label(cmark_mem *mem, cmark_chunk *ref);
 cmark_map *cmark_map_new(cmark_mem *mem, cmark_map_free_f free);
 void cmark_map_free(cmark_map *map);
+void cmark_map_insert(cmark_map *map, cmark_map_entry *entry);
 cmark_map_entry *cmark_map_lookup(cmark_map *map, cmark_chunk *label);
+// Whether lookups of the label of 'entry' find it, rather than an earlier
+// entry with the same label.
+bool cmark_map_entry_found(cmark_map *map, cmark_map_entry *entry);
+// Moves the entries of 'from' to 'map', as if inserted after those already
+// in it, and leaves 'from' empty.
+void cmark_map_append(cmark_map *map, cmark_map *from);
 
 #ifdef __cplusplus
 }
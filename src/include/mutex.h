@@ -28,6 +28,32 @@ pthread_mutex_lock(&NAME##_lock);
 
 #define CMARK_UNLOCK(NAME) pthread_mutex_unlock(&NAME##_lock);
 
+#define CMARK_HAVE_THREADS 1
+
+typedef pthread_t cmark_thread;
+typedef pthread_mutex_t cmark_mutex;
+
+#define CMARK_THREAD_FUNC(NAME, ARG) static void *NAME(void *ARG)
+#define CMARK_THREAD_RETURN return NULL
+#define CMARK_THREAD_START(THREAD, FUNC, ARG) \
+  (pthread_create(&(THREAD), NULL, FUNC, ARG) == 0)
+#define CMARK_THREAD_JOIN(THREAD) pthread_join(THREAD, NULL)
+
+#define CMARK_MUTEX_INIT(MUTEX) pthread_mutex_init(&(MUTEX), NULL)
+#define CMARK_MUTEX_LOCK(MUTEX) pthread_mutex_lock(&(MUTEX))
+#define CMARK_MUTEX_UNLOCK(MUTEX) pthread_mutex_unlock(&(MUTEX))
+#define CMARK_MUTEX_DESTROY(MUTEX) pthread_mutex_destroy(&(MUTEX))
+
+typedef int cmark_atomic_int;
+
+#define CMARK_ATOMIC_LOAD(PTR) __atomic_load_n((PTR), __ATOMIC_ACQUIRE)
+#define CMARK_ATOMIC_STORE(PTR, VAL) \
+  __atomic_store_n((PTR), (VAL), __ATOMIC_RELEASE)
+#define CMARK_ATOMIC_INC(PTR) __atomic_add_fetch((PTR), 1, __ATOMIC_RELAXED)
+#define CMARK_ATOMIC_DEC(PTR) __atomic_sub_fetch((PTR), 1, __ATOMIC_ACQ_REL)
+#define CMARK_ATOMIC_CAS_PTR(PTR, OLD, NEW) \
+  __sync_bool_compare_and_swap((PTR), (OLD), (NEW))
+
 #elif defined(_WIN32) // building for windows
 
 #define _WIN32_WINNT 0x0600 // minimum target of Windows Vista
@@ -50,6 +76,33 @@ pthread_mutex_lock(&NAME##_lock);
 
 #define CMARK_UNLOCK(NAME) ReleaseSRWLockExclusive(&NAME##_lock);
 
+#define CMARK_HAVE_THREADS 1
+
+typedef HANDLE cmark_thread;
+typedef SRWLOCK cmark_mutex;
+
+#define CMARK_THREAD_FUNC(NAME, ARG) static DWORD WINAPI NAME(LPVOID ARG)
+#define CMARK_THREAD_RETURN return 0
+#define CMARK_THREAD_START(THREAD, FUNC, ARG) \
+  (((THREAD) = CreateThread(NULL, 0, FUNC, ARG, 0, NULL)) != NULL)
+#define CMARK_THREAD_JOIN(THREAD) \
+  (WaitForSingleObject(THREAD, INFINITE), CloseHandle(THREAD))
+
+#define CMARK_MUTEX_INIT(MUTEX) InitializeSRWLock(&(MUTEX))
+#define CMARK_MUTEX_LOCK(MUTEX) AcquireSRWLockExclusive(&(MUTEX))
+#define CMARK_MUTEX_UNLOCK(MUTEX) ReleaseSRWLockExclusive(&(MUTEX))
+#define CMARK_MUTEX_DESTROY(MUTEX) ((void)0)
+
+typedef volatile LONG cmark_atomic_int;
+
+#define CMARK_ATOMIC_LOAD(PTR) (*(PTR))
+#define CMARK_ATOMIC_STORE(PTR, VAL) InterlockedExchange((PTR), (VAL))
+#define CMARK_ATOMIC_INC(PTR) InterlockedIncrement(PTR)
+#define CMARK_ATOMIC_DEC(PTR) InterlockedDecrement(PTR)
+#define CMARK_ATOMIC_CAS_PTR(PTR, OLD, NEW) \
+  (InterlockedCompareExchangePointer((PVOID volatile *)(PTR), (NEW), \
+                                     (OLD)) == (OLD))
+
 #endif
 
 #else // no threading support
@@ -71,6 +124,15 @@ static inline bool check_latch(int *latch) {
 
 #define CMARK_RUN_ONCE(NAME, FUNC) if (check_latch(&NAME)) FUNC();
 
+typedef int cmark_atomic_int;
+
+#define CMARK_ATOMIC_LOAD(PTR) (*(PTR))
+#define CMARK_ATOMIC_STORE(PTR, VAL) (*(PTR) = (VAL))
+#define CMARK_ATOMIC_INC(PTR) (++*(PTR))
+#define CMARK_ATOMIC_DEC(PTR) (--*(PTR))
+#define CMARK_ATOMIC_CAS_PTR(PTR, OLD, NEW) \
+  (*(PTR) == (OLD) ? (*(PTR) = (NEW), true) : false)
+
 #endif // CMARK_THREADING
 
 #endif // CMARK_MUTEX_H
@@ -61,47 +61,81 @@ enum cmark_node__internal_flags {
   // Extensions can register custom flags by calling `cmark_register_node_flag`.
   // This is the starting value for the custom flags.
   CMARK_NODE__REGISTER_FIRST = (1 << 3),
+
+  // The flags below are taken from the top down, so that the custom flags
+  // keep the values they had before these were added.  Registration stops
+  // short of the lowest of them.
+
+  // 'cold->hash' holds the structural hash of the node.  Set only when it
+  // is set on all the descendants too, so invalidating a node clears it up
+  // the ancestors until a node that does not have it.
+  CMARK_NODE__HASHED = (1 << 13),
+  // The node is a document that owns the arena its 'mem' carves from.
+  CMARK_NODE__ARENA_ROOT = (1 << 14),
+  // The node lives in a 'cmark_node_slab' rather than its own allocation.
+  CMARK_NODE__SLAB = (1 << 15),
 };
 
 typedef uint16_t cmark_node_internal_flags;
 
-struct cmark_node {
+/**
+ * What a document parsed with CMARK_OPT_INCREMENTAL keeps for
+ * 'cmark_parser_reparse': its reference definitions, and the line the last
+ * re-parse started at, from which the next edit is looked for.  'block' is
+ * the first top-level block from that line on, or NULL if there is none.
+ */
+typedef struct cmark_incremental {
+  struct cmark_map *refmap;
+  cmark_node *block;
+  size_t offset;
+  int line;
+} cmark_incremental;
+
+/**
+ * Fields that few nodes use, kept out of line so that the many small
+ * inline nodes do not pay for them.  Allocated on first use by
+ * 'cmark_node_cold_fields'.
+ */
+typedef struct cmark_node_cold {
+  // The raw content of a leaf block, collected while it is open.
   cmark_strbuf content;
 
+  void *user_data;
+  cmark_free_func user_data_free_func;
+
+  union {
+    int ref_ix;
+    int def_count;
+  } footnote;
+
+  int internal_offset;
+
+  cmark_node *parent_footnote_def;
+
+  // See 'cmark_node_hash'.
+  uint64_t hash;
+} cmark_node_cold;
+
+struct cmark_node {
   struct cmark_node *next;
   struct cmark_node *prev;
   struct cmark_node *parent;
   struct cmark_node *first_child;
   struct cmark_node *last_child;
 
-  void *user_data;
-  cmark_free_func user_data_free_func;
-
-  int start_line;
-  int start_column;
-  int end_line;
-  int end_column;
-  int internal_offset;
   uint16_t type;
   cmark_node_internal_flags flags;
   int backtick_count;
 
+  cmark_mem *mem;
   cmark_syntax_extension *extension;
 
-  /**
-   * Used during cmark_render() to cache the most recent non-NULL
-   * extension, if you go up the parent chain like this:
-   *
-   * node->parent->...parent->extension
-   */
-  cmark_syntax_extension *ancestor_extension;
-
-  union {
-    int ref_ix;
-    int def_count;
-  } footnote;
+  int start_line;
+  int start_column;
+  int end_line;
+  int end_column;
 
-  cmark_node *parent_footnote_def;
+  cmark_node_cold *cold;
 
   union {
     cmark_chunk literal;
@@ -112,6 +146,7 @@ struct cmark_node {
     cmark_attribute attribute;
     cmark_custom custom;
     int html_block_type;
+    cmark_incremental *incremental;
     void *opaque;
   } as;
 };
@@ -137,7 +172,45 @@ CMARK_GFM_EXPORT
 void cmark_init_standard_node_flags(void);
 
 static inline cmark_mem *cmark_node_mem(cmark_node *node) {
-  return node->content.mem;
+  return node->mem;
+}
+
+CMARK_GFM_EXPORT cmark_node_cold *cmark_node_alloc_cold(cmark_node *node);
+
+/**
+ * Returns the allocator renderers allocate their results for 'node' from:
+ * its own, unless it belongs to a document in an arena of its own, whose
+ * results come from the allocator that built the document.
+ */
+CMARK_GFM_EXPORT cmark_mem *cmark_node_output_mem(cmark_node *node);
+
+/**
+ * Parsers carve their nodes out of slabs instead of allocating each one.
+ * A slab counts the nodes still alive in it, plus one while a parser is
+ * carving from it or from the slab after it, and frees itself once that
+ * count drops to zero, so nodes can outlive their parser and be freed in
+ * any order, on any thread: with CMARK_THREADING the count and the list of
+ * freed nodes are updated atomically.
+ */
+typedef struct cmark_node_slab cmark_node_slab;
+
+/** Returns a zeroed node from '*slab', starting a new slab from 'mem'
+ * when it is full or NULL.
+ */
+cmark_node *cmark_node_slab_alloc(cmark_node_slab **slab, cmark_mem *mem);
+
+/** Drops the parser's hold on '*slab' and sets it to NULL.
+ */
+void cmark_node_slab_release(cmark_node_slab **slab);
+
+/** Returns the out-of-line fields of 'node', allocating them if needed.
+ */
+static inline cmark_node_cold *cmark_node_cold_fields(cmark_node *node) {
+  return node->cold ? node->cold : cmark_node_alloc_cold(node);
+}
+
+static inline cmark_strbuf *cmark_node_content(cmark_node *node) {
+  return &cmark_node_cold_fields(node)->content;
 }
 CMARK_GFM_EXPORT int cmark_node_check(cmark_node *node, FILE *out);
 
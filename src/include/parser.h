@@ -8,6 +8,9 @@
 #include "references.h"
 #include "node.h"
 #include "buffer.h"
+#include "chunk.h"
+#include "simd.h"
+#include "pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,7 +19,13 @@ extern "C" {
 #define MAX_LINK_LABEL_LENGTH 1000
 
 struct cmark_parser {
+  /* Allocates the document being built and everything that goes with it */
   struct cmark_mem *mem;
+  /* The allocator the parser was created with; differs from 'mem' while
+   * the document is built in an arena of its own */
+  struct cmark_mem *base_mem;
+  /* The arena the document is built in under CMARK_OPT_DOCUMENT_ARENA */
+  cmark_arena *doc_arena;
   /* A hashtable of urls in the current document for cross-references */
   struct cmark_map *refmap;
   /* The root node of the parser, always a CMARK_NODE_DOCUMENT */
@@ -40,8 +49,12 @@ struct cmark_parser {
   bool blank;
   /* See the documentation for cmark_parser_has_partially_consumed_tab() in cmark.h */
   bool partially_consumed_tab;
-  /* Contains the currently processed line */
+  /* Backing storage for the currently processed line when it has to be
+   * copied out of the caller's buffer */
   cmark_strbuf curline;
+  /* The currently processed line; points either into curline or, for lines
+   * fed in place, directly into the caller's buffer */
+  cmark_chunk line;
   /* See the documentation for cmark_parser_get_last_line_length() in cmark.h */
   bufsize_t last_line_length;
   /* FIXME: not sure about the difference with curline */
@@ -56,6 +69,41 @@ struct cmark_parser {
   /* used when parsing inlines, can be populated by extensions if any are loaded */
   int8_t *skip_chars;
   int8_t *special_chars;
+  /* special_chars, plus the smart punctuation characters when
+   * special_charset_smart is set, in the form the SIMD scanner wants.
+   * Checked by the inline parser whenever special_charset_valid is false,
+   * and rebuilt if special_chars no longer match special_charset_chars,
+   * their copy from the last build. */
+  cmark_simd_charset special_charset;
+  bool special_charset_valid;
+  bool special_charset_smart;
+  int8_t special_charset_chars[256];
+  /* The slab new nodes are carved from */
+  cmark_node_slab *node_slab;
+  /* Entries of the inline parser's delimiter and bracket stacks, reused
+   * from one block to the next */
+  cmark_pool delimiter_pool;
+  cmark_pool bracket_pool;
+  /* See cmark_parser_set_stream_block_func() in cmark-gfm.h */
+  cmark_stream_block_func stream_block_func;
+  void *stream_block_data;
+  /* Footnote definitions seen while streaming, and how many of them have
+   * been numbered */
+  cmark_map *stream_footnotes;
+  unsigned int stream_footnote_ix;
+  /* Blocks held back while streaming until the footnotes they refer to
+   * are defined, oldest first, as the extensions left them, and the last
+   * of them.  What they were parsed from are the first children of the
+   * document, up to stream_held_block */
+  cmark_llist *stream_held;
+  cmark_llist *stream_held_last;
+  cmark_node *stream_held_block;
+  /* See cmark_parser_set_threads() in cmark-gfm.h */
+  int threads;
+  /* Input held back for cmark_parser_finish to parse on several threads */
+  unsigned char *held_input;
+  size_t held_size;
+  size_t held_alloc;
 };
 
 #ifdef __cplusplus
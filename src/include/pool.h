@@ -0,0 +1,39 @@
+#ifndef CMARK_POOL_H
+#define CMARK_POOL_H
+
+#include <stddef.h>
+
+#include "cmark-gfm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A pool of fixed-size items carved out of larger slabs.  Freed items are
+ * kept on a free list for reuse, and the slabs are only given back to the
+ * allocator when the pool is released.
+ */
+typedef struct cmark_pool {
+  cmark_mem *mem;
+  size_t item_size;
+  void *free_items;
+  struct cmark_pool_slab *slabs;
+  size_t slab_used; // items handed out from the newest slab
+} cmark_pool;
+
+void cmark_pool_init(cmark_pool *pool, cmark_mem *mem, size_t item_size);
+
+/** Returns a zeroed item. */
+void *cmark_pool_alloc(cmark_pool *pool);
+
+void cmark_pool_free(cmark_pool *pool, void *item);
+
+/** Frees every slab of the pool, including items still handed out. */
+void cmark_pool_release(cmark_pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -13,6 +13,9 @@ extern "C" {
 
 typedef enum { LITERAL, NORMAL, TITLE, URL } cmark_escaping;
 
+// How much output the '_to_sink' renderers build up before passing it on.
+#define CMARK_SINK_CHUNK_SIZE 65536
+
 struct cmark_renderer {
   cmark_mem *mem;
   cmark_strbuf *buffer;
@@ -30,6 +33,10 @@ struct cmark_renderer {
   void (*blankline)(struct cmark_renderer *);
   void (*out)(struct cmark_renderer *, cmark_node *, const char *, bool, cmark_escaping);
   unsigned int footnote_ix;
+  // The node being rendered and the nearest extension among it and its
+  // ancestors, which decides how its text is escaped.
+  cmark_node *escape_node;
+  cmark_syntax_extension *escape_extension;
 };
 
 typedef struct cmark_renderer cmark_renderer;
@@ -57,6 +64,17 @@ char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
                                       cmark_node *node,
                                       cmark_event_type ev_type, int options));
 
+void cmark_render_to_sink(cmark_mem *mem, cmark_node *root, int options,
+                          int width,
+                          void (*outc)(cmark_renderer *, cmark_node *,
+                                       cmark_escaping, int32_t,
+                                       unsigned char),
+                          int (*render_node)(cmark_renderer *renderer,
+                                             cmark_node *node,
+                                             cmark_event_type ev_type,
+                                             int options),
+                          cmark_write_func write, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,110 @@
+#ifndef CMARK_SIMD_H
+#define CMARK_SIMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cmark-gfm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Vectorized scanning kernels.
+ *
+ * Every kernel has a portable scalar implementation; on x86 an SSE2 and an
+ * AVX2 variant are selected at runtime depending on what the CPU supports.
+ * UTF-8 validation has an SSSE3 variant as well; the other kernels use their
+ * SSE2 variant at that level.
+ */
+
+typedef enum {
+  CMARK_SIMD_NONE,
+  CMARK_SIMD_SSE2,
+  CMARK_SIMD_SSSE3,
+  CMARK_SIMD_AVX2
+} cmark_simd_level;
+
+/** Returns the instruction set the kernels currently use.
+ */
+CMARK_GFM_EXPORT
+cmark_simd_level cmark_simd_get_level(void);
+
+/** Restricts the kernels to at most 'level' and returns the level that is
+ * actually used, which may be lower if the CPU lacks support. Intended for
+ * tests and benchmarks. The level is shared by the whole process: set it
+ * before any thread starts parsing or rendering. Kernels that run while it
+ * changes use either level, and give the same results with both.
+ */
+CMARK_GFM_EXPORT
+cmark_simd_level cmark_simd_set_level(cmark_simd_level level);
+
+/** Returns a pointer to the first '\r', '\n' or NUL byte in [p, end), or
+ * 'end' if there is none.
+ */
+CMARK_GFM_EXPORT
+const unsigned char *cmark_simd_find_eol(const unsigned char *p,
+                                         const unsigned char *end);
+
+#define CMARK_SIMD_CHARSET_MAX_RANGES 16
+
+/** A set of bytes to search for, kept in the forms the different kernels
+ * want: a 256-bit bitmap for the scalar loop, nibble lookup tables for
+ * AVX2, and runs of consecutive members for SSE2.
+ */
+typedef struct {
+  uint8_t bitmap[32];
+  uint8_t lo_nibble[16];
+  uint8_t hi_nibble[16];
+  uint8_t range_lo[CMARK_SIMD_CHARSET_MAX_RANGES];
+  uint8_t range_len[CMARK_SIMD_CHARSET_MAX_RANGES];
+  int num_ranges;
+  bool non_ascii;
+} cmark_simd_charset;
+
+/** Initializes 'set' to the empty set.
+ */
+CMARK_GFM_EXPORT
+void cmark_simd_charset_init(cmark_simd_charset *set);
+
+/** Adds the byte 'c' to 'set'.
+ */
+CMARK_GFM_EXPORT
+void cmark_simd_charset_add(cmark_simd_charset *set, unsigned char c);
+
+static inline bool cmark_simd_charset_contains(const cmark_simd_charset *set,
+                                               unsigned char c) {
+  return (set->bitmap[c >> 3] >> (c & 7)) & 1;
+}
+
+/** Returns a pointer to the first byte in [p, end) that is a member of
+ * 'set', or 'end' if there is none.
+ */
+CMARK_GFM_EXPORT
+const unsigned char *cmark_simd_find_charset(const cmark_simd_charset *set,
+                                             const unsigned char *p,
+                                             const unsigned char *end);
+
+/** Returns a pointer to the first byte in [p, end) that is not a member of
+ * 'set', or 'end' if there is none.
+ */
+CMARK_GFM_EXPORT
+const unsigned char *
+cmark_simd_find_not_charset(const cmark_simd_charset *set,
+                            const unsigned char *p, const unsigned char *end);
+
+/** Returns a pointer 'q' such that [p, q) is valid UTF-8 without NUL bytes
+ * and 'q' is a character boundary. Depending on the instruction set, 'q' may
+ * stop short of the first invalid byte; the caller is expected to decode the
+ * bytes from 'q' on its own and call again.
+ */
+CMARK_GFM_EXPORT
+const unsigned char *cmark_simd_skip_valid_utf8(const unsigned char *p,
+                                                const unsigned char *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef CMARK_UTF8_H
 #define CMARK_UTF8_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "buffer.h"
 
@@ -22,6 +23,12 @@ CMARK_GFM_EXPORT
 void cmark_utf8proc_check(cmark_strbuf *dest, const uint8_t *line,
                           bufsize_t size);
 
+/** Returns true if 'line' is valid UTF-8 without NUL bytes, that is, if
+ * cmark_utf8proc_check would copy it unchanged.
+ */
+CMARK_GFM_EXPORT
+bool cmark_utf8proc_is_valid(const uint8_t *line, bufsize_t size);
+
 CMARK_GFM_EXPORT
 int cmark_utf8proc_is_space(int32_t uc);
 
@@ -26,10 +26,10 @@ static const char *RIGHTSINGLEQUOTE = "\xE2\x80\x99";
 #define make_str(subj, sc, ec, s) make_literal(subj, CMARK_NODE_TEXT, sc, ec, s)
 #define make_code(subj, sc, ec, s) make_literal(subj, CMARK_NODE_CODE, sc, ec, s)
 #define make_raw_html(subj, sc, ec, s) make_literal(subj, CMARK_NODE_HTML_INLINE, sc, ec, s)
-#define make_linebreak(mem) make_simple(mem, CMARK_NODE_LINEBREAK)
-#define make_softbreak(mem) make_simple(mem, CMARK_NODE_SOFTBREAK)
-#define make_emph(mem) make_simple(mem, CMARK_NODE_EMPH)
-#define make_strong(mem) make_simple(mem, CMARK_NODE_STRONG)
+#define make_linebreak(subj) make_simple(subj, CMARK_NODE_LINEBREAK)
+#define make_softbreak(subj) make_simple(subj, CMARK_NODE_SOFTBREAK)
+#define make_emph(subj) make_simple(subj, CMARK_NODE_EMPH)
+#define make_strong(subj) make_simple(subj, CMARK_NODE_STRONG)
 
 #define MAXBACKTICKS 80
 
@@ -56,6 +56,8 @@ typedef struct bracket {
 
 typedef struct subject{
   cmark_mem *mem;
+  // NULL when parsing reference definitions outside of a parser
+  cmark_parser *parser;
   cmark_chunk input;
   unsigned flags;
   int line;
@@ -70,6 +72,11 @@ typedef struct subject{
   bool no_link_openers;
 } subject;
 
+void cmark_inlines_init_pools(cmark_parser *parser) {
+  cmark_pool_init(&parser->delimiter_pool, parser->mem, sizeof(delimiter));
+  cmark_pool_init(&parser->bracket_pool, parser->mem, sizeof(bracket));
+}
+
 void cmark_set_default_skip_chars(int8_t **skip_chars, bool use_memcpy) {
   static int8_t default_skip_chars[256];
 
@@ -92,12 +99,22 @@ static void subject_from_buf(cmark_mem *mem, int line_number, int block_offset,
                              cmark_chunk *buffer, cmark_map *refmap);
 static bufsize_t subject_find_special_char(cmark_parser *parser, subject *subj, int options);
 
+static inline cmark_node *alloc_node(subject *subj) {
+  cmark_node *e;
+
+  if (subj->parser)
+    return cmark_node_slab_alloc(&subj->parser->node_slab, subj->mem);
+
+  e = (cmark_node *)cmark_mem_calloc(subj->mem, 1, sizeof(*e));
+  e->mem = subj->mem;
+  return e;
+}
+
 // Create an inline with a literal string value.
 static inline cmark_node *make_literal(subject *subj, cmark_node_type t,
                                        int start_column, int end_column,
                                        cmark_chunk s) {
-  cmark_node *e = (cmark_node *)subj->mem->calloc(1, sizeof(*e));
-  cmark_strbuf_init(subj->mem, &e->content, 0);
+  cmark_node *e = alloc_node(subj);
   e->type = (uint16_t)t;
   e->as.literal = s;
   e->start_line = e->end_line = subj->line;
@@ -108,9 +125,8 @@ static inline cmark_node *make_literal(subject *subj, cmark_node_type t,
 }
 
 // Create an inline with no value.
-static inline cmark_node *make_simple(cmark_mem *mem, cmark_node_type t) {
-  cmark_node *e = (cmark_node *)mem->calloc(1, sizeof(*e));
-  cmark_strbuf_init(mem, &e->content, 0);
+static inline cmark_node *make_simple(subject *subj, cmark_node_type t) {
+  cmark_node *e = alloc_node(subj);
   e->type = (uint16_t)t;
   return e;
 }
@@ -153,7 +169,7 @@ static cmark_chunk chunk_clone(cmark_mem *mem, cmark_chunk *src) {
   bufsize_t len = src->len;
 
   c.len = len;
-  c.data = (unsigned char *)mem->calloc(len + 1, 1);
+  c.data = (unsigned char *)cmark_mem_calloc(mem, len + 1, 1);
   c.alloc = 1;
   if (len)
     memcpy(c.data, src->data, len);
@@ -183,7 +199,7 @@ static cmark_chunk cmark_clean_autolink(cmark_mem *mem, cmark_chunk *url,
 static inline cmark_node *make_autolink(subject *subj, int start_column,
                                         int end_column, cmark_chunk url,
                                         int is_email) {
-  cmark_node *link = make_simple(subj->mem, CMARK_NODE_LINK);
+  cmark_node *link = make_simple(subj, CMARK_NODE_LINK);
   link->as.link.url = cmark_clean_autolink(subj->mem, &url, is_email);
   link->as.link.title = cmark_chunk_literal("");
   link->start_line = link->end_line = subj->line;
@@ -197,6 +213,7 @@ static void subject_from_buf(cmark_mem *mem, int line_number, int block_offset,
                              cmark_chunk *chunk, cmark_map *refmap) {
   int i;
   e->mem = mem;
+  e->parser = NULL;
   e->input = *chunk;
   e->flags = 0;
   e->line = line_number;
@@ -527,7 +544,10 @@ static void remove_delimiter(subject *subj, delimiter *delim) {
   if (delim->previous != NULL) {
     delim->previous->next = delim->next;
   }
-  subj->mem->free(delim);
+  if (subj->parser)
+    cmark_pool_free(&subj->parser->delimiter_pool, delim);
+  else
+    cmark_mem_free(subj->mem, delim);
 }
 
 static void pop_bracket(subject *subj) {
@@ -536,12 +556,17 @@ static void pop_bracket(subject *subj) {
     return;
   b = subj->last_bracket;
   subj->last_bracket = subj->last_bracket->previous;
-  subj->mem->free(b);
+  if (subj->parser)
+    cmark_pool_free(&subj->parser->bracket_pool, b);
+  else
+    cmark_mem_free(subj->mem, b);
 }
 
 static void push_delimiter(subject *subj, unsigned char c, bool can_open,
                            bool can_close, cmark_node *inl_text) {
-  delimiter *delim = (delimiter *)subj->mem->calloc(1, sizeof(delimiter));
+  delimiter *delim = subj->parser
+      ? (delimiter *)cmark_pool_alloc(&subj->parser->delimiter_pool)
+      : (delimiter *)cmark_mem_calloc(subj->mem, 1, sizeof(delimiter));
   delim->delim_char = c;
   delim->can_open = can_open;
   delim->can_close = can_close;
@@ -557,7 +582,9 @@ static void push_delimiter(subject *subj, unsigned char c, bool can_open,
 }
 
 static void push_bracket(subject *subj, bracket_type type, cmark_node *inl_text) {
-  bracket *b = (bracket *)subj->mem->calloc(1, sizeof(bracket));
+  bracket *b = subj->parser
+      ? (bracket *)cmark_pool_alloc(&subj->parser->bracket_pool)
+      : (bracket *)cmark_mem_calloc(subj->mem, 1, sizeof(bracket));
   if (subj->last_bracket != NULL) {
     subj->last_bracket->bracket_after = true;
     memcpy(b->in_bracket, subj->last_bracket->in_bracket, sizeof(b->in_bracket));
@@ -808,7 +835,7 @@ static delimiter *S_insert_emph(subject *subj, delimiter *opener,
 
   // create new emph or strong, and splice it in to our inlines
   // between the opener and closer
-  emph = use_delims == 1 ? make_emph(subj->mem) : make_strong(subj->mem);
+  emph = use_delims == 1 ? make_emph(subj) : make_strong(subj);
 
   tmp = opener_inl->next;
   while (tmp && tmp != closer_inl) {
@@ -852,7 +879,7 @@ static cmark_node *handle_backslash(cmark_parser *parser, subject *subj) {
     advance(subj);
     return make_str(subj, subj->pos - 2, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   } else if (!is_eof(subj) && skip_line_end(subj)) {
-    return make_linebreak(subj->mem);
+    return make_linebreak(subj);
   } else {
     return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("\\"));
   }
@@ -1245,7 +1272,7 @@ static cmark_node *handle_close_bracket_attribute(cmark_parser *parser, subject
     return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("]"));
   }
 
-  inl = make_simple(subj->mem, CMARK_NODE_ATTRIBUTE);
+  inl = make_simple(subj, CMARK_NODE_ATTRIBUTE);
   inl->as.attribute.attributes = attributes;
   inl->start_line = inl->end_line = subj->line;
   inl->start_column = opener->inl_text->start_column;
@@ -1393,7 +1420,7 @@ noMatch:
       // Let's just rewind the subject's position:
       subj->pos = initial_pos;
 
-      cmark_node *fnref = make_simple(subj->mem, CMARK_NODE_FOOTNOTE_REFERENCE);
+      cmark_node *fnref = make_simple(subj, CMARK_NODE_FOOTNOTE_REFERENCE);
 
       // the start and end of the footnote ref is the opening and closing brace
       // i.e. the subject's current position, and the opener's start_column
@@ -1459,7 +1486,7 @@ noMatch:
   return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("]"));
 
 match:
-  inl = make_simple(subj->mem, is_image ? CMARK_NODE_IMAGE : CMARK_NODE_LINK);
+  inl = make_simple(subj, is_image ? CMARK_NODE_IMAGE : CMARK_NODE_LINK);
   inl->as.link.url = url;
   inl->as.link.title = title;
   inl->start_line = opener->inl_text->start_line;
@@ -1509,9 +1536,9 @@ static cmark_node *handle_newline(subject *subj) {
   skip_spaces(subj);
   if (nlpos > 1 && peek_at(subj, nlpos - 1) == ' ' &&
       peek_at(subj, nlpos - 2) == ' ') {
-    return make_linebreak(subj->mem);
+    return make_linebreak(subj);
   } else {
-    return make_softbreak(subj->mem);
+    return make_softbreak(subj);
   }
 }
 
@@ -1551,28 +1578,58 @@ static const char SMART_PUNCT_CHARS[] = {
       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-static bufsize_t subject_find_special_char(cmark_parser *parser, subject *subj, int options) {
-  bufsize_t n = subj->pos + 1;
+// Rebuild parser->special_charset if special_chars or the smart
+// punctuation option changed since it was last built.
+static void S_update_special_charset(cmark_parser *parser, int options) {
+  bool smart = (options & CMARK_OPT_SMART) != 0;
+  int c;
 
-  while (n < subj->input.len) {
-    if (parser->special_chars[subj->input.data[n]])
-      return n;
-    if (options & CMARK_OPT_SMART && SMART_PUNCT_CHARS[subj->input.data[n]])
-      return n;
-    n++;
+  if (parser->special_charset_smart == smart &&
+      (parser->special_charset_valid ||
+       memcmp(parser->special_charset_chars, parser->special_chars, 256) == 0)) {
+    parser->special_charset_valid = true;
+    return;
   }
 
-  return subj->input.len;
+  cmark_simd_charset_init(&parser->special_charset);
+  for (c = 0; c < 256; ++c) {
+    if (parser->special_chars[c] || (smart && SMART_PUNCT_CHARS[c]))
+      cmark_simd_charset_add(&parser->special_charset, (unsigned char)c);
+  }
+
+  memcpy(parser->special_charset_chars, parser->special_chars, 256);
+  parser->special_charset_valid = true;
+  parser->special_charset_smart = smart;
+}
+
+void cmark_inlines_prepare(cmark_parser *parser, int options) {
+  S_update_special_charset(parser, options);
+}
+
+static bufsize_t subject_find_special_char(cmark_parser *parser, subject *subj, int options) {
+  const unsigned char *p;
+
+  if (subj->pos + 1 >= subj->input.len)
+    return subj->input.len;
+
+  S_update_special_charset(parser, options);
+  p = cmark_simd_find_charset(&parser->special_charset,
+                              subj->input.data + subj->pos + 1,
+                              subj->input.data + subj->input.len);
+
+  return (bufsize_t)(p - subj->input.data);
 }
 
 void cmark_inlines_add_special_character(cmark_parser *parser, unsigned char c, bool emphasis) {
   parser->special_chars[c] = 1;
+  parser->special_charset_valid = false;
   if (emphasis)
     parser->skip_chars[c] = 1;
 }
 
 void cmark_inlines_remove_special_character(cmark_parser *parser, unsigned char c, bool emphasis) {
   parser->special_chars[c] = 0;
+  parser->special_charset_valid = false;
   if (emphasis)
     parser->skip_chars[c] = 0;
 }
@@ -1707,8 +1764,10 @@ void cmark_parse_inlines(cmark_parser *parser,
                          cmark_map *refmap,
                          int options) {
   subject subj;
-  cmark_chunk content = {parent->content.ptr, parent->content.size, 0};
-  subject_from_buf(parser->mem, parent->start_line, parent->start_column - 1 + parent->internal_offset, &subj, &content, refmap);
+  cmark_node_cold *cold = cmark_node_cold_fields(parent);
+  cmark_chunk content = {cold->content.ptr, cold->content.size, 0};
+  subject_from_buf(parser->mem, parent->start_line, parent->start_column - 1 + cold->internal_offset, &subj, &content, refmap);
+  subj.parser = parser;
   if ((options & CMARK_OPT_PRESERVE_WHITESPACE) == 0)
     cmark_chunk_rtrim(&subj.input);
 
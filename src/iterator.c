@@ -10,8 +10,8 @@ cmark_iter *cmark_iter_new(cmark_node *root) {
   if (root == NULL) {
     return NULL;
   }
-  cmark_mem *mem = root->content.mem;
-  cmark_iter *iter = (cmark_iter *)mem->calloc(1, sizeof(cmark_iter));
+  cmark_mem *mem = root->mem;
+  cmark_iter *iter = (cmark_iter *)cmark_mem_calloc(mem, 1, sizeof(cmark_iter));
   iter->mem = mem;
   iter->root = root;
   iter->cur.ev_type = CMARK_EVENT_NONE;
@@ -21,7 +21,7 @@ cmark_iter *cmark_iter_new(cmark_node *root) {
   return iter;
 }
 
-void cmark_iter_free(cmark_iter *iter) { iter->mem->free(iter); }
+void cmark_iter_free(cmark_iter *iter) { cmark_mem_free(iter->mem, iter); }
 
 static bool S_is_leaf(cmark_node *node) {
   switch (node->type) {
@@ -118,6 +118,7 @@ void cmark_consolidate_text_nodes(cmark_node *root) {
       }
       cmark_chunk_free(iter->mem, &cur->as.literal);
       cur->as.literal = cmark_chunk_buf_detach(&buf);
+      cmark_node_invalidate_hash(cur);
     }
   }
 
@@ -137,20 +138,33 @@ void cmark_node_own(cmark_node *root) {
     cur = cmark_iter_get_node(iter);
     if (ev_type == CMARK_EVENT_ENTER) {
       switch (cur->type) {
+      case CMARK_NODE_CODE_BLOCK:
+        cmark_chunk_to_cstr(iter->mem, &cur->as.code.info);
+        cmark_chunk_to_cstr(iter->mem, &cur->as.code.literal);
+        break;
       case CMARK_NODE_TEXT:
       case CMARK_NODE_HTML_INLINE:
       case CMARK_NODE_CODE:
       case CMARK_NODE_HTML_BLOCK:
+      case CMARK_NODE_FOOTNOTE_REFERENCE:
+      case CMARK_NODE_FOOTNOTE_DEFINITION:
         cmark_chunk_to_cstr(iter->mem, &cur->as.literal);
         break;
       case CMARK_NODE_LINK:
+      case CMARK_NODE_IMAGE:
         cmark_chunk_to_cstr(iter->mem, &cur->as.link.url);
         cmark_chunk_to_cstr(iter->mem, &cur->as.link.title);
         break;
+      case CMARK_NODE_ATTRIBUTE:
+        cmark_chunk_to_cstr(iter->mem, &cur->as.attribute.attributes);
+        break;
+      case CMARK_NODE_CUSTOM_BLOCK:
       case CMARK_NODE_CUSTOM_INLINE:
         cmark_chunk_to_cstr(iter->mem, &cur->as.custom.on_enter);
         cmark_chunk_to_cstr(iter->mem, &cur->as.custom.on_exit);
         break;
+      default:
+        break;
       }
     }
   }
@@ -4,7 +4,8 @@
 
 cmark_llist *cmark_llist_append(cmark_mem *mem, cmark_llist *head, void *data) {
   cmark_llist *tmp;
-  cmark_llist *new_node = (cmark_llist *) mem->calloc(1, sizeof(cmark_llist));
+  cmark_llist *new_node =
+      (cmark_llist *) cmark_mem_calloc(mem, 1, sizeof(cmark_llist));
 
   new_node->data = data;
   new_node->next = NULL;
@@ -28,7 +29,7 @@ void cmark_llist_free_full(cmark_mem *mem, cmark_llist *head, cmark_free_func fr
 
     prev = tmp;
     tmp = tmp->next;
-    mem->free(prev);
+    cmark_mem_free(mem, prev);
   }
 }
 
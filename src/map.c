@@ -4,99 +4,149 @@
 
 // normalize map label:  collapse internal whitespace to single space,
 // remove leading/trailing whitespace, case fold
-// Return NULL if the label is actually empty (i.e. composed solely from
+// Return false if the label is actually empty (i.e. composed solely from
 // whitespace)
+static bool normalize_label(cmark_strbuf *normalized, cmark_chunk *ref) {
+  cmark_strbuf_clear(normalized);
+
+  if (ref == NULL || ref->len == 0)
+    return false;
+
+  cmark_utf8proc_case_fold(normalized, ref->data, ref->len);
+  cmark_strbuf_trim(normalized);
+  cmark_strbuf_normalize_whitespace(normalized);
+
+  return normalized->size > 0;
+}
+
+// Return NULL if the label is empty; otherwise a normalized copy owned by
+// the caller.
 unsigned char *normalize_map_label(cmark_mem *mem, cmark_chunk *ref) {
   cmark_strbuf normalized = CMARK_BUF_INIT(mem);
-  unsigned char *result;
 
-  if (ref == NULL)
+  if (!normalize_label(&normalized, ref)) {
+    cmark_strbuf_free(&normalized);
     return NULL;
+  }
 
-  if (ref->len == 0)
-    return NULL;
+  return cmark_strbuf_detach(&normalized);
+}
 
-  cmark_utf8proc_case_fold(&normalized, ref->data, ref->len);
-  cmark_strbuf_trim(&normalized);
-  cmark_strbuf_normalize_whitespace(&normalized);
+// FNV-1a
+static uint32_t label_hash(const unsigned char *label, size_t len) {
+  uint32_t h = 2166136261u;
+  size_t i;
 
-  result = cmark_strbuf_detach(&normalized);
-  assert(result);
+  for (i = 0; i < len; ++i) {
+    h ^= label[i];
+    h *= 16777619u;
+  }
+  return h;
+}
 
-  if (result[0] == '\0') {
-    mem->free(result);
-    return NULL;
+// Returns the table slot holding 'label', or the empty slot where it
+// belongs.
+static cmark_map_entry **find_slot(cmark_map *map, const unsigned char *label,
+                                   uint32_t hash) {
+  size_t mask = map->table_size - 1;
+  size_t i = hash & mask;
+
+  while (map->table[i]) {
+    cmark_map_entry *entry = map->table[i];
+    if (entry->hash == hash &&
+        strcmp((const char *)entry->label, (const char *)label) == 0)
+      break;
+    i = (i + 1) & mask;
   }
 
-  return result;
+  return &map->table[i];
 }
 
-static int
-labelcmp(const unsigned char *a, const unsigned char *b) {
-  return strcmp((const char *)a, (const char *)b);
+static void grow_table(cmark_map *map) {
+  cmark_map_entry **old = map->table;
+  size_t old_size = map->table_size, i;
+
+  map->table_size = old_size ? old_size * 2 : 16;
+  map->table = (cmark_map_entry **)cmark_mem_calloc(map->mem, map->table_size,
+                                                     sizeof(cmark_map_entry *));
+
+  for (i = 0; i < old_size; ++i) {
+    if (old[i])
+      *find_slot(map, old[i]->label, old[i]->hash) = old[i];
+  }
+
+  cmark_mem_free(map->mem, old);
 }
 
-static int
-refcmp(const void *p1, const void *p2) {
-  cmark_map_entry *r1 = *(cmark_map_entry **)p1;
-  cmark_map_entry *r2 = *(cmark_map_entry **)p2;
-  int res = labelcmp(r1->label, r2->label);
-  return res ? res : ((int)r1->age - (int)r2->age);
+void cmark_map_insert(cmark_map *map, cmark_map_entry *entry) {
+  cmark_map_entry **slot;
+
+  entry->age = map->size;
+  entry->next = map->refs;
+  entry->hash = label_hash(entry->label, strlen((const char *)entry->label));
+  map->refs = entry;
+  map->size++;
+
+  if ((map->num_labels + 1) * 2 > map->table_size)
+    grow_table(map);
+
+  // If the label is already taken, the earlier definition wins.
+  slot = find_slot(map, entry->label, entry->hash);
+  if (*slot == NULL) {
+    *slot = entry;
+    map->num_labels++;
+  }
 }
 
-static int
-refsearch(const void *label, const void *p2) {
-  cmark_map_entry *ref = *(cmark_map_entry **)p2;
-  return labelcmp((const unsigned char *)label, ref->label);
+bool cmark_map_entry_found(cmark_map *map, cmark_map_entry *entry) {
+  return map->table_size &&
+         *find_slot(map, entry->label, entry->hash) == entry;
 }
 
-static void sort_map(cmark_map *map) {
-  size_t i = 0, last = 0, size = map->size;
-  cmark_map_entry *r = map->refs, **sorted = NULL;
+void cmark_map_append(cmark_map *map, cmark_map *from) {
+  cmark_map_entry *entry = NULL, *next;
 
-  sorted = (cmark_map_entry **)map->mem->calloc(size, sizeof(cmark_map_entry *));
-  while (r) {
-    sorted[i++] = r;
-    r = r->next;
+  // 'refs' runs newest first; insert the oldest first.
+  while (from->refs) {
+    next = from->refs->next;
+    from->refs->next = entry;
+    entry = from->refs;
+    from->refs = next;
   }
 
-  qsort(sorted, size, sizeof(cmark_map_entry *), refcmp);
-
-  for (i = 1; i < size; i++) {
-    if (labelcmp(sorted[i]->label, sorted[last]->label) != 0)
-      sorted[++last] = sorted[i];
+  while (entry) {
+    next = entry->next;
+    cmark_map_insert(map, entry);
+    entry = next;
   }
 
-  map->sorted = sorted;
-  map->size = last + 1;
+  if (from->table)
+    memset(from->table, 0, from->table_size * sizeof(cmark_map_entry *));
+  from->num_labels = 0;
+  from->size = 0;
 }
 
 cmark_map_entry *cmark_map_lookup(cmark_map *map, cmark_chunk *label) {
-  cmark_map_entry **ref = NULL;
   cmark_map_entry *r = NULL;
-  unsigned char *norm;
 
   if (label->len < 1 || label->len > MAX_LINK_LABEL_LENGTH)
     return NULL;
 
-  if (map == NULL || !map->size)
+  if (map == NULL || !map->num_labels)
     return NULL;
 
-  norm = normalize_map_label(map->mem, label);
-  if (norm == NULL)
+  if (!normalize_label(&map->scratch, label))
     return NULL;
 
-  if (!map->sorted)
-    sort_map(map);
-
-  ref = (cmark_map_entry **)bsearch(norm, map->sorted, map->size, sizeof(cmark_map_entry *), refsearch);
-  map->mem->free(norm);
+  r = *find_slot(map, map->scratch.ptr,
+                 label_hash(map->scratch.ptr, (size_t)map->scratch.size));
 
-  if (ref != NULL) {
-    r = ref[0];
+  if (r != NULL) {
     /* Check for expansion limit */
-    if (r->size > map->max_ref_size - map->ref_size)
+    if (r->size > map->max_ref_size - map->ref_size) {
+      map->ref_size_exceeded = true;
       return NULL;
+    }
     map->ref_size += r->size;
   }
 
@@ -116,14 +166,16 @@ void cmark_map_free(cmark_map *map) {
     ref = next;
   }
 
-  map->mem->free(map->sorted);
-  map->mem->free(map);
+  cmark_strbuf_free(&map->scratch);
+  cmark_mem_free(map->mem, map->table);
+  cmark_mem_free(map->mem, map);
 }
 
 cmark_map *cmark_map_new(cmark_mem *mem, cmark_map_free_f free) {
-  cmark_map *map = (cmark_map *)mem->calloc(1, sizeof(cmark_map));
+  cmark_map *map = (cmark_map *)cmark_mem_calloc(mem, 1, sizeof(cmark_map));
   map->mem = mem;
   map->free = free;
   map->max_ref_size = UINT_MAX;
+  cmark_strbuf_init(mem, &map->scratch, 0);
   return map;
 }
@@ -1,7 +1,9 @@
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "map.h"
 #include "mutex.h"
 #include "node.h"
 #include "syntax_extension.h"
@@ -49,7 +51,7 @@ void cmark_register_node_flag(cmark_node_internal_flags *flags) {
   }
 
   // Check that we haven't run out of bits.
-  if (nextflag == 0) {
+  if (nextflag == CMARK_NODE__HASHED) {
     fprintf(stderr, "too many flags in cmark_register_node_flag\n");
     abort();
   }
@@ -124,8 +126,8 @@ static bool S_can_contain(cmark_node *node, cmark_node *child) {
 }
 
 cmark_node *cmark_node_new_with_mem_and_ext(cmark_node_type type, cmark_mem *mem, cmark_syntax_extension *extension) {
-  cmark_node *node = (cmark_node *)mem->calloc(1, sizeof(*node));
-  cmark_strbuf_init(mem, &node->content, 0);
+  cmark_node *node = (cmark_node *)cmark_mem_calloc(mem, 1, sizeof(*node));
+  node->mem = mem;
   node->type = (uint16_t)type;
   node->extension = extension;
 
@@ -169,6 +171,13 @@ cmark_node *cmark_node_new(cmark_node_type type) {
 
 static void free_node_as(cmark_node *node) {
   switch (node->type) {
+    case CMARK_NODE_DOCUMENT:
+    if (node->as.incremental) {
+      cmark_map_free(node->as.incremental->refmap);
+      cmark_mem_free(NODE_MEM(node), node->as.incremental);
+    }
+    node->as.incremental = NULL;
+      break;
     case CMARK_NODE_CODE_BLOCK:
     cmark_chunk_free(NODE_MEM(node), &node->as.code.info);
     cmark_chunk_free(NODE_MEM(node), &node->as.code.literal);
@@ -199,14 +208,117 @@ static void free_node_as(cmark_node *node) {
     }
 }
 
+#define NODE_SLAB_SIZE 64
+
+typedef struct {
+  cmark_node_slab *slab;
+  cmark_node node;
+} node_slot;
+
+struct cmark_node_slab {
+  cmark_mem *mem;
+  cmark_atomic_int refs;
+  size_t used;
+  // Slots freed while a parser still allocates from this slab, linked
+  // through their nodes' 'next'.  The inline parser frees many of the
+  // nodes it makes shortly after making them.  Any thread may push a
+  // node, but only the parser that owns the slab pops them, so the list
+  // cannot see a node popped and pushed back behind its back.
+  cmark_node *free_nodes;
+  // The slab the parser allocated from before this one, kept (with a
+  // reference) while this one is current so that nodes freed from a
+  // paragraph that straddles the two are reused as well.
+  cmark_node_slab *prev;
+  node_slot slots[NODE_SLAB_SIZE];
+};
+
+static void S_slab_unref(cmark_node_slab *slab) {
+  while (slab && CMARK_ATOMIC_DEC(&slab->refs) == 0) {
+    cmark_node_slab *prev = slab->prev;
+    cmark_mem_free(slab->mem, slab);
+    slab = prev;
+  }
+}
+
+static cmark_node *S_slab_reuse(cmark_node_slab *slab, cmark_mem *mem) {
+  cmark_node *node;
+
+  do {
+    node = CMARK_ATOMIC_LOAD(&slab->free_nodes);
+  } while (!CMARK_ATOMIC_CAS_PTR(&slab->free_nodes, node, node->next));
+  CMARK_ATOMIC_INC(&slab->refs);
+  memset(node, 0, sizeof(*node));
+  node->mem = mem;
+  node->flags = CMARK_NODE__SLAB;
+  return node;
+}
+
+cmark_node *cmark_node_slab_alloc(cmark_node_slab **slab, cmark_mem *mem) {
+  cmark_node_slab *cur = *slab;
+  node_slot *slot;
+
+  if (cur && CMARK_ATOMIC_LOAD(&cur->free_nodes))
+    return S_slab_reuse(cur, mem);
+  if (cur && cur->prev && CMARK_ATOMIC_LOAD(&cur->prev->free_nodes))
+    return S_slab_reuse(cur->prev, mem);
+
+  if (cur == NULL || cur->used == NODE_SLAB_SIZE) {
+    *slab =
+        (cmark_node_slab *)cmark_mem_calloc(mem, 1, sizeof(cmark_node_slab));
+    (*slab)->mem = mem;
+    (*slab)->refs = 1;
+    if (cur) {
+      // The caller's reference to the full slab passes to the new one.
+      S_slab_unref(cur->prev);
+      cur->prev = NULL;
+      (*slab)->prev = cur;
+    }
+    cur = *slab;
+  }
+
+  slot = &cur->slots[cur->used++];
+  slot->slab = cur;
+  CMARK_ATOMIC_INC(&cur->refs);
+  slot->node.mem = mem;
+  slot->node.flags = CMARK_NODE__SLAB;
+  return &slot->node;
+}
+
+void cmark_node_slab_release(cmark_node_slab **slab) {
+  if (*slab) {
+    S_slab_unref(*slab);
+    *slab = NULL;
+  }
+}
+
+static void S_free_node_memory(cmark_node *node) {
+  if (node->flags & CMARK_NODE__SLAB) {
+    node_slot *slot =
+        (node_slot *)((char *)node - offsetof(node_slot, node));
+    cmark_node *head;
+
+    do {
+      head = CMARK_ATOMIC_LOAD(&slot->slab->free_nodes);
+      node->next = head;
+    } while (!CMARK_ATOMIC_CAS_PTR(&slot->slab->free_nodes, head, node));
+    S_slab_unref(slot->slab);
+  } else {
+    cmark_mem_free(NODE_MEM(node), node);
+  }
+}
+
 // Free a cmark_node list and any children.
 static void S_free_nodes(cmark_node *e) {
   cmark_node *next;
   while (e != NULL) {
-    cmark_strbuf_free(&e->content);
+    if (e->cold) {
+      cmark_strbuf_free(&e->cold->content);
 
-    if (e->user_data && e->user_data_free_func)
-      e->user_data_free_func(NODE_MEM(e), e->user_data);
+      if (e->cold->user_data && e->cold->user_data_free_func)
+        e->cold->user_data_free_func(NODE_MEM(e), e->cold->user_data);
+
+      cmark_mem_free(NODE_MEM(e), e->cold);
+    }
 
     if (e->as.opaque && e->extension && e->extension->opaque_free_func)
       e->extension->opaque_free_func(e->extension, NODE_MEM(e), e);
@@ -219,17 +331,212 @@ static void S_free_nodes(cmark_node *e) {
       e->next = e->first_child;
     }
     next = e->next;
-    NODE_MEM(e)->free(e);
+    S_free_node_memory(e);
     e = next;
   }
 }
 
+cmark_mem *cmark_node_output_mem(cmark_node *node) {
+  cmark_arena *arena = cmark_arena_from_mem(node->mem);
+  cmark_mem *mem = arena ? cmark_arena_output_mem(arena) : NULL;
+
+  return mem ? mem : node->mem;
+}
+
 void cmark_node_free(cmark_node *node) {
   S_node_unlink(node);
+  if (node->flags & CMARK_NODE__ARENA_ROOT) {
+    // Everything the document owns lives in its arena.
+    cmark_arena_free(cmark_arena_from_mem(node->mem));
+    return;
+  }
   node->next = NULL;
   S_free_nodes(node);
 }
 
+static cmark_chunk S_chunk_copy(cmark_mem *mem, const cmark_chunk *c) {
+  cmark_chunk copy = CMARK_CHUNK_EMPTY;
+
+  if (c->data == NULL)
+    return copy;
+  copy.data = (unsigned char *)cmark_mem_calloc(mem, c->len + 1, 1);
+  memcpy(copy.data, c->data, c->len);
+  copy.len = c->len;
+  copy.alloc = 1;
+  return copy;
+}
+
+// Returns a copy of 'src' without its links to other nodes, or NULL if its
+// extension data cannot be copied.
+static cmark_node *S_copy_node(cmark_node *src, cmark_mem *mem) {
+  cmark_syntax_extension *ext = src->extension;
+  cmark_node *node;
+
+  if (src->as.opaque && ext && ext->opaque_free_func && !ext->opaque_copy_func)
+    return NULL;
+
+  node = (cmark_node *)cmark_mem_calloc(mem, 1, sizeof(*node));
+  node->mem = mem;
+  node->type = src->type;
+  node->flags = src->flags & ~(CMARK_NODE__SLAB | CMARK_NODE__ARENA_ROOT);
+  node->backtick_count = src->backtick_count;
+  node->extension = ext;
+  node->start_line = src->start_line;
+  node->start_column = src->start_column;
+  node->end_line = src->end_line;
+  node->end_column = src->end_column;
+  node->as = src->as;
+
+  if (src->cold) {
+    cmark_node_cold *cold = cmark_node_alloc_cold(node);
+    cmark_strbuf_put(&cold->content, src->cold->content.ptr,
+                     src->cold->content.size);
+    cold->user_data = src->cold->user_data;
+    cold->footnote = src->cold->footnote;
+    cold->internal_offset = src->cold->internal_offset;
+    // Still points into the source tree; cmark_node_copy remaps it.
+    cold->parent_footnote_def = src->cold->parent_footnote_def;
+    // The copy has the same structure as 'src', so it keeps its hash.
+    cold->hash = src->cold->hash;
+  }
+
+  if (ext && ext->opaque_copy_func) {
+    node->as.opaque = NULL;
+    if (src->as.opaque)
+      ext->opaque_copy_func(ext, mem, node, src);
+    return node;
+  }
+
+  switch (node->type) {
+  case CMARK_NODE_DOCUMENT:
+    // A copy is re-parsed from scratch.
+    node->as.incremental = NULL;
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    node->as.code.info = S_chunk_copy(mem, &src->as.code.info);
+    node->as.code.literal = S_chunk_copy(mem, &src->as.code.literal);
+    break;
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+  case CMARK_NODE_CODE:
+  case CMARK_NODE_HTML_BLOCK:
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    node->as.literal = S_chunk_copy(mem, &src->as.literal);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    node->as.link.url = S_chunk_copy(mem, &src->as.link.url);
+    node->as.link.title = S_chunk_copy(mem, &src->as.link.title);
+    break;
+  case CMARK_NODE_ATTRIBUTE:
+    node->as.attribute.attributes =
+        S_chunk_copy(mem, &src->as.attribute.attributes);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    node->as.custom.on_enter = S_chunk_copy(mem, &src->as.custom.on_enter);
+    node->as.custom.on_exit = S_chunk_copy(mem, &src->as.custom.on_exit);
+    break;
+  default:
+    break;
+  }
+
+  return node;
+}
+
+typedef struct {
+  cmark_node *src;
+  cmark_node *copy;
+} node_pair;
+
+static int S_compare_pairs(const void *a, const void *b) {
+  const cmark_node *x = ((const node_pair *)a)->src;
+  const cmark_node *y = ((const node_pair *)b)->src;
+  return x < y ? -1 : x > y;
+}
+
+cmark_node *cmark_node_copy(cmark_node *node, cmark_mem *mem) {
+  cmark_node *src = node, *root = NULL, *parent = NULL, *copy;
+  node_pair *defs = NULL, *refs = NULL, *found;
+  size_t n_defs = 0, n_refs = 0, size_defs = 0, size_refs = 0, i;
+
+  if (node == NULL)
+    return NULL;
+
+  // Copy the nodes in document order, keeping 'parent' as the copy of
+  // 'src->parent'.
+  while (true) {
+    copy = S_copy_node(src, mem);
+    if (copy == NULL) {
+      if (root)
+        cmark_node_free(root);
+      root = NULL;
+      break;
+    }
+
+    if (parent) {
+      copy->parent = parent;
+      copy->prev = parent->last_child;
+      if (parent->last_child)
+        parent->last_child->next = copy;
+      else
+        parent->first_child = copy;
+      parent->last_child = copy;
+    } else {
+      root = copy;
+    }
+
+    if (src->type == CMARK_NODE_FOOTNOTE_DEFINITION) {
+      if (n_defs == size_defs) {
+        size_defs = size_defs ? size_defs * 2 : 8;
+        defs = (node_pair *)cmark_mem_realloc(
+            mem, defs, size_defs * sizeof(node_pair));
+      }
+      defs[n_defs].src = src;
+      defs[n_defs++].copy = copy;
+    }
+    if (copy->cold && copy->cold->parent_footnote_def) {
+      if (n_refs == size_refs) {
+        size_refs = size_refs ? size_refs * 2 : 8;
+        refs = (node_pair *)cmark_mem_realloc(
+            mem, refs, size_refs * sizeof(node_pair));
+      }
+      refs[n_refs].src = copy->cold->parent_footnote_def;
+      refs[n_refs++].copy = copy;
+    }
+
+    if (src->first_child) {
+      parent = copy;
+      src = src->first_child;
+      continue;
+    }
+    while (src != node && src->next == NULL) {
+      src = src->parent;
+      parent = parent->parent;
+    }
+    if (src == node)
+      break;
+    src = src->next;
+  }
+
+  if (root && n_refs) {
+    if (n_defs)
+      qsort(defs, n_defs, sizeof(node_pair), S_compare_pairs);
+    for (i = 0; i < n_refs; ++i) {
+      found = n_defs ? (node_pair *)bsearch(&refs[i], defs, n_defs,
+                                            sizeof(node_pair),
+                                            S_compare_pairs)
+                     : NULL;
+      refs[i].copy->cold->parent_footnote_def = found ? found->copy : NULL;
+    }
+  }
+
+  cmark_mem_free(mem, defs);
+  cmark_mem_free(mem, refs);
+  return root;
+}
+
 cmark_node_type cmark_node_get_type(cmark_node *node) {
   if (node == NULL) {
     return CMARK_NODE_NONE;
@@ -257,6 +564,9 @@ int cmark_node_set_type(cmark_node * node, cmark_node_type type) {
   free_node_as(node);
 
   node->type = (uint16_t)type;
+  if (type == CMARK_NODE_DOCUMENT)
+    node->as.incremental = NULL;
+  cmark_node_invalidate_hash(node);
 
   return 1;
 }
@@ -373,19 +683,25 @@ cmark_node *cmark_node_nth_child(cmark_node *node, int n) {
   return ret;
 }
 
+cmark_node_cold *cmark_node_alloc_cold(cmark_node *node) {
+  node->cold = (cmark_node_cold *)cmark_mem_calloc(NODE_MEM(node), 1, sizeof(*node->cold));
+  cmark_strbuf_init(NODE_MEM(node), &node->cold->content, 0);
+  return node->cold;
+}
+
 cmark_node *cmark_node_parent_footnote_def(cmark_node *node) {
-  if (node == NULL) {
+  if (node == NULL || node->cold == NULL) {
     return NULL;
   } else {
-    return node->parent_footnote_def;
+    return node->cold->parent_footnote_def;
   }
 }
 
 void *cmark_node_get_user_data(cmark_node *node) {
-  if (node == NULL) {
+  if (node == NULL || node->cold == NULL) {
     return NULL;
   } else {
-    return node->user_data;
+    return node->cold->user_data;
   }
 }
 
@@ -393,7 +709,7 @@ int cmark_node_set_user_data(cmark_node *node, void *user_data) {
   if (node == NULL) {
     return 0;
   }
-  node->user_data = user_data;
+  cmark_node_cold_fields(node)->user_data = user_data;
   return 1;
 }
 
@@ -402,7 +718,7 @@ int cmark_node_set_user_data_free_func(cmark_node *node,
   if (node == NULL) {
     return 0;
   }
-  node->user_data_free_func = free_func;
+  cmark_node_cold_fields(node)->user_data_free_func = free_func;
   return 1;
 }
 
@@ -439,6 +755,8 @@ int cmark_node_set_literal(cmark_node *node, const char *content) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_HTML_BLOCK:
   case CMARK_NODE_TEXT:
@@ -460,11 +778,13 @@ int cmark_node_set_literal(cmark_node *node, const char *content) {
 }
 
 const char *cmark_node_get_string_content(cmark_node *node) {
-  return (char *) node->content.ptr;
+  if (node->cold == NULL)
+    return "";
+  return (char *) node->cold->content.ptr;
 }
 
 int cmark_node_set_string_content(cmark_node *node, const char *content) {
-  cmark_strbuf_sets(&node->content, content);
+  cmark_strbuf_sets(cmark_node_content(node), content);
   return true;
 }
 
@@ -489,6 +809,8 @@ int cmark_node_set_heading_level(cmark_node *node, int level) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_HEADING:
     node->as.heading.level = level;
@@ -522,6 +844,8 @@ int cmark_node_set_list_type(cmark_node *node, cmark_list_type type) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_LIST) {
     node->as.list.list_type = type;
     return 1;
@@ -551,6 +875,8 @@ int cmark_node_set_list_delim(cmark_node *node, cmark_delim_type delim) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_LIST) {
     node->as.list.delimiter = delim;
     return 1;
@@ -576,6 +902,8 @@ int cmark_node_set_list_start(cmark_node *node, int start) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_LIST) {
     node->as.list.start = start;
     return 1;
@@ -601,6 +929,8 @@ int cmark_node_set_list_tight(cmark_node *node, int tight) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_LIST) {
     node->as.list.tight = tight == 1;
     return 1;
@@ -626,6 +956,8 @@ int cmark_node_set_item_index(cmark_node *node, int idx) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_ITEM) {
     node->as.list.start = idx;
     return 1;
@@ -651,6 +983,8 @@ int cmark_node_set_fence_info(cmark_node *node, const char *info) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_CODE_BLOCK) {
     cmark_chunk_set_cstr(NODE_MEM(node), &node->as.code.info, info);
     return 1;
@@ -680,6 +1014,8 @@ int cmark_node_set_fenced(cmark_node * node, int fenced,
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   if (node->type == CMARK_NODE_CODE_BLOCK) {
     node->as.code.fenced = (int8_t)fenced;
     node->as.code.fence_length = (uint8_t)length;
@@ -712,6 +1048,8 @@ int cmark_node_set_url(cmark_node *node, const char *url) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_LINK:
   case CMARK_NODE_IMAGE:
@@ -745,6 +1083,8 @@ int cmark_node_set_title(cmark_node *node, const char *title) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_LINK:
   case CMARK_NODE_IMAGE:
@@ -777,6 +1117,8 @@ int cmark_node_set_attributes(cmark_node *node, const char *attributes) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_ATTRIBUTE:
     cmark_chunk_set_cstr(NODE_MEM(node), &node->as.attribute.attributes, attributes);
@@ -809,6 +1151,8 @@ int cmark_node_set_on_enter(cmark_node *node, const char *on_enter) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_CUSTOM_INLINE:
   case CMARK_NODE_CUSTOM_BLOCK:
@@ -842,6 +1186,8 @@ int cmark_node_set_on_exit(cmark_node *node, const char *on_exit) {
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   switch (node->type) {
   case CMARK_NODE_CUSTOM_INLINE:
   case CMARK_NODE_CUSTOM_BLOCK:
@@ -867,6 +1213,8 @@ int cmark_node_set_syntax_extension(cmark_node *node, cmark_syntax_extension *ex
     return 0;
   }
 
+  cmark_node_invalidate_hash(node);
+
   node->extension = extension;
   return 1;
 }
@@ -915,6 +1263,7 @@ static void S_node_unlink(cmark_node *node) {
   // Adjust first_child and last_child of parent.
   cmark_node *parent = node->parent;
   if (parent) {
+    cmark_node_invalidate_hash(parent);
     if (parent->first_child == node) {
       parent->first_child = node->next;
     }
@@ -961,6 +1310,7 @@ int cmark_node_insert_before(cmark_node *node, cmark_node *sibling) {
   if (parent && !old_prev) {
     parent->first_child = sibling;
   }
+  cmark_node_invalidate_hash(parent);
 
   return 1;
 }
@@ -994,6 +1344,7 @@ int cmark_node_insert_after(cmark_node *node, cmark_node *sibling) {
   if (parent && !old_next) {
     parent->last_child = sibling;
   }
+  cmark_node_invalidate_hash(parent);
 
   return 1;
 }
@@ -1019,6 +1370,7 @@ int cmark_node_prepend_child(cmark_node *node, cmark_node *child) {
   child->prev = NULL;
   child->parent = node;
   node->first_child = child;
+  cmark_node_invalidate_hash(node);
 
   if (old_first_child) {
     old_first_child->prev = child;
@@ -1043,6 +1395,7 @@ int cmark_node_append_child(cmark_node *node, cmark_node *child) {
   child->prev = old_last_child;
   child->parent = node;
   node->last_child = child;
+  cmark_node_invalidate_hash(node);
 
   if (old_last_child) {
     old_last_child->next = child;
@@ -1054,6 +1407,287 @@ int cmark_node_append_child(cmark_node *node, cmark_node *child) {
   return 1;
 }
 
+// Hashes 'len' bytes into 'hash' eight at a time, in the manner of FNV-1a.
+uint64_t cmark_hash_bytes(uint64_t hash, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t word;
+
+  for (; len >= 8; p += 8, len -= 8) {
+    memcpy(&word, p, 8);
+    hash = (hash ^ word) * 1099511628211u;
+    hash ^= hash >> 29;
+  }
+  for (; len; ++p, --len)
+    hash = (hash ^ *p) * 1099511628211u;
+  return hash;
+}
+
+static uint64_t S_hash_int(uint64_t hash, int64_t value) {
+  return cmark_hash_bytes(hash, &value, sizeof(value));
+}
+
+// Mixes in the length first so that the strings of a node cannot run into
+// each other.
+static uint64_t S_hash_chunk(uint64_t hash, const cmark_chunk *c) {
+  hash = S_hash_int(hash, c->len);
+  return cmark_hash_bytes(hash, c->data, (size_t)c->len);
+}
+
+// The final mix of MurmurHash3, so that every bit of a child's hash moves
+// every bit of its parent's.
+static uint64_t S_hash_finish(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdu;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53u;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+// Hashes what 'node' holds itself: its type and everything its accessors
+// return apart from its position and its children.
+static uint64_t S_local_hash(cmark_node *node) {
+  uint64_t hash = S_hash_int(14695981039346656037u, node->type);
+
+  switch (node->type) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_ITEM:
+    hash = S_hash_int(hash, node->as.list.list_type);
+    hash = S_hash_int(hash, node->as.list.delimiter);
+    hash = S_hash_int(hash, node->as.list.start);
+    hash = S_hash_int(hash, node->as.list.bullet_char |
+                                node->as.list.tight << 8 |
+                                node->as.list.checked << 9);
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    hash = S_hash_chunk(hash, &node->as.code.info);
+    hash = S_hash_chunk(hash, &node->as.code.literal);
+    hash = S_hash_int(hash, node->as.code.fenced);
+    hash = S_hash_int(hash, node->as.code.fence_length |
+                                node->as.code.fence_offset << 8 |
+                                node->as.code.fence_char << 16);
+    break;
+  case CMARK_NODE_CODE:
+    hash = S_hash_int(hash, node->backtick_count);
+    hash = S_hash_chunk(hash, &node->as.literal);
+    break;
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    // The numbers the renderers give footnotes and their references, and
+    // the label of the definition a reference links to.
+    if (node->cold) {
+      hash = S_hash_int(hash, node->cold->footnote.ref_ix);
+      if (node->cold->parent_footnote_def)
+        hash = S_hash_chunk(hash,
+                            &node->cold->parent_footnote_def->as.literal);
+    }
+    hash = S_hash_chunk(hash, &node->as.literal);
+    break;
+  case CMARK_NODE_HTML_BLOCK:
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+    hash = S_hash_chunk(hash, &node->as.literal);
+    break;
+  case CMARK_NODE_HEADING:
+    hash = S_hash_int(hash, node->as.heading.level);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    hash = S_hash_chunk(hash, &node->as.link.url);
+    hash = S_hash_chunk(hash, &node->as.link.title);
+    break;
+  case CMARK_NODE_ATTRIBUTE:
+    hash = S_hash_chunk(hash, &node->as.attribute.attributes);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    hash = S_hash_chunk(hash, &node->as.custom.on_enter);
+    hash = S_hash_chunk(hash, &node->as.custom.on_exit);
+    break;
+  default:
+    break;
+  }
+
+  if (node->extension) {
+    // Extensions such as the task list one give core nodes their own
+    // rendering, so the extension is part of the node.
+    const char *name = node->extension->name;
+    hash = cmark_hash_bytes(hash, name, strlen(name) + 1);
+    if (node->extension->hash_func)
+      hash = node->extension->hash_func(node->extension, node, hash);
+  }
+
+  return hash;
+}
+
+static void S_set_hash(cmark_node *node) {
+  uint64_t hash = S_local_hash(node);
+  cmark_node *child;
+
+  for (child = node->first_child; child; child = child->next)
+    hash = cmark_hash_bytes(hash, &child->cold->hash,
+                            sizeof(child->cold->hash));
+  cmark_node_cold_fields(node)->hash = S_hash_finish(hash);
+  node->flags |= CMARK_NODE__HASHED;
+}
+
+static cmark_node *S_first_unhashed(cmark_node *node) {
+  while (node && (node->flags & CMARK_NODE__HASHED))
+    node = node->next;
+  return node;
+}
+
+uint64_t cmark_node_hash(cmark_node *root) {
+  cmark_node *node = root, *next;
+
+  if (root == NULL)
+    return 0;
+
+  // Hashes the nodes without a hash in post-order without recursing, so
+  // that deeply nested documents cannot overflow the stack.  The children
+  // of a node are all hashed by the time it is reached again from its last
+  // one.
+  while (!(node->flags & CMARK_NODE__HASHED)) {
+    while ((next = S_first_unhashed(node->first_child)) != NULL)
+      node = next;
+    S_set_hash(node);
+    if (node == root)
+      break;
+    next = S_first_unhashed(node->next);
+    node = next ? next : node->parent;
+  }
+
+  return root->cold->hash;
+}
+
+void cmark_node_invalidate_hash(cmark_node *node) {
+  while (node && (node->flags & CMARK_NODE__HASHED)) {
+    node->flags &= ~CMARK_NODE__HASHED;
+    node = node->parent;
+  }
+}
+
+// A pair of nodes to compare, or to report when 'report' is set.
+typedef struct {
+  cmark_node *old_node;
+  cmark_node *new_node;
+  bool report;
+} diff_item;
+
+typedef struct {
+  cmark_mem *mem;
+  diff_item *items;
+  size_t size, alloc;
+} diff_stack;
+
+static void S_diff_push(diff_stack *stack, cmark_node *old_node,
+                        cmark_node *new_node, bool report) {
+  if (stack->size == stack->alloc) {
+    stack->alloc = stack->alloc ? stack->alloc * 2 : 32;
+    stack->items = (diff_item *)cmark_mem_realloc(
+        stack->mem, stack->items, stack->alloc * sizeof(diff_item));
+  }
+  stack->items[stack->size].old_node = old_node;
+  stack->items[stack->size].new_node = new_node;
+  stack->items[stack->size].report = report;
+  stack->size++;
+}
+
+// Both trees are hashed by the time they are compared, so every node has
+// its cold fields.
+static bool S_same_hash(cmark_node *a, cmark_node *b) {
+  return a && b && a->cold->hash == b->cold->hash;
+}
+
+// Pushes what is left to do for the children of 'old_node' and 'new_node'
+// in reverse document order, so that they are popped in document order.
+// The children both ends have in common are skipped.  In between, a child
+// equal to the next one on the other side is taken as inserted or removed,
+// and other children are paired up in order and compared in turn.
+static void S_diff_children(diff_stack *stack, cmark_node *old_node,
+                            cmark_node *new_node) {
+  cmark_node *a = old_node->first_child, *b = new_node->first_child;
+  cmark_node *a_stop = NULL, *b_stop = NULL, *a_next, *b_next;
+  size_t start = stack->size, i, j;
+
+  while (S_same_hash(a, b)) {
+    a = a->next;
+    b = b->next;
+  }
+  while (a != a_stop && b != b_stop) {
+    a_next = a_stop ? a_stop->prev : old_node->last_child;
+    b_next = b_stop ? b_stop->prev : new_node->last_child;
+    if (a_next->cold->hash != b_next->cold->hash)
+      break;
+    a_stop = a_next;
+    b_stop = b_next;
+  }
+
+  while (a != a_stop || b != b_stop) {
+    a_next = a != a_stop && a->next != a_stop ? a->next : NULL;
+    b_next = b != b_stop && b->next != b_stop ? b->next : NULL;
+
+    if (a == a_stop) {
+      S_diff_push(stack, NULL, b, true);
+      b = b->next;
+    } else if (b == b_stop) {
+      S_diff_push(stack, a, NULL, true);
+      a = a->next;
+    } else if (a->cold->hash == b->cold->hash) {
+      a = a->next;
+      b = b->next;
+    } else if (S_same_hash(a_next, b)) {
+      S_diff_push(stack, a, NULL, true);
+      a = a->next;
+    } else if (S_same_hash(a, b_next)) {
+      S_diff_push(stack, NULL, b, true);
+      b = b->next;
+    } else {
+      S_diff_push(stack, a, b, false);
+      a = a->next;
+      b = b->next;
+    }
+  }
+
+  for (i = start, j = stack->size; i + 1 < j; ++i, --j) {
+    diff_item tmp = stack->items[i];
+    stack->items[i] = stack->items[j - 1];
+    stack->items[j - 1] = tmp;
+  }
+}
+
+int cmark_node_diff(cmark_node *old_root, cmark_node *new_root,
+                    cmark_diff_func func, void *userdata) {
+  diff_stack stack = {NULL, NULL, 0, 0};
+  int changes = 0;
+
+  if (old_root == NULL || new_root == NULL)
+    return 0;
+
+  if (cmark_node_hash(old_root) == cmark_node_hash(new_root))
+    return 0;
+
+  stack.mem = NODE_MEM(old_root);
+  S_diff_push(&stack, old_root, new_root, false);
+
+  while (stack.size) {
+    diff_item item = stack.items[--stack.size];
+
+    if (!item.report && S_local_hash(item.old_node) ==
+                            S_local_hash(item.new_node)) {
+      S_diff_children(&stack, item.old_node, item.new_node);
+      continue;
+    }
+
+    ++changes;
+    if (func)
+      func(item.old_node, item.new_node, userdata);
+  }
+
+  cmark_mem_free(stack.mem, stack.items);
+  return changes;
+}
+
 static void S_print_error(FILE *out, cmark_node *node, const char *elem) {
   if (out == NULL) {
     return;
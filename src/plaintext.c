@@ -210,7 +210,7 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
 }
 
 char *cmark_render_plaintext(cmark_node *root, int options, int width) {
-  return cmark_render_plaintext_with_mem(root, options, width, cmark_node_mem(root));
+  return cmark_render_plaintext_with_mem(root, options, width, cmark_node_output_mem(root));
 }
 
 char *cmark_render_plaintext_with_mem(cmark_node *root, int options, int width, cmark_mem *mem) {
@@ -221,3 +221,14 @@ char *cmark_render_plaintext_with_mem(cmark_node *root, int options, int width,
   }
   return cmark_render(mem, root, options, width, outc, S_render_node);
 }
+
+void cmark_render_plaintext_to_sink(cmark_node *root, int options, int width,
+                                    cmark_write_func write, void *userdata) {
+  if (options & CMARK_OPT_HARDBREAKS) {
+    // disable breaking on width, since it has
+    // a different meaning with OPT_HARDBREAKS
+    width = 0;
+  }
+  cmark_render_to_sink(cmark_node_output_mem(root), root, options, width, outc,
+                       S_render_node, write, userdata);
+}
@@ -0,0 +1,60 @@
+#include <string.h>
+
+#include "pool.h"
+
+#define POOL_SLAB_ITEMS 64
+
+struct cmark_pool_slab {
+  struct cmark_pool_slab *prev;
+  // Items follow, aligned like the slab header itself.
+};
+
+void cmark_pool_init(cmark_pool *pool, cmark_mem *mem, size_t item_size) {
+  const size_t align = sizeof(void *) - 1;
+
+  memset(pool, 0, sizeof(*pool));
+  pool->mem = mem;
+  // Every item must be able to hold the free list link.
+  if (item_size < sizeof(void *))
+    item_size = sizeof(void *);
+  pool->item_size = (item_size + align) & ~align;
+  pool->slab_used = POOL_SLAB_ITEMS;
+}
+
+void *cmark_pool_alloc(cmark_pool *pool) {
+  unsigned char *item;
+
+  if (pool->free_items) {
+    item = (unsigned char *)pool->free_items;
+    pool->free_items = *(void **)item;
+    memset(item, 0, pool->item_size);
+    return item;
+  }
+
+  if (pool->slab_used == POOL_SLAB_ITEMS) {
+    struct cmark_pool_slab *slab = (struct cmark_pool_slab *)cmark_mem_calloc(
+        pool->mem, 1, sizeof(*slab) + POOL_SLAB_ITEMS * pool->item_size);
+    slab->prev = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_used = 0;
+  }
+
+  item = (unsigned char *)(pool->slabs + 1) +
+         pool->slab_used++ * pool->item_size;
+  return item;
+}
+
+void cmark_pool_free(cmark_pool *pool, void *item) {
+  *(void **)item = pool->free_items;
+  pool->free_items = item;
+}
+
+void cmark_pool_release(cmark_pool *pool) {
+  while (pool->slabs) {
+    struct cmark_pool_slab *prev = pool->slabs->prev;
+    cmark_mem_free(pool->mem, pool->slabs);
+    pool->slabs = prev;
+  }
+  pool->free_items = NULL;
+  pool->slab_used = POOL_SLAB_ITEMS;
+}
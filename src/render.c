@@ -21,6 +21,13 @@ static inline void S_blankline(cmark_renderer *renderer) {
   }
 }
 
+static cmark_syntax_extension *S_nearest_extension(cmark_node *node) {
+  cmark_syntax_extension *ext = NULL;
+  for (; node && !ext; node = node->parent)
+    ext = node->extension;
+  return ext;
+}
+
 static void S_out(cmark_renderer *renderer, cmark_node *node,
                   const char *source, bool wrap,
                   cmark_escaping escape) {
@@ -33,7 +40,9 @@ static void S_out(cmark_renderer *renderer, cmark_node *node,
   cmark_chunk remainder = cmark_chunk_literal("");
   int k = renderer->buffer->size - 1;
 
-  cmark_syntax_extension *ext = node->ancestor_extension;
+  cmark_syntax_extension *ext = node == renderer->escape_node
+                                    ? renderer->escape_extension
+                                    : S_nearest_extension(node);
   if (ext && !ext->commonmark_escape_func)
     ext = NULL;
 
@@ -157,32 +166,84 @@ void cmark_render_code_point(cmark_renderer *renderer, uint32_t c) {
   renderer->column += 1;
 }
 
-char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
-                   void (*outc)(cmark_renderer *, cmark_node *,
-                                cmark_escaping, int32_t,
-                                unsigned char),
-                   int (*render_node)(cmark_renderer *renderer,
-                                      cmark_node *node,
-                                      cmark_event_type ev_type, int options)) {
-  cmark_strbuf pref = CMARK_BUF_INIT(mem);
-  cmark_strbuf buf = CMARK_BUF_INIT(mem);
+// Passes everything before the line being rendered on to 'write'.  Line
+// wrapping can still rewrite that line back to its last breakable space,
+// and S_out and the renderers look at the byte before it.
+static void S_flush(cmark_renderer *renderer, cmark_write_func write,
+                    void *userdata) {
+  cmark_strbuf *buf = renderer->buffer;
+  bufsize_t len = cmark_strbuf_strrchr(buf, '\n', buf->size - 1) - 1;
+
+  if (renderer->last_breakable > 0 && len >= renderer->last_breakable)
+    len = renderer->last_breakable - 1;
+  if (len <= 0)
+    return;
+
+  write((const char *)buf->ptr, (size_t)len, userdata);
+  cmark_strbuf_drop(buf, len);
+  if (renderer->last_breakable > 0)
+    renderer->last_breakable -= len;
+}
+
+// The nodes from the root down to the one being rendered, each with the
+// nearest extension among it and its ancestors, so that finding that
+// extension does not take a walk up the tree for every node.
+typedef struct {
+  cmark_node *node;
+  cmark_syntax_extension *extension;
+} escape_frame;
+
+typedef struct {
+  cmark_mem *mem;
+  escape_frame *frames;
+  size_t size, alloc;
+} escape_stack;
+
+static void S_track_escape(cmark_renderer *renderer, escape_stack *stack,
+                           cmark_node *cur, cmark_event_type ev_type) {
+  cmark_node *top = ev_type == CMARK_EVENT_EXIT ? cur : cur->parent;
+  cmark_syntax_extension *ext;
+
+  while (stack->size && stack->frames[stack->size - 1].node != top)
+    --stack->size;
+
+  if (ev_type == CMARK_EVENT_EXIT && stack->size) {
+    ext = stack->frames[stack->size - 1].extension;
+  } else {
+    ext = cur->extension;
+    if (!ext)
+      ext = stack->size ? stack->frames[stack->size - 1].extension
+                        : S_nearest_extension(cur->parent);
+    if (ev_type == CMARK_EVENT_ENTER) {
+      if (stack->size == stack->alloc) {
+        stack->alloc = stack->alloc ? stack->alloc * 2 : 32;
+        stack->frames = (escape_frame *)cmark_mem_realloc(
+            stack->mem, stack->frames, stack->alloc * sizeof(escape_frame));
+      }
+      stack->frames[stack->size].node = cur;
+      stack->frames[stack->size].extension = ext;
+      ++stack->size;
+    }
+  }
+
+  renderer->escape_node = cur;
+  renderer->escape_extension = ext;
+}
+
+static void S_render(cmark_renderer *renderer, cmark_node *root, int options,
+                     int (*render_node)(cmark_renderer *renderer,
+                                        cmark_node *node,
+                                        cmark_event_type ev_type, int options),
+                     cmark_write_func write, void *userdata) {
   cmark_node *cur;
   cmark_event_type ev_type;
-  char *result;
   cmark_iter *iter = cmark_iter_new(root);
-
-  cmark_renderer renderer = {mem,   &buf, &pref, 0,           width,
-                             0,     0,    true,  true,        false,
-                             false, outc, S_cr,  S_blankline, S_out,
-                             0};
+  bufsize_t flush_size = CMARK_SINK_CHUNK_SIZE;
+  escape_stack stack = {renderer->mem, NULL, 0, 0};
 
   while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
     cur = cmark_iter_get_node(iter);
-    if (cur->extension) {
-      cur->ancestor_extension = cur->extension;
-    } else if (cur->parent) {
-      cur->ancestor_extension = cur->parent->ancestor_extension;
-    }
+    S_track_escape(renderer, &stack, cur, ev_type);
     if (cur->type == CMARK_NODE_ITEM) {
       // Calculate the list item's index, for the benefit of output formats
       // like commonmark and plaintext.
@@ -192,24 +253,76 @@ char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
         cmark_node_set_item_index(cur, cmark_node_get_list_start(cur->parent));
       }
     }
-    if (!render_node(&renderer, cur, ev_type, options)) {
+    if (!render_node(renderer, cur, ev_type, options)) {
       // a false value causes us to skip processing
       // the node's contents.  this is used for
       // autolinks.
       cmark_iter_reset(iter, cur, CMARK_EVENT_EXIT);
     }
+    if (write && renderer->buffer->size >= flush_size) {
+      S_flush(renderer, write, userdata);
+      // A line longer than a chunk is only looked at again a chunk later.
+      flush_size = renderer->buffer->size + CMARK_SINK_CHUNK_SIZE;
+    }
   }
 
   // ensure final newline
-  if (renderer.buffer->size == 0 || renderer.buffer->ptr[renderer.buffer->size - 1] != '\n') {
-    cmark_strbuf_putc(renderer.buffer, '\n');
+  if (renderer->buffer->size == 0 || renderer->buffer->ptr[renderer->buffer->size - 1] != '\n') {
+    cmark_strbuf_putc(renderer->buffer, '\n');
   }
 
+  renderer->escape_node = NULL;
+  cmark_mem_free(stack.mem, stack.frames);
+  cmark_iter_free(iter);
+}
+
+char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
+                   void (*outc)(cmark_renderer *, cmark_node *,
+                                cmark_escaping, int32_t,
+                                unsigned char),
+                   int (*render_node)(cmark_renderer *renderer,
+                                      cmark_node *node,
+                                      cmark_event_type ev_type, int options)) {
+  cmark_strbuf pref = CMARK_BUF_INIT(mem);
+  cmark_strbuf buf = CMARK_BUF_INIT(mem);
+  char *result;
+
+  cmark_renderer renderer = {mem,   &buf, &pref, 0,           width,
+                             0,     0,    true,  true,        false,
+                             false, outc, S_cr,  S_blankline, S_out,
+                             0,     NULL, NULL};
+
+  S_render(&renderer, root, options, render_node, NULL, NULL);
+
   result = (char *)cmark_strbuf_detach(renderer.buffer);
 
-  cmark_iter_free(iter);
   cmark_strbuf_free(renderer.prefix);
   cmark_strbuf_free(renderer.buffer);
 
   return result;
 }
+
+void cmark_render_to_sink(cmark_mem *mem, cmark_node *root, int options,
+                          int width,
+                          void (*outc)(cmark_renderer *, cmark_node *,
+                                       cmark_escaping, int32_t,
+                                       unsigned char),
+                          int (*render_node)(cmark_renderer *renderer,
+                                             cmark_node *node,
+                                             cmark_event_type ev_type,
+                                             int options),
+                          cmark_write_func write, void *userdata) {
+  cmark_strbuf pref = CMARK_BUF_INIT(mem);
+  cmark_strbuf buf = CMARK_BUF_INIT(mem);
+
+  cmark_renderer renderer = {mem,   &buf, &pref, 0,           width,
+                             0,     0,    true,  true,        false,
+                             false, outc, S_cr,  S_blankline, S_out,
+                             0,     NULL, NULL};
+
+  S_render(&renderer, root, options, render_node, write, userdata);
+  write((const char *)buf.ptr, (size_t)buf.size, userdata);
+
+  cmark_strbuf_free(renderer.prefix);
+  cmark_strbuf_free(renderer.buffer);
+}
@@ -1,34 +1,32 @@
 /* Generated by re2c 3.0 */
+/* The input accesses were converted by hand to the YYPEEK/YYSKIP API that
+   the .re file declares; regenerate with `make src/scanners.c` (re2c >= 1.2). */
 #include "scanners.h"
 #include "chunk.h"
 #include <stdlib.h>
 
-bufsize_t _scan_at(bufsize_t (*scanner)(const unsigned char *), cmark_chunk *c,
-                   bufsize_t offset) {
-  bufsize_t res;
-  unsigned char *ptr = (unsigned char *)c->data;
+bufsize_t _scan_at(bufsize_t (*scanner)(const unsigned char *,
+                                        const unsigned char *),
+                   const cmark_chunk *c, bufsize_t offset) {
+  const unsigned char *ptr = c->data;
 
   if (ptr == NULL || offset > c->len) {
     return 0;
-  } else {
-    unsigned char lim = ptr[c->len];
-
-    ptr[c->len] = '\0';
-    res = scanner(ptr + offset);
-    ptr[c->len] = lim;
   }
 
-  return res;
+  // The scanners read no further than the end of the chunk, and take
+  // it for a NUL byte.
+  return scanner(ptr + offset, ptr + c->len);
 }
 
 // Try to match a scheme including colon.
-bufsize_t _scan_scheme(const unsigned char *p) {
+bufsize_t _scan_scheme(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
   {
     unsigned char yych;
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@')
       goto yy1;
     if (yych <= 'Z')
@@ -41,7 +39,9 @@ bufsize_t _scan_scheme(const unsigned char *p) {
     ++p;
   yy2 : { return 0; }
   yy3:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= '+') {
         if (yych <= '*')
@@ -66,7 +66,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
       }
     }
   yy4:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych == '+')
@@ -92,7 +93,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
     p = marker;
     goto yy2;
   yy6:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych == '+')
@@ -122,7 +124,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy8:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -144,7 +147,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -166,7 +170,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -188,7 +193,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -210,7 +216,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -232,7 +239,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -254,7 +262,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -276,7 +285,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -298,7 +308,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -320,7 +331,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -342,7 +354,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -364,7 +377,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -386,7 +400,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -408,7 +423,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -430,7 +446,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -452,7 +469,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -474,7 +492,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -496,7 +515,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -518,7 +538,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -540,7 +561,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -562,7 +584,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -584,7 +607,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -606,7 +630,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -628,7 +653,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -650,7 +676,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -672,7 +699,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -694,7 +722,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -716,7 +745,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -738,7 +768,8 @@ bufsize_t _scan_scheme(const unsigned char *p) {
           goto yy5;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == ':')
       goto yy7;
     goto yy5;
@@ -746,7 +777,7 @@ bufsize_t _scan_scheme(const unsigned char *p) {
 }
 
 // Try to match URI autolink after first <, returning number of chars matched.
-bufsize_t _scan_autolink_uri(const unsigned char *p) {
+bufsize_t _scan_autolink_uri(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -773,7 +804,7 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@')
       goto yy10;
     if (yych <= 'Z')
@@ -786,7 +817,9 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
     ++p;
   yy11 : { return 0; }
   yy12:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= '+') {
         if (yych <= '*')
@@ -811,7 +844,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
       }
     }
   yy13:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych == '+')
@@ -837,7 +871,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
     p = marker;
     goto yy11;
   yy15:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych == '+')
@@ -864,7 +899,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
       }
     }
   yy16:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy16;
     }
@@ -898,7 +934,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
       }
     }
   yy17:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych == '+')
@@ -928,56 +965,64 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy19:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy14;
     if (yych <= 0xBF)
       goto yy16;
     goto yy14;
   yy20:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy14;
     if (yych <= 0xBF)
       goto yy19;
     goto yy14;
   yy21:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy14;
     if (yych <= 0xBF)
       goto yy19;
     goto yy14;
   yy22:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy14;
     if (yych <= 0x9F)
       goto yy19;
     goto yy14;
   yy23:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy14;
     if (yych <= 0xBF)
       goto yy21;
     goto yy14;
   yy24:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy14;
     if (yych <= 0xBF)
       goto yy21;
     goto yy14;
   yy25:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy14;
     if (yych <= 0x8F)
       goto yy21;
     goto yy14;
   yy26:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -999,7 +1044,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1021,7 +1067,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1043,7 +1090,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1065,7 +1113,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1087,7 +1136,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1109,7 +1159,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1131,7 +1182,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1153,7 +1205,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1175,7 +1228,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1197,7 +1251,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1219,7 +1274,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1241,7 +1297,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1263,7 +1320,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1285,7 +1343,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1307,7 +1366,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1329,7 +1389,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1351,7 +1412,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1373,7 +1435,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1395,7 +1458,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1417,7 +1481,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1439,7 +1504,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1461,7 +1527,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1483,7 +1550,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1505,7 +1573,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1527,7 +1596,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1549,7 +1619,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= ',') {
         if (yych != '+')
@@ -1571,7 +1642,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
           goto yy14;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == ':')
       goto yy16;
     goto yy14;
@@ -1579,7 +1651,8 @@ bufsize_t _scan_autolink_uri(const unsigned char *p) {
 }
 
 // Try to match email autolink after first <, returning num of chars matched.
-bufsize_t _scan_autolink_email(const unsigned char *p) {
+bufsize_t _scan_autolink_email(const unsigned char *p,
+                               const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -1606,7 +1679,7 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych <= '\'') {
         if (yych == '!')
@@ -1641,7 +1714,9 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
     ++p;
   yy29 : { return 0; }
   yy30:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= ',') {
       if (yych <= '"') {
         if (yych == '!')
@@ -1674,7 +1749,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy31:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy32:
     if (yybm[0 + yych] & 128) {
       goto yy31;
@@ -1687,7 +1763,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
     p = marker;
     goto yy29;
   yy34:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych <= '/')
         goto yy33;
@@ -1702,7 +1779,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
         goto yy33;
     }
   yy35:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1731,7 +1809,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
         goto yy33;
       }
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy38;
@@ -1752,7 +1831,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy36:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1786,7 +1866,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy38:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy40;
@@ -1807,7 +1888,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy39:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1837,7 +1919,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy40:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy42;
@@ -1858,7 +1941,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy41:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1888,7 +1972,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy42:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy44;
@@ -1909,7 +1994,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy43:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1939,7 +2025,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy44:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy46;
@@ -1960,7 +2047,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy45:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -1990,7 +2078,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy46:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy48;
@@ -2011,7 +2100,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy47:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2041,7 +2131,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy48:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy50;
@@ -2062,7 +2153,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy49:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2092,7 +2184,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy50:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy52;
@@ -2113,7 +2206,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy51:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2143,7 +2237,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy52:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy54;
@@ -2164,7 +2259,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy53:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2194,7 +2290,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy54:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy56;
@@ -2215,7 +2312,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy55:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2245,7 +2343,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy56:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy58;
@@ -2266,7 +2365,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy57:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2296,7 +2396,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy58:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy60;
@@ -2317,7 +2418,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy59:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2347,7 +2449,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy60:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy62;
@@ -2368,7 +2471,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy61:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2398,7 +2502,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy62:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy64;
@@ -2419,7 +2524,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy63:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2449,7 +2555,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy64:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy66;
@@ -2470,7 +2577,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy65:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2500,7 +2608,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy66:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy68;
@@ -2521,7 +2630,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy67:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2551,7 +2661,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy68:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy70;
@@ -2572,7 +2683,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy69:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2602,7 +2714,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy70:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy72;
@@ -2623,7 +2736,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy71:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2653,7 +2767,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy72:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy74;
@@ -2674,7 +2789,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy73:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2704,7 +2820,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy74:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy76;
@@ -2725,7 +2842,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy75:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2755,7 +2873,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy76:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy78;
@@ -2776,7 +2895,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy77:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2806,7 +2926,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy78:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy80;
@@ -2827,7 +2948,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy79:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2857,7 +2979,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy80:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy82;
@@ -2878,7 +3001,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy81:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2908,7 +3032,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy82:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy84;
@@ -2929,7 +3054,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy83:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -2959,7 +3085,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy84:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy86;
@@ -2980,7 +3107,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy85:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3010,7 +3138,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy86:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy88;
@@ -3031,7 +3160,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy87:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3061,7 +3191,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy88:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy90;
@@ -3082,7 +3213,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy89:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3112,7 +3244,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy90:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy92;
@@ -3133,7 +3266,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy91:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3163,7 +3297,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy92:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy94;
@@ -3184,7 +3319,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy93:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3214,7 +3350,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy94:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy96;
@@ -3235,7 +3372,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy95:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3265,7 +3403,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy96:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy98;
@@ -3286,7 +3425,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy97:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3316,7 +3456,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy98:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy100;
@@ -3337,7 +3478,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy99:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3367,7 +3509,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy100:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy102;
@@ -3388,7 +3531,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy101:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3418,7 +3562,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy102:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy104;
@@ -3439,7 +3584,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy103:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3469,7 +3615,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy104:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy106;
@@ -3490,7 +3637,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy105:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3520,7 +3668,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy106:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy108;
@@ -3541,7 +3690,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy107:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3571,7 +3721,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy108:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy110;
@@ -3592,7 +3743,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy109:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3622,7 +3774,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy110:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy112;
@@ -3643,7 +3796,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy111:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3673,7 +3827,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy112:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy114;
@@ -3694,7 +3849,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy113:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3724,7 +3880,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy114:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy116;
@@ -3745,7 +3902,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy115:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3775,7 +3933,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy116:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy118;
@@ -3796,7 +3955,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy117:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3826,7 +3986,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy118:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy120;
@@ -3847,7 +4008,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy119:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3877,7 +4039,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy120:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy122;
@@ -3898,7 +4061,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy121:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3928,7 +4092,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy122:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy124;
@@ -3949,7 +4114,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy123:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -3979,7 +4145,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy124:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy126;
@@ -4000,7 +4167,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy125:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4030,7 +4198,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy126:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy128;
@@ -4051,7 +4220,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy127:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4081,7 +4251,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy128:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy130;
@@ -4102,7 +4273,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy129:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4132,7 +4304,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy130:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy132;
@@ -4153,7 +4326,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy131:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4183,7 +4357,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy132:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy134;
@@ -4204,7 +4379,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy133:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4234,7 +4410,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy134:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy136;
@@ -4255,7 +4432,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy135:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4285,7 +4463,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy136:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy138;
@@ -4306,7 +4485,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy137:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4336,7 +4516,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy138:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy140;
@@ -4357,7 +4538,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy139:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4387,7 +4569,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy140:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy142;
@@ -4408,7 +4591,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy141:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4438,7 +4622,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy142:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy144;
@@ -4459,7 +4644,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy143:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4489,7 +4675,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy144:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy146;
@@ -4510,7 +4697,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy145:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4540,7 +4728,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy146:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy148;
@@ -4561,7 +4750,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy147:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4591,7 +4781,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy148:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy150;
@@ -4612,7 +4803,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy149:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4642,7 +4834,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy150:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy152;
@@ -4663,7 +4856,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy151:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4693,7 +4887,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy152:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy154;
@@ -4714,7 +4909,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy153:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4744,7 +4940,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy154:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '9') {
       if (yych == '-')
         goto yy156;
@@ -4765,7 +4962,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy155:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= ',')
@@ -4795,7 +4993,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy156:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych <= '/')
         goto yy33;
@@ -4812,7 +5011,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       goto yy33;
     }
   yy157:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= '.') {
         if (yych <= '-')
@@ -4838,7 +5038,8 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
       }
     }
   yy158:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '.')
       goto yy34;
     if (yych == '>')
@@ -4848,7 +5049,7 @@ bufsize_t _scan_autolink_email(const unsigned char *p) {
 }
 
 // Try to match an HTML tag after first <, returning num of chars matched.
-bufsize_t _scan_html_tag(const unsigned char *p) {
+bufsize_t _scan_html_tag(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -4875,7 +5076,7 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych == '/')
         goto yy162;
@@ -4891,7 +5092,9 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
     ++p;
   yy161 : { return 0; }
   yy162:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@')
       goto yy161;
     if (yych <= 'Z')
@@ -4902,7 +5105,9 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       goto yy164;
     goto yy161;
   yy163:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '.') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -4935,7 +5140,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy164:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 4) {
       goto yy164;
     }
@@ -4954,7 +5160,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
     p = marker;
     goto yy161;
   yy166:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 8) {
       goto yy166;
     }
@@ -4986,7 +5193,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy167:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy168:
     if (yybm[0 + yych] & 8) {
       goto yy166;
@@ -5019,14 +5227,16 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy169:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != '>')
       goto yy165;
   yy170:
     ++p;
     { return (bufsize_t)(p - start); }
   yy171:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x1F) {
       if (yych <= 0x08)
         goto yy165;
@@ -5041,7 +5251,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       goto yy165;
     }
   yy172:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 16) {
       goto yy172;
     }
@@ -5067,7 +5278,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy173:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '<') {
       if (yych <= ' ') {
         if (yych <= 0x08)
@@ -5112,7 +5324,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy174:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy175;
     }
@@ -5148,7 +5361,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy175:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy175;
     }
@@ -5184,7 +5398,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy176:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy176;
     }
@@ -5218,7 +5433,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy177:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy177;
     }
@@ -5252,56 +5468,64 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       }
     }
   yy178:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy175;
     goto yy165;
   yy179:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy178;
     goto yy165;
   yy180:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy178;
     goto yy165;
   yy181:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x9F)
       goto yy178;
     goto yy165;
   yy182:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy180;
     goto yy165;
   yy183:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy180;
     goto yy165;
   yy184:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x8F)
       goto yy180;
     goto yy165;
   yy185:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 8) {
       goto yy166;
     }
@@ -5311,98 +5535,112 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
       goto yy170;
     goto yy165;
   yy186:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy176;
     goto yy165;
   yy187:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy186;
     goto yy165;
   yy188:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy186;
     goto yy165;
   yy189:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x9F)
       goto yy186;
     goto yy165;
   yy190:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy188;
     goto yy165;
   yy191:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy188;
     goto yy165;
   yy192:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x8F)
       goto yy188;
     goto yy165;
   yy193:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy177;
     goto yy165;
   yy194:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy193;
     goto yy165;
   yy195:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy193;
     goto yy165;
   yy196:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x9F)
       goto yy193;
     goto yy165;
   yy197:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy195;
     goto yy165;
   yy198:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0xBF)
       goto yy195;
     goto yy165;
   yy199:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy165;
     if (yych <= 0x8F)
@@ -5413,7 +5651,8 @@ bufsize_t _scan_html_tag(const unsigned char *p) {
 
 // Try to (liberally) match an HTML tag after first <, returning num of chars
 // matched.
-bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
+bufsize_t _scan_liberal_html_tag(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -5437,7 +5676,7 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
         0,  0,  0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xE0) {
       if (yych <= '\n') {
         if (yych <= 0x00)
@@ -5472,7 +5711,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
   yy202 : { return 0; }
   yy203:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy202;
@@ -5490,7 +5731,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     }
   yy204:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy202;
     if (yych <= 0xBF)
@@ -5498,7 +5741,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy205:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy202;
     if (yych <= 0xBF)
@@ -5506,7 +5751,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy206:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy202;
     if (yych <= 0xBF)
@@ -5514,7 +5761,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy207:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy202;
     if (yych <= 0x9F)
@@ -5522,7 +5771,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy208:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy202;
     if (yych <= 0xBF)
@@ -5530,7 +5781,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy209:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy202;
     if (yych <= 0xBF)
@@ -5538,14 +5791,17 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     goto yy202;
   yy210:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy202;
     if (yych <= 0x8F)
       goto yy218;
     goto yy202;
   yy211:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy212:
     if (yybm[0 + yych] & 64) {
       goto yy211;
@@ -5586,7 +5842,9 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     }
   yy214:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy211;
     }
@@ -5619,49 +5877,56 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
     }
   yy215 : { return (bufsize_t)(p - start); }
   yy216:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy213;
     if (yych <= 0xBF)
       goto yy211;
     goto yy213;
   yy217:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy213;
     if (yych <= 0xBF)
       goto yy216;
     goto yy213;
   yy218:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy213;
     if (yych <= 0xBF)
       goto yy216;
     goto yy213;
   yy219:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy213;
     if (yych <= 0x9F)
       goto yy216;
     goto yy213;
   yy220:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy213;
     if (yych <= 0xBF)
       goto yy218;
     goto yy213;
   yy221:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy213;
     if (yych <= 0xBF)
       goto yy218;
     goto yy213;
   yy222:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy213;
     if (yych <= 0x8F)
@@ -5670,7 +5935,7 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_html_comment(const unsigned char *p) {
+bufsize_t _scan_html_comment(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -5697,17 +5962,20 @@ bufsize_t _scan_html_comment(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '-')
       goto yy225;
     ++p;
   yy224 : { return 0; }
   yy225:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych != '-')
       goto yy224;
   yy226:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy226;
     }
@@ -5742,7 +6010,8 @@ bufsize_t _scan_html_comment(const unsigned char *p) {
     p = marker;
     goto yy224;
   yy228:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy226;
     }
@@ -5776,56 +6045,64 @@ bufsize_t _scan_html_comment(const unsigned char *p) {
       }
     }
   yy229:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy227;
     if (yych <= 0xBF)
       goto yy226;
     goto yy227;
   yy230:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy227;
     if (yych <= 0xBF)
       goto yy229;
     goto yy227;
   yy231:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy227;
     if (yych <= 0xBF)
       goto yy229;
     goto yy227;
   yy232:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy227;
     if (yych <= 0x9F)
       goto yy229;
     goto yy227;
   yy233:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy227;
     if (yych <= 0xBF)
       goto yy231;
     goto yy227;
   yy234:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy227;
     if (yych <= 0xBF)
       goto yy231;
     goto yy227;
   yy235:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy227;
     if (yych <= 0x8F)
       goto yy231;
     goto yy227;
   yy236:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xE0) {
       if (yych <= '>') {
         if (yych <= 0x00)
@@ -5861,7 +6138,7 @@ bufsize_t _scan_html_comment(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_html_pi(const unsigned char *p) {
+bufsize_t _scan_html_pi(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -5889,7 +6166,7 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy240;
     }
@@ -5925,7 +6202,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
   yy239 : { return 0; }
   yy240:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
   yy241:
     if (yybm[0 + yych] & 128) {
       goto yy240;
@@ -5960,7 +6239,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
   yy242 : { return (bufsize_t)(p - start); }
   yy243:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '?') {
       if (yych <= 0x00)
         goto yy239;
@@ -5979,7 +6260,8 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
       goto yy239;
     }
   yy244:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy239;
     if (yych <= 0xBF)
@@ -5987,7 +6269,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy245:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy239;
     if (yych <= 0xBF)
@@ -5995,7 +6279,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy246:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy239;
     if (yych <= 0xBF)
@@ -6003,7 +6289,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy247:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy239;
     if (yych <= 0x9F)
@@ -6011,7 +6299,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy248:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy239;
     if (yych <= 0xBF)
@@ -6019,7 +6309,9 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy249:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy239;
     if (yych <= 0xBF)
@@ -6027,14 +6319,17 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
     goto yy239;
   yy250:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy239;
     if (yych <= 0x8F)
       goto yy255;
     goto yy239;
   yy251:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xE0) {
       if (yych <= '>') {
         if (yych <= 0x00)
@@ -6072,49 +6367,56 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
       goto yy239;
     }
   yy253:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy252;
     if (yych <= 0xBF)
       goto yy240;
     goto yy252;
   yy254:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy252;
     if (yych <= 0xBF)
       goto yy253;
     goto yy252;
   yy255:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy252;
     if (yych <= 0xBF)
       goto yy253;
     goto yy252;
   yy256:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy252;
     if (yych <= 0x9F)
       goto yy253;
     goto yy252;
   yy257:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy252;
     if (yych <= 0xBF)
       goto yy255;
     goto yy252;
   yy258:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy252;
     if (yych <= 0xBF)
       goto yy255;
     goto yy252;
   yy259:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy252;
     if (yych <= 0x8F)
@@ -6123,7 +6425,8 @@ bufsize_t _scan_html_pi(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_html_declaration(const unsigned char *p) {
+bufsize_t _scan_html_declaration(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -6151,7 +6454,7 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@')
       goto yy261;
     if (yych <= 'Z')
@@ -6161,7 +6464,9 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
   yy262 : { return 0; }
   yy263:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy266;
     }
@@ -6173,7 +6478,9 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
       goto yy262;
   yy264:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy264;
     }
@@ -6202,7 +6509,8 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
     }
   yy265 : { return (bufsize_t)(p - start); }
   yy266:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy266;
     }
@@ -6220,49 +6528,56 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
       goto yy265;
     }
   yy268:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy267;
     if (yych <= 0xBF)
       goto yy264;
     goto yy267;
   yy269:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy267;
     if (yych <= 0xBF)
       goto yy268;
     goto yy267;
   yy270:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy267;
     if (yych <= 0xBF)
       goto yy268;
     goto yy267;
   yy271:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy267;
     if (yych <= 0x9F)
       goto yy268;
     goto yy267;
   yy272:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy267;
     if (yych <= 0xBF)
       goto yy270;
     goto yy267;
   yy273:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy267;
     if (yych <= 0xBF)
       goto yy270;
     goto yy267;
   yy274:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy267;
     if (yych <= 0x8F)
@@ -6271,7 +6586,7 @@ bufsize_t _scan_html_declaration(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_html_cdata(const unsigned char *p) {
+bufsize_t _scan_html_cdata(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -6299,7 +6614,7 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy277;
     if (yych == 'c')
@@ -6308,13 +6623,16 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
   yy276 : { return 0; }
   yy277:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy278;
     if (yych != 'd')
       goto yy276;
   yy278:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy280;
     if (yych == 'a')
@@ -6327,24 +6645,29 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
       goto yy284;
     }
   yy280:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy281;
     if (yych != 't')
       goto yy279;
   yy281:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy282;
     if (yych != 'a')
       goto yy279;
   yy282:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != '[')
       goto yy279;
   yy283:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy283;
     }
@@ -6377,7 +6700,8 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
     }
   yy284 : { return (bufsize_t)(p - start); }
   yy285:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy283;
     }
@@ -6411,56 +6735,64 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
       }
     }
   yy286:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy279;
     if (yych <= 0xBF)
       goto yy283;
     goto yy279;
   yy287:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy279;
     if (yych <= 0xBF)
       goto yy286;
     goto yy279;
   yy288:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy279;
     if (yych <= 0xBF)
       goto yy286;
     goto yy279;
   yy289:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy279;
     if (yych <= 0x9F)
       goto yy286;
     goto yy279;
   yy290:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy279;
     if (yych <= 0xBF)
       goto yy288;
     goto yy279;
   yy291:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy279;
     if (yych <= 0xBF)
       goto yy288;
     goto yy279;
   yy292:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy279;
     if (yych <= 0x8F)
       goto yy288;
     goto yy279;
   yy293:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xE0) {
       if (yych <= '>') {
         if (yych <= 0x00)
@@ -6498,18 +6830,21 @@ bufsize_t _scan_html_cdata(const unsigned char *p) {
 // Try to match an HTML block tag start line, returning
 // an integer code for the type of block (1-6, matching the spec).
 // #7 is handled by a separate function, below.
-bufsize_t _scan_html_block_start(const unsigned char *p) {
+bufsize_t _scan_html_block_start(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
 
   {
     unsigned char yych;
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '<')
       goto yy296;
     ++p;
   yy295 : { return 0; }
   yy296:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case '!':
       goto yy297;
@@ -6566,7 +6901,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy295;
     }
   yy297:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych == '-')
         goto yy316;
@@ -6580,7 +6916,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     p = marker;
     goto yy295;
   yy299:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case 'A':
     case 'a':
@@ -6634,7 +6971,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 3; }
   yy301:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'S') {
       if (yych <= 'D') {
         if (yych <= 'C')
@@ -6661,7 +6999,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy302:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'O') {
       if (yych <= 'K') {
         if (yych == 'A')
@@ -6688,7 +7027,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy303:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'O') {
       if (yych <= 'D') {
         if (yych == 'A')
@@ -6715,7 +7055,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy304:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case 'D':
     case 'L':
@@ -6734,7 +7075,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy298;
     }
   yy305:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'R') {
       if (yych <= 'N') {
         if (yych == 'I')
@@ -6761,7 +7103,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy306:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'S') {
       if (yych <= 'D') {
         if (yych <= '0')
@@ -6792,14 +7135,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy307:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'F')
       goto yy339;
     if (yych == 'f')
       goto yy339;
     goto yy298;
   yy308:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'I') {
       if (yych == 'E')
         goto yy340;
@@ -6818,7 +7163,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy309:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'E') {
       if (yych == 'A')
         goto yy342;
@@ -6837,7 +7183,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy310:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'O') {
       if (yych == 'A')
         goto yy344;
@@ -6856,7 +7203,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy311:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'P') {
       if (yych == 'L')
         goto yy331;
@@ -6875,7 +7223,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy312:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '>') {
       if (yych <= ' ') {
         if (yych <= 0x08)
@@ -6912,7 +7261,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy313:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case 'C':
     case 'c':
@@ -6933,7 +7283,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy298;
     }
   yy314:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case 'A':
     case 'a':
@@ -6963,14 +7314,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy298;
     }
   yy315:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy331;
     if (yych == 'l')
       goto yy331;
     goto yy298;
   yy316:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '-')
       goto yy363;
     goto yy298;
@@ -6978,14 +7331,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 4; }
   yy318:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy364;
     if (yych == 'c')
       goto yy364;
     goto yy298;
   yy319:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7014,7 +7369,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy320:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'U') {
       if (yych <= 'N') {
         if (yych == 'E')
@@ -7041,7 +7397,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy321:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     switch (yych) {
     case 'A':
     case 'a':
@@ -7068,70 +7425,80 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy298;
     }
   yy322:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy365;
     if (yych == 'd')
       goto yy365;
     goto yy298;
   yy323:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy366;
     if (yych == 't')
       goto yy366;
     goto yy298;
   yy324:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy367;
     if (yych == 'i')
       goto yy367;
     goto yy298;
   yy325:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'S')
       goto yy368;
     if (yych == 's')
       goto yy368;
     goto yy298;
   yy326:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy369;
     if (yych == 'o')
       goto yy369;
     goto yy298;
   yy327:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy370;
     if (yych == 'd')
       goto yy370;
     goto yy298;
   yy328:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy371;
     if (yych == 'p')
       goto yy371;
     goto yy298;
   yy329:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy372;
     if (yych == 'n')
       goto yy372;
     goto yy298;
   yy330:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy373;
     if (yych == 'l')
       goto yy373;
     goto yy298;
   yy331:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ' ') {
       if (yych <= 0x08)
         goto yy298;
@@ -7152,14 +7519,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy332:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy374;
     if (yych == 't')
       goto yy374;
     goto yy298;
   yy333:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'V') {
       if (yych <= 'Q') {
         if (yych == 'A')
@@ -7186,7 +7555,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy334:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'G') {
       if (yych == 'E')
         goto yy376;
@@ -7205,7 +7575,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy335:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'R') {
       if (yych == 'O')
         goto yy372;
@@ -7224,42 +7595,48 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy336:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy379;
     if (yych == 'a')
       goto yy379;
     goto yy298;
   yy337:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy380;
     if (yych == 'a')
       goto yy380;
     goto yy298;
   yy338:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy315;
     if (yych == 'm')
       goto yy315;
     goto yy298;
   yy339:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy381;
     if (yych == 'r')
       goto yy381;
     goto yy298;
   yy340:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'G')
       goto yy382;
     if (yych == 'g')
       goto yy382;
     goto yy298;
   yy341:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7288,35 +7665,40 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy342:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy384;
     if (yych == 'i')
       goto yy384;
     goto yy298;
   yy343:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy385;
     if (yych == 'n')
       goto yy385;
     goto yy298;
   yy344:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'V')
       goto yy331;
     if (yych == 'v')
       goto yy331;
     goto yy298;
   yy345:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'F')
       goto yy386;
     if (yych == 'f')
       goto yy386;
     goto yy298;
   yy346:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy387;
     if (yych == 't')
@@ -7326,89 +7708,102 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 6; }
   yy348:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '>')
       goto yy347;
     goto yy298;
   yy349:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy388;
     if (yych == 'r')
       goto yy388;
     goto yy298;
   yy350:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy389;
     if (yych == 'e')
       goto yy389;
     goto yy298;
   yy351:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy390;
     if (yych == 'r')
       goto yy390;
     goto yy298;
   yy352:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy371;
     if (yych == 'c')
       goto yy371;
     goto yy298;
   yy353:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'U')
       goto yy391;
     if (yych == 'u')
       goto yy391;
     goto yy298;
   yy354:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'Y')
       goto yy392;
     if (yych == 'y')
       goto yy392;
     goto yy298;
   yy355:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy393;
     if (yych == 'm')
       goto yy393;
     goto yy298;
   yy356:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'B')
       goto yy394;
     if (yych == 'b')
       goto yy394;
     goto yy298;
   yy357:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy327;
     if (yych == 'o')
       goto yy327;
     goto yy298;
   yy358:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'X')
       goto yy395;
     if (yych == 'x')
       goto yy395;
     goto yy298;
   yy359:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy396;
     if (yych == 'o')
       goto yy396;
     goto yy298;
   yy360:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7437,14 +7832,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy361:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy394;
     if (yych == 't')
       goto yy394;
     goto yy298;
   yy362:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7476,70 +7873,80 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 2; }
   yy364:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy399;
     if (yych == 'd')
       goto yy399;
     goto yy298;
   yy365:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy400;
     if (yych == 'r')
       goto yy400;
     goto yy298;
   yy366:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy401;
     if (yych == 'i')
       goto yy401;
     goto yy298;
   yy367:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy402;
     if (yych == 'd')
       goto yy402;
     goto yy298;
   yy368:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy403;
     if (yych == 'e')
       goto yy403;
     goto yy298;
   yy369:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy404;
     if (yych == 'c')
       goto yy404;
     goto yy298;
   yy370:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'Y')
       goto yy331;
     if (yych == 'y')
       goto yy331;
     goto yy298;
   yy371:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy405;
     if (yych == 't')
       goto yy405;
     goto yy298;
   yy372:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy406;
     if (yych == 't')
       goto yy406;
     goto yy298;
   yy373:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7568,28 +7975,32 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy374:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy408;
     if (yych == 'a')
       goto yy408;
     goto yy298;
   yy375:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy409;
     if (yych == 'l')
       goto yy409;
     goto yy298;
   yy376:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy410;
     if (yych == 'l')
       goto yy410;
     goto yy298;
   yy377:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'U') {
       if (yych == 'C')
         goto yy411;
@@ -7608,70 +8019,80 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy378:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy331;
     if (yych == 'm')
       goto yy331;
     goto yy298;
   yy379:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy413;
     if (yych == 'm')
       goto yy413;
     goto yy298;
   yy380:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy414;
     if (yych == 'd')
       goto yy414;
     goto yy298;
   yy381:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy415;
     if (yych == 'a')
       goto yy415;
     goto yy298;
   yy382:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy416;
     if (yych == 'e')
       goto yy416;
     goto yy298;
   yy383:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'K')
       goto yy331;
     if (yych == 'k')
       goto yy331;
     goto yy298;
   yy384:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy331;
     if (yych == 'n')
       goto yy331;
     goto yy298;
   yy385:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'U')
       goto yy417;
     if (yych == 'u')
       goto yy417;
     goto yy298;
   yy386:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy418;
     if (yych == 'r')
       goto yy418;
     goto yy298;
   yy387:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'I') {
       if (yych == 'G')
         goto yy407;
@@ -7690,14 +8111,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy388:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy378;
     if (yych == 'a')
       goto yy378;
     goto yy298;
   yy389:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x1F) {
       if (yych <= 0x08)
         goto yy298;
@@ -7712,98 +8135,112 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       goto yy298;
     }
   yy390:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy421;
     if (yych == 'i')
       goto yy421;
     goto yy298;
   yy391:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy422;
     if (yych == 'r')
       goto yy422;
     goto yy298;
   yy392:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy350;
     if (yych == 'l')
       goto yy350;
     goto yy298;
   yy393:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy423;
     if (yych == 'm')
       goto yy423;
     goto yy298;
   yy394:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy402;
     if (yych == 'l')
       goto yy402;
     goto yy298;
   yy395:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy424;
     if (yych == 't')
       goto yy424;
     goto yy298;
   yy396:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy425;
     if (yych == 'o')
       goto yy425;
     goto yy298;
   yy397:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy426;
     if (yych == 'a')
       goto yy426;
     goto yy298;
   yy398:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy383;
     if (yych == 'c')
       goto yy383;
     goto yy298;
   yy399:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy427;
     if (yych == 'a')
       goto yy427;
     goto yy298;
   yy400:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy428;
     if (yych == 'e')
       goto yy428;
     goto yy298;
   yy401:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy394;
     if (yych == 'c')
       goto yy394;
     goto yy298;
   yy402:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy331;
     if (yych == 'e')
       goto yy331;
     goto yy298;
   yy403:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7832,77 +8269,88 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy404:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'K')
       goto yy430;
     if (yych == 'k')
       goto yy430;
     goto yy298;
   yy405:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy419;
     if (yych == 'i')
       goto yy419;
     goto yy298;
   yy406:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy431;
     if (yych == 'e')
       goto yy431;
     goto yy298;
   yy407:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy432;
     if (yych == 'r')
       goto yy432;
     goto yy298;
   yy408:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy433;
     if (yych == 'i')
       goto yy433;
     goto yy298;
   yy409:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy434;
     if (yych == 'o')
       goto yy434;
     goto yy298;
   yy410:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy435;
     if (yych == 'd')
       goto yy435;
     goto yy298;
   yy411:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy328;
     if (yych == 'a')
       goto yy328;
     goto yy298;
   yy412:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy402;
     if (yych == 'r')
       goto yy402;
     goto yy298;
   yy413:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy436;
     if (yych == 'e')
       goto yy436;
     goto yy298;
   yy414:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7931,21 +8379,24 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy415:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy402;
     if (yych == 'm')
       goto yy402;
     goto yy298;
   yy416:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy426;
     if (yych == 'n')
       goto yy426;
     goto yy298;
   yy417:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -7974,14 +8425,16 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy418:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy438;
     if (yych == 'a')
       goto yy438;
     goto yy298;
   yy419:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy384;
     if (yych == 'o')
@@ -7991,112 +8444,128 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 1; }
   yy421:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy439;
     if (yych == 'p')
       goto yy439;
     goto yy298;
   yy422:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy402;
     if (yych == 'c')
       goto yy402;
     goto yy298;
   yy423:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy440;
     if (yych == 'a')
       goto yy440;
     goto yy298;
   yy424:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy441;
     if (yych == 'a')
       goto yy441;
     goto yy298;
   yy425:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy331;
     if (yych == 't')
       goto yy331;
     goto yy298;
   yy426:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'D')
       goto yy331;
     if (yych == 'd')
       goto yy331;
     goto yy298;
   yy427:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy442;
     if (yych == 't')
       goto yy442;
     goto yy298;
   yy428:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'S')
       goto yy443;
     if (yych == 's')
       goto yy443;
     goto yy298;
   yy429:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy444;
     if (yych == 'o')
       goto yy444;
     goto yy298;
   yy430:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'Q')
       goto yy445;
     if (yych == 'q')
       goto yy445;
     goto yy298;
   yy431:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy331;
     if (yych == 'r')
       goto yy331;
     goto yy298;
   yy432:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy446;
     if (yych == 'o')
       goto yy446;
     goto yy298;
   yy433:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy443;
     if (yych == 'l')
       goto yy443;
     goto yy298;
   yy434:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'G')
       goto yy331;
     if (yych == 'g')
       goto yy331;
     goto yy298;
   yy435:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'S')
       goto yy447;
     if (yych == 's')
       goto yy447;
     goto yy298;
   yy436:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -8125,124 +8594,142 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
       }
     }
   yy437:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy448;
     if (yych == 't')
       goto yy448;
     goto yy298;
   yy438:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy449;
     if (yych == 'm')
       goto yy449;
     goto yy298;
   yy439:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy389;
     if (yych == 't')
       goto yy389;
     goto yy298;
   yy440:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy370;
     if (yych == 'r')
       goto yy370;
     goto yy298;
   yy441:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy450;
     if (yych == 'r')
       goto yy450;
     goto yy298;
   yy442:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy451;
     if (yych == 'a')
       goto yy451;
     goto yy298;
   yy443:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'S')
       goto yy331;
     if (yych == 's')
       goto yy331;
     goto yy298;
   yy444:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy425;
     if (yych == 'n')
       goto yy425;
     goto yy298;
   yy445:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'U')
       goto yy452;
     if (yych == 'u')
       goto yy452;
     goto yy298;
   yy446:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'U')
       goto yy453;
     if (yych == 'u')
       goto yy453;
     goto yy298;
   yy447:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy425;
     if (yych == 'e')
       goto yy425;
     goto yy298;
   yy448:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy378;
     if (yych == 'e')
       goto yy378;
     goto yy298;
   yy449:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy443;
     if (yych == 'e')
       goto yy443;
     goto yy298;
   yy450:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy454;
     if (yych == 'e')
       goto yy454;
     goto yy298;
   yy451:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == '[')
       goto yy455;
     goto yy298;
   yy452:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'O')
       goto yy456;
     if (yych == 'o')
       goto yy456;
     goto yy298;
   yy453:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy331;
     if (yych == 'p')
       goto yy331;
     goto yy298;
   yy454:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy389;
     if (yych == 'a')
@@ -8252,7 +8739,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
     ++p;
     { return 5; }
   yy456:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy402;
     if (yych == 't')
@@ -8263,7 +8751,8 @@ bufsize_t _scan_html_block_start(const unsigned char *p) {
 
 // Try to match an HTML block tag start line of type 7, returning
 // 7 if successful, 0 if not.
-bufsize_t _scan_html_block_start_7(const unsigned char *p) {
+bufsize_t _scan_html_block_start_7(const unsigned char *p,
+                                   const unsigned char *end) {
   const unsigned char *marker = NULL;
 
   {
@@ -8290,14 +8779,16 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '<')
       goto yy459;
     ++p;
   yy458 : { return 0; }
   yy459:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych != '/')
         goto yy458;
@@ -8310,7 +8801,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
         goto yy461;
       goto yy458;
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@')
       goto yy460;
     if (yych <= 'Z')
@@ -8327,7 +8819,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       goto yy469;
     }
   yy461:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 2) {
       goto yy463;
     }
@@ -8359,7 +8852,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy462:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/') {
       if (yych <= 0x1F) {
         if (yych <= 0x08)
@@ -8392,7 +8886,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy463:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 2) {
       goto yy463;
     }
@@ -8423,11 +8918,13 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy464:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != '>')
       goto yy460;
   yy465:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 4) {
       goto yy465;
     }
@@ -8441,7 +8938,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       goto yy470;
     goto yy460;
   yy466:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x1F) {
       if (yych <= 0x08)
         goto yy460;
@@ -8456,7 +8954,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       goto yy460;
     }
   yy467:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 8) {
       goto yy467;
     }
@@ -8485,7 +8984,9 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
     }
   yy468:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 4) {
       goto yy465;
     }
@@ -8502,7 +9003,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
     ++p;
     goto yy469;
   yy471:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '<') {
       if (yych <= ' ') {
         if (yych <= 0x08)
@@ -8547,7 +9049,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy472:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy473;
     }
@@ -8583,7 +9086,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy473:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy473;
     }
@@ -8619,7 +9123,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy474:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy474;
     }
@@ -8653,7 +9158,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy475:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy475;
     }
@@ -8687,56 +9193,64 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       }
     }
   yy476:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy473;
     goto yy460;
   yy477:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy476;
     goto yy460;
   yy478:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy476;
     goto yy460;
   yy479:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x9F)
       goto yy476;
     goto yy460;
   yy480:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy478;
     goto yy460;
   yy481:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy478;
     goto yy460;
   yy482:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x8F)
       goto yy478;
     goto yy460;
   yy483:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 2) {
       goto yy463;
     }
@@ -8746,98 +9260,112 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
       goto yy465;
     goto yy460;
   yy484:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy474;
     goto yy460;
   yy485:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy484;
     goto yy460;
   yy486:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy484;
     goto yy460;
   yy487:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x9F)
       goto yy484;
     goto yy460;
   yy488:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy486;
     goto yy460;
   yy489:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy486;
     goto yy460;
   yy490:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x8F)
       goto yy486;
     goto yy460;
   yy491:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy475;
     goto yy460;
   yy492:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy491;
     goto yy460;
   yy493:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy491;
     goto yy460;
   yy494:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x9F)
       goto yy491;
     goto yy460;
   yy495:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy493;
     goto yy460;
   yy496:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0xBF)
       goto yy493;
     goto yy460;
   yy497:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy460;
     if (yych <= 0x8F)
@@ -8847,7 +9375,8 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p) {
 }
 
 // Try to match an HTML block end line of type 1
-bufsize_t _scan_html_block_end_1(const unsigned char *p) {
+bufsize_t _scan_html_block_end_1(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -8871,7 +9400,7 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
         0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xDF) {
       if (yych <= ';') {
         if (yych <= 0x00)
@@ -8907,7 +9436,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
   yy500 : { return 0; }
   yy501:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy500;
@@ -8925,7 +9456,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     }
   yy502:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '.') {
       if (yych <= 0x00)
         goto yy500;
@@ -8947,7 +9480,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     }
   yy503:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy500;
     if (yych <= 0xBF)
@@ -8955,7 +9490,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy504:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy500;
     if (yych <= 0xBF)
@@ -8963,7 +9500,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy505:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy500;
     if (yych <= 0xBF)
@@ -8971,7 +9510,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy506:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy500;
     if (yych <= 0x9F)
@@ -8979,7 +9520,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy507:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy500;
     if (yych <= 0xBF)
@@ -8987,7 +9530,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy508:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy500;
     if (yych <= 0xBF)
@@ -8995,14 +9540,17 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     goto yy500;
   yy509:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy500;
     if (yych <= 0x8F)
       goto yy516;
     goto yy500;
   yy510:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy511:
     if (yybm[0 + yych] & 64) {
       goto yy510;
@@ -9042,7 +9590,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       goto yy534;
     }
   yy513:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9079,56 +9628,64 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy514:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy512;
     if (yych <= 0xBF)
       goto yy510;
     goto yy512;
   yy515:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy512;
     if (yych <= 0xBF)
       goto yy514;
     goto yy512;
   yy516:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy512;
     if (yych <= 0xBF)
       goto yy514;
     goto yy512;
   yy517:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy512;
     if (yych <= 0x9F)
       goto yy514;
     goto yy512;
   yy518:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy512;
     if (yych <= 0xBF)
       goto yy516;
     goto yy512;
   yy519:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy512;
     if (yych <= 0xBF)
       goto yy516;
     goto yy512;
   yy520:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy512;
     if (yych <= 0x8F)
       goto yy516;
     goto yy512;
   yy521:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9191,7 +9748,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy522:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9239,7 +9797,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy523:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9299,7 +9858,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy524:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9347,7 +9907,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy525:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9395,7 +9956,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy526:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9443,7 +10005,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy527:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9491,7 +10054,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy528:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9539,7 +10103,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy529:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9577,7 +10142,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy530:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9625,7 +10191,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy531:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9673,7 +10240,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy532:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9722,7 +10290,9 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     }
   yy533:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy510;
     }
@@ -9755,7 +10325,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
     }
   yy534 : { return (bufsize_t)(p - start); }
   yy535:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9803,7 +10374,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy536:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9851,7 +10423,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy537:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9899,7 +10472,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy538:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9946,7 +10520,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy539:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -9993,7 +10568,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
       }
     }
   yy540:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy513;
     }
@@ -10044,7 +10620,8 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p) {
 }
 
 // Try to match an HTML block end line of type 2
-bufsize_t _scan_html_block_end_2(const unsigned char *p) {
+bufsize_t _scan_html_block_end_2(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -10068,7 +10645,7 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
         0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xDF) {
       if (yych <= ',') {
         if (yych <= 0x00)
@@ -10104,7 +10681,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
   yy543 : { return 0; }
   yy544:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy543;
@@ -10122,7 +10701,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     }
   yy545:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy564;
     }
@@ -10143,7 +10724,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     }
   yy546:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy543;
     if (yych <= 0xBF)
@@ -10151,7 +10734,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy547:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy543;
     if (yych <= 0xBF)
@@ -10159,7 +10744,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy548:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy543;
     if (yych <= 0xBF)
@@ -10167,7 +10754,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy549:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy543;
     if (yych <= 0x9F)
@@ -10175,7 +10764,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy550:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy543;
     if (yych <= 0xBF)
@@ -10183,7 +10774,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy551:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy543;
     if (yych <= 0xBF)
@@ -10191,14 +10784,17 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     goto yy543;
   yy552:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy543;
     if (yych <= 0x8F)
       goto yy559;
     goto yy543;
   yy553:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy554:
     if (yybm[0 + yych] & 64) {
       goto yy553;
@@ -10238,7 +10834,8 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
       goto yy566;
     }
   yy556:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy553;
     }
@@ -10272,56 +10869,64 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
       }
     }
   yy557:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy555;
     if (yych <= 0xBF)
       goto yy553;
     goto yy555;
   yy558:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy555;
     if (yych <= 0xBF)
       goto yy557;
     goto yy555;
   yy559:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy555;
     if (yych <= 0xBF)
       goto yy557;
     goto yy555;
   yy560:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy555;
     if (yych <= 0x9F)
       goto yy557;
     goto yy555;
   yy561:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy555;
     if (yych <= 0xBF)
       goto yy559;
     goto yy555;
   yy562:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy555;
     if (yych <= 0xBF)
       goto yy559;
     goto yy555;
   yy563:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy555;
     if (yych <= 0x8F)
       goto yy559;
     goto yy555;
   yy564:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy564;
     }
@@ -10360,7 +10965,9 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
     }
   yy565:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy553;
     }
@@ -10396,7 +11003,8 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p) {
 }
 
 // Try to match an HTML block end line of type 3
-bufsize_t _scan_html_block_end_3(const unsigned char *p) {
+bufsize_t _scan_html_block_end_3(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -10420,7 +11028,7 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
         0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xDF) {
       if (yych <= '>') {
         if (yych <= 0x00)
@@ -10456,7 +11064,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
   yy569 : { return 0; }
   yy570:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy569;
@@ -10474,7 +11084,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     }
   yy571:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '=') {
       if (yych <= 0x00)
         goto yy569;
@@ -10496,7 +11108,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     }
   yy572:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy569;
     if (yych <= 0xBF)
@@ -10504,7 +11118,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy573:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy569;
     if (yych <= 0xBF)
@@ -10512,7 +11128,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy574:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy569;
     if (yych <= 0xBF)
@@ -10520,7 +11138,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy575:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy569;
     if (yych <= 0x9F)
@@ -10528,7 +11148,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy576:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy569;
     if (yych <= 0xBF)
@@ -10536,7 +11158,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy577:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy569;
     if (yych <= 0xBF)
@@ -10544,14 +11168,17 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy569;
   yy578:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy569;
     if (yych <= 0x8F)
       goto yy585;
     goto yy569;
   yy579:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy580:
     if (yybm[0 + yych] & 64) {
       goto yy579;
@@ -10591,7 +11218,8 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
       goto yy591;
     }
   yy582:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy582;
     }
@@ -10628,49 +11256,56 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
       }
     }
   yy583:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy581;
     if (yych <= 0xBF)
       goto yy579;
     goto yy581;
   yy584:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy581;
     if (yych <= 0xBF)
       goto yy583;
     goto yy581;
   yy585:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy581;
     if (yych <= 0xBF)
       goto yy583;
     goto yy581;
   yy586:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy581;
     if (yych <= 0x9F)
       goto yy583;
     goto yy581;
   yy587:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy581;
     if (yych <= 0xBF)
       goto yy585;
     goto yy581;
   yy588:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy581;
     if (yych <= 0xBF)
       goto yy585;
     goto yy581;
   yy589:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy581;
     if (yych <= 0x8F)
@@ -10678,7 +11313,9 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
     goto yy581;
   yy590:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy579;
     }
@@ -10714,7 +11351,8 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p) {
 }
 
 // Try to match an HTML block end line of type 4
-bufsize_t _scan_html_block_end_4(const unsigned char *p) {
+bufsize_t _scan_html_block_end_4(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -10742,7 +11380,7 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy596;
     }
@@ -10780,7 +11418,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
   yy594 : { return 0; }
   yy595:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy594;
@@ -10798,7 +11438,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     }
   yy596:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy605;
     }
@@ -10832,7 +11474,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
   yy597 : { return (bufsize_t)(p - start); }
   yy598:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy594;
     if (yych <= 0xBF)
@@ -10840,7 +11484,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy599:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy594;
     if (yych <= 0xBF)
@@ -10848,7 +11494,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy600:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy594;
     if (yych <= 0xBF)
@@ -10856,7 +11504,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy601:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy594;
     if (yych <= 0x9F)
@@ -10864,7 +11514,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy602:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy594;
     if (yych <= 0xBF)
@@ -10872,7 +11524,9 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy603:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy594;
     if (yych <= 0xBF)
@@ -10880,14 +11534,17 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
     goto yy594;
   yy604:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy594;
     if (yych <= 0x8F)
       goto yy610;
     goto yy594;
   yy605:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy606:
     if (yybm[0 + yych] & 128) {
       goto yy605;
@@ -10927,49 +11584,56 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
       goto yy597;
     }
   yy608:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy607;
     if (yych <= 0xBF)
       goto yy605;
     goto yy607;
   yy609:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy607;
     if (yych <= 0xBF)
       goto yy608;
     goto yy607;
   yy610:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy607;
     if (yych <= 0xBF)
       goto yy608;
     goto yy607;
   yy611:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy607;
     if (yych <= 0x9F)
       goto yy608;
     goto yy607;
   yy612:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy607;
     if (yych <= 0xBF)
       goto yy610;
     goto yy607;
   yy613:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy607;
     if (yych <= 0xBF)
       goto yy610;
     goto yy607;
   yy614:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy607;
     if (yych <= 0x8F)
@@ -10979,7 +11643,8 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p) {
 }
 
 // Try to match an HTML block end line of type 5
-bufsize_t _scan_html_block_end_5(const unsigned char *p) {
+bufsize_t _scan_html_block_end_5(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -11003,7 +11668,7 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
         0,  0,  0,  0,   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
         0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xDF) {
       if (yych <= '\\') {
         if (yych <= 0x00)
@@ -11039,7 +11704,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
   yy617 : { return 0; }
   yy618:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\n') {
       if (yych <= 0x00)
         goto yy617;
@@ -11057,7 +11724,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     }
   yy619:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy638;
     }
@@ -11078,7 +11747,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     }
   yy620:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy617;
     if (yych <= 0xBF)
@@ -11086,7 +11757,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy621:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy617;
     if (yych <= 0xBF)
@@ -11094,7 +11767,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy622:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy617;
     if (yych <= 0xBF)
@@ -11102,7 +11777,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy623:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy617;
     if (yych <= 0x9F)
@@ -11110,7 +11787,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy624:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy617;
     if (yych <= 0xBF)
@@ -11118,7 +11797,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy625:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy617;
     if (yych <= 0xBF)
@@ -11126,14 +11807,17 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     goto yy617;
   yy626:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy617;
     if (yych <= 0x8F)
       goto yy633;
     goto yy617;
   yy627:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy628:
     if (yybm[0 + yych] & 64) {
       goto yy627;
@@ -11173,7 +11857,8 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
       goto yy640;
     }
   yy630:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy627;
     }
@@ -11207,56 +11892,64 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
       }
     }
   yy631:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy629;
     if (yych <= 0xBF)
       goto yy627;
     goto yy629;
   yy632:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy629;
     if (yych <= 0xBF)
       goto yy631;
     goto yy629;
   yy633:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy629;
     if (yych <= 0xBF)
       goto yy631;
     goto yy629;
   yy634:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy629;
     if (yych <= 0x9F)
       goto yy631;
     goto yy629;
   yy635:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy629;
     if (yych <= 0xBF)
       goto yy633;
     goto yy629;
   yy636:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy629;
     if (yych <= 0xBF)
       goto yy633;
     goto yy629;
   yy637:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy629;
     if (yych <= 0x8F)
       goto yy633;
     goto yy629;
   yy638:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy638;
     }
@@ -11295,7 +11988,9 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
     }
   yy639:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy627;
     }
@@ -11333,7 +12028,7 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p) {
 // Try to match a link title (in single quotes, in double quotes, or
 // in parentheses), returning number of chars matched.  Allow one
 // level of internal nesting (quotes within quotes).
-bufsize_t _scan_link_title(const unsigned char *p) {
+bufsize_t _scan_link_title(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -11361,7 +12056,7 @@ bufsize_t _scan_link_title(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= '&') {
       if (yych == '"')
         goto yy643;
@@ -11375,7 +12070,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
   yy642 : { return 0; }
   yy643:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x00)
       goto yy642;
     if (yych <= 0x7F)
@@ -11387,7 +12084,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     goto yy642;
   yy644:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x00)
       goto yy642;
     if (yych <= 0x7F)
@@ -11399,7 +12098,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     goto yy642;
   yy645:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '(') {
       if (yych <= 0x00)
         goto yy642;
@@ -11416,7 +12117,8 @@ bufsize_t _scan_link_title(const unsigned char *p) {
       goto yy642;
     }
   yy646:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy647:
     if (yybm[0 + yych] & 16) {
       goto yy646;
@@ -11468,7 +12170,8 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     ++p;
   yy650 : { return (bufsize_t)(p - start); }
   yy651:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 16) {
       goto yy646;
     }
@@ -11501,56 +12204,64 @@ bufsize_t _scan_link_title(const unsigned char *p) {
       }
     }
   yy652:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy646;
     goto yy648;
   yy653:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy652;
     goto yy648;
   yy654:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy652;
     goto yy648;
   yy655:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x9F)
       goto yy652;
     goto yy648;
   yy656:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy654;
     goto yy648;
   yy657:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy654;
     goto yy648;
   yy658:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x8F)
       goto yy654;
     goto yy648;
   yy659:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy660:
     if (yybm[0 + yych] & 64) {
       goto yy659;
@@ -11587,7 +12298,8 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     ++p;
   yy662 : { return (bufsize_t)(p - start); }
   yy663:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy659;
     }
@@ -11620,56 +12332,64 @@ bufsize_t _scan_link_title(const unsigned char *p) {
       }
     }
   yy664:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy659;
     goto yy648;
   yy665:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy664;
     goto yy648;
   yy666:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy664;
     goto yy648;
   yy667:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x9F)
       goto yy664;
     goto yy648;
   yy668:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy666;
     goto yy648;
   yy669:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy666;
     goto yy648;
   yy670:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x8F)
       goto yy666;
     goto yy648;
   yy671:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy672:
     if (yybm[0 + yych] & 128) {
       goto yy671;
@@ -11706,7 +12426,8 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     ++p;
   yy674 : { return (bufsize_t)(p - start); }
   yy675:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0xDF) {
       if (yych <= '[') {
         if (yych <= 0x00)
@@ -11740,49 +12461,56 @@ bufsize_t _scan_link_title(const unsigned char *p) {
       }
     }
   yy676:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy671;
     goto yy648;
   yy677:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy676;
     goto yy648;
   yy678:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy676;
     goto yy648;
   yy679:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x9F)
       goto yy676;
     goto yy648;
   yy680:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy678;
     goto yy648;
   yy681:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0xBF)
       goto yy678;
     goto yy648;
   yy682:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy648;
     if (yych <= 0x8F)
@@ -11790,7 +12518,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     goto yy648;
   yy683:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 16) {
       goto yy646;
     }
@@ -11825,7 +12555,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     }
   yy684:
     yyaccept = 2;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy659;
     }
@@ -11860,7 +12592,9 @@ bufsize_t _scan_link_title(const unsigned char *p) {
     }
   yy685:
     yyaccept = 3;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy671;
     }
@@ -11897,7 +12631,7 @@ bufsize_t _scan_link_title(const unsigned char *p) {
 }
 
 // Match space characters, including newlines.
-bufsize_t _scan_spacechars(const unsigned char *p) {
+bufsize_t _scan_spacechars(const unsigned char *p, const unsigned char *end) {
   const unsigned char *start = p;
 
   {
@@ -11917,14 +12651,15 @@ bufsize_t _scan_spacechars(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0,   0,   0,   0,   0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0,   0,   0,   0,   0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy687;
     }
     ++p;
     { return 0; }
   yy687:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy687;
     }
@@ -11933,7 +12668,8 @@ bufsize_t _scan_spacechars(const unsigned char *p) {
 }
 
 // Match ATX heading start.
-bufsize_t _scan_atx_heading_start(const unsigned char *p) {
+bufsize_t _scan_atx_heading_start(const unsigned char *p,
+                                  const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -11953,13 +12689,15 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0,   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0,   0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '#')
       goto yy690;
     ++p;
   yy689 : { return 0; }
   yy690:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -11977,7 +12715,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
       goto yy689;
     }
   yy691:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -11986,7 +12725,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
     ++p;
     goto yy692;
   yy694:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -12005,7 +12745,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
     p = marker;
     goto yy689;
   yy696:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -12021,7 +12762,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
       if (yych != '#')
         goto yy695;
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -12037,7 +12779,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
       if (yych != '#')
         goto yy695;
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -12053,7 +12796,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
       if (yych != '#')
         goto yy695;
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy691;
     }
@@ -12069,7 +12813,8 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p) {
 
 // Match setext heading line.  Return 1 for level-1 heading,
 // 2 for level-2, 0 for no match.
-bufsize_t _scan_setext_heading_line(const unsigned char *p) {
+bufsize_t _scan_setext_heading_line(const unsigned char *p,
+                                    const unsigned char *end) {
   const unsigned char *marker = NULL;
 
   {
@@ -12088,7 +12833,7 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
         0, 0,  0, 0, 0, 0, 0, 0, 0, 0,  0,  0, 0, 0, 0, 0, 0, 0,   0, 0, 0, 0,
         0, 0,  0, 0, 0, 0, 0, 0, 0, 0,  0,  0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '-')
       goto yy699;
     if (yych == '=')
@@ -12096,7 +12841,9 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
     ++p;
   yy698 : { return 0; }
   yy699:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy705;
     }
@@ -12114,7 +12861,9 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
       goto yy698;
     }
   yy700:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy709;
     }
@@ -12132,7 +12881,8 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
       goto yy698;
     }
   yy701:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy702:
     if (yybm[0 + yych] & 32) {
       goto yy701;
@@ -12150,7 +12900,8 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
     ++p;
     { return 2; }
   yy705:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy701;
     }
@@ -12168,7 +12919,8 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
       goto yy703;
     }
   yy706:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy707:
     if (yych <= '\f') {
       if (yych <= 0x08)
@@ -12188,7 +12940,8 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
     ++p;
     { return 1; }
   yy709:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy709;
     }
@@ -12211,7 +12964,8 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p) {
 }
 
 // Scan an opening code fence.
-bufsize_t _scan_open_code_fence(const unsigned char *p) {
+bufsize_t _scan_open_code_fence(const unsigned char *p,
+                                const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -12238,7 +12992,7 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '`')
       goto yy712;
     if (yych == '~')
@@ -12246,17 +13000,22 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
     ++p;
   yy711 : { return 0; }
   yy712:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == '`')
       goto yy714;
     goto yy711;
   yy713:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == '~')
       goto yy716;
     goto yy711;
   yy714:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 16) {
       goto yy717;
     }
@@ -12264,13 +13023,15 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
     p = marker;
     goto yy711;
   yy716:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy718;
     }
     goto yy715;
   yy717:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 16) {
       goto yy717;
     }
@@ -12327,7 +13088,8 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
       }
     }
   yy718:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy718;
     }
@@ -12384,7 +13146,8 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
       }
     }
   yy719:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy719;
     }
@@ -12421,56 +13184,64 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
     p = marker;
     { return (bufsize_t)(p - start); }
   yy721:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy719;
     goto yy715;
   yy722:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy721;
     goto yy715;
   yy723:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy721;
     goto yy715;
   yy724:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0x9F)
       goto yy721;
     goto yy715;
   yy725:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy723;
     goto yy715;
   yy726:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy723;
     goto yy715;
   yy727:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0x8F)
       goto yy723;
     goto yy715;
   yy728:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy728;
     }
@@ -12507,49 +13278,56 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
     p = marker;
     { return (bufsize_t)(p - start); }
   yy730:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy728;
     goto yy715;
   yy731:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy730;
     goto yy715;
   yy732:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy730;
     goto yy715;
   yy733:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0x9F)
       goto yy730;
     goto yy715;
   yy734:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy732;
     goto yy715;
   yy735:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0xBF)
       goto yy732;
     goto yy715;
   yy736:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy715;
     if (yych <= 0x8F)
@@ -12559,7 +13337,8 @@ bufsize_t _scan_open_code_fence(const unsigned char *p) {
 }
 
 // Scan a closing code fence with length at least len.
-bufsize_t _scan_close_code_fence(const unsigned char *p) {
+bufsize_t _scan_close_code_fence(const unsigned char *p,
+                                 const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -12579,7 +13358,7 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0,  0,   0,   0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0,  0,   0,   0, 0, 0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '`')
       goto yy739;
     if (yych == '~')
@@ -12587,17 +13366,22 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
     ++p;
   yy738 : { return 0; }
   yy739:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == '`')
       goto yy741;
     goto yy738;
   yy740:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == '~')
       goto yy743;
     goto yy738;
   yy741:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy744;
     }
@@ -12605,13 +13389,15 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
     p = marker;
     goto yy738;
   yy743:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy745;
     }
     goto yy742;
   yy744:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 32) {
       goto yy744;
     }
@@ -12639,7 +13425,8 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
       goto yy742;
     }
   yy745:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 64) {
       goto yy745;
     }
@@ -12667,7 +13454,8 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
       goto yy742;
     }
   yy746:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy746;
     }
@@ -12682,7 +13470,8 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
     p = marker;
     { return (bufsize_t)(p - start); }
   yy748:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '\f') {
       if (yych <= 0x08)
         goto yy742;
@@ -12706,19 +13495,21 @@ bufsize_t _scan_close_code_fence(const unsigned char *p) {
 
 // Scans an entity.
 // Returns number of chars matched.
-bufsize_t _scan_entity(const unsigned char *p) {
+bufsize_t _scan_entity(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
   {
     unsigned char yych;
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '&')
       goto yy752;
     ++p;
   yy751 : { return 0; }
   yy752:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych != '#')
         goto yy751;
@@ -12731,7 +13522,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
         goto yy754;
       goto yy751;
     }
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'W') {
       if (yych <= '/')
         goto yy753;
@@ -12747,7 +13539,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
     p = marker;
     goto yy751;
   yy754:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych <= '/')
         goto yy753;
@@ -12764,7 +13557,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy753;
     }
   yy755:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -12773,7 +13567,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy759;
     goto yy753;
   yy756:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '@') {
       if (yych <= '/')
         goto yy753;
@@ -12790,7 +13585,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy753;
     }
   yy757:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12813,7 +13609,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy758:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -12824,7 +13621,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
     ++p;
     { return (bufsize_t)(p - start); }
   yy760:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12847,7 +13645,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy761:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12870,7 +13669,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy762:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -12879,7 +13679,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy759;
     goto yy753;
   yy763:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12902,7 +13703,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy764:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12925,7 +13727,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy765:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -12934,7 +13737,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy759;
     goto yy753;
   yy766:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12957,7 +13761,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy767:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -12980,7 +13785,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy768:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -12989,7 +13795,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy759;
     goto yy753;
   yy769:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13012,7 +13819,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy770:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13035,7 +13843,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy771:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= '/')
       goto yy753;
     if (yych <= '9')
@@ -13044,7 +13853,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       goto yy759;
     goto yy753;
   yy772:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13067,7 +13877,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy773:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13090,12 +13901,14 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy774:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == ';')
       goto yy759;
     goto yy753;
   yy775:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13116,7 +13929,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy776:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13137,7 +13951,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy777:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13158,7 +13973,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy778:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13179,7 +13995,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy779:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13200,7 +14017,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy780:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13221,7 +14039,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy781:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13242,7 +14061,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy782:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13263,7 +14083,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy783:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13284,7 +14105,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy784:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13305,7 +14127,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy785:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13326,7 +14149,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy786:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13347,7 +14171,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy787:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13368,7 +14193,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy788:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13389,7 +14215,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy789:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13410,7 +14237,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy790:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13431,7 +14259,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy791:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13452,7 +14281,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy792:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13473,7 +14303,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy793:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13494,7 +14325,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy794:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13515,7 +14347,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy795:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13536,7 +14369,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy796:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13557,7 +14391,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy797:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13578,7 +14413,8 @@ bufsize_t _scan_entity(const unsigned char *p) {
       }
     }
   yy798:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= ';') {
       if (yych <= '/')
         goto yy753;
@@ -13605,14 +14441,15 @@ bufsize_t _scan_entity(const unsigned char *p) {
 
 // Returns positive value if a URL begins in a way that is potentially
 // dangerous, with javascript:, vbscript:, file:, or data:, otherwise 0.
-bufsize_t _scan_dangerous_url(const unsigned char *p) {
+bufsize_t _scan_dangerous_url(const unsigned char *p,
+                              const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
   {
     unsigned char yych;
     unsigned int yyaccept = 0;
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'V') {
       if (yych <= 'F') {
         if (yych == 'D')
@@ -13645,7 +14482,9 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
   yy800 : { return 0; }
   yy801:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy805;
     if (yych == 'a')
@@ -13653,7 +14492,9 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     goto yy800;
   yy802:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy807;
     if (yych == 'i')
@@ -13661,7 +14502,9 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     goto yy800;
   yy803:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy808;
     if (yych == 'a')
@@ -13669,14 +14512,17 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     goto yy800;
   yy804:
     yyaccept = 0;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'B')
       goto yy809;
     if (yych == 'b')
       goto yy809;
     goto yy800;
   yy805:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy810;
     if (yych == 't')
@@ -13689,66 +14535,76 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
       goto yy818;
     }
   yy807:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'L')
       goto yy811;
     if (yych == 'l')
       goto yy811;
     goto yy806;
   yy808:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'V')
       goto yy812;
     if (yych == 'v')
       goto yy812;
     goto yy806;
   yy809:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'S')
       goto yy813;
     if (yych == 's')
       goto yy813;
     goto yy806;
   yy810:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy814;
     if (yych == 'a')
       goto yy814;
     goto yy806;
   yy811:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy815;
     if (yych == 'e')
       goto yy815;
     goto yy806;
   yy812:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy809;
     if (yych == 'a')
       goto yy809;
     goto yy806;
   yy813:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'C')
       goto yy816;
     if (yych == 'c')
       goto yy816;
     goto yy806;
   yy814:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == ':')
       goto yy817;
     goto yy806;
   yy815:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == ':')
       goto yy819;
     goto yy806;
   yy816:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'R')
       goto yy820;
     if (yych == 'r')
@@ -13756,7 +14612,9 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     goto yy806;
   yy817:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy821;
     if (yych == 'i')
@@ -13766,57 +14624,66 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     ++p;
     goto yy818;
   yy820:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy822;
     if (yych == 'i')
       goto yy822;
     goto yy806;
   yy821:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'M')
       goto yy823;
     if (yych == 'm')
       goto yy823;
     goto yy806;
   yy822:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy824;
     if (yych == 'p')
       goto yy824;
     goto yy806;
   yy823:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'A')
       goto yy825;
     if (yych == 'a')
       goto yy825;
     goto yy806;
   yy824:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'T')
       goto yy815;
     if (yych == 't')
       goto yy815;
     goto yy806;
   yy825:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'G')
       goto yy826;
     if (yych != 'g')
       goto yy806;
   yy826:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy827;
     if (yych != 'e')
       goto yy806;
   yy827:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != '/')
       goto yy806;
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 'W') {
       if (yych <= 'J') {
         if (yych == 'G')
@@ -13851,55 +14718,63 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
       }
     }
   yy828:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'I')
       goto yy832;
     if (yych == 'i')
       goto yy832;
     goto yy806;
   yy829:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy833;
     if (yych == 'p')
       goto yy833;
     goto yy806;
   yy830:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'N')
       goto yy834;
     if (yych == 'n')
       goto yy834;
     goto yy806;
   yy831:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy835;
     if (yych == 'e')
       goto yy835;
     goto yy806;
   yy832:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'F')
       goto yy836;
     if (yych == 'f')
       goto yy836;
     goto yy806;
   yy833:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'E')
       goto yy834;
     if (yych != 'e')
       goto yy806;
   yy834:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'G')
       goto yy836;
     if (yych == 'g')
       goto yy836;
     goto yy806;
   yy835:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'B')
       goto yy837;
     if (yych == 'b')
@@ -13909,7 +14784,8 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
     ++p;
     { return 0; }
   yy837:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych == 'P')
       goto yy836;
     if (yych == 'p')
@@ -13919,7 +14795,8 @@ bufsize_t _scan_dangerous_url(const unsigned char *p) {
 }
 
 // Scans a footnote definition opening.
-bufsize_t _scan_footnote_definition(const unsigned char *p) {
+bufsize_t _scan_footnote_definition(const unsigned char *p,
+                                    const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -13943,23 +14820,27 @@ bufsize_t _scan_footnote_definition(const unsigned char *p) {
         0,   0,  0,  0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,
         0,   0,  0,  0,  0,  0,  0,  0,  0,  0,   0,  0,  0,  0,  0,  0,
     };
-    yych = *p;
+    yych = (p < end ? *p : 0);
     if (yych == '[')
       goto yy840;
     ++p;
   yy839 : { return 0; }
   yy840:
-    yych = *(marker = ++p);
+    ++p;
+    marker = p;
+    yych = (p < end ? *p : 0);
     if (yych != '^')
       goto yy839;
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != ']')
       goto yy843;
   yy841:
     p = marker;
     goto yy839;
   yy842:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
   yy843:
     if (yybm[0 + yych] & 64) {
       goto yy842;
@@ -13994,60 +14875,69 @@ bufsize_t _scan_footnote_definition(const unsigned char *p) {
       }
     }
   yy844:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy841;
     if (yych <= 0xBF)
       goto yy842;
     goto yy841;
   yy845:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x9F)
       goto yy841;
     if (yych <= 0xBF)
       goto yy844;
     goto yy841;
   yy846:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy841;
     if (yych <= 0xBF)
       goto yy844;
     goto yy841;
   yy847:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy841;
     if (yych <= 0x9F)
       goto yy844;
     goto yy841;
   yy848:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x8F)
       goto yy841;
     if (yych <= 0xBF)
       goto yy846;
     goto yy841;
   yy849:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy841;
     if (yych <= 0xBF)
       goto yy846;
     goto yy841;
   yy850:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych <= 0x7F)
       goto yy841;
     if (yych <= 0x8F)
       goto yy846;
     goto yy841;
   yy851:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yych != ':')
       goto yy841;
   yy852:
-    yych = *++p;
+    ++p;
+    yych = (p < end ? *p : 0);
     if (yybm[0 + yych] & 128) {
       goto yy852;
     }
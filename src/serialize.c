@@ -0,0 +1,725 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmark-gfm.h"
+#include "buffer.h"
+#include "chunk.h"
+#include "node.h"
+#include "syntax_extension.h"
+
+// A serialized tree is the magic bytes and format version, the syntax
+// extensions its nodes use, the node types those extensions added, and
+// then the nodes in document order.  Numbers are LEB128 varints, signed
+// ones zigzag-encoded first, and strings are a length and their bytes.
+//
+// Each node is its type code (see S_type_code), a byte of NODE_* bits, the index of its syntax
+// extension if it has one, its position, what its type holds (see
+// S_write_payload), the data its extension wrote, and then its children
+// followed by a zero byte if it has any.  No type code is zero, so the
+// zero byte cannot be taken for a child.
+//
+// The types extensions add are numbered in the order the extensions
+// register them, so the file gives each one's number along with the name
+// of its extension and its type string, and a process that numbered them
+// differently refuses the file.
+
+#define MAGIC "CMARKAST"
+#define MAGIC_LEN 8
+#define VERSION 1
+
+#define NODE_CHILDREN 1
+#define NODE_EXTENSION 2
+#define NODE_EXTENSION_DATA 4
+
+#define CORE_LAST_BLOCK CMARK_NODE_FOOTNOTE_DEFINITION
+#define CORE_LAST_INLINE CMARK_NODE_ATTRIBUTE
+
+static void S_put_uint(cmark_strbuf *buf, uint64_t value) {
+  unsigned char bytes[10];
+  int n = 0;
+
+  while (value >= 0x80) {
+    bytes[n++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[n++] = (unsigned char)value;
+  cmark_strbuf_put(buf, bytes, n);
+}
+
+static void S_put_int(cmark_strbuf *buf, int64_t value) {
+  S_put_uint(buf, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void S_put_string(cmark_strbuf *buf, const void *data, size_t len) {
+  S_put_uint(buf, len);
+  cmark_strbuf_put(buf, (const unsigned char *)data, (bufsize_t)len);
+}
+
+static void S_put_chunk(cmark_strbuf *buf, const cmark_chunk *c) {
+  S_put_string(buf, c->data, (size_t)c->len);
+}
+
+// Node types keep their kind in the top bits, which would take every
+// inline node three bytes to write, so they are written as their value
+// with the kind in the lowest bit instead.
+static uint64_t S_type_code(uint16_t type) {
+  return (uint64_t)(type & CMARK_NODE_VALUE_MASK) << 1 |
+         (CMARK_NODE_TYPE_INLINE_P((cmark_node_type)type) ? 1 : 0);
+}
+
+static uint16_t S_code_type(uint64_t code) {
+  if (code >> 1 > CMARK_NODE_VALUE_MASK)
+    return 0;
+  return (uint16_t)((code >> 1) |
+                    (code & 1 ? CMARK_NODE_TYPE_INLINE : CMARK_NODE_TYPE_BLOCK));
+}
+
+static bool S_core_type(uint16_t type) {
+  if (CMARK_NODE_TYPE_BLOCK_P((cmark_node_type)type))
+    return type > CMARK_NODE_TYPE_BLOCK && type <= CORE_LAST_BLOCK;
+  if (CMARK_NODE_TYPE_INLINE_P((cmark_node_type)type))
+    return type > CMARK_NODE_TYPE_INLINE && type <= CORE_LAST_INLINE;
+  return false;
+}
+
+// Returns the type string 'extension' gives a fresh node of 'type', which
+// unlike that of a parsed node cannot depend on what the node holds.
+static void S_type_string(cmark_syntax_extension *extension, uint16_t type,
+                          cmark_mem *mem, cmark_strbuf *out) {
+  cmark_node probe;
+
+  memset(&probe, 0, sizeof(probe));
+  probe.type = type;
+  probe.mem = mem;
+  probe.extension = extension;
+  if (extension->opaque_alloc_func)
+    extension->opaque_alloc_func(extension, mem, &probe);
+  if (extension->get_type_string_func)
+    cmark_strbuf_puts(out, extension->get_type_string_func(extension, &probe));
+  if (extension->opaque_free_func && probe.as.opaque)
+    extension->opaque_free_func(extension, mem, &probe);
+}
+
+typedef struct {
+  cmark_node *node;
+  size_t index;
+} node_index;
+
+static int S_compare_nodes(const void *a, const void *b) {
+  const cmark_node *x = ((const node_index *)a)->node;
+  const cmark_node *y = ((const node_index *)b)->node;
+  return x < y ? -1 : x > y;
+}
+
+static cmark_node *S_next(cmark_node *root, cmark_node *node) {
+  if (node->first_child)
+    return node->first_child;
+  while (node != root && node->next == NULL)
+    node = node->parent;
+  return node == root ? NULL : node->next;
+}
+
+// Writes what 'node' holds for its type apart from its position.
+static void S_write_payload(cmark_strbuf *buf, cmark_node *node,
+                            node_index *defs, size_t n_defs) {
+  node_index key, *found;
+
+  switch (node->type) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_ITEM:
+    S_put_uint(buf, node->as.list.list_type);
+    S_put_uint(buf, node->as.list.delimiter);
+    S_put_int(buf, node->as.list.start);
+    S_put_int(buf, node->as.list.marker_offset);
+    S_put_int(buf, node->as.list.padding);
+    cmark_strbuf_putc(buf, node->as.list.bullet_char);
+    cmark_strbuf_putc(buf, node->as.list.tight | node->as.list.checked << 1);
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    S_put_chunk(buf, &node->as.code.info);
+    S_put_chunk(buf, &node->as.code.literal);
+    cmark_strbuf_putc(buf, node->as.code.fence_length);
+    cmark_strbuf_putc(buf, node->as.code.fence_offset);
+    cmark_strbuf_putc(buf, node->as.code.fence_char);
+    cmark_strbuf_putc(buf, node->as.code.fenced);
+    break;
+  case CMARK_NODE_CODE:
+    S_put_uint(buf, (uint64_t)node->backtick_count);
+    S_put_chunk(buf, &node->as.literal);
+    break;
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+  case CMARK_NODE_HTML_BLOCK:
+    S_put_chunk(buf, &node->as.literal);
+    break;
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    S_put_chunk(buf, &node->as.literal);
+    S_put_uint(buf, node->cold ? (uint64_t)node->cold->footnote.def_count : 0);
+    break;
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+    // The definition is written as its place among the definitions.
+    S_put_chunk(buf, &node->as.literal);
+    S_put_uint(buf, node->cold ? (uint64_t)node->cold->footnote.ref_ix : 0);
+    key.node = node->cold ? node->cold->parent_footnote_def : NULL;
+    found = key.node && n_defs
+                ? (node_index *)bsearch(&key, defs, n_defs, sizeof(node_index),
+                                        S_compare_nodes)
+                : NULL;
+    S_put_uint(buf, found ? found->index + 1 : 0);
+    break;
+  case CMARK_NODE_HEADING:
+    cmark_strbuf_putc(buf, node->as.heading.level);
+    cmark_strbuf_putc(buf, node->as.heading.setext);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    S_put_chunk(buf, &node->as.link.url);
+    S_put_chunk(buf, &node->as.link.title);
+    break;
+  case CMARK_NODE_ATTRIBUTE:
+    S_put_chunk(buf, &node->as.attribute.attributes);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    S_put_chunk(buf, &node->as.custom.on_enter);
+    S_put_chunk(buf, &node->as.custom.on_exit);
+    break;
+  default:
+    break;
+  }
+}
+
+static void S_write_extension_data(cmark_strbuf *buf, cmark_node *node,
+                                   cmark_mem *mem) {
+  cmark_syntax_extension *ext = node->extension;
+  unsigned char small[64], *data = small;
+  size_t len = ext->serialize_func(ext, node, small, sizeof(small));
+
+  if (len > sizeof(small)) {
+    data = (unsigned char *)cmark_mem_calloc(mem, len, 1);
+    ext->serialize_func(ext, node, data, len);
+  }
+  S_put_string(buf, data, len);
+  if (data != small)
+    cmark_mem_free(mem, data);
+}
+
+unsigned char *cmark_node_serialize(cmark_node *root, cmark_mem *mem,
+                                    size_t *len) {
+  cmark_strbuf buf = CMARK_BUF_INIT(mem), names = CMARK_BUF_INIT(mem);
+  cmark_syntax_extension **exts = NULL;
+  uint16_t *types = NULL;
+  node_index *defs = NULL;
+  size_t n_exts = 0, n_types = 0, n_defs = 0, size_defs = 0, i;
+  cmark_node *node;
+  bool ok = true;
+
+  *len = 0;
+  if (root == NULL)
+    return NULL;
+
+  // Collect the extensions, the types they added and the footnote
+  // definitions first, since the nodes refer to them.
+  for (node = root; node && ok; node = S_next(root, node)) {
+    cmark_syntax_extension *ext = node->extension;
+
+    if (ext && ext->opaque_free_func && !ext->serialize_func)
+      ok = false;
+    for (i = 0; ext && i < n_exts && exts[i] != ext; ++i)
+      ;
+    if (ext && i == n_exts) {
+      exts = (cmark_syntax_extension **)cmark_mem_realloc(
+          mem, exts, (n_exts + 1) * sizeof(*exts));
+      exts[n_exts++] = ext;
+    }
+    if (!S_core_type(node->type)) {
+      for (i = 0; i < n_types && types[i] != node->type; ++i)
+        ;
+      if (i == n_types) {
+        if (!ext)
+          ok = false;
+        types = (uint16_t *)cmark_mem_realloc(
+            mem, types, (n_types + 1) * sizeof(*types));
+        types[n_types++] = node->type;
+      }
+    }
+    if (node->type == CMARK_NODE_FOOTNOTE_DEFINITION) {
+      if (n_defs == size_defs) {
+        size_defs = size_defs ? size_defs * 2 : 8;
+        defs = (node_index *)cmark_mem_realloc(
+            mem, defs, size_defs * sizeof(*defs));
+      }
+      defs[n_defs].node = node;
+      defs[n_defs].index = n_defs;
+      ++n_defs;
+    }
+  }
+  if (n_defs)
+    qsort(defs, n_defs, sizeof(node_index), S_compare_nodes);
+
+  cmark_strbuf_put(&buf, (const unsigned char *)MAGIC, MAGIC_LEN);
+  S_put_uint(&buf, VERSION);
+  S_put_uint(&buf, n_exts);
+  for (i = 0; i < n_exts; ++i)
+    S_put_string(&buf, exts[i]->name, strlen(exts[i]->name));
+  S_put_uint(&buf, n_types);
+  for (i = 0; ok && i < n_types; ++i) {
+    size_t e;
+
+    // Find the extension of a node of this type.
+    for (node = root; node->type != types[i]; node = S_next(root, node))
+      ;
+    for (e = 0; exts[e] != node->extension; ++e)
+      ;
+    S_put_uint(&buf, S_type_code(types[i]));
+    S_put_uint(&buf, e);
+    cmark_strbuf_clear(&names);
+    S_type_string(exts[e], types[i], mem, &names);
+    S_put_string(&buf, names.ptr, (size_t)names.size);
+  }
+
+  int prev_line = 0;
+  for (node = root; node && ok;) {
+    unsigned char bits = 0;
+    size_t ext_index = 0;
+
+    if (node->first_child)
+      bits |= NODE_CHILDREN;
+    if (node->extension) {
+      bits |= NODE_EXTENSION;
+      while (exts[ext_index] != node->extension)
+        ++ext_index;
+      if (node->extension->serialize_func)
+        bits |= NODE_EXTENSION_DATA;
+    }
+
+    S_put_uint(&buf, S_type_code(node->type));
+    cmark_strbuf_putc(&buf, bits);
+    if (bits & NODE_EXTENSION)
+      S_put_uint(&buf, ext_index);
+    S_put_int(&buf, (int64_t)node->start_line - prev_line);
+    S_put_int(&buf, node->start_column);
+    S_put_int(&buf, (int64_t)node->end_line - node->start_line);
+    S_put_int(&buf, node->end_column);
+    prev_line = node->start_line;
+
+    S_write_payload(&buf, node, defs, n_defs);
+    if (bits & NODE_EXTENSION_DATA)
+      S_write_extension_data(&buf, node, mem);
+
+    if (node->first_child) {
+      node = node->first_child;
+      continue;
+    }
+    while (node != root && node->next == NULL) {
+      node = node->parent;
+      cmark_strbuf_putc(&buf, 0);
+    }
+    node = node == root ? NULL : node->next;
+  }
+
+  cmark_mem_free(mem, exts);
+  cmark_mem_free(mem, types);
+  cmark_mem_free(mem, defs);
+  cmark_strbuf_free(&names);
+  if (!ok) {
+    cmark_strbuf_free(&buf);
+    return NULL;
+  }
+  *len = (size_t)buf.size;
+  return cmark_strbuf_detach(&buf);
+}
+
+typedef struct {
+  const unsigned char *p;
+  const unsigned char *end;
+  cmark_mem *mem;
+  bool in_place;
+  bool failed;
+
+  // The footnote definitions read so far, in order, and the references to
+  // link to them once they are all read.
+  cmark_node **defs;
+  size_t n_defs, size_defs;
+  node_index *refs;
+  size_t n_refs, size_refs;
+} reader;
+
+static uint64_t S_get_uint(reader *r) {
+  uint64_t value = 0;
+  int shift = 0;
+
+  while (r->p < r->end && shift < 64) {
+    unsigned char byte = *r->p++;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return value;
+    shift += 7;
+  }
+  r->failed = true;
+  return 0;
+}
+
+// Reads a signed number, failing on values outside [min, max].
+static int S_get_int(reader *r, int64_t min, int64_t max) {
+  uint64_t raw = S_get_uint(r);
+  int64_t value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+
+  if (value < min || value > max) {
+    r->failed = true;
+    return 0;
+  }
+  return (int)value;
+}
+
+static unsigned char S_get_byte(reader *r) {
+  if (r->p == r->end) {
+    r->failed = true;
+    return 0;
+  }
+  return *r->p++;
+}
+
+static const unsigned char *S_get_bytes(reader *r, size_t *len) {
+  const unsigned char *data;
+  uint64_t n = S_get_uint(r);
+
+  if (n > (uint64_t)(r->end - r->p) || n > INT32_MAX) {
+    r->failed = true;
+    *len = 0;
+    return NULL;
+  }
+  *len = (size_t)n;
+  data = r->p;
+  r->p += n;
+  return data;
+}
+
+static cmark_chunk S_get_chunk(reader *r) {
+  cmark_chunk c = CMARK_CHUNK_EMPTY;
+  size_t len;
+  const unsigned char *data = S_get_bytes(r, &len);
+
+  if (len == 0)
+    return c;
+  c.len = (bufsize_t)len;
+  if (r->in_place) {
+    c.data = (unsigned char *)data;
+  } else {
+    c.data = (unsigned char *)cmark_mem_calloc(r->mem, len + 1, 1);
+    memcpy(c.data, data, len);
+    c.alloc = 1;
+  }
+  return c;
+}
+
+static void S_read_payload(reader *r, cmark_node *node) {
+  int n;
+
+  switch (node->type) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_ITEM:
+    node->as.list.list_type = (cmark_list_type)S_get_uint(r);
+    node->as.list.delimiter = (cmark_delim_type)S_get_uint(r);
+    if (node->as.list.list_type > CMARK_ORDERED_LIST ||
+        node->as.list.delimiter > CMARK_PAREN_DELIM)
+      r->failed = true;
+    node->as.list.start = S_get_int(r, 0, INT32_MAX);
+    node->as.list.marker_offset = S_get_int(r, INT32_MIN, INT32_MAX);
+    node->as.list.padding = S_get_int(r, INT32_MIN, INT32_MAX);
+    node->as.list.bullet_char = S_get_byte(r);
+    n = S_get_byte(r);
+    node->as.list.tight = (n & 1) != 0;
+    node->as.list.checked = (n & 2) != 0;
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    node->as.code.info = S_get_chunk(r);
+    node->as.code.literal = S_get_chunk(r);
+    node->as.code.fence_length = S_get_byte(r);
+    node->as.code.fence_offset = S_get_byte(r);
+    node->as.code.fence_char = S_get_byte(r);
+    node->as.code.fenced = (int8_t)S_get_byte(r);
+    break;
+  case CMARK_NODE_CODE:
+    node->backtick_count = (int)S_get_uint(r);
+    if (node->backtick_count < 0)
+      r->failed = true;
+    node->as.literal = S_get_chunk(r);
+    break;
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+  case CMARK_NODE_HTML_BLOCK:
+    node->as.literal = S_get_chunk(r);
+    break;
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    node->as.literal = S_get_chunk(r);
+    n = (int)S_get_uint(r);
+    if (n)
+      cmark_node_cold_fields(node)->footnote.def_count = n;
+    if (r->n_defs == r->size_defs) {
+      r->size_defs = r->size_defs ? r->size_defs * 2 : 8;
+      r->defs = (cmark_node **)cmark_mem_realloc(
+          r->mem, r->defs, r->size_defs * sizeof(*r->defs));
+    }
+    r->defs[r->n_defs++] = node;
+    break;
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+    node->as.literal = S_get_chunk(r);
+    n = (int)S_get_uint(r);
+    if (n)
+      cmark_node_cold_fields(node)->footnote.ref_ix = n;
+    if (r->n_refs == r->size_refs) {
+      r->size_refs = r->size_refs ? r->size_refs * 2 : 8;
+      r->refs = (node_index *)cmark_mem_realloc(
+          r->mem, r->refs, r->size_refs * sizeof(*r->refs));
+    }
+    r->refs[r->n_refs].node = node;
+    r->refs[r->n_refs++].index = (size_t)S_get_uint(r);
+    break;
+  case CMARK_NODE_HEADING:
+    n = S_get_byte(r);
+    if (n < 1 || n > 6)
+      r->failed = true;
+    node->as.heading.level = n;
+    node->as.heading.setext = S_get_byte(r) != 0;
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    node->as.link.url = S_get_chunk(r);
+    node->as.link.title = S_get_chunk(r);
+    break;
+  case CMARK_NODE_ATTRIBUTE:
+    node->as.attribute.attributes = S_get_chunk(r);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    node->as.custom.on_enter = S_get_chunk(r);
+    node->as.custom.on_exit = S_get_chunk(r);
+    break;
+  default:
+    break;
+  }
+}
+
+// Reads the extensions and the types they added, checking that each type
+// has the same number here and the same extension and type string.
+static bool S_read_extensions(reader *r, cmark_syntax_extension ***exts,
+                              size_t *n_exts, uint16_t **types,
+                              size_t **type_exts, size_t *n_types) {
+  cmark_strbuf name = CMARK_BUF_INIT(r->mem);
+  const unsigned char *data;
+  size_t len, i;
+
+  // Every entry takes at least a byte, which bounds the allocations.
+  *n_exts = (size_t)S_get_uint(r);
+  if (*n_exts > (size_t)(r->end - r->p))
+    return false;
+  *exts = (cmark_syntax_extension **)cmark_mem_calloc(r->mem, *n_exts + 1,
+                                                    sizeof(**exts));
+  for (i = 0; i < *n_exts && !r->failed; ++i) {
+    data = S_get_bytes(r, &len);
+    cmark_strbuf_clear(&name);
+    cmark_strbuf_put(&name, data, (bufsize_t)len);
+    (*exts)[i] = cmark_find_syntax_extension((const char *)name.ptr);
+    if ((*exts)[i] == NULL)
+      r->failed = true;
+  }
+
+  *n_types = r->failed ? 0 : (size_t)S_get_uint(r);
+  if (*n_types > (size_t)(r->end - r->p))
+    r->failed = true;
+  if (r->failed) {
+    cmark_strbuf_free(&name);
+    return false;
+  }
+  *types = (uint16_t *)cmark_mem_calloc(r->mem, *n_types + 1, sizeof(**types));
+  *type_exts =
+      (size_t *)cmark_mem_calloc(r->mem, *n_types + 1, sizeof(**type_exts));
+  for (i = 0; i < *n_types && !r->failed; ++i) {
+    uint16_t type = S_code_type(S_get_uint(r));
+    uint64_t e = S_get_uint(r);
+    cmark_node_type last = CMARK_NODE_TYPE_BLOCK_P((cmark_node_type)type)
+                               ? CMARK_NODE_LAST_BLOCK
+                               : CMARK_NODE_LAST_INLINE;
+
+    data = S_get_bytes(r, &len);
+    if (r->failed || type == 0 || S_core_type(type) || type > last ||
+        e >= *n_exts) {
+      r->failed = true;
+      break;
+    }
+    cmark_strbuf_clear(&name);
+    S_type_string((*exts)[e], type, r->mem, &name);
+    if ((size_t)name.size != len || memcmp(name.ptr, data, len) != 0)
+      r->failed = true;
+    (*types)[i] = type;
+    (*type_exts)[i] = (size_t)e;
+  }
+
+  cmark_strbuf_free(&name);
+  return !r->failed;
+}
+
+static cmark_node *S_deserialize(const unsigned char *data, size_t len,
+                                 int options, cmark_mem *mem, bool in_place) {
+  reader r;
+  cmark_arena *arena = NULL;
+  cmark_node_slab *slab = NULL;
+  cmark_syntax_extension **exts = NULL;
+  uint16_t *types = NULL;
+  size_t *type_exts = NULL, n_exts = 0, n_types = 0, i;
+  cmark_node *root = NULL, *parent = NULL, *node;
+  int64_t line = 0;
+
+  if (data == NULL || len < MAGIC_LEN || memcmp(data, MAGIC, MAGIC_LEN) != 0)
+    return NULL;
+
+  if (options & CMARK_OPT_DOCUMENT_ARENA) {
+    arena = cmark_arena_new();
+    cmark_arena_set_output_mem(arena, mem);
+    mem = cmark_arena_get_mem(arena);
+  }
+
+  memset(&r, 0, sizeof(r));
+  r.p = data + MAGIC_LEN;
+  r.end = data + len;
+  r.mem = mem;
+  r.in_place = in_place;
+
+  if (S_get_uint(&r) != VERSION ||
+      !S_read_extensions(&r, &exts, &n_exts, &types, &type_exts, &n_types))
+    r.failed = true;
+
+  while (!r.failed) {
+    uint64_t code = S_get_uint(&r);
+    uint16_t type = S_code_type(code);
+    cmark_syntax_extension *ext = NULL, *owner = NULL;
+    unsigned char bits;
+
+    if (code == 0) {
+      // The end of the children of 'parent'.
+      if (parent == NULL) {
+        r.failed = true;
+        break;
+      }
+      if (parent == root)
+        break;
+      parent = parent->parent;
+      continue;
+    }
+
+    if (type == 0) {
+      r.failed = true;
+      break;
+    }
+    if (!S_core_type(type)) {
+      for (i = 0; i < n_types && types[i] != type; ++i)
+        ;
+      if (i == n_types) {
+        r.failed = true;
+        break;
+      }
+      owner = exts[type_exts[i]];
+    }
+    bits = S_get_byte(&r);
+    if (bits & NODE_EXTENSION) {
+      i = (size_t)S_get_uint(&r);
+      ext = i < n_exts ? exts[i] : NULL;
+    }
+    if (r.failed || ((bits & NODE_EXTENSION) && ext == NULL) ||
+        (owner && ext != owner) ||
+        ((bits & NODE_EXTENSION_DATA) && !(ext && ext->deserialize_func)) ||
+        (!(bits & NODE_EXTENSION_DATA) && ext && ext->deserialize_func) ||
+        (parent && !cmark_node_can_contain_type(parent,
+                                                (cmark_node_type)type))) {
+      r.failed = true;
+      break;
+    }
+
+    node = cmark_node_slab_alloc(&slab, mem);
+    node->type = type;
+    node->extension = ext;
+    if (parent) {
+      node->parent = parent;
+      node->prev = parent->last_child;
+      if (parent->last_child)
+        parent->last_child->next = node;
+      else
+        parent->first_child = node;
+      parent->last_child = node;
+    } else {
+      root = node;
+      if (arena)
+        root->flags |= CMARK_NODE__ARENA_ROOT;
+    }
+    if (ext && ext->opaque_alloc_func)
+      ext->opaque_alloc_func(ext, mem, node);
+
+    line += S_get_int(&r, INT32_MIN, INT32_MAX);
+    if (line < INT32_MIN || line > INT32_MAX)
+      r.failed = true;
+    node->start_line = (int)line;
+    node->start_column = S_get_int(&r, INT32_MIN, INT32_MAX);
+    line += S_get_int(&r, INT32_MIN, INT32_MAX);
+    if (line < INT32_MIN || line > INT32_MAX)
+      r.failed = true;
+    node->end_line = (int)line;
+    line = node->start_line;
+    node->end_column = S_get_int(&r, INT32_MIN, INT32_MAX);
+
+    S_read_payload(&r, node);
+
+    if ((bits & NODE_EXTENSION_DATA) && !r.failed) {
+      size_t ext_len;
+      const unsigned char *ext_data = S_get_bytes(&r, &ext_len);
+      if (r.failed ||
+          !ext->deserialize_func(ext, mem, node, ext_data, ext_len))
+        r.failed = true;
+    }
+
+    if (bits & NODE_CHILDREN)
+      parent = node;
+    else if (node == root)
+      break;
+  }
+
+  if (r.p != r.end)
+    r.failed = true;
+  for (i = 0; i < r.n_refs && !r.failed; ++i) {
+    size_t def = r.refs[i].index;
+    if (def > r.n_defs)
+      r.failed = true;
+    else if (def)
+      cmark_node_cold_fields(r.refs[i].node)->parent_footnote_def =
+          r.defs[def - 1];
+  }
+
+  cmark_node_slab_release(&slab);
+  cmark_mem_free(mem, exts);
+  cmark_mem_free(mem, types);
+  cmark_mem_free(mem, type_exts);
+  cmark_mem_free(mem, r.defs);
+  cmark_mem_free(mem, r.refs);
+
+  if (r.failed) {
+    if (root)
+      cmark_node_free(root);
+    else if (arena)
+      cmark_arena_free(arena);
+    return NULL;
+  }
+  return root;
+}
+
+cmark_node *cmark_node_deserialize(const unsigned char *data, size_t len,
+                                   int options, cmark_mem *mem) {
+  return S_deserialize(data, len, options, mem, false);
+}
+
+cmark_node *cmark_node_deserialize_in_place(const unsigned char *data,
+                                            size_t len, int options,
+                                            cmark_mem *mem) {
+  return S_deserialize(data, len, options, mem, true);
+}
@@ -0,0 +1,652 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "simd.h"
+#include "mutex.h"
+
+#if defined(_M_X64) || defined(__x86_64__) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2) ||                                \
+    (defined(__i386__) && defined(__SSE2__))
+#define CMARK_HAVE_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define CMARK_HAVE_SSSE3 1
+#define CMARK_HAVE_AVX2 1
+#define CMARK_TARGET_SSSE3
+#define CMARK_TARGET_AVX2
+#elif defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define CMARK_HAVE_SSSE3 1
+#define CMARK_HAVE_AVX2 1
+#define CMARK_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define CMARK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static cmark_simd_level supported_level = CMARK_SIMD_NONE;
+// Read by every kernel call, possibly on several threads at once.
+static cmark_atomic_int active_level = CMARK_SIMD_NONE;
+
+CMARK_DEFINE_ONCE(simd)
+
+static void initialize_simd(void) {
+  cmark_simd_level level = CMARK_SIMD_NONE;
+
+#ifdef CMARK_HAVE_SSE2
+  level = CMARK_SIMD_SSE2;
+#endif
+
+#ifdef CMARK_HAVE_AVX2
+#if defined(_MSC_VER)
+  {
+    int info[4], max_leaf;
+    __cpuid(info, 0);
+    max_leaf = info[0];
+    __cpuid(info, 1);
+    if (info[2] & (1 << 9))
+      level = CMARK_SIMD_SSSE3;
+    // OSXSAVE and AVX, then check that the OS saves the YMM registers.
+    if (max_leaf >= 7 && (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+        (_xgetbv(0) & 6) == 6) {
+      __cpuidex(info, 7, 0);
+      if (info[1] & (1 << 5))
+        level = CMARK_SIMD_AVX2;
+    }
+  }
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3"))
+    level = CMARK_SIMD_SSSE3;
+  if (__builtin_cpu_supports("avx2"))
+    level = CMARK_SIMD_AVX2;
+#endif
+#endif
+
+  supported_level = level;
+  CMARK_ATOMIC_STORE(&active_level, level);
+}
+
+static inline cmark_simd_level S_level(void) {
+  CMARK_RUN_ONCE(simd, initialize_simd);
+  return (cmark_simd_level)CMARK_ATOMIC_LOAD(&active_level);
+}
+
+cmark_simd_level cmark_simd_get_level(void) { return S_level(); }
+
+cmark_simd_level cmark_simd_set_level(cmark_simd_level level) {
+  S_level();
+  if (level > supported_level)
+    level = supported_level;
+  CMARK_ATOMIC_STORE(&active_level, level);
+  return level;
+}
+
+#ifdef CMARK_HAVE_SSE2
+static inline int S_ctz(unsigned int mask) {
+#if defined(_MSC_VER)
+  unsigned long ix;
+  _BitScanForward(&ix, mask);
+  return (int)ix;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+static const unsigned char *find_eol_scalar(const unsigned char *p,
+                                            const unsigned char *end) {
+  for (; p < end; ++p) {
+    if (*p == '\n' || *p == '\r' || *p == '\0')
+      break;
+  }
+  return p;
+}
+
+#ifdef CMARK_HAVE_SSE2
+static const unsigned char *find_eol_sse2(const unsigned char *p,
+                                          const unsigned char *end) {
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i nul = _mm_setzero_si128();
+
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i hit = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)),
+        _mm_cmpeq_epi8(v, nul));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(hit);
+    if (mask)
+      return p + S_ctz(mask);
+    p += 16;
+  }
+
+  return find_eol_scalar(p, end);
+}
+#endif
+
+#ifdef CMARK_HAVE_AVX2
+CMARK_TARGET_AVX2
+static const unsigned char *find_eol_avx2(const unsigned char *p,
+                                          const unsigned char *end) {
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i nul = _mm256_setzero_si256();
+
+  // Most lines are short, so look at the first 16 bytes on their own before
+  // switching to 32 byte strides.
+  if (end - p >= 16) {
+    const unsigned char *q = find_eol_sse2(p, p + 16);
+    if (q < p + 16)
+      return q;
+    p += 16;
+  }
+
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hit = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)),
+        _mm256_cmpeq_epi8(v, nul));
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(hit);
+    if (mask)
+      return p + S_ctz(mask);
+    p += 32;
+  }
+
+  return find_eol_sse2(p, end);
+}
+#endif
+
+const unsigned char *cmark_simd_find_eol(const unsigned char *p,
+                                         const unsigned char *end) {
+  switch (S_level()) {
+#ifdef CMARK_HAVE_AVX2
+  case CMARK_SIMD_AVX2:
+    return find_eol_avx2(p, end);
+#endif
+#ifdef CMARK_HAVE_SSE2
+  case CMARK_SIMD_SSE2:
+  case CMARK_SIMD_SSSE3:
+    return find_eol_sse2(p, end);
+#endif
+  default:
+    return find_eol_scalar(p, end);
+  }
+}
+
+void cmark_simd_charset_init(cmark_simd_charset *set) {
+  memset(set, 0, sizeof(*set));
+  // High nibbles 8-15 stay zero, so bytes >= 0x80 never match in the
+  // nibble lookup; sets containing such bytes are handled by 'non_ascii'.
+  for (int i = 0; i < 8; ++i)
+    set->hi_nibble[i] = (uint8_t)(1 << i);
+}
+
+void cmark_simd_charset_add(cmark_simd_charset *set, unsigned char c) {
+  int lo;
+
+  if (cmark_simd_charset_contains(set, c))
+    return;
+
+  set->bitmap[c >> 3] |= (uint8_t)(1 << (c & 7));
+  if (c < 0x80)
+    set->lo_nibble[c & 0x0F] |= (uint8_t)(1 << (c >> 4));
+  else
+    set->non_ascii = true;
+
+  // Recompute the ranges of consecutive members.
+  set->num_ranges = 0;
+  for (lo = 0; lo < 256;) {
+    int hi;
+
+    if (!cmark_simd_charset_contains(set, (unsigned char)lo)) {
+      lo++;
+      continue;
+    }
+    for (hi = lo; hi < 255; ++hi) {
+      if (!cmark_simd_charset_contains(set, (unsigned char)(hi + 1)))
+        break;
+    }
+    if (set->num_ranges < CMARK_SIMD_CHARSET_MAX_RANGES) {
+      set->range_lo[set->num_ranges] = (uint8_t)lo;
+      set->range_len[set->num_ranges] = (uint8_t)(hi - lo);
+    }
+    set->num_ranges++;
+    lo = hi + 1;
+  }
+}
+
+// The kernels below return the first byte whose membership in 'set' equals
+// 'member', so that they serve both cmark_simd_find_charset and
+// cmark_simd_find_not_charset.
+
+static const unsigned char *
+find_charset_scalar(const cmark_simd_charset *set, const unsigned char *p,
+                    const unsigned char *end, bool member) {
+  for (; p < end; ++p) {
+    if (cmark_simd_charset_contains(set, *p) == member)
+      break;
+  }
+  return p;
+}
+
+#ifdef CMARK_HAVE_SSE2
+static const unsigned char *
+find_charset_sse2(const cmark_simd_charset *set, const unsigned char *p,
+                  const unsigned char *end, bool member) {
+  __m128i range_lo[CMARK_SIMD_CHARSET_MAX_RANGES];
+  __m128i range_len[CMARK_SIMD_CHARSET_MAX_RANGES];
+  const __m128i zero = _mm_setzero_si128();
+  const unsigned int flip = member ? 0 : 0xFFFF;
+  int n = set->num_ranges;
+
+  if (n > CMARK_SIMD_CHARSET_MAX_RANGES)
+    return find_charset_scalar(set, p, end, member);
+
+  for (int i = 0; i < n; ++i) {
+    range_lo[i] = _mm_set1_epi8((char)set->range_lo[i]);
+    range_len[i] = _mm_set1_epi8((char)set->range_len[i]);
+  }
+
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i hit = zero;
+    for (int i = 0; i < n; ++i) {
+      // v is in [lo, lo + len] iff (v - lo) saturating-minus len is zero,
+      // with the subtraction wrapping around.
+      __m128i d = _mm_subs_epu8(_mm_sub_epi8(v, range_lo[i]), range_len[i]);
+      hit = _mm_or_si128(hit, _mm_cmpeq_epi8(d, zero));
+    }
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(hit) ^ flip;
+    if (mask)
+      return p + S_ctz(mask);
+    p += 16;
+  }
+
+  return find_charset_scalar(set, p, end, member);
+}
+#endif
+
+#ifdef CMARK_HAVE_AVX2
+CMARK_TARGET_AVX2
+static const unsigned char *
+find_charset_avx2(const cmark_simd_charset *set, const unsigned char *p,
+                  const unsigned char *end, bool member) {
+  if (set->non_ascii)
+    return find_charset_sse2(set, p, end, member);
+
+  const __m256i lo_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->lo_nibble));
+  const __m256i hi_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->hi_nibble));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const unsigned int flip = member ? 0xFFFFFFFF : 0;
+
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)p);
+    // Each byte's low nibble selects the high nibbles that are members, and
+    // its high nibble selects a single bit; the byte is a member if the two
+    // overlap.
+    __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(
+        hi_table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    __m256i miss =
+        _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(miss) ^ flip;
+    if (mask)
+      return p + S_ctz(mask);
+    p += 32;
+  }
+
+  return find_charset_scalar(set, p, end, member);
+}
+#endif
+
+static const unsigned char *find_charset(const cmark_simd_charset *set,
+                                         const unsigned char *p,
+                                         const unsigned char *end,
+                                         bool member) {
+  switch (S_level()) {
+#ifdef CMARK_HAVE_AVX2
+  case CMARK_SIMD_AVX2:
+    return find_charset_avx2(set, p, end, member);
+#endif
+#ifdef CMARK_HAVE_SSE2
+  case CMARK_SIMD_SSE2:
+  case CMARK_SIMD_SSSE3:
+    return find_charset_sse2(set, p, end, member);
+#endif
+  default:
+    return find_charset_scalar(set, p, end, member);
+  }
+}
+
+const unsigned char *cmark_simd_find_charset(const cmark_simd_charset *set,
+                                             const unsigned char *p,
+                                             const unsigned char *end) {
+  return find_charset(set, p, end, true);
+}
+
+const unsigned char *
+cmark_simd_find_not_charset(const cmark_simd_charset *set,
+                            const unsigned char *p, const unsigned char *end) {
+  return find_charset(set, p, end, false);
+}
+
+// UTF-8 validation.  The scalar and SSE2 kernels only skip ASCII; the SSSE3
+// and AVX2 kernels validate multi-byte sequences as well, using the lookup
+// tables of Keiser and Lemire, "Validating UTF-8 In Less Than One
+// Instruction Per Byte" (2021).
+
+static const unsigned char *skip_valid_utf8_scalar(const unsigned char *p,
+                                                   const unsigned char *end) {
+  while (p < end && *p < 0x80 && *p != 0)
+    p++;
+  return p;
+}
+
+#ifdef CMARK_HAVE_SSE2
+static const unsigned char *skip_valid_utf8_sse2(const unsigned char *p,
+                                                 const unsigned char *end) {
+  const __m128i zero = _mm_setzero_si128();
+
+  // Don't bother loading a vector when there is no ASCII to skip.
+  if (p < end && (*p >= 0x80 || *p == 0))
+    return p;
+
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(v) |
+                        (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+    if (mask)
+      return p + S_ctz(mask);
+    p += 16;
+  }
+
+  return skip_valid_utf8_scalar(p, end);
+}
+#endif
+
+#ifdef CMARK_HAVE_SSSE3
+// Error bits, set in the byte following the one that starts the error.
+#define UTF8_TOO_SHORT (1 << 0)
+#define UTF8_TOO_LONG (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+static const uint8_t utf8_byte_1_high[16] = {
+    // 0_______: ASCII
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    // 10______: continuation
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    // 110_____: two byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2, UTF8_TOO_SHORT,
+    // 1110____: three byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    // 1111____: four byte lead
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4};
+
+static const uint8_t utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000};
+
+static const uint8_t utf8_byte_2_high[16] = {
+    // 0_______: ASCII
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    // 1000____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+        UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    // 1001____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+        UTF8_TOO_LARGE,
+    // 101_____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+        UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+        UTF8_TOO_LARGE,
+    // 11______: lead
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT};
+
+// Given that [start, p) passed validation except for sequences that may
+// continue past 'p', returns the last character boundary at or before 'p'
+// up to which the input is known to be valid.
+static const unsigned char *utf8_boundary(const unsigned char *start,
+                                          const unsigned char *p) {
+  for (int k = 1; k <= 3 && p - k >= start; ++k) {
+    if (p[-k] < 0x80)
+      break;
+    if (p[-k] >= 0xC0)
+      return p - k;
+  }
+  return p;
+}
+
+// Returns non-zero bytes where 'input' and the bytes before it, which end
+// 'prev', are not valid UTF-8.
+CMARK_TARGET_SSSE3
+static inline __m128i utf8_errors_ssse3(__m128i input, __m128i prev) {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i byte_1_high_table =
+      _mm_loadu_si128((const __m128i *)utf8_byte_1_high);
+  const __m128i byte_1_low_table =
+      _mm_loadu_si128((const __m128i *)utf8_byte_1_low);
+  const __m128i byte_2_high_table =
+      _mm_loadu_si128((const __m128i *)utf8_byte_2_high);
+
+  __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+  __m128i byte_1_high = _mm_shuffle_epi8(
+      byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+  __m128i byte_1_low =
+      _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, nibble));
+  __m128i byte_2_high = _mm_shuffle_epi8(
+      byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+  __m128i special =
+      _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  // Third and fourth bytes of a sequence must be continuations; only a lead
+  // byte two or three positions back leaves the high bit set here.
+  __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14),
+                                _mm_set1_epi8((char)(0xE0 - 0x80)));
+  __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13),
+                                 _mm_set1_epi8((char)(0xF0 - 0x80)));
+  __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth),
+                                 _mm_set1_epi8((char)0x80));
+
+  return _mm_xor_si128(must23, special);
+}
+
+// Returns non-zero bytes if 'input' ends in the middle of a sequence.
+CMARK_TARGET_SSSE3
+static inline __m128i utf8_incomplete_ssse3(__m128i input) {
+  const __m128i max =
+      _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+  return _mm_subs_epu8(input, max);
+}
+
+CMARK_TARGET_SSSE3
+static inline bool S_any_ssse3(__m128i v) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF;
+}
+
+CMARK_TARGET_SSSE3
+static const unsigned char *skip_valid_utf8_ssse3(const unsigned char *p,
+                                                  const unsigned char *end) {
+  const unsigned char *start = p;
+  const __m128i zero = _mm_setzero_si128();
+  __m128i prev = zero;
+
+  while (p < end) {
+    size_t n = (size_t)(end - p);
+    __m128i input, error;
+
+    if (n >= 16) {
+      input = _mm_loadu_si128((const __m128i *)p);
+      n = 16;
+    } else {
+      // Pad the tail with spaces, so that a sequence cut off by 'end' is
+      // reported as too short.
+      unsigned char tail[16];
+      memset(tail, ' ', sizeof(tail));
+      memcpy(tail, p, n);
+      input = _mm_loadu_si128((const __m128i *)tail);
+    }
+
+    error = _mm_cmpeq_epi8(input, zero);
+    if (_mm_movemask_epi8(input))
+      error = _mm_or_si128(error, utf8_errors_ssse3(input, prev));
+    else
+      error = _mm_or_si128(error, utf8_incomplete_ssse3(prev));
+
+    if (S_any_ssse3(error))
+      return utf8_boundary(start, p);
+
+    prev = input;
+    p += n;
+  }
+
+  if (S_any_ssse3(utf8_incomplete_ssse3(prev)))
+    return utf8_boundary(start, end);
+
+  return end;
+}
+#endif
+
+#ifdef CMARK_HAVE_AVX2
+// Returns the bytes of 'input' shifted right by 'n', filled in from the end
+// of 'prev'.
+#define UTF8_PREV(input, prev, n)                                              \
+  _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev), (input), 0x21), \
+                     16 - (n))
+
+CMARK_TARGET_AVX2
+static inline __m256i S_broadcast_table(const uint8_t *table) {
+  return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+
+CMARK_TARGET_AVX2
+static inline __m256i utf8_errors_avx2(__m256i input, __m256i prev) {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i byte_1_high_table = S_broadcast_table(utf8_byte_1_high);
+  const __m256i byte_1_low_table = S_broadcast_table(utf8_byte_1_low);
+  const __m256i byte_2_high_table = S_broadcast_table(utf8_byte_2_high);
+
+  __m256i prev1 = UTF8_PREV(input, prev, 1);
+  __m256i byte_1_high = _mm256_shuffle_epi8(
+      byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+  __m256i byte_1_low =
+      _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+  __m256i byte_2_high = _mm256_shuffle_epi8(
+      byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+  __m256i special =
+      _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // Third and fourth bytes of a sequence must be continuations; only a lead
+  // byte two or three positions back leaves the high bit set here.
+  __m256i third = _mm256_subs_epu8(UTF8_PREV(input, prev, 2),
+                                   _mm256_set1_epi8((char)(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(UTF8_PREV(input, prev, 3),
+                                    _mm256_set1_epi8((char)(0xF0 - 0x80)));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                    _mm256_set1_epi8((char)0x80));
+
+  return _mm256_xor_si256(must23, special);
+}
+
+// Returns non-zero bytes if 'input' ends in the middle of a sequence.
+CMARK_TARGET_AVX2
+static inline __m256i utf8_incomplete_avx2(__m256i input) {
+  const __m256i max = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1),
+      (char)(0xE0 - 1), (char)(0xC0 - 1));
+  return _mm256_subs_epu8(input, max);
+}
+
+CMARK_TARGET_AVX2
+static const unsigned char *skip_valid_utf8_avx2(const unsigned char *p,
+                                                 const unsigned char *end) {
+  const unsigned char *start = p;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i prev = zero;
+
+  while (p < end) {
+    size_t n = (size_t)(end - p);
+    __m256i input, error;
+
+    if (n >= 32) {
+      input = _mm256_loadu_si256((const __m256i *)p);
+      n = 32;
+    } else {
+      // Pad the tail with spaces, so that a sequence cut off by 'end' is
+      // reported as too short.
+      unsigned char tail[32];
+      memset(tail, ' ', sizeof(tail));
+      memcpy(tail, p, n);
+      input = _mm256_loadu_si256((const __m256i *)tail);
+    }
+
+    error = _mm256_cmpeq_epi8(input, zero);
+    if (_mm256_movemask_epi8(input))
+      error = _mm256_or_si256(error, utf8_errors_avx2(input, prev));
+    else
+      error = _mm256_or_si256(error, utf8_incomplete_avx2(prev));
+
+    if (!_mm256_testz_si256(error, error))
+      return utf8_boundary(start, p);
+
+    prev = input;
+    p += n;
+  }
+
+  if (!_mm256_testz_si256(utf8_incomplete_avx2(prev),
+                          utf8_incomplete_avx2(prev)))
+    return utf8_boundary(start, end);
+
+  return end;
+}
+#endif
+
+const unsigned char *cmark_simd_skip_valid_utf8(const unsigned char *p,
+                                                const unsigned char *end) {
+  switch (S_level()) {
+#ifdef CMARK_HAVE_AVX2
+  case CMARK_SIMD_AVX2:
+    return skip_valid_utf8_avx2(p, end);
+#endif
+#ifdef CMARK_HAVE_SSSE3
+  case CMARK_SIMD_SSSE3:
+    return skip_valid_utf8_ssse3(p, end);
+#endif
+#ifdef CMARK_HAVE_SSE2
+  case CMARK_SIMD_SSE2:
+    return skip_valid_utf8_sse2(p, end);
+#endif
+  default:
+    return skip_valid_utf8_scalar(p, end);
+  }
+}
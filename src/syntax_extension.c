@@ -16,14 +16,14 @@ void cmark_syntax_extension_free(cmark_mem *mem, cmark_syntax_extension *extensi
   }
 
   cmark_llist_free(mem, extension->special_inline_chars);
-  mem->free(extension->name);
-  mem->free(extension);
+  cmark_mem_free(mem, extension->name);
+  cmark_mem_free(mem, extension);
 }
 
 cmark_syntax_extension *cmark_syntax_extension_new(const char *name) {
-  cmark_syntax_extension *res = (cmark_syntax_extension *) _mem->calloc(1, sizeof(cmark_syntax_extension));
+  cmark_syntax_extension *res = (cmark_syntax_extension *) cmark_mem_calloc(_mem, 1, sizeof(cmark_syntax_extension));
   size_t size = strlen(name) + 1;
-  res->name = (char *) _mem->calloc(size, sizeof(char));
+  res->name = (char *) cmark_mem_calloc(_mem, size, sizeof(char));
 #if defined(_WIN32)
   strcpy_s(res->name, size, name);
 #else
@@ -149,6 +149,26 @@ void cmark_syntax_extension_set_opaque_free_func(cmark_syntax_extension *extensi
   extension->opaque_free_func = func;
 }
 
+void cmark_syntax_extension_set_opaque_copy_func(cmark_syntax_extension *extension,
+                                                 cmark_opaque_copy_func func) {
+  extension->opaque_copy_func = func;
+}
+
+void cmark_syntax_extension_set_hash_func(cmark_syntax_extension *extension,
+                                          cmark_hash_func func) {
+  extension->hash_func = func;
+}
+
+void cmark_syntax_extension_set_serialize_func(cmark_syntax_extension *extension,
+                                               cmark_serialize_func func) {
+  extension->serialize_func = func;
+}
+
+void cmark_syntax_extension_set_deserialize_func(cmark_syntax_extension *extension,
+                                                 cmark_deserialize_func func) {
+  extension->deserialize_func = func;
+}
+
 void cmark_syntax_extension_set_commonmark_escape_func(cmark_syntax_extension *extension,
                                                        cmark_commonmark_escape_func func) {
   extension->commonmark_escape_func = func;
@@ -4,6 +4,7 @@
 
 #include "cmark_ctype.h"
 #include "utf8.h"
+#include "simd.h"
 
 static const int8_t utf8proc_utf8class[256] = {
     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
@@ -107,31 +108,48 @@ static int utf8proc_valid(const uint8_t *str, bufsize_t str_len) {
   return length;
 }
 
+// Returns the end of the valid UTF-8 without NUL bytes that starts at 'i',
+// and sets 'charlen' to the length of the invalid sequence there, if any.
+static bufsize_t S_skip_valid(const uint8_t *line, bufsize_t i,
+                              bufsize_t size, int *charlen) {
+  // Except for SSSE3 and AVX2, the kernel stops at the first byte that is not
+  // ASCII.
+  // A line that has one seldom has long runs of ASCII after it, so the rest
+  // is decoded here, rather than going back to the kernel after every
+  // character.
+  i = (bufsize_t)(cmark_simd_skip_valid_utf8(line + i, line + size) - line);
+
+  while (i < size) {
+    if (line[i] < 0x80 && line[i] != 0) {
+      i++;
+    } else if (line[i] >= 0x80) {
+      int len = utf8proc_valid(line + i, size - i);
+      if (len < 0) {
+        *charlen = -len;
+        return i;
+      }
+      i += len;
+    } else {
+      // ASCII NUL is technically valid but rejected
+      // for security reasons.
+      *charlen = 1;
+      return i;
+    }
+  }
+
+  *charlen = 0;
+  return size;
+}
+
 void cmark_utf8proc_check(cmark_strbuf *ob, const uint8_t *line,
                           bufsize_t size) {
   bufsize_t i = 0;
 
   while (i < size) {
     bufsize_t org = i;
-    int charlen = 0;
-
-    while (i < size) {
-      if (line[i] < 0x80 && line[i] != 0) {
-        i++;
-      } else if (line[i] >= 0x80) {
-        charlen = utf8proc_valid(line + i, size - i);
-        if (charlen < 0) {
-          charlen = -charlen;
-          break;
-        }
-        i += charlen;
-      } else if (line[i] == 0) {
-        // ASCII NUL is technically valid but rejected
-        // for security reasons.
-        charlen = 1;
-        break;
-      }
-    }
+    int charlen;
+
+    i = S_skip_valid(line, i, size, &charlen);
 
     if (i > org) {
       cmark_strbuf_put(ob, line + org, i - org);
@@ -147,6 +165,12 @@ void cmark_utf8proc_check(cmark_strbuf *ob, const uint8_t *line,
   }
 }
 
+bool cmark_utf8proc_is_valid(const uint8_t *line, bufsize_t size) {
+  int charlen;
+
+  return S_skip_valid(line, 0, size, &charlen) >= size;
+}
+
 int cmark_utf8proc_iterate(const uint8_t *str, bufsize_t str_len,
                            int32_t *dst) {
   int length;
@@ -8,6 +8,7 @@
 #include "node.h"
 #include "buffer.h"
 #include "houdini.h"
+#include "render.h"
 #include "syntax_extension.h"
 
 #define BUFFER_SIZE 100
@@ -159,27 +160,48 @@ static int S_render_node(cmark_node *node, cmark_event_type ev_type,
 }
 
 char *cmark_render_xml(cmark_node *root, int options) {
-  return cmark_render_xml_with_mem(root, options, cmark_node_mem(root));
+  return cmark_render_xml_with_mem(root, options, cmark_node_output_mem(root));
 }
 
-char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem) {
-  char *result;
-  cmark_strbuf xml = CMARK_BUF_INIT(mem);
+static void S_render_tree(struct render_state *state, cmark_node *root,
+                          int options, cmark_write_func write,
+                          void *userdata) {
   cmark_event_type ev_type;
   cmark_node *cur;
-  struct render_state state = {&xml, 0};
-
   cmark_iter *iter = cmark_iter_new(root);
 
-  cmark_strbuf_puts(state.xml, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-  cmark_strbuf_puts(state.xml,
+  cmark_strbuf_puts(state->xml, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+  cmark_strbuf_puts(state->xml,
                     "<!DOCTYPE document SYSTEM \"CommonMark.dtd\">\n");
   while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
     cur = cmark_iter_get_node(iter);
-    S_render_node(cur, ev_type, &state, options);
+    S_render_node(cur, ev_type, state, options);
+    if (write && state->xml->size >= CMARK_SINK_CHUNK_SIZE) {
+      write((const char *)state->xml->ptr, (size_t)state->xml->size, userdata);
+      cmark_strbuf_clear(state->xml);
+    }
   }
-  result = (char *)cmark_strbuf_detach(&xml);
 
   cmark_iter_free(iter);
+}
+
+char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem) {
+  char *result;
+  cmark_strbuf xml = CMARK_BUF_INIT(mem);
+  struct render_state state = {&xml, 0};
+
+  S_render_tree(&state, root, options, NULL, NULL);
+  result = (char *)cmark_strbuf_detach(&xml);
+
   return result;
 }
+
+void cmark_render_xml_to_sink(cmark_node *root, int options,
+                              cmark_write_func write, void *userdata) {
+  cmark_strbuf xml = CMARK_BUF_INIT(cmark_node_output_mem(root));
+  struct render_state state = {&xml, 0};
+
+  S_render_tree(&state, root, options, write, userdata);
+  write((const char *)xml.ptr, (size_t)xml.size, userdata);
+  cmark_strbuf_free(&xml);
+}
@@ -1,4 +1,4 @@
-# Creates C data structures for binary lookup table of entities,
+# Creates C data structures for a perfect hash table of entities,
 # using python's html5 entity data.
 # Usage: python3 tools/make_entities_inc.py > src/entities.inc
 
@@ -11,8 +11,53 @@ entities5 = html.entities.html5
 # without a semicolon.
 entities = sorted([(k[:-1], entities5[k].encode('utf-8')) for k in entities5.keys() if k[-1] == ';'])
 
+# Build a minimal perfect hash ("hash, displace"): every name is first
+# hashed into one of NUM_BUCKETS buckets.  Each bucket stores a seed for a
+# second hash that sends all of its names to distinct free slots; buckets
+# holding a single name store the slot directly, as -slot - 1.  The lookup
+# in houdini_html_u.c mirrors entity_hash().
+NUM_BUCKETS = 1024
+
+def entity_hash(seed, name):
+    h = seed if seed else 0x01000193
+    for c in name.encode('ascii'):
+        h = ((h * 0x01000193) ^ c) & 0xffffffff
+    return h
+
+num_slots = len(entities)
+buckets = [[] for _ in range(NUM_BUCKETS)]
+for (ent, bs) in entities:
+    buckets[entity_hash(0, ent) % NUM_BUCKETS].append((ent, bs))
+
+seeds = [0] * NUM_BUCKETS
+slots = [None] * num_slots
+
+order = sorted(range(NUM_BUCKETS), key=lambda b: -len(buckets[b]))
+for b in order:
+    bucket = buckets[b]
+    if len(bucket) <= 1:
+        break
+    seed = 1
+    while True:
+        taken = [entity_hash(seed, ent) % num_slots for (ent, bs) in bucket]
+        if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+            break
+        seed += 1
+    for s, item in zip(taken, bucket):
+        slots[s] = item
+    seeds[b] = seed
+
+free = [s for s in range(num_slots) if slots[s] is None]
+for b in order:
+    if len(buckets[b]) == 1:
+        s = free.pop()
+        slots[s] = buckets[b][0]
+        seeds[b] = -s - 1
+
+assert max(abs(s) for s in seeds) < 32768
+
 # Print out the header:
-print("""/* Autogenerated by tools/make_headers_inc.py */
+print("""/* Autogenerated by tools/make_entities_inc.py */
 
 struct cmark_entity_node {
 	unsigned char *entity;
@@ -23,10 +68,16 @@ struct cmark_entity_node {
 #define CMARK_ENTITY_MAX_LENGTH 32""")
 
 print("#define CMARK_NUM_ENTITIES " + str(len(entities)));
+print("#define CMARK_ENTITY_HASH_BUCKETS " + str(NUM_BUCKETS));
+
+print("\nstatic const int16_t cmark_entity_seeds[] = {");
+for i in range(0, NUM_BUCKETS, 12):
+  print(' '.join(str(s) + ',' for s in seeds[i:i + 12]))
+print("};")
 
 print("\nstatic const struct cmark_entity_node cmark_entities[] = {");
 
-for (ent, bs) in entities:
+for (ent, bs) in slots:
   print('{(unsigned char*)"' + ent + '", {' + ', '.join(map(str, bs)) + ', 0}},')
 
 print("};")